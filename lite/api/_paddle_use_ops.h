@@ -51,6 +51,7 @@ USE_LITE_OP(pool2d)
 USE_LITE_OP(max_pool2d_with_index)
 USE_LITE_OP(batch_norm)
 USE_LITE_OP(fusion_elementwise_sub_activation)
+USE_LITE_OP(fused_elementwise)
 USE_LITE_OP(transpose)
 USE_LITE_OP(transpose2)
 USE_LITE_OP(arg_max)
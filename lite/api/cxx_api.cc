@@ -15,6 +15,8 @@
 #include "lite/api/cxx_api.h"
 
 #include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
 #include <memory>
 #include <set>
 #include <string>
@@ -22,7 +24,10 @@
 #include <vector>
 
 #include "lite/api/paddle_use_passes.h"
+#include "lite/core/version.h"
+#include "lite/utils/env.h"
 #include "lite/utils/io.h"
+#include "lite/utils/md5.h"
 
 namespace paddle {
 namespace lite {
@@ -68,13 +73,97 @@ bool IsQuantizedMode(const std::shared_ptr<cpp::ProgramDesc> &program_desc) {
   return is_quantized_model;
 }
 
+std::string FileMD5(const std::string &path) {
+  // The naive buffer models with meta_version 4 carry the md5 of their
+  // content, so they don't have to be read.
+  std::string hash;
+  if (ReadModelContentHash(path, &hash)) {
+    return hash;
+  }
+  // The file is hashed in chunks rather than read at once, as the params may
+  // be as large as the memory available.
+  FILE *file = fopen(path.c_str(), "rb");
+  CHECK(file) << "Failed to open " << path;
+  MD5Hasher hasher;
+  std::vector<char> chunk(1 << 20);
+  size_t size;
+  while ((size = fread(chunk.data(), 1, chunk.size(), file)) > 0) {
+    hasher.Update(chunk.data(), size);
+  }
+  bool failed = ferror(file) != 0;
+  fclose(file);
+  CHECK(!failed) << "Failed to read " << path;
+  return hasher.HexFinal();
+}
+
+std::string OptimizedModelCacheKey(const lite_api::CxxConfig &config,
+                                   const std::vector<Place> &valid_places,
+                                   const std::vector<std::string> &passes,
+                                   lite_api::LiteModelType model_type) {
+  std::ostringstream key;
+  key << "version:" << version() << ";model_type:"
+      << static_cast<int>(model_type) << ";";
+  if (config.is_model_from_memory()) {
+    const auto &model_buffer = config.get_model_buffer();
+    key << "program:" << MD5(model_buffer.get_program())
+        << ";params:" << MD5(model_buffer.get_params()) << ";";
+  } else {
+    std::vector<std::string> files;
+    if (!config.model_file().empty()) files.push_back(config.model_file());
+    if (!config.param_file().empty()) files.push_back(config.param_file());
+    const auto &model_dir = config.model_dir();
+    if (files.empty() && IsDir(model_dir)) {
+      // The separated params are all the files of the model dir.
+      for (auto &name : ListDir(model_dir, false)) {
+        auto path = model_dir + "/" + name;
+        if (!IsDir(path)) files.push_back(path);
+      }
+      std::sort(files.begin(), files.end());
+    } else if (files.empty()) {
+      files.push_back(model_dir);
+    }
+    for (auto &file : files) {
+      key << file.substr(file.find_last_of("/\\") + 1) << ":"
+          << FileMD5(file) << ";";
+    }
+  }
+  for (auto &place : valid_places) {
+    key << "place:" << place.DebugString() << ";";
+  }
+  for (auto &pass : passes) {
+    key << "pass:" << pass << ";";
+  }
+  if (config.quant_model()) {
+    key << "quant_type:" << static_cast<int>(config.quant_type()) << ";";
+  }
+  // The environment variables read by the passes.
+  for (auto &env : std::vector<std::string>{
+           SUBGRAPH_CUSTOM_PARTITION_CONFIG_FILE,
+           SUBGRAPH_ONLINE_MODE,
+           QUANT_INPUT_OUTPUT_SCALE_RESTRICT_METHOD,
+           KERNEL_PICK_BENCHMARK,
+           "XPU_ENABLE_XTCL",
+           "XPU_ENCODER_PRECISION",
+           "LITE_DISABLE_MLU_CAST"}) {
+    key << env << ":" << GetStringFromEnv(env) << ";";
+  }
+  auto partition_file = GetStringFromEnv(SUBGRAPH_CUSTOM_PARTITION_CONFIG_FILE);
+  if (!partition_file.empty() && IsFileExists(partition_file)) {
+    key << "partition:" << FileMD5(partition_file) << ";";
+  }
+  return MD5(key.str());
+}
+
 void Predictor::SaveModel(const std::string &dir,
                           lite_api::LiteModelType model_type,
-                          bool record_info) {
+                          bool record_info,
+                          bool save_prepacked_weights,
+                          bool drop_prepacked_sources) {
   if (!program_) {
     GenRuntimeProgram();
   }
-  program_->SaveToProgram(program_desc_);
+  program_->SaveToProgram(
+      program_desc_, save_prepacked_weights, drop_prepacked_sources);
   switch (model_type) {
     case lite_api::LiteModelType::kProtobuf:
       SaveModelPb(dir, *program_->exec_scope(), *program_desc_.get(), true);
@@ -296,6 +385,13 @@ void Predictor::Build(const lite_api::CxxConfig &config,
                       const std::vector<Place> &valid_places,
                       const std::vector<std::string> &passes,
                       lite_api::LiteModelType model_type) {
+  std::string cache_path;
+  if (!config.optimized_model_cache_dir().empty()) {
+    cache_path =
+        config.optimized_model_cache_dir() + "/" +
+        OptimizedModelCacheKey(config, valid_places, passes, model_type);
+    if (LoadOptimizedModelCache(cache_path, valid_places)) return;
+  }
   if (config.is_model_from_memory()) {
     LOG(INFO) << "Load model from memory.";
     Build(config.model_dir(),
@@ -314,6 +410,55 @@ void Predictor::Build(const lite_api::CxxConfig &config,
           passes,
           model_type);
   }
+  if (!cache_path.empty()) {
+    SaveOptimizedModelCache(cache_path);
+  }
+}
+
+bool Predictor::LoadOptimizedModelCache(
+    const std::string &cache_path, const std::vector<Place> &valid_places) {
+  const std::string model_file = cache_path + ".nb";
+  if (!IsFileExists(model_file)) {
+    VLOG(3) << "The optimized model is not cached in " << model_file;
+    return false;
+  }
+  LOG(INFO) << "Load the optimized model from " << model_file;
+  LoadModelNaiveFromFile(model_file, scope_.get(), program_desc_.get());
+  // The kernels are picked already, the places only create the ops.
+  std::vector<Place> inner_places = valid_places;
+  for (auto &valid_place : valid_places) {
+    if (valid_place.target == TARGET(kOpenCL)) continue;
+    inner_places.emplace_back(
+        Place(TARGET(kHost), valid_place.precision, valid_place.layout));
+  }
+  Program program(program_desc_, scope_, inner_places);
+  valid_places_ = inner_places;
+  exec_scope_ = program.exec_scope();
+  program_.reset(new RuntimeProgram(program_desc_, exec_scope_, kRootBlockIdx));
+  program_generated_ = true;
+  PrepareFeedFetch();
+  return true;
+}
+
+void Predictor::SaveOptimizedModelCache(const std::string &cache_path) {
+  auto pos = cache_path.find_last_of('/');
+  MkDirRecur(cache_path.substr(0, pos));
+  // Write to a unique temporary file first and rename it, so that another
+  // process never loads a partially written model.
+  auto tmp_path = string_format(
+      "%s.%lld.%p",
+      cache_path.c_str(),
+      static_cast<long long>(  // NOLINT
+          std::chrono::steady_clock::now().time_since_epoch().count()),
+      static_cast<void *>(this));
+  SaveModel(tmp_path, lite_api::LiteModelType::kNaiveBuffer);
+  const std::string model_file = cache_path + ".nb";
+  if (std::rename((tmp_path + ".nb").c_str(), model_file.c_str()) != 0) {
+    LOG(WARNING) << "Failed to save the optimized model to " << model_file;
+    std::remove((tmp_path + ".nb").c_str());
+    return;
+  }
+  LOG(INFO) << "Save the optimized model to " << model_file;
 }
 void Predictor::Build(const std::string &model_path,
                       const std::string &model_file,
@@ -384,9 +529,26 @@ void Predictor::Build(const std::shared_ptr<cpp::ProgramDesc> &program_desc,
 void Predictor::GenRuntimeProgram() {
   program_ = optimizer_.GenRuntimeProgram();
   CHECK_EQ(exec_scope_, program_->exec_scope());
+  program_->set_runtime_stats(runtime_stats_);
   program_generated_ = true;
 }
 
+void Predictor::set_runtime_stats(bool enabled) {
+  runtime_stats_ = enabled;
+  if (program_generated_) {
+    program_->set_runtime_stats(enabled);
+  }
+}
+
+lite_api::RuntimeStats Predictor::GetRuntimeStats() const {
+  if (!program_generated_) {
+    lite_api::RuntimeStats stats;
+    stats.enabled = runtime_stats_;
+    return stats;
+  }
+  return program_->GetRuntimeStats();
+}
+
 const lite::Tensor *Predictor::GetTensor(const std::string &name) const {
   auto *var = exec_scope_->FindVar(name);
   CHECK(var) << "no variable named with " << name << " in exec_scope";
@@ -38,6 +38,13 @@ static const char TAILORD_KERNELS_LIST_NAME[] = ".tailored_kernels_list";
 
 std::vector<std::string> GetAllOps();
 
+// The name of the optimized model in the cache, i.e. the md5 of the content
+// of the model and of everything the optimizer depends on.
+std::string OptimizedModelCacheKey(const lite_api::CxxConfig& config,
+                                   const std::vector<Place>& valid_places,
+                                   const std::vector<std::string>& passes,
+                                   lite_api::LiteModelType model_type);
+
 /*
  * Predictor for inference, input a model, it will optimize and execute it.
  */
@@ -198,13 +205,22 @@ class LITE_API Predictor {
   // get a const tensor according to its name
   const lite::Tensor* GetTensor(const std::string& name) const;
   const RuntimeProgram& runtime_program() const;
+  // Record the latencies of the runs and the ops, see
+  // lite_api::ConfigBase::set_runtime_stats.
+  void set_runtime_stats(bool enabled);
+  lite_api::RuntimeStats GetRuntimeStats() const;
   Scope* scope() { return scope_.get(); }
 
   // This method is disabled in mobile, for unnecessary dependencies required.
+  // If `save_prepacked_weights` is true, the weights packed by the kernels are
+  // saved too, see CxxConfig::set_save_prepacked_weights and
+  // CxxConfig::set_drop_prepacked_sources.
   void SaveModel(
       const std::string& dir,
       lite_api::LiteModelType model_type = lite_api::LiteModelType::kProtobuf,
-      bool record_info = false);
+      bool record_info = false,
+      bool save_prepacked_weights = false,
+      bool drop_prepacked_sources = false);
   void SaveOpKernelInfo(const std::string& model_dir);
 
   /////////////////////////////////////////////////////////////////////////////
@@ -227,6 +243,11 @@ class LITE_API Predictor {
   // check if the input tensor precision type is correct.
   // would be called in Run().
   void CheckInputValid();
+  // Build the runtime program from the optimized model cached at
+  // `cache_path`, returns false if the model is not cached yet.
+  bool LoadOptimizedModelCache(const std::string& cache_path,
+                               const std::vector<Place>& valid_places);
+  void SaveOptimizedModelCache(const std::string& cache_path);
 
  private:
   Optimizer optimizer_;
@@ -235,6 +256,7 @@ class LITE_API Predictor {
   Scope* exec_scope_;
   std::shared_ptr<RuntimeProgram> program_;
   bool program_generated_{false};
+  bool runtime_stats_{false};
   std::vector<std::string> input_names_;
   std::vector<std::string> output_names_;
   std::vector<Place> valid_places_;
@@ -290,6 +312,8 @@ class CxxPaddleApiImpl : public lite_api::PaddlePredictor {
       lite_api::LiteModelType model_type = lite_api::LiteModelType::kProtobuf,
       bool record_info = false) override;
 
+  lite_api::RuntimeStats GetRuntimeStats() const override;
+
  private:
   std::shared_ptr<Predictor> raw_predictor_;
   lite_api::CxxConfig config_;
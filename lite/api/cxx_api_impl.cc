@@ -93,6 +93,7 @@ void CxxPaddleApiImpl::Init(const lite_api::CxxConfig &config) {
     raw_predictor_->PrepareFeedFetch();
     CHECK(raw_predictor_) << "The Predictor can not be nullptr in Clone mode.";
   }
+  raw_predictor_->set_runtime_stats(config.runtime_stats());
   mode_ = config.power_mode();
   threads_ = config.threads();
 #ifdef LITE_WITH_NPU
@@ -259,7 +260,15 @@ std::unique_ptr<lite_api::Tensor> CxxPaddleApiImpl::GetInputByName(
 void CxxPaddleApiImpl::SaveOptimizedModel(const std::string &model_dir,
                                           lite_api::LiteModelType model_type,
                                           bool record_info) {
-  raw_predictor_->SaveModel(model_dir, model_type, record_info);
+  raw_predictor_->SaveModel(model_dir,
+                            model_type,
+                            record_info,
+                            config_.save_prepacked_weights(),
+                            config_.drop_prepacked_sources());
+}
+
+lite_api::RuntimeStats CxxPaddleApiImpl::GetRuntimeStats() const {
+  return raw_predictor_->GetRuntimeStats();
 }
 
 }  // namespace lite
@@ -15,6 +15,8 @@
 #include "lite/api/cxx_api.h"
 #include <gflags/gflags.h>
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
 #include <vector>
 #include "lite/api/lite_api_test_helper.h"
 #include "lite/api/paddle_use_kernels.h"
@@ -22,6 +24,7 @@
 #include "lite/api/paddle_use_passes.h"
 #include "lite/core/op_registry.h"
 #include "lite/core/tensor.h"
+#include "lite/utils/io.h"
 
 // For training.
 DEFINE_string(startup_program_path, "", "");
@@ -100,6 +103,130 @@ TEST(CXXApi, clone_predictor) {
   }
 }
 
+TEST(CXXApi, optimized_model_cache_key) {
+  std::vector<Place> valid_places({Place{TARGET(kX86), PRECISION(kFloat)}});
+  lite_api::CxxConfig config;
+  config.set_model_dir(FLAGS_model_dir);
+  auto key = OptimizedModelCacheKey(
+      config, valid_places, {}, lite_api::LiteModelType::kProtobuf);
+  EXPECT_EQ(key.size(), 32u);
+  EXPECT_EQ(key,
+            OptimizedModelCacheKey(
+                config, valid_places, {}, lite_api::LiteModelType::kProtobuf));
+
+  // Everything the optimizer depends on is part of the key.
+  std::vector<Place> host_places(valid_places);
+  host_places.emplace_back(TARGET(kHost), PRECISION(kFloat));
+  EXPECT_NE(key,
+            OptimizedModelCacheKey(
+                config, host_places, {}, lite_api::LiteModelType::kProtobuf));
+  EXPECT_NE(key,
+            OptimizedModelCacheKey(config,
+                                   valid_places,
+                                   {"lite_fc_fuse_pass"},
+                                   lite_api::LiteModelType::kProtobuf));
+  EXPECT_NE(key,
+            OptimizedModelCacheKey(config,
+                                   valid_places,
+                                   {},
+                                   lite_api::LiteModelType::kNaiveBuffer));
+
+  // So is the content of the model files, which span several of the chunks
+  // they are hashed in.
+  const std::string dir = FLAGS_optimized_model + "_cache_key";
+  MkDirRecur(dir);
+  std::string params(3 * 1024 * 1024 + 17, 'p');
+  ASSERT_TRUE(WriteFile(dir + "/__model__", std::vector<char>(100, 'm')));
+  ASSERT_TRUE(WriteFile(dir + "/params",
+                        std::vector<char>(params.begin(), params.end())));
+  lite_api::CxxConfig files_config;
+  files_config.set_model_file(dir + "/__model__");
+  files_config.set_param_file(dir + "/params");
+  auto files_key = OptimizedModelCacheKey(
+      files_config, valid_places, {}, lite_api::LiteModelType::kProtobuf);
+  params.back() = 'q';
+  ASSERT_TRUE(WriteFile(dir + "/params",
+                        std::vector<char>(params.begin(), params.end())));
+  EXPECT_NE(files_key,
+            OptimizedModelCacheKey(files_config,
+                                   valid_places,
+                                   {},
+                                   lite_api::LiteModelType::kProtobuf));
+  params.back() = 'p';
+  ASSERT_TRUE(WriteFile(dir + "/params",
+                        std::vector<char>(params.begin(), params.end())));
+  EXPECT_EQ(files_key,
+            OptimizedModelCacheKey(files_config,
+                                   valid_places,
+                                   {},
+                                   lite_api::LiteModelType::kProtobuf));
+}
+
+// Runs the predictor on an input of ones and returns its output.
+std::vector<float> RunOnOnes(lite::Predictor* predictor) {
+  auto* input_tensor = predictor->GetInput(0);
+  input_tensor->Resize(std::vector<int64_t>({1, 100}));
+  auto* data = input_tensor->mutable_data<float>();
+  for (int i = 0; i < 100; i++) {
+    data[i] = 1;
+  }
+  predictor->Run();
+  auto* output_tensor = predictor->GetOutput(0);
+  const float* output = output_tensor->data<float>();
+  return std::vector<float>(output, output + output_tensor->numel());
+}
+
+TEST(CXXApi, optimized_model_cache) {
+  const std::string cache_dir = FLAGS_optimized_model + "_cache";
+  MkDirRecur(cache_dir);
+  for (auto& name : ListDir(cache_dir, false)) {
+    std::remove((cache_dir + "/" + name).c_str());
+  }
+  std::vector<Place> valid_places({Place{TARGET(kX86), PRECISION(kFloat)}});
+  lite_api::CxxConfig config;
+  config.set_model_dir(FLAGS_model_dir);
+  config.set_optimized_model_cache_dir(cache_dir);
+
+  lite::Predictor uncached;
+  uncached.Build(FLAGS_model_dir, "", "", valid_places);
+  auto expected = RunOnOnes(&uncached);
+
+  // The first build misses and saves the optimized model.
+  lite::Predictor missed;
+  missed.Build(config, valid_places);
+  ASSERT_EQ(ListDir(cache_dir, false).size(), 1u);
+  auto cached_model = cache_dir + "/" + ListDir(cache_dir, false)[0];
+  EXPECT_EQ(cached_model,
+            cache_dir + "/" +
+                OptimizedModelCacheKey(config,
+                                       valid_places,
+                                       {},
+                                       lite_api::LiteModelType::kProtobuf) +
+                ".nb");
+  auto cached_content = ReadFile(cached_model);
+
+  // The next one hits and loads it, leaving the cache as it is.
+  lite::Predictor hit;
+  hit.Build(config, valid_places);
+  ASSERT_EQ(ListDir(cache_dir, false).size(), 1u);
+  EXPECT_EQ(ReadFile(cached_model), cached_content);
+
+  for (auto* predictor : {&missed, &hit}) {
+    auto output = RunOnOnes(predictor);
+    ASSERT_EQ(output.size(), expected.size());
+    for (size_t i = 0; i < output.size(); i++) {
+      EXPECT_NEAR(output[i], expected[i], 1e-6);
+    }
+  }
+
+  // Another config misses again.
+  std::vector<Place> host_places(valid_places);
+  host_places.emplace_back(TARGET(kHost), PRECISION(kFloat));
+  lite::Predictor other;
+  other.Build(config, host_places);
+  EXPECT_EQ(ListDir(cache_dir, false).size(), 2u);
+}
+
 /*TEST(CXXTrainer, train) {
   Place place({TARGET(kHost), PRECISION(kFloat), DATALAYOUT(kNCHW)});
   std::vector<Place> valid_places({place});
@@ -15,6 +15,9 @@
 #include "lite/api/light_api.h"
 #include <algorithm>
 #include <map>
+#include <set>
+#include <utility>
+#include "lite/utils/parallel.h"
 #ifdef ENABLE_ARM_FP16
 #include "lite/backends/arm/math/fp16/funcs_fp16.h"
 #endif
@@ -23,12 +26,19 @@ namespace paddle {
 namespace lite {
 
 void LightPredictor::Build(const std::string& lite_model_file,
-                           bool model_from_memory) {
+                           bool model_from_memory,
+                           ParamsMmapMode mmap_mode,
+                           int num_threads) {
+  load_threads_ = num_threads;
   if (model_from_memory) {
     LoadModelNaiveFromMemory(
-        lite_model_file, scope_.get(), program_desc_.get());
+        lite_model_file, scope_.get(), program_desc_.get(), num_threads);
   } else {
-    LoadModelNaiveFromFile(lite_model_file, scope_.get(), program_desc_.get());
+    LoadModelNaiveFromFile(lite_model_file,
+                           scope_.get(),
+                           program_desc_.get(),
+                           mmap_mode,
+                           num_threads);
   }
 
   // For weight quantization of post training, load the int8/16 weights
@@ -238,7 +248,10 @@ void LightPredictor::DequantizeWeight() {
     }
     return result;
   };
-  Tensor tmp_tensor;
+  // The quantized weights and the ops reading them, a weight shared by
+  // several ops is dequantized once.
+  std::vector<std::pair<const cpp::OpDesc*, std::string>> weights;
+  std::set<std::string> weight_names;
   for (size_t i = 0; i < program_desc->BlocksSize(); i++) {
     auto* block = program_desc->GetBlock<cpp::BlockDesc>(i);
     for (size_t k = 0; k < block->OpsSize(); ++k) {
@@ -247,49 +260,56 @@ void LightPredictor::DequantizeWeight() {
         auto input_names = op_desc->input_vars();
         for (auto& input_name : input_names) {
           std::string input_scale_name = input_name + "_quant_scale";
-          if (op_desc->HasAttr(input_scale_name)) {  // the input is quantized
-            auto input_tensor =
-                scope_->FindVar(input_name)->GetMutable<lite::Tensor>();
-            tmp_tensor.CopyDataFrom(*input_tensor);
-            auto scale_list =
-                op_desc->GetAttr<std::vector<float>>(input_scale_name);
-
-            int quantize_weight_bits =
-                op_desc->GetAttr<int>("quantize_weight_bits");
-            CHECK(quantize_weight_bits == 8 || quantize_weight_bits == 16);
-            float* fp_data = input_tensor->mutable_data<float>();
-
-            std::string op_type = op_desc->Type();
-            if (op_type == "conv2d" || op_type == "depthwise_conv2d") {
-              int64_t ch = input_tensor->dims()[0];
-              int64_t offset = input_tensor->numel() / ch;
-              CHECK_EQ(scale_list.size(), ch);
-              if (quantize_weight_bits == 8) {
-                const int8_t* int_data = tmp_tensor.data<int8_t>();
-                PROCESS_CONV2D_DATA()
-              } else {
-                const int16_t* int_data = tmp_tensor.data<int16_t>();
-                PROCESS_CONV2D_DATA()
-              }
-            } else if (op_type == "fc" || op_type == "mul" ||
-                       op_type == "lookup_table") {
-              int64_t chin = input_tensor->dims()[0];
-              int64_t chout = input_tensor->dims()[1];
-              CHECK_EQ(scale_list.size(), chout);
-              if (quantize_weight_bits == 8) {
-                const int8_t* int_data = tmp_tensor.data<int8_t>();
-                PROCESS_FC_DATA()
-              } else {
-                const int16_t* int_data = tmp_tensor.data<int16_t>();
-                PROCESS_FC_DATA()
-              }
-            }
+          if (op_desc->HasAttr(input_scale_name) &&  // the input is quantized
+              weight_names.insert(input_name).second) {
+            weights.emplace_back(op_desc, input_name);
           }
         }
       }
     }
   }
 
+  // The weights are independent, so they are dequantized in parallel.
+  ParallelFor(weights.size(), load_threads_, [&](int64_t w) {
+    auto* op_desc = weights[w].first;
+    const auto& input_name = weights[w].second;
+    std::string input_scale_name = input_name + "_quant_scale";
+    Tensor tmp_tensor;
+    auto input_tensor = scope_->FindVar(input_name)->GetMutable<lite::Tensor>();
+    tmp_tensor.CopyDataFrom(*input_tensor);
+    auto scale_list = op_desc->GetAttr<std::vector<float>>(input_scale_name);
+
+    int quantize_weight_bits = op_desc->GetAttr<int>("quantize_weight_bits");
+    CHECK(quantize_weight_bits == 8 || quantize_weight_bits == 16);
+    float* fp_data = input_tensor->mutable_data<float>();
+
+    std::string op_type = op_desc->Type();
+    if (op_type == "conv2d" || op_type == "depthwise_conv2d") {
+      int64_t ch = input_tensor->dims()[0];
+      int64_t offset = input_tensor->numel() / ch;
+      CHECK_EQ(scale_list.size(), ch);
+      if (quantize_weight_bits == 8) {
+        const int8_t* int_data = tmp_tensor.data<int8_t>();
+        PROCESS_CONV2D_DATA()
+      } else {
+        const int16_t* int_data = tmp_tensor.data<int16_t>();
+        PROCESS_CONV2D_DATA()
+      }
+    } else if (op_type == "fc" || op_type == "mul" ||
+               op_type == "lookup_table") {
+      int64_t chin = input_tensor->dims()[0];
+      int64_t chout = input_tensor->dims()[1];
+      CHECK_EQ(scale_list.size(), chout);
+      if (quantize_weight_bits == 8) {
+        const int8_t* int_data = tmp_tensor.data<int8_t>();
+        PROCESS_FC_DATA()
+      } else {
+        const int16_t* int_data = tmp_tensor.data<int16_t>();
+        PROCESS_FC_DATA()
+      }
+    }
+  });
+
 #undef PROCESS_CONV2D_DATA
 #undef PROCESS_FC_DATA
 }
@@ -42,12 +42,16 @@ class LITE_API LightPredictor {
  public:
   // constructor function of LightPredictor, `lite_model_file` refers to data in
   // model file or buffer,`model_from_memory` refers to whther to load model
-  // from memory.
+  // from memory, `mmap_mode` refers to which params to share with a memory
+  // mapping of the model file, `num_threads` refers to the number of threads
+  // loading and dequantizing the params.
   LightPredictor(const std::string& lite_model_file,
-                 bool model_from_memory = false) {
+                 bool model_from_memory = false,
+                 ParamsMmapMode mmap_mode = ParamsMmapMode::kNone,
+                 int num_threads = 1) {
     scope_ = std::make_shared<Scope>();
     program_desc_ = std::make_shared<cpp::ProgramDesc>();
-    Build(lite_model_file, model_from_memory);
+    Build(lite_model_file, model_from_memory, mmap_mode, num_threads);
   }
 
   // NOTE: This is a deprecated API and will be removed in latter release.
@@ -87,13 +91,22 @@ class LITE_API LightPredictor {
   void PrepareFeedFetch();
   Scope* scope() { return scope_.get(); }
 
+  // Record the latencies of the runs and the ops, see
+  // lite_api::ConfigBase::set_runtime_stats.
+  void set_runtime_stats(bool enabled) { program_->set_runtime_stats(enabled); }
+  lite_api::RuntimeStats GetRuntimeStats() const {
+    return program_->GetRuntimeStats();
+  }
+
  private:
   // check if the input tensor precision type is correct.
   // would be called in Run().
   void CheckInputValid();
 
   void Build(const std::string& lite_model_file,
-             bool model_from_memory = false);
+             bool model_from_memory = false,
+             ParamsMmapMode mmap_mode = ParamsMmapMode::kNone,
+             int num_threads = 1);
 
   // NOTE: This is a deprecated API and will be removed in latter release.
   void Build(
@@ -119,6 +132,8 @@ class LITE_API LightPredictor {
   std::vector<std::string> input_names_;
   std::vector<std::string> output_names_;
   std::vector<PrecisionType> input_precisions_;
+  // The number of threads transforming the weights after loading.
+  int load_threads_{1};
 };
 
 class LightPredictorImpl : public lite_api::PaddlePredictor {
@@ -144,6 +159,8 @@ class LightPredictorImpl : public lite_api::PaddlePredictor {
   std::unique_ptr<lite_api::Tensor> GetInputByName(
       const std::string& name) override;
 
+  lite_api::RuntimeStats GetRuntimeStats() const override;
+
   void Init(const lite_api::MobileConfig& config);
 
  private:
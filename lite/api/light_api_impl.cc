@@ -40,9 +40,18 @@ void LightPredictorImpl::Init(const lite_api::MobileConfig& config) {
                            config.is_model_from_memory(),
                            lite_api::LiteModelType::kNaiveBuffer));
   } else {
+    ParamsMmapMode mmap_mode = ParamsMmapMode::kNone;
+    if (config.mmap_model()) {
+      mmap_mode = ParamsMmapMode::kAllParams;
+    } else if (config.mmap_embedding_tables()) {
+      mmap_mode = ParamsMmapMode::kEmbeddingTables;
+    }
     raw_predictor_.reset(new LightPredictor(config.lite_model_file(),
-                                            config.is_model_from_memory()));
+                                            config.is_model_from_memory(),
+                                            mmap_mode,
+                                            config.threads()));
   }
+  raw_predictor_->set_runtime_stats(config.runtime_stats());
   mode_ = config.power_mode();
   threads_ = config.threads();
 
@@ -121,6 +130,10 @@ std::shared_ptr<lite_api::PaddlePredictor> LightPredictorImpl::Clone(
 
 std::string LightPredictorImpl::GetVersion() const { return lite::version(); }
 
+lite_api::RuntimeStats LightPredictorImpl::GetRuntimeStats() const {
+  return raw_predictor_->GetRuntimeStats();
+}
+
 std::unique_ptr<const lite_api::Tensor> LightPredictorImpl::GetTensor(
     const std::string& name) const {
   return std::unique_ptr<const lite_api::Tensor>(
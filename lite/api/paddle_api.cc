@@ -14,12 +14,14 @@
 
 #include "lite/api/paddle_api.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "lite/core/context.h"
 #include "lite/core/device_info.h"
 #include "lite/core/target_wrapper.h"
 #include "lite/core/tensor.h"
+#include "lite/utils/trace.h"
 
 #ifdef LITE_WITH_CUDA
 #include "lite/backends/cuda/target_wrapper.h"
@@ -281,6 +283,39 @@ void PaddlePredictor::SaveOptimizedModel(const std::string &model_dir,
       << "The SaveOptimizedModel API is only supported by CxxConfig predictor.";
 }
 
+void EnableTrace(size_t events_per_thread) {
+  lite::Tracer::Global().Enable(events_per_thread);
+}
+
+void DisableTrace() { lite::Tracer::Global().Disable(); }
+
+bool DumpTrace(const std::string &path) {
+  return lite::Tracer::Global().DumpChromeTrace(path);
+}
+
+RuntimeStats PaddlePredictor::GetRuntimeStats() const {
+  return RuntimeStats();
+}
+
+double LatencyHistogram::Percentile(double p) const {
+  if (count == 0 || bucket_counts.empty()) return 0;
+  const double rank = (std::min)((std::max)(p, 0.), 100.) / 100 * count;
+  uint64_t seen = 0;
+  size_t i = 0;
+  while (i + 1 < bucket_counts.size() && seen + bucket_counts[i] < rank) {
+    seen += bucket_counts[i++];
+  }
+  // The latencies are assumed to be spread evenly in the bucket.
+  const double lower = i > 0 ? bucket_bounds_ms[i - 1] : 0;
+  const double upper = i + 1 < bucket_counts.size() ? bucket_bounds_ms[i]
+                                                    : max_ms;
+  double value = upper;
+  if (bucket_counts[i] > 0) {
+    value = lower + (upper - lower) * (rank - seen) / bucket_counts[i];
+  }
+  return (std::min)((std::max)(value, min_ms), max_ms);
+}
+
 template <typename ConfigT>
 std::shared_ptr<PaddlePredictor> CreatePaddlePredictor(const ConfigT &) {
   return std::shared_ptr<PaddlePredictor>();
@@ -45,6 +45,16 @@ enum class L3CacheSetMethod {
 // return true if current device supports OpenCL model
 LITE_API bool IsOpenCLBackendValid(bool check_fp16_valid = false);
 
+// Record the runs, the ops, the chunks of the parallel loops and the sizes of
+// the workspaces of all the predictors on every thread, keeping the latest
+// `events_per_thread` events of each thread. It should be called between the
+// runs, and drops the events recorded before.
+LITE_API void EnableTrace(size_t events_per_thread = 1 << 14);
+LITE_API void DisableTrace();
+// Write the recorded events to `path` as Chrome trace JSON, which is opened
+// by chrome://tracing or Perfetto. Return false if it can't be written.
+LITE_API bool DumpTrace(const std::string& path);
+
 struct LITE_API Tensor {
   explicit Tensor(void* raw);
   explicit Tensor(const void* raw);
@@ -85,6 +95,45 @@ struct LITE_API Tensor {
   void* raw_tensor_;
 };
 
+/// The latencies of a run or an op, counted in fixed buckets whose bounds
+/// grow exponentially, each power of two being split into 4 buckets.
+struct LITE_API LatencyHistogram {
+  uint64_t count{0};
+  double total_ms{0};
+  double min_ms{0};
+  double max_ms{0};
+  /// The upper bound of each bucket, the last one counts all the latencies
+  /// above the bound of the previous one.
+  std::vector<double> bucket_bounds_ms;
+  std::vector<uint64_t> bucket_counts;
+
+  double avg_ms() const { return count > 0 ? total_ms / count : 0; }
+  /// Estimate the p-th percentile, p in [0, 100], by interpolating in its
+  /// bucket.
+  double Percentile(double p) const;
+};
+
+/// The latencies of an op of the main block, in the order they run.
+struct LITE_API OpRuntimeStats {
+  std::string op_type;
+  std::string kernel;
+  LatencyHistogram latency;
+};
+
+/// The stats recorded since the predictor was created, see
+/// ConfigBase::set_runtime_stats.
+struct LITE_API RuntimeStats {
+  bool enabled{false};
+  LatencyHistogram run_latency;
+  std::vector<OpRuntimeStats> ops;
+  /// The memory held by the tensors of all the predictors in the process,
+  /// its high-water mark, and the number of allocations and frees.
+  uint64_t memory_bytes{0};
+  uint64_t peak_memory_bytes{0};
+  uint64_t num_allocations{0};
+  uint64_t num_frees{0};
+};
+
 /// The PaddlePredictor defines the basic interfaces for different kinds of
 /// predictors.
 class LITE_API PaddlePredictor {
@@ -128,6 +177,11 @@ class LITE_API PaddlePredictor {
       LiteModelType model_type = LiteModelType::kProtobuf,
       bool record_info = false);
 
+  /// Get the latencies and the memory usage recorded when the runtime stats
+  /// are enabled by ConfigBase::set_runtime_stats. It should not be called
+  /// while the predictor is running.
+  virtual RuntimeStats GetRuntimeStats() const;
+
   virtual ~PaddlePredictor() = default;
 
  protected:
@@ -156,6 +210,7 @@ class LITE_API ConfigBase {
   std::string metal_path_;
   bool metal_use_agressive_;
   bool metal_use_mps_;
+  bool runtime_stats_{false};
 
  public:
   explicit ConfigBase(PowerMode mode = LITE_POWER_NO_BIND, int threads = 1);
@@ -211,6 +266,10 @@ class LITE_API ConfigBase {
   void set_metal_dir(const std::string& path);
   void set_metal_use_aggressive_optimization(bool flag);
   void set_metal_use_mps(bool flag);
+  // Record the latency histograms of the runs and the ops, which costs two
+  // clock reads per op, see PaddlePredictor::GetRuntimeStats.
+  void set_runtime_stats(bool enabled) { runtime_stats_ = enabled; }
+  bool runtime_stats() const { return runtime_stats_; }
 };
 
 class LITE_API CxxModelBuffer {
@@ -241,6 +300,9 @@ class LITE_API CxxConfig : public ConfigBase {
   std::vector<std::string> passes_internal_{};
   bool quant_model_{false};  // Enable post_quant_dynamic in opt
   QuantType quant_type_{QuantType::QUANT_INT16};
+  std::string optimized_model_cache_dir_;
+  bool save_prepacked_weights_{false};
+  bool drop_prepacked_sources_{false};
   std::map<int, std::vector<std::shared_ptr<void>>>
       preferred_inputs_for_warmup_;
 #ifdef LITE_WITH_CUDA
@@ -354,6 +416,35 @@ class LITE_API CxxConfig : public ConfigBase {
   bool quant_model() const { return quant_model_; }
   void set_quant_type(QuantType quant_type) { quant_type_ = quant_type; }
   QuantType quant_type() const { return quant_type_; }
+
+  // Save the optimized program of the model into `cache_dir`, keyed by the
+  // content of the model, the valid places, the passes and the Lite version.
+  // The later predictors of the same model and config load it from there
+  // instead of running the optimizer again.
+  void set_optimized_model_cache_dir(const std::string& cache_dir) {
+    optimized_model_cache_dir_ = cache_dir;
+  }
+  const std::string& optimized_model_cache_dir() const {
+    return optimized_model_cache_dir_;
+  }
+
+  // Save the weights packed by the kernels, e.g. the filters of the x86
+  // depthwise conv, with the model in SaveOptimizedModel. The predictors
+  // loading the model skip the packing if their kernels pack the weights the
+  // same way, e.g. on the same instruction set, and pack the original weights
+  // otherwise.
+  void set_save_prepacked_weights(bool save_prepacked_weights) {
+    save_prepacked_weights_ = save_prepacked_weights;
+  }
+  bool save_prepacked_weights() const { return save_prepacked_weights_; }
+  // Don't save the original weights replaced by the prepacked ones and read
+  // by no other op, which makes the model smaller. The model records the
+  // instruction set of the packed weights, and can only be run by the kernels
+  // built for it.
+  void set_drop_prepacked_sources(bool drop_prepacked_sources) {
+    drop_prepacked_sources_ = drop_prepacked_sources;
+  }
+  bool drop_prepacked_sources() const { return drop_prepacked_sources_; }
 };
 
 /// MobileConfig is the config for the light weight predictor, it will skip
@@ -366,6 +457,12 @@ class LITE_API MobileConfig : public ConfigBase {
   // model data readed from file or memory buffer in combined format.
   std::string lite_model_file_;
 
+  // whether to share the embedding tables with a memory mapping of the model
+  // file instead of copying them into host memory.
+  bool mmap_embedding_tables_{false};
+  // whether to share all the params with a memory mapping of the model file.
+  bool mmap_model_{false};
+
   // NOTE: This is a deprecated variable and will be removed in latter release.
   std::string model_buffer_;
   std::string param_buffer_;
@@ -387,6 +484,19 @@ class LITE_API MobileConfig : public ConfigBase {
   // abandoned in v3.0.
   bool model_from_memory() const { return model_from_memory_; }
 
+  // Keep the embedding tables of lookup_table ops memory-mapped from the model
+  // file set by `set_model_from_file`. Rows are paged in lazily on first
+  // access and the pages are shared by all processes using the same file.
+  void set_mmap_embedding_tables(bool x) { mmap_embedding_tables_ = x; }
+  bool mmap_embedding_tables() const { return mmap_embedding_tables_; }
+
+  // Keep all the params memory-mapped from the model file set by
+  // `set_model_from_file` instead of copying them into host memory, so the
+  // model is loaded without reading the weights. The weights transformed in
+  // place by the kernels get private copies of the pages they write.
+  void set_mmap_model(bool x) { mmap_model_ = x; }
+  bool mmap_model() const { return mmap_model_; }
+
   // NOTE: This is a deprecated API and will be removed in latter release.
   void set_model_buffer(const char* model_buffer,
                         size_t model_buffer_size,
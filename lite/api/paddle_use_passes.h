@@ -16,6 +16,7 @@
 #include "paddle_lite_factory_helper.h"  // NOLINT
 
 USE_MIR_PASS(demo);
+USE_MIR_PASS(layout_assignment_pass);
 USE_MIR_PASS(static_kernel_pick_pass);
 USE_MIR_PASS(op_transformation_pass);
 USE_MIR_PASS(variable_place_inference_pass);
@@ -60,6 +61,7 @@ USE_MIR_PASS(lite_quant_dequant_fuse_pass);
 USE_MIR_PASS(type_precision_cast_pass);
 USE_MIR_PASS(type_layout_cast_pass);
 USE_MIR_PASS(type_layout_cast_preprocess_pass);
+USE_MIR_PASS(memory_aware_schedule_pass);
 USE_MIR_PASS(memory_optimize_pass);
 USE_MIR_PASS(lite_inplace_fuse_pass);
 USE_MIR_PASS(multi_stream_analysis_pass);
@@ -79,8 +81,13 @@ USE_MIR_PASS(restrict_quantized_op_with_same_input_output_scale_pass);
 USE_MIR_PASS(control_flow_op_unused_inputs_and_outputs_eliminate_pass);
 USE_MIR_PASS(control_flow_op_shared_inputs_and_outputs_place_sync_pass);
 USE_MIR_PASS(lite_scale_activation_fuse_pass);
+USE_MIR_PASS(lite_elementwise_chain_fuse_pass);
+USE_MIR_PASS(lite_fc_horizontal_fuse_pass);
 USE_MIR_PASS(lite_instance_norm_activation_fuse_pass);
 USE_MIR_PASS(ssd_boxes_calc_offline_pass);
+USE_MIR_PASS(constant_folding_pass);
+USE_MIR_PASS(common_subexpression_elimination_pass);
+USE_MIR_PASS(dead_code_elimination_pass);
 USE_MIR_PASS(lite_flatten_fc_fuse_pass);
 USE_MIR_PASS(lite_fc_prelu_fuse_pass);
 USE_MIR_PASS(__xpu__graph_dedup_pass);
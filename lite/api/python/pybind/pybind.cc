@@ -137,6 +137,12 @@ void BindLiteCxxConfig(py::module *m) {
            (void (CxxConfig::*)(std::shared_ptr<CxxModelBuffer>)) &
                CxxConfig::set_model_buffer)
       .def("set_passes_internal", &CxxConfig::set_passes_internal)
+      .def("set_save_prepacked_weights",
+           &CxxConfig::set_save_prepacked_weights)
+      .def("save_prepacked_weights", &CxxConfig::save_prepacked_weights)
+      .def("set_drop_prepacked_sources",
+           &CxxConfig::set_drop_prepacked_sources)
+      .def("drop_prepacked_sources", &CxxConfig::drop_prepacked_sources)
       .def("is_model_from_memory", &CxxConfig::is_model_from_memory);
 #ifdef LITE_WITH_ARM
   cxx_config.def("set_threads", &CxxConfig::set_threads)
@@ -164,7 +170,12 @@ void BindLiteMobileConfig(py::module *m) {
       .def("set_model_dir", &MobileConfig::set_model_dir)
       .def("model_dir", &MobileConfig::model_dir)
       .def("set_model_buffer", &MobileConfig::set_model_buffer)
-      .def("is_model_from_memory", &MobileConfig::is_model_from_memory);
+      .def("is_model_from_memory", &MobileConfig::is_model_from_memory)
+      .def("set_mmap_embedding_tables",
+           &MobileConfig::set_mmap_embedding_tables)
+      .def("mmap_embedding_tables", &MobileConfig::mmap_embedding_tables)
+      .def("set_mmap_model", &MobileConfig::set_mmap_model)
+      .def("mmap_model", &MobileConfig::mmap_model);
 #ifdef LITE_WITH_ARM
   mobile_config.def("set_threads", &MobileConfig::set_threads)
       .def("threads", &MobileConfig::threads)
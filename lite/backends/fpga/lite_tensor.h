@@ -167,6 +167,10 @@ class TensorLite {
   // Other share data to this.
   void ShareDataWith(const TensorLite &other);
 
+  // The zynq tensors can not be shared copy-on-write, so the data is copied.
+  void ShareDataUntilWrite(const TensorLite &other) { CopyDataFrom(other); }
+  void DetachSharedBuffer(bool keep_data = true) {}
+
   void CopyDataFrom(const TensorLite &other);
 
   void ResetBuffer(std::shared_ptr<Buffer> buffer, size_t memory_size) {
@@ -50,10 +50,10 @@ void concat_func(const std::vector<lite::Tensor*>& input,
     int64_t in_concat_axis = dims[axis];
     auto* dout_ptr = dst_ptr + offset_concat_axis * concat_input_size;
     int64_t in_sum = in_concat_axis * concat_input_size;
-    for (int i = 0; i < num_cancats; i++) {
-      std::memcpy(dout_ptr, src_ptr, sizeof(T) * in_sum);
-      dout_ptr += out_sum;
-      src_ptr += in_sum;
+#pragma omp parallel for if (num_cancats * in_sum >= (1 << 20))
+    for (int64_t i = 0; i < num_cancats; i++) {
+      std::memcpy(
+          dout_ptr + i * out_sum, src_ptr + i * in_sum, sizeof(T) * in_sum);
     }
     offset_concat_axis += in_concat_axis;
   }
@@ -0,0 +1,268 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/host/math/fused_elementwise.h"
+#include <cmath>
+#include <cstring>
+
+namespace paddle {
+namespace lite {
+namespace host {
+namespace math {
+
+namespace {
+
+// The registers are evaluated in blocks of kBlock elements of an output row.
+const int kBlock = 256;
+const int64_t kParallelThreshold = 1 << 15;
+
+// Collapsed iteration space: dims[0] is the innermost dim, strides[k][j] is
+// the stride of the k-th load along dims[j], the innermost one is 0 or 1.
+struct LoopNest {
+  std::vector<int64_t> dims;
+  std::vector<std::vector<int64_t>> strides;
+};
+
+// The offset of every register in the output dims, resolved from the output
+// back to the loads.
+std::vector<int> RegisterOffsets(
+    const std::vector<int>& instructions,
+    const std::vector<std::vector<int64_t>>& dims) {
+  const int num = dims.size();
+  std::vector<int> offsets(num, -1);
+  offsets[num - 1] = 0;
+  auto assign = [&](int reg, int offset) {
+    CHECK(offsets[reg] == -1 || offsets[reg] == offset)
+        << "register " << reg << " of fused_elementwise is broadcast twice";
+    offsets[reg] = offset;
+  };
+  for (int i = num - 1; i >= 0; --i) {
+    const int* instr = &instructions[i * kFusedElementwiseInstrSize];
+    auto opcode = static_cast<FusedElementwiseOpcode>(instr[0]);
+    if (opcode == FusedElementwiseOpcode::kLoad) continue;
+    CHECK_GE(offsets[i], 0) << "register " << i << " is never read";
+    if (!IsFusedElementwiseBinary(opcode)) {
+      assign(instr[1], offsets[i]);
+      continue;
+    }
+    const auto& x = dims[instr[1]];
+    const auto& y = dims[instr[2]];
+    int axis = instr[4] == -1
+                   ? std::abs(static_cast<int>(x.size() - y.size()))
+                   : instr[4];
+    if (x == y) {
+      assign(instr[1], offsets[i]);
+      assign(instr[2], offsets[i]);
+    } else if (x.size() > y.size()) {
+      assign(instr[1], offsets[i]);
+      assign(instr[2], offsets[i] + axis);
+    } else {
+      assign(instr[1], offsets[i] + axis);
+      assign(instr[2], offsets[i]);
+    }
+  }
+  return offsets;
+}
+
+LoopNest BuildLoopNest(const std::vector<int64_t>& out_dims,
+                       const std::vector<std::vector<int64_t>>& load_dims,
+                       const std::vector<int>& load_offsets) {
+  const int rank = out_dims.size();
+  const int num_loads = load_dims.size();
+  std::vector<std::vector<int64_t>> full_strides(
+      num_loads, std::vector<int64_t>(rank, 0));
+  for (int k = 0; k < num_loads; ++k) {
+    const auto& dims = load_dims[k];
+    int64_t stride = 1;
+    for (int t = static_cast<int>(dims.size()) - 1; t >= 0; --t) {
+      int j = load_offsets[k] + t;
+      CHECK_LT(j, rank);
+      CHECK(dims[t] == out_dims[j] || dims[t] == 1)
+          << "dim " << t << " of input " << k << " (" << dims[t]
+          << ") can't be broadcast to " << out_dims[j];
+      if (dims[t] != 1) full_strides[k][j] = stride;
+      stride *= dims[t];
+    }
+  }
+
+  // Merge the adjacent dims along which every load is either contiguous or
+  // broadcast, from the innermost one.
+  LoopNest nest;
+  nest.strides.resize(num_loads);
+  for (int j = rank - 1; j >= 0; --j) {
+    if (out_dims[j] == 1) continue;
+    bool mergeable = !nest.dims.empty();
+    for (int k = 0; mergeable && k < num_loads; ++k) {
+      mergeable = full_strides[k][j] ==
+                  nest.strides[k].back() * nest.dims.back();
+    }
+    if (mergeable) {
+      nest.dims.back() *= out_dims[j];
+      continue;
+    }
+    nest.dims.push_back(out_dims[j]);
+    for (int k = 0; k < num_loads; ++k) {
+      nest.strides[k].push_back(full_strides[k][j]);
+    }
+  }
+  if (nest.dims.empty()) {
+    nest.dims.push_back(1);
+    for (auto& strides : nest.strides) strides.push_back(0);
+  }
+  return nest;
+}
+
+// Evaluate instruction `instr` over `n` elements into dst.
+inline void Execute(const int* instr,
+                    const float* a,
+                    const float* b,
+                    const float* p,
+                    int n,
+                    float* dst) {
+  switch (static_cast<FusedElementwiseOpcode>(instr[0])) {
+#define BINARY(opcode, expr)               \
+  case FusedElementwiseOpcode::opcode:     \
+    for (int i = 0; i < n; ++i) {          \
+      float x = a[i];                      \
+      float y = b[i];                      \
+      dst[i] = (expr);                     \
+    }                                      \
+    break
+#define UNARY(opcode, expr)                \
+  case FusedElementwiseOpcode::opcode:     \
+    for (int i = 0; i < n; ++i) {          \
+      float x = a[i];                      \
+      dst[i] = (expr);                     \
+    }                                      \
+    break
+    BINARY(kAdd, x + y);
+    BINARY(kSub, x - y);
+    BINARY(kMul, x * y);
+    BINARY(kDiv, x / y);
+    BINARY(kMax, x > y ? x : y);
+    BINARY(kMin, x < y ? x : y);
+    BINARY(kPow, std::pow(x, y));
+    UNARY(kRelu, x > 0.f ? x : 0.f);
+    UNARY(kRelu6, (std::min)((std::max)(x, 0.f), p[0]));
+    UNARY(kLeakyRelu, x > 0.f ? x : x * p[0]);
+    UNARY(kSigmoid, 1.f / (1.f + std::exp(-x)));
+    UNARY(kTanh, std::tanh(x));
+    UNARY(kExp, std::exp(x));
+    UNARY(kLog, std::log(x));
+    UNARY(kAbs, std::fabs(x));
+    UNARY(kSqrt, std::sqrt(x));
+    UNARY(kRsqrt, 1.f / std::sqrt(x));
+    UNARY(kSquare, x * x);
+    UNARY(kHardSigmoid, (std::min)((std::max)(x * p[0] + p[1], 0.f), 1.f));
+    UNARY(kSwish, x / (1.f + std::exp(-p[0] * x)));
+    UNARY(kHardSwish,
+          x * (std::min)((std::max)(x + p[2], 0.f), p[0]) / p[1]);
+    UNARY(kScale, p[2] != 0.f ? x * p[0] + p[1] : (x + p[1]) * p[0]);
+    UNARY(kClip, (std::min)((std::max)(x, p[0]), p[1]));
+#undef BINARY
+#undef UNARY
+    default:
+      LOG(FATAL) << "Unsupported fused_elementwise opcode " << instr[0];
+  }
+}
+
+}  // namespace
+
+void fused_elementwise(const std::vector<const float*>& inputs,
+                       const std::vector<std::vector<int64_t>>& input_dims,
+                       const std::vector<int>& instructions,
+                       const std::vector<float>& params,
+                       float* out) {
+  CHECK_EQ(instructions.size() % kFusedElementwiseInstrSize, 0u);
+  const int num = instructions.size() / kFusedElementwiseInstrSize;
+  CHECK_GT(num, 0);
+  auto dims = FusedElementwiseDims(instructions, input_dims);
+  auto offsets = RegisterOffsets(instructions, dims);
+
+  std::vector<int> loads;
+  std::vector<std::vector<int64_t>> load_dims;
+  std::vector<int> load_offsets;
+  for (int i = 0; i < num; ++i) {
+    const int* instr = &instructions[i * kFusedElementwiseInstrSize];
+    if (static_cast<FusedElementwiseOpcode>(instr[0]) ==
+        FusedElementwiseOpcode::kLoad) {
+      loads.push_back(i);
+      load_dims.push_back(dims[i]);
+      load_offsets.push_back(offsets[i]);
+    }
+  }
+  auto nest = BuildLoopNest(dims.back(), load_dims, load_offsets);
+  const int num_loads = loads.size();
+  const int64_t inner = nest.dims[0];
+  int64_t rows = 1;
+  for (size_t j = 1; j < nest.dims.size(); ++j) rows *= nest.dims[j];
+
+#pragma omp parallel if (rows * inner >= kParallelThreshold)
+  {
+    // One block per register, the loads of contiguous rows and the output
+    // register read and write the tensors directly.
+    std::vector<float> buffer(static_cast<size_t>(num) * kBlock);
+    std::vector<const float*> regs(num);
+    std::vector<const float*> bases(num_loads);
+#pragma omp for
+    for (int64_t row = 0; row < rows; ++row) {
+      for (int k = 0; k < num_loads; ++k) {
+        int64_t offset = 0;
+        int64_t index = row;
+        for (size_t j = 1; j < nest.dims.size(); ++j) {
+          offset += (index % nest.dims[j]) * nest.strides[k][j];
+          index /= nest.dims[j];
+        }
+        bases[k] =
+            inputs[instructions[loads[k] * kFusedElementwiseInstrSize + 1]] +
+            offset;
+      }
+      float* out_row = out + row * inner;
+      for (int64_t start = 0; start < inner; start += kBlock) {
+        int n = static_cast<int>((std::min)(inner - start,
+                                            static_cast<int64_t>(kBlock)));
+        int k = 0;
+        for (int i = 0; i < num; ++i) {
+          const int* instr = &instructions[i * kFusedElementwiseInstrSize];
+          float* block = &buffer[static_cast<size_t>(i) * kBlock];
+          float* dst = i == num - 1 ? out_row + start : block;
+          if (static_cast<FusedElementwiseOpcode>(instr[0]) ==
+              FusedElementwiseOpcode::kLoad) {
+            if (nest.strides[k][0] != 0) {
+              regs[i] = bases[k] + start;
+            } else {
+              std::fill(block, block + n, bases[k][0]);
+              regs[i] = block;
+            }
+            if (i == num - 1) std::memcpy(dst, regs[i], n * sizeof(float));
+            ++k;
+            continue;
+          }
+          Execute(instr,
+                  regs[instr[1]],
+                  regs[instr[2] >= 0 ? instr[2] : instr[1]],
+                  params.data() + (instr[3] >= 0 ? instr[3] : 0),
+                  n,
+                  dst);
+          regs[i] = dst;
+        }
+      }
+    }
+  }
+}
+
+}  // namespace math
+}  // namespace host
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,122 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "lite/utils/cp_logging.h"
+
+namespace paddle {
+namespace lite {
+namespace host {
+namespace math {
+
+// A fused_elementwise program is a list of instructions of
+// kFusedElementwiseInstrSize ints: {opcode, a, b, param, axis}.
+//   - kLoad reads the input `a`.
+//   - A unary op reads the register `a`, its float parameters start at
+//     `param` in the parameter list.
+//   - A binary op reads the registers `a` (X) and `b` (Y), broadcast with
+//     `axis` like the elementwise ops.
+// Instruction i writes the register i, the last register is the output. Every
+// register except the output is read exactly once, i.e. the program is a tree.
+enum class FusedElementwiseOpcode : int {
+  kLoad = 0,
+  // binary
+  kAdd,
+  kSub,
+  kMul,
+  kDiv,
+  kMax,
+  kMin,
+  kPow,
+  // unary
+  kRelu,
+  kRelu6,       // threshold
+  kLeakyRelu,   // alpha
+  kSigmoid,
+  kTanh,
+  kExp,
+  kLog,
+  kAbs,
+  kSqrt,
+  kRsqrt,
+  kSquare,
+  kHardSigmoid,  // slope, offset
+  kSwish,        // beta
+  kHardSwish,    // threshold, scale, offset
+  kScale,        // scale, bias, bias_after_scale
+  kClip,         // min, max
+};
+
+const int kFusedElementwiseInstrSize = 5;
+
+inline bool IsFusedElementwiseBinary(FusedElementwiseOpcode opcode) {
+  return opcode >= FusedElementwiseOpcode::kAdd &&
+         opcode <= FusedElementwiseOpcode::kPow;
+}
+
+// The output dims of an elementwise op, the same as ElementwiseOp::InferShape.
+inline std::vector<int64_t> ElementwiseBroadcastDims(
+    const std::vector<int64_t>& x, const std::vector<int64_t>& y, int axis) {
+  if (x == y) return x;
+  const auto& large = x.size() > y.size() ? x : y;
+  const auto& small = x.size() > y.size() ? y : x;
+  int offset = axis == -1 ? static_cast<int>(large.size() - small.size())
+                          : axis;
+  std::vector<int64_t> out = large;
+  for (size_t i = 0; i < small.size(); ++i) {
+    CHECK_LT(i + offset, out.size());
+    auto& dim = out[i + offset];
+    dim = (dim == -1 || small[i] == -1) ? -1 : (std::max)(dim, small[i]);
+  }
+  return out;
+}
+
+// The dims of every register of the program.
+inline std::vector<std::vector<int64_t>> FusedElementwiseDims(
+    const std::vector<int>& instructions,
+    const std::vector<std::vector<int64_t>>& input_dims) {
+  const int num = instructions.size() / kFusedElementwiseInstrSize;
+  std::vector<std::vector<int64_t>> dims(num);
+  for (int i = 0; i < num; ++i) {
+    const int* instr = &instructions[i * kFusedElementwiseInstrSize];
+    auto opcode = static_cast<FusedElementwiseOpcode>(instr[0]);
+    if (opcode == FusedElementwiseOpcode::kLoad) {
+      dims[i] = input_dims.at(instr[1]);
+    } else if (IsFusedElementwiseBinary(opcode)) {
+      dims[i] =
+          ElementwiseBroadcastDims(dims[instr[1]], dims[instr[2]], instr[4]);
+    } else {
+      dims[i] = dims[instr[1]];
+    }
+  }
+  return dims;
+}
+
+// Run the program over the broadcast output in one pass, without storing any
+// intermediate tensor.
+void fused_elementwise(const std::vector<const float*>& inputs,
+                       const std::vector<std::vector<int64_t>>& input_dims,
+                       const std::vector<int>& instructions,
+                       const std::vector<float>& params,
+                       float* out);
+
+}  // namespace math
+}  // namespace host
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,116 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace paddle {
+namespace lite {
+namespace host {
+namespace math {
+
+// Bool tensors hold one 0/1 byte per element. A packed mask holds one bit per
+// element in 64-bit words, element i of a word at bit i.
+
+inline int popcount64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcountll(x);
+#else
+  x = x - ((x >> 1) & 0x5555555555555555ULL);
+  x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+  x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return static_cast<int>((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Index of the lowest set bit, x must not be zero.
+inline int ctz64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(x);
+#else
+  return popcount64((x & (0 - x)) - 1);
+#endif
+}
+
+// Packed mask of `x[i] != 0` for the first `size` (at most 64) elements.
+template <typename T>
+inline uint64_t nonzero_mask(const T* x, int size) {
+  uint64_t mask = 0;
+  for (int i = 0; i < size; ++i) {
+    mask |= static_cast<uint64_t>(x[i] != static_cast<T>(0)) << i;
+  }
+  return mask;
+}
+
+// Same as nonzero_mask(x, 64).
+template <typename T>
+inline uint64_t nonzero_mask64(const T* x) {
+  return nonzero_mask(x, 64);
+}
+
+#ifdef __SSE2__
+template <>
+inline uint64_t nonzero_mask64<float>(const float* x) {
+  // Unordered compare, so NaN counts as nonzero like static_cast<bool>.
+  __m128 zero = _mm_setzero_ps();
+  uint64_t mask = 0;
+  for (int i = 0; i < 64; i += 4) {
+    __m128 nz = _mm_cmpneq_ps(_mm_loadu_ps(x + i), zero);
+    mask |= static_cast<uint64_t>(_mm_movemask_ps(nz)) << i;
+  }
+  return mask;
+}
+
+template <>
+inline uint64_t nonzero_mask64<int32_t>(const int32_t* x) {
+  __m128i zero = _mm_setzero_si128();
+  uint64_t mask = 0;
+  for (int i = 0; i < 64; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i));
+    int eq = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, zero)));
+    mask |= static_cast<uint64_t>(~eq & 0xF) << i;
+  }
+  return mask;
+}
+
+inline uint64_t nonzero_bytes_mask64(const void* x) {
+  const __m128i* p = reinterpret_cast<const __m128i*>(x);
+  __m128i zero = _mm_setzero_si128();
+  uint64_t mask = 0;
+  for (int i = 0; i < 4; ++i) {
+    int eq = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(p + i), zero));
+    mask |= static_cast<uint64_t>(~eq & 0xFFFF) << (i * 16);
+  }
+  return mask;
+}
+
+template <>
+inline uint64_t nonzero_mask64<int8_t>(const int8_t* x) {
+  return nonzero_bytes_mask64(x);
+}
+
+template <>
+inline uint64_t nonzero_mask64<bool>(const bool* x) {
+  return nonzero_bytes_mask64(x);
+}
+#endif
+
+}  // namespace math
+}  // namespace host
+}  // namespace lite
+}  // namespace paddle
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "lite/backends/host/math/reduce.h"
+#include <cstring>
+#include <type_traits>
 #include "lite/core/tensor.h"
 
 namespace paddle {
@@ -20,6 +22,210 @@ namespace lite {
 namespace host {
 namespace math {
 
+// Stages smaller than this many input elements stay on the calling thread.
+static const int64_t kParallelThreshold = 1 << 15;
+// Number of columns accumulated together on strided stages.
+static const int64_t kInnerBlock = 256;
+// Row length at which pairwise summation stops splitting.
+static const int64_t kPairwiseBlock = 128;
+
+template <typename T, typename Functor>
+inline T reduce_row(const T* src, int64_t size) {
+  Functor functor;
+  if (size == 0) {
+    return Functor::template Identity<T>();
+  }
+  if (size < 4) {
+    T acc = src[0];
+    for (int64_t i = 1; i < size; ++i) {
+      acc = functor(acc, src[i]);
+    }
+    return acc;
+  }
+  // Independent accumulators break the dependency chain so the loop can be
+  // vectorized.
+  T acc0 = src[0];
+  T acc1 = src[1];
+  T acc2 = src[2];
+  T acc3 = src[3];
+  int64_t i = 4;
+  for (; i + 3 < size; i += 4) {
+    acc0 = functor(acc0, src[i]);
+    acc1 = functor(acc1, src[i + 1]);
+    acc2 = functor(acc2, src[i + 2]);
+    acc3 = functor(acc3, src[i + 3]);
+  }
+  for (; i < size; ++i) {
+    acc0 = functor(acc0, src[i]);
+  }
+  return functor(functor(acc0, acc1), functor(acc2, acc3));
+}
+
+template <typename T, typename Functor, typename Enable = void>
+struct StageKernel {
+  static T Row(const T* src, int64_t size) {
+    return reduce_row<T, Functor>(src, size);
+  }
+
+  // Folds `reduce` rows of `width` columns, `stride` elements apart.
+  static void Columns(
+      const T* src, T* dst, int64_t reduce, int64_t width, int64_t stride) {
+    Functor functor;
+    if (reduce == 0) {
+      std::fill(dst, dst + width, Functor::template Identity<T>());
+      return;
+    }
+    std::memcpy(dst, src, sizeof(T) * width);
+    for (int64_t r = 1; r < reduce; ++r) {
+      const T* row = src + r * stride;
+      for (int64_t j = 0; j < width; ++j) {
+        dst[j] = functor(dst[j], row[j]);
+      }
+    }
+  }
+};
+
+template <typename T>
+struct StageKernel<
+    T,
+    Sum,
+    typename std::enable_if<std::is_floating_point<T>::value>::type> {
+  static T Row(const T* src, int64_t size) {
+    if (size <= kPairwiseBlock) {
+      return reduce_row<T, Sum>(src, size);
+    }
+    int64_t half = size / 2;
+    return Row(src, half) + Row(src + half, size - half);
+  }
+
+  static void Columns(
+      const T* src, T* dst, int64_t reduce, int64_t width, int64_t stride) {
+    T comp[kInnerBlock];
+    if (reduce == 0) {
+      std::fill(dst, dst + width, static_cast<T>(0));
+      return;
+    }
+    std::memcpy(dst, src, sizeof(T) * width);
+    std::fill(comp, comp + width, static_cast<T>(0));
+    for (int64_t r = 1; r < reduce; ++r) {
+      const T* row = src + r * stride;
+      for (int64_t j = 0; j < width; ++j) {
+        T y = row[j] - comp[j];
+        T t = dst[j] + y;
+        comp[j] = (t - dst[j]) - y;
+        dst[j] = t;
+      }
+    }
+  }
+};
+
+std::vector<ReduceStage> ReduceStages(const std::vector<int64_t>& dims,
+                                      const std::vector<int>& reduce_dim) {
+  int rank = static_cast<int>(dims.size());
+  std::vector<bool> reduced(rank, false);
+  for (int axis : reduce_dim) {
+    if (axis < 0) {
+      axis += rank;
+    }
+    CHECK(axis >= 0 && axis < rank) << "invalid reduce dim " << axis
+                                    << " for rank " << rank;
+    reduced[axis] = true;
+  }
+
+  std::vector<int64_t> sizes;
+  std::vector<bool> roles;
+  for (int i = 0; i < rank; ++i) {
+    if (dims[i] == 1) {
+      continue;
+    }
+    if (!sizes.empty() && roles.back() == reduced[i]) {
+      sizes.back() *= dims[i];
+    } else {
+      sizes.push_back(dims[i]);
+      roles.push_back(reduced[i]);
+    }
+  }
+
+  std::vector<ReduceStage> stages;
+  while (true) {
+    int pick = -1;
+    for (size_t g = 0; g < sizes.size(); ++g) {
+      // An empty reduced group is a stage too, it writes the identity.
+      if (roles[g] && sizes[g] != 1 &&
+          (pick < 0 || sizes[g] > sizes[pick] || sizes[pick] == 0)) {
+        pick = static_cast<int>(g);
+      }
+    }
+    if (pick < 0) {
+      break;
+    }
+    ReduceStage stage{1, sizes[pick], 1};
+    for (int g = 0; g < pick; ++g) {
+      stage.outer *= sizes[g];
+    }
+    for (size_t g = pick + 1; g < sizes.size(); ++g) {
+      stage.inner *= sizes[g];
+    }
+    stages.push_back(stage);
+    sizes[pick] = 1;
+  }
+  return stages;
+}
+
+template <typename T, typename Functor>
+void reduce_stage(
+    const T* src, T* dst, int64_t outer, int64_t reduce, int64_t inner) {
+  bool parallel = outer * reduce * inner >= kParallelThreshold;
+  if (inner == 1) {
+#pragma omp parallel for if (parallel)
+    for (int64_t o = 0; o < outer; ++o) {
+      dst[o] = StageKernel<T, Functor>::Row(src + o * reduce, reduce);
+    }
+    return;
+  }
+  int64_t blocks = (inner + kInnerBlock - 1) / kInnerBlock;
+#pragma omp parallel for if (parallel)
+  for (int64_t task = 0; task < outer * blocks; ++task) {
+    int64_t o = task / blocks;
+    int64_t j = task % blocks * kInnerBlock;
+    StageKernel<T, Functor>::Columns(src + o * reduce * inner + j,
+                                     dst + o * inner + j,
+                                     reduce,
+                                     std::min(kInnerBlock, inner - j),
+                                     inner);
+  }
+}
+
+template <typename T, typename Functor>
+void reduce_dims(const T* src,
+                 T* dst,
+                 const std::vector<int64_t>& dims,
+                 const std::vector<int>& reduce_dim) {
+  auto stages = ReduceStages(dims, reduce_dim);
+  if (stages.empty()) {
+    int64_t size = 1;
+    for (auto d : dims) {
+      size *= d;
+    }
+    std::memcpy(dst, src, sizeof(T) * size);
+    return;
+  }
+  // Intermediate results of multi-stage reductions ping-pong between two
+  // scratch tensors; the last stage writes to dst.
+  lite::Tensor scratch[2];
+  const T* in = src;
+  for (size_t i = 0; i < stages.size(); ++i) {
+    const auto& stage = stages[i];
+    T* out = dst;
+    if (i + 1 < stages.size()) {
+      scratch[i % 2].Resize({stage.outer * stage.inner});
+      out = scratch[i % 2].mutable_data<T>();
+    }
+    reduce_stage<T, Functor>(in, out, stage.outer, stage.reduce, stage.inner);
+    in = out;
+  }
+}
+
 template <typename T, typename Functor>
 void reduce_n(const T* src,
               T* dst,
@@ -27,22 +233,8 @@ void reduce_n(const T* src,
               int channel_in,
               int height_in,
               int width_in) {
-  int hw_size = height_in * width_in;
-  int chw_size = channel_in * hw_size;
-  int data_index, src_index;
-  Functor functor;
-  for (int c = 0; c < channel_in; ++c) {
-    for (int h = 0; h < height_in; ++h) {
-      for (int w = 0; w < width_in; ++w) {
-        data_index = c * hw_size + h * width_in + w;
-        dst[data_index] = src[data_index];
-        for (int n = 1; n < num_in; ++n) {
-          src_index = n * chw_size + data_index;
-          dst[data_index] = functor(dst[data_index], src[src_index]);
-        }
-      }
-    }
-  }
+  int64_t chw_size = static_cast<int64_t>(channel_in) * height_in * width_in;
+  reduce_stage<T, Functor>(src, dst, 1, num_in, chw_size);
 }
 
 template <typename T, typename Functor>
@@ -52,23 +244,8 @@ void reduce_c(const T* src,
               int channel_in,
               int height_in,
               int width_in) {
-  int hw_size = height_in * width_in;
-  int chw_size = hw_size * channel_in;
-  int data_index, src_index0, src_index;
-  Functor functor;
-  for (int n = 0; n < num_in; ++n) {
-    for (int h = 0; h < height_in; ++h) {
-      for (int w = 0; w < width_in; ++w) {
-        data_index = n * hw_size + h * width_in + w;
-        src_index0 = n * chw_size + h * width_in + w;
-        dst[data_index] = src[src_index0];
-        for (int c = 1; c < channel_in; ++c) {
-          src_index = src_index0 + c * hw_size;
-          dst[data_index] = functor(dst[data_index], src[src_index]);
-        }
-      }
-    }
-  }
+  int64_t hw_size = static_cast<int64_t>(height_in) * width_in;
+  reduce_stage<T, Functor>(src, dst, num_in, channel_in, hw_size);
 }
 
 template <typename T, typename Functor>
@@ -78,24 +255,8 @@ void reduce_h(const T* src,
               int channel_in,
               int height_in,
               int width_in) {
-  int cw_size = channel_in * width_in;
-  int chw_size = cw_size * height_in;
-  int hw_size = height_in * width_in;
-  int data_index, src_index, src_index0;
-  Functor functor;
-  for (int n = 0; n < num_in; ++n) {
-    for (int c = 0; c < channel_in; ++c) {
-      for (int w = 0; w < width_in; ++w) {
-        data_index = n * cw_size + c * width_in + w;
-        src_index0 = n * chw_size + c * hw_size + w;
-        dst[data_index] = src[src_index0];
-        for (int h = 1; h < height_in; ++h) {
-          src_index = src_index0 + h * width_in;
-          dst[data_index] = functor(dst[data_index], src[src_index]);
-        }
-      }
-    }
-  }
+  int64_t nc_size = static_cast<int64_t>(num_in) * channel_in;
+  reduce_stage<T, Functor>(src, dst, nc_size, height_in, width_in);
 }
 
 template <typename T, typename Functor>
@@ -105,26 +266,8 @@ void reduce_w(const T* src,
               int channel_in,
               int height_in,
               int width_in) {
-  int ch_size = channel_in * height_in;
-  int hw_size = height_in * width_in;
-  int chw_size = ch_size * width_in;
-  int data_index = 0;
-  int src_index0 = 0;
-  int src_index = 0;
-  Functor functor;
-  for (int n = 0; n < num_in; ++n) {
-    for (int c = 0; c < channel_in; ++c) {
-      for (int h = 0; h < height_in; ++h) {
-        data_index = n * ch_size + c * height_in + h;
-        src_index0 = n * chw_size + c * hw_size + h * width_in;
-        dst[data_index] = src[src_index0];
-        for (int w = 0; w < width_in; ++w) {
-          src_index = src_index0 + w;
-          dst[data_index] = functor(dst[data_index], src[src_index]);
-        }
-      }
-    }
-  }
+  int64_t nch_size = static_cast<int64_t>(num_in) * channel_in * height_in;
+  reduce_stage<T, Functor>(src, dst, nch_size, width_in, 1);
 }
 
 template <typename T, typename Functor>
@@ -134,13 +277,9 @@ void reduce_nc(const T* src,
                int channel_in,
                int height_in,
                int width_in) {
-  // reduce n first.
-  DDimLite ddimA({1, channel_in, height_in, width_in});
-  lite::Tensor tensor_tmp;
-  tensor_tmp.Resize(ddimA);
-  T* tmp_out = tensor_tmp.mutable_data<T>();
-  reduce_n<T, Functor>(src, tmp_out, num_in, channel_in, height_in, width_in);
-  reduce_c<T, Functor>(tmp_out, dst, 1, channel_in, height_in, width_in);
+  int64_t nc_size = static_cast<int64_t>(num_in) * channel_in;
+  int64_t hw_size = static_cast<int64_t>(height_in) * width_in;
+  reduce_stage<T, Functor>(src, dst, 1, nc_size, hw_size);
 }
 
 template <typename T, typename Functor>
@@ -150,13 +289,8 @@ void reduce_ch(const T* src,
                int channel_in,
                int height_in,
                int width_in) {
-  // reduce c first
-  DDimLite ddimA({num_in, 1, height_in, width_in});
-  lite::Tensor tensor_tmp;
-  tensor_tmp.Resize(ddimA);
-  T* tmp_out = tensor_tmp.mutable_data<T>();
-  reduce_c<T, Functor>(src, tmp_out, num_in, channel_in, height_in, width_in);
-  reduce_h<T, Functor>(tmp_out, dst, num_in, 1, height_in, width_in);
+  int64_t ch_size = static_cast<int64_t>(channel_in) * height_in;
+  reduce_stage<T, Functor>(src, dst, num_in, ch_size, width_in);
 }
 
 template <typename T, typename Functor>
@@ -166,21 +300,46 @@ void reduce_hw(const T* src,
                int channel_in,
                int height_in,
                int width_in) {
-  // reduce h first
-  DDimLite ddimA({num_in, channel_in, 1, width_in});
-  lite::Tensor tensor_tmp;
-  tensor_tmp.Resize(ddimA);
-  T* tmp_out = tensor_tmp.mutable_data<T>();
-  reduce_h<T, Functor>(src, tmp_out, num_in, channel_in, height_in, width_in);
-  reduce_w<T, Functor>(tmp_out, dst, num_in, channel_in, 1, width_in);
+  int64_t nc_size = static_cast<int64_t>(num_in) * channel_in;
+  int64_t hw_size = static_cast<int64_t>(height_in) * width_in;
+  reduce_stage<T, Functor>(src, dst, nc_size, hw_size, 1);
 }
 
 template <typename T, typename Functor>
 void reduce_all(const T* src, T* dst, int num_all) {
-  dst[0] = src[0];
-  Functor functor;
-  for (int i = 1; i < num_all; i++) {
-    dst[0] = functor(dst[0], src[i]);
+  reduce_stage<T, Functor>(src, dst, 1, num_all, 1);
+}
+
+template <typename T>
+void cumsum(const T* src,
+            T* dst,
+            int64_t outer,
+            int64_t count,
+            int64_t inner,
+            bool exclusive,
+            bool reverse) {
+  // Rows of `inner` elements are visited in scan order and each one adds the
+  // previous row elementwise, which keeps the inner loop contiguous.
+  int64_t step = reverse ? -inner : inner;
+  bool parallel = outer * count * inner >= kParallelThreshold;
+#pragma omp parallel for if (parallel)
+  for (int64_t o = 0; o < outer; ++o) {
+    int64_t first = (o * count + (reverse ? count - 1 : 0)) * inner;
+    const T* x = src + first;
+    T* y = dst + first;
+    for (int64_t j = 0; j < inner; ++j) {
+      y[j] = exclusive ? static_cast<T>(0) : x[j];
+    }
+    for (int64_t k = 1; k < count; ++k) {
+      const T* x_prev = x;
+      const T* y_prev = y;
+      x += step;
+      y += step;
+      const T* add = exclusive ? x_prev : x;
+      for (int64_t j = 0; j < inner; ++j) {
+        y[j] = y_prev[j] + add[j];
+      }
+    }
   }
 }
 
@@ -228,12 +387,42 @@ void reduce_all(const T* src, T* dst, int num_all) {
                                        int height_in,    \
                                        int width_in);    \
   template void reduce_all<DTYPE, FUNC>(                 \
-      const DTYPE* src, DTYPE* dst, int num_all);
+      const DTYPE* src, DTYPE* dst, int num_all);        \
+  template void reduce_stage<DTYPE, FUNC>(               \
+      const DTYPE* src,                                  \
+      DTYPE* dst,                                        \
+      int64_t outer,                                     \
+      int64_t reduce,                                    \
+      int64_t inner);                                    \
+  template void reduce_dims<DTYPE, FUNC>(                \
+      const DTYPE* src,                                  \
+      DTYPE* dst,                                        \
+      const std::vector<int64_t>& dims,                  \
+      const std::vector<int>& reduce_dim);
 
 ReduceFuncs(bool, LogicalAnd);
 ReduceFuncs(bool, LogicalOr);
+ReduceFuncs(float, Sum);
+ReduceFuncs(float, Prod);
+ReduceFuncs(float, Max);
+ReduceFuncs(int, Sum);
+ReduceFuncs(int64_t, Sum);
 #undef ReduceFuncs
 
+#define CumsumFuncs(DTYPE)                      \
+  template void cumsum<DTYPE>(const DTYPE* src, \
+                              DTYPE* dst,       \
+                              int64_t outer,    \
+                              int64_t count,    \
+                              int64_t inner,    \
+                              bool exclusive,   \
+                              bool reverse);
+
+CumsumFuncs(float);
+CumsumFuncs(int);
+CumsumFuncs(int64_t);
+#undef CumsumFuncs
+
 }  // namespace math
 }  // namespace host
 }  // namespace lite
@@ -14,19 +14,103 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
 namespace paddle {
 namespace lite {
 namespace host {
 namespace math {
 
+// The functors folding the reduced elements. Identity() is the result of
+// reducing no element at all.
 struct LogicalAnd {
   inline bool operator()(const bool a, const bool b) { return a && b; }
+  template <typename T>
+  static T Identity() {
+    return true;
+  }
 };
 
 struct LogicalOr {
   inline bool operator()(const bool a, const bool b) { return a || b; }
+  template <typename T>
+  static T Identity() {
+    return false;
+  }
+};
+
+struct Sum {
+  template <typename T>
+  inline T operator()(const T a, const T b) {
+    return a + b;
+  }
+  template <typename T>
+  static T Identity() {
+    return static_cast<T>(0);
+  }
+};
+
+struct Prod {
+  template <typename T>
+  inline T operator()(const T a, const T b) {
+    return a * b;
+  }
+  template <typename T>
+  static T Identity() {
+    return static_cast<T>(1);
+  }
+};
+
+struct Max {
+  template <typename T>
+  inline T operator()(const T a, const T b) {
+    return std::max(a, b);
+  }
+  template <typename T>
+  static T Identity() {
+    return std::numeric_limits<T>::has_infinity
+               ? -std::numeric_limits<T>::infinity()
+               : std::numeric_limits<T>::lowest();
+  }
 };
 
+// One pass of a reduction: the input is viewed as [outer, reduce, inner] and
+// the middle axis is folded away, producing [outer, inner].
+struct ReduceStage {
+  int64_t outer;
+  int64_t reduce;
+  int64_t inner;
+};
+
+// Splits the reduction of `dims` over the axes in `reduce_dim` into
+// (outer, reduce, inner) stages. Size-1 axes are dropped and adjacent axes
+// with the same role are merged, so e.g. reducing {1, 2} of NCHW is a single
+// stage. Non-adjacent reduced groups yield one stage each, largest first;
+// every stage refers to the shape left behind by the previous ones. An empty
+// result means nothing is reduced and the input is copied as is.
+std::vector<ReduceStage> ReduceStages(const std::vector<int64_t>& dims,
+                                      const std::vector<int>& reduce_dim);
+
+// Reduces [outer, reduce, inner] to [outer, inner], which is filled with the
+// identity of the functor if reduce is 0. Contiguous rows
+// (inner == 1) are folded with several independent accumulators, strided
+// rows are accumulated a whole inner block at a time; floating-point sums use
+// pairwise and Kahan summation respectively.
+template <typename T, typename Functor>
+void reduce_stage(
+    const T* src, T* dst, int64_t outer, int64_t reduce, int64_t inner);
+
+// Reduces `src` with shape `dims` over the axes in `reduce_dim`, which may be
+// negative, unordered and of any rank.
+template <typename T, typename Functor>
+void reduce_dims(const T* src,
+                 T* dst,
+                 const std::vector<int64_t>& dims,
+                 const std::vector<int>& reduce_dim);
+
 template <typename T, typename Functor>
 void reduce_n(const T* src,
               T* dst,
@@ -86,6 +170,16 @@ void reduce_hw(const T* src,
 template <typename T, typename Functor>
 void reduce_all(const T* src, T* dst, int num_all);
 
+// Prefix sum of [outer, count, inner] along the middle axis.
+template <typename T>
+void cumsum(const T* src,
+            T* dst,
+            int64_t outer,
+            int64_t count,
+            int64_t inner,
+            bool exclusive,
+            bool reverse);
+
 }  // namespace math
 }  // namespace host
 }  // namespace lite
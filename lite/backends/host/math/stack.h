@@ -42,15 +42,15 @@ void stack_func(const std::vector<lite::Tensor *> &input,
 
   auto x_data_arr = x_datas.data();
 
-  size_t x_offset = 0;
-  size_t y_offset = 0;
+#pragma omp parallel for if (static_cast<int64_t>(pre) * n * post >= (1 << 20))
   for (int i = 0; i < pre; i++) {
+    size_t x_offset = static_cast<size_t>(i) * post;
+    size_t y_offset = x_offset * n;
     for (int j = 0; j < n; j++) {
       std::memcpy(
           y_data + y_offset, x_data_arr[j] + x_offset, post * sizeof(T));
       y_offset += post;
     }
-    x_offset += post;
   }
 }
 
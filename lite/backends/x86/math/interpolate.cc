@@ -13,6 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "lite/backends/x86/math/interpolate.h"
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+#include <cstring>
 #include <string>
 #include <vector>
 #include "lite/backends/x86/math/math_function.h"
@@ -22,6 +26,67 @@ namespace lite {
 namespace x86 {
 namespace math {
 
+// Horizontally interpolate one input row into `rows`. The columns from
+// `w_bound` sample the last input column only.
+static void bilinear_resize_row(const float* src,
+                                float* rows,
+                                const int* xofs,
+                                const float* alpha0,
+                                const float* alpha1,
+                                const int w_in,
+                                const int w_bound,
+                                const int w_out) {
+  int dx = 0;
+#ifdef __AVX2__
+  for (; dx + 7 < w_bound; dx += 8) {
+    __m256i _x =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(xofs + dx));
+    __m256 _s0 = _mm256_i32gather_ps(src, _x, 4);
+    __m256 _s1 = _mm256_i32gather_ps(src + 1, _x, 4);
+    __m256 _r = _mm256_add_ps(_mm256_mul_ps(_s0, _mm256_loadu_ps(alpha0 + dx)),
+                              _mm256_mul_ps(_s1, _mm256_loadu_ps(alpha1 + dx)));
+    _mm256_storeu_ps(rows + dx, _r);
+  }
+#endif
+  for (; dx < w_bound; ++dx) {
+    const float* sp = src + xofs[dx];
+    rows[dx] = sp[0] * alpha0[dx] + sp[1] * alpha1[dx];
+  }
+  const float last = src[w_in - 1];
+  for (; dx < w_out; ++dx) {
+    rows[dx] = last * alpha0[dx] + last * alpha1[dx];
+  }
+}
+
+// Vertically blend two horizontally interpolated rows into one output row.
+static void bilinear_blend_rows(const float* rows0,
+                                const float* rows1,
+                                const float b0,
+                                const float b1,
+                                float* dst,
+                                const int w_out) {
+  int dx = 0;
+#ifdef __AVX__
+  __m256 _b0 = _mm256_set1_ps(b0);
+  __m256 _b1 = _mm256_set1_ps(b1);
+  for (; dx + 7 < w_out; dx += 8) {
+    __m256 _d = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(rows0 + dx), _b0),
+                              _mm256_mul_ps(_mm256_loadu_ps(rows1 + dx), _b1));
+    _mm256_storeu_ps(dst + dx, _d);
+  }
+  __m128 _c0 = _mm_set1_ps(b0);
+  __m128 _c1 = _mm_set1_ps(b1);
+  for (; dx + 3 < w_out; dx += 4) {
+    __m128 _d = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(rows0 + dx), _c0),
+                           _mm_mul_ps(_mm_loadu_ps(rows1 + dx), _c1));
+    _mm_storeu_ps(dst + dx, _d);
+  }
+#endif
+  for (; dx < w_out; ++dx) {
+    dst[dx] = rows0[dx] * b0 + rows1[dx] * b1;
+  }
+}
+
 void bilinear_interp(const float* input_data,
                      float* output_data,
                      const float ratio_h,
@@ -34,72 +99,52 @@ void bilinear_interp(const float* input_data,
                      const int w_out,
                      const bool align_corners,
                      const bool align_mode) {
-  int* buf = static_cast<int*>(lite::host::malloc(
-      sizeof(int) * (w_out + h_out + w_out * 2 + h_out * 2)));
-
+  // The index and weight tables only depend on the shapes, they are computed
+  // once and shared by all the channels.
+  int* buf = static_cast<int*>(
+      lite::host::malloc(sizeof(int) * (w_out * 3 + h_out * 3)));
   int* xofs = buf;
   int* yofs = buf + w_out;
+  float* alpha0 = reinterpret_cast<float*>(buf + w_out + h_out);
+  float* alpha1 = alpha0 + w_out;
+  float* beta0 = alpha1 + w_out;
+  float* beta1 = beta0 + h_out;
 
-  float* alpha = reinterpret_cast<float*>(buf + w_out + h_out);
-  float* beta = reinterpret_cast<float*>(buf + w_out + h_out + w_out * 2);
-
-  float fx = 0.0f;
-  float fy = 0.0f;
-  int sx = 0;
-  int sy = 0;
-  if (align_corners) {
-    // calculate x axis coordinate
-    for (int dx = 0; dx < w_out; dx++) {
-      fx = dx * ratio_w;
-      sx = static_cast<int>(fx);
-      fx -= sx;
-      xofs[dx] = sx;
-      alpha[dx * 2] = 1.f - fx;
-      alpha[dx * 2 + 1] = fx;
-    }
-    // calculate y axis coordinate
-    for (int dy = 0; dy < h_out; dy++) {
-      fy = dy * ratio_h;
-      sy = static_cast<int>(fy);
-      fy -= sy;
-      yofs[dy] = sy;
-      beta[dy * 2] = 1.f - fy;
-      beta[dy * 2 + 1] = fy;
-    }
-  } else {
-    // calculate x axis coordinate
-    for (int dx = 0; dx < w_out; dx++) {
-      fx = align_mode ? ratio_w * dx : ratio_w * (dx + 0.5f) - 0.5f;
-      fx = fx < 0 ? 0.f : fx;
-      sx = static_cast<int>(fx);
-      fx -= sx;
-      xofs[dx] = sx;
-      alpha[dx * 2] = 1.f - fx;
-      alpha[dx * 2 + 1] = fx;
+  auto src_coord = [&](int d, float ratio) {
+    float f = 0.f;
+    if (align_corners) {
+      f = d * ratio;
+    } else {
+      f = align_mode ? ratio * d : ratio * (d + 0.5f) - 0.5f;
+      f = f < 0 ? 0.f : f;
     }
-    // calculate y axis coordinate
-    for (int dy = 0; dy < h_out; dy++) {
-      fy = align_mode ? ratio_h * dy : ratio_h * (dy + 0.5f) - 0.5f;
-      fy = fy < 0 ? 0.f : fy;
-      sy = static_cast<int>(fy);
-      fy -= sy;
-      yofs[dy] = sy;
-      beta[dy * 2] = 1.f - fy;
-      beta[dy * 2 + 1] = fy;
+    return f;
+  };
+  // Output positions from the bound on sample the last input row or column,
+  // so the second neighbor is never read out of range.
+  int w_bound = w_out;
+  for (int dx = 0; dx < w_out; dx++) {
+    float fx = src_coord(dx, ratio_w);
+    int sx = static_cast<int>(fx);
+    xofs[dx] = sx;
+    alpha0[dx] = 1.f - (fx - sx);
+    alpha1[dx] = fx - sx;
+    if (sx >= w_in - 1 && w_bound == w_out) {
+      w_bound = dx;
     }
   }
-  // output w , h boundary
-  int w_bound = w_out;
   int h_bound = h_out;
-  if (ratio_w > 0 && ratio_h > 0) {
-    if (align_corners) {
-      w_bound = ceil((w_in - 1) / ratio_w);
-      h_bound = ceil((h_in - 1) / ratio_h);
-    } else {
-      w_bound = ceil((w_in - 0.5f) / ratio_w - 0.5f);
-      h_bound = ceil((h_in - 0.5f) / ratio_h - 0.5f);
+  for (int dy = 0; dy < h_out; dy++) {
+    float fy = src_coord(dy, ratio_h);
+    int sy = static_cast<int>(fy);
+    yofs[dy] = sy;
+    beta0[dy] = 1.f - (fy - sy);
+    beta1[dy] = fy - sy;
+    if (sy >= h_in - 1 && h_bound == h_out) {
+      h_bound = dy;
     }
   }
+
   int in_stride = h_in * w_in;
   int out_stride = h_out * w_out;
   int total = n * c;
@@ -110,345 +155,73 @@ void bilinear_interp(const float* input_data,
   for (int nc = 0; nc < total; ++nc) {
     const float* src = input_data + nc * in_stride;
     float* dst = output_data + nc * out_stride;
-    const float* betap = beta;
-
-    float* rowsbuf0 =
-        static_cast<float*>(lite::host::malloc(sizeof(int) * w_out));
-    float* rowsbuf1 =
-        static_cast<float*>(lite::host::malloc(sizeof(int) * w_out));
-    float* rows0 = rowsbuf0;
-    float* rows1 = rowsbuf1;
-    // h_bound loop
-    for (int dy = 0; dy < h_bound; dy++) {
-      int sy = yofs[dy];
-
-      const float* s0 = src + sy * w_in;
-      const float* s1 = src + (sy + 1) * w_in;
-
-      const float* alphap = alpha;
-      float* rows0p = rows0;
-      float* rows1p = rows1;
-
-      int dx = 0;
-// w_bound loop
-#ifdef __AVX__
-      for (; dx + 3 < w_bound; dx += 4) {
-        int x0 = xofs[dx];
-        int x1 = xofs[dx + 1];
-        int x2 = xofs[dx + 2];
-        int x3 = xofs[dx + 3];
-
-        const float* s0p0 = s0 + x0;
-        const float* s0p1 = s0 + x1;
-        const float* s0p2 = s0 + x2;
-        const float* s0p3 = s0 + x3;
-
-        const float* s0p0_1 = s0p0 + 1;
-        const float* s0p1_1 = s0p1 + 1;
-        const float* s0p2_1 = s0p2 + 1;
-        const float* s0p3_1 = s0p3 + 1;
-
-        const float* s1p0 = s1 + x0;
-        const float* s1p1 = s1 + x1;
-        const float* s1p2 = s1 + x2;
-        const float* s1p3 = s1 + x3;
-
-        const float* s1p0_1 = s1p0 + 1;
-        const float* s1p1_1 = s1p1 + 1;
-        const float* s1p2_1 = s1p2 + 1;
-        const float* s1p3_1 = s1p3 + 1;
-
-        __m256 _a = _mm256_loadu_ps(alphap);
-
-        __m256 _s0p0p3 = _mm256_set_ps(
-            *s0p3_1, *s0p3, *s0p2_1, *s0p2, *s0p1_1, *s0p1, *s0p0_1, *s0p0);
-
-        __m256 _ms0 = _mm256_mul_ps(_s0p0p3, _a);
-        __m256 _s1p0p3 = _mm256_set_ps(
-            *s1p3_1, *s1p3, *s1p2_1, *s1p2, *s1p1_1, *s1p1, *s1p0_1, *s1p0);
-        __m256 _ms1 = _mm256_mul_ps(_s1p0p3, _a);
-
-        __m256 _rows0 = _mm256_hadd_ps(_ms0, _ms0);
-        __m256 _rows1 = _mm256_hadd_ps(_ms1, _ms1);
-
-        __m256 _rs0 = _mm256_castpd_ps(
-            _mm256_permute4x64_pd(_mm256_castps_pd(_rows0), 0b11011000));
-        __m256 _rs1 = _mm256_castpd_ps(
-            _mm256_permute4x64_pd(_mm256_castps_pd(_rows1), 0b11011000));
-        _mm_storeu_ps(rows0p + dx, _mm256_castps256_ps128(_rs0));
-        _mm_storeu_ps(rows1p + dx, _mm256_castps256_ps128(_rs1));
-
-        alphap += 8;
-      }
-#endif
-
-      // w_bound remain loop
-      for (; dx < w_bound; ++dx) {
-        int sx = xofs[dx];
-        const float* s0p = s0 + sx;
-        const float* s1p = s1 + sx;
-
-        float a0 = alphap[0];
-        float a1 = alphap[1];
-        rows0p[dx] = s0p[0] * a0 + s0p[1] * a1;
-        rows1p[dx] = s1p[0] * a0 + s1p[1] * a1;
-
-        alphap += 2;
-      }
-
-      float param0 = *(src + sy * w_in + w_in - 1);
-      float param1 = *(src + (sy + 1) * w_in + w_in - 1);
-      const float buffer0[2] = {param0, param0};
-      const float buffer1[2] = {param1, param1};
-#ifdef __AVX__
-      __m256 _s0p0p3 = _mm256_set1_ps(param0);
-      __m256 _s1p0p3 = _mm256_set1_ps(param1);
-      for (; dx + 3 < w_out; dx += 4) {
-        __m256 _a = _mm256_loadu_ps(alphap);
-
-        __m256 _ms0 = _mm256_mul_ps(_s0p0p3, _a);
-        __m256 _ms1 = _mm256_mul_ps(_s1p0p3, _a);
-
-        __m256 _rows0 = _mm256_hadd_ps(_ms0, _ms0);
-        __m256 _rows1 = _mm256_hadd_ps(_ms1, _ms1);
-
-        __m256 _rs0 = _mm256_castpd_ps(
-            _mm256_permute4x64_pd(_mm256_castps_pd(_rows0), 0b11011000));
-        __m256 _rs1 = _mm256_castpd_ps(
-            _mm256_permute4x64_pd(_mm256_castps_pd(_rows1), 0b11011000));
-        _mm_storeu_ps(rows0p + dx, _mm256_castps256_ps128(_rs0));
-        _mm_storeu_ps(rows1p + dx, _mm256_castps256_ps128(_rs1));
-
-        alphap += 8;
-      }
-#endif
-
-      // w_bound - w_out remain loop
-      for (; dx < w_out; dx++) {
-        const float* s0p = buffer0;
-        const float* s1p = buffer1;
-
-        float a0 = alphap[0];
-        float a1 = alphap[1];
-        rows0p[dx] = s0p[0] * a0 + s0p[1] * a1;
-        rows1p[dx] = s1p[0] * a0 + s1p[1] * a1;
-
-        alphap += 2;
-      }
-
-      float b0 = betap[0];
-      float b1 = betap[1];
-
-      // output pos
-      float* dp = dst + dy * w_out;
-
-      int nn = 0;
-
-#ifdef __AVX__
-      // 8 float
-      __m256 _b0 = _mm256_set1_ps(b0);
-      __m256 _b1 = _mm256_set1_ps(b1);
-      // calculate and store results
-      for (; nn + 7 < w_out; nn += 8) {
-        __m256 _rows0 = _mm256_loadu_ps(rows0p);
-        __m256 _rows1 = _mm256_loadu_ps(rows1p);
-
-        __m256 _d = _mm256_add_ps(_mm256_mul_ps(_rows0, _b0),
-                                  _mm256_mul_ps(_rows1, _b1));
-        _mm256_storeu_ps(dp, _d);
 
-        dp += 8;
-        rows0p += 8;
-        rows1p += 8;
+    // Two horizontally interpolated rows are cached with the input row they
+    // come from, so each input row is resized once when upsampling.
+    float* rowsbuf =
+        static_cast<float*>(lite::host::malloc(sizeof(float) * w_out * 2));
+    float* rows[2] = {rowsbuf, rowsbuf + w_out};
+    int rows_y[2] = {-1, -1};
+    auto fetch_row = [&](int sy, int keep) {
+      for (int i = 0; i < 2; ++i) {
+        if (rows_y[i] == sy) return i;
       }
+      int i = (keep == 0) ? 1 : 0;
+      bilinear_resize_row(src + sy * w_in,
+                          rows[i],
+                          xofs,
+                          alpha0,
+                          alpha1,
+                          w_in,
+                          w_bound,
+                          w_out);
+      rows_y[i] = sy;
+      return i;
+    };
 
-      // 4 float
-      __m128 _c0 = _mm_set1_ps(b0);
-      __m128 _c1 = _mm_set1_ps(b1);
-      for (; nn + 3 < w_out; nn += 4) {
-        __m128 _rows0 = _mm_loadu_ps(rows0p);
-        __m128 _rows1 = _mm_loadu_ps(rows1p);
-
-        __m128 _d =
-            _mm_add_ps(_mm_mul_ps(_rows0, _c0), _mm_mul_ps(_rows1, _c1));
-        _mm_storeu_ps(dp, _d);
-
-        dp += 4;
-        rows0p += 4;
-        rows1p += 4;
-      }
-#endif
-
-      // calculate and store remain resluts
-      for (; nn < w_out; ++nn) {
-        *dp++ = *rows0p++ * b0 + *rows1p++ * b1;
-      }
-      betap += 2;
-    }  // end h_bound loop
-
-    // h_bound - h_out loop
-    for (int dy = h_bound; dy < h_out; dy++) {
-      int sy = h_in - 1;
-      const float* s0 = src + sy * w_in;
-      const float* s1 = s0;
-      const float* alphap = alpha;
-      float* rows0p = rows0;
-      float* rows1p = rows1;
-
-      int dx = 0;
-#ifdef __AVX__
-      // w_bound loop
-      for (; dx + 3 < w_bound; dx += 4) {
-        int x0 = xofs[dx];
-        int x1 = xofs[dx + 1];
-        int x2 = xofs[dx + 2];
-        int x3 = xofs[dx + 3];
-
-        const float* s0p0 = s0 + x0;
-        const float* s0p1 = s0 + x1;
-        const float* s0p2 = s0 + x2;
-        const float* s0p3 = s0 + x3;
-
-        const float* s0p0_1 = s0p0 + 1;
-        const float* s0p1_1 = s0p1 + 1;
-        const float* s0p2_1 = s0p2 + 1;
-        const float* s0p3_1 = s0p3 + 1;
-
-        const float* s1p0 = s1 + x0;
-        const float* s1p1 = s1 + x1;
-        const float* s1p2 = s1 + x2;
-        const float* s1p3 = s1 + x3;
-
-        const float* s1p0_1 = s1p0 + 1;
-        const float* s1p1_1 = s1p1 + 1;
-        const float* s1p2_1 = s1p2 + 1;
-        const float* s1p3_1 = s1p3 + 1;
-
-        __m256 _a = _mm256_loadu_ps(alphap);
-
-        __m256 _s0p0p3 = _mm256_set_ps(
-            *s0p3_1, *s0p3, *s0p2_1, *s0p2, *s0p1_1, *s0p1, *s0p0_1, *s0p0);
-        __m256 _ms0 = _mm256_mul_ps(_s0p0p3, _a);
-        __m256 _s1p0p3 = _mm256_set_ps(
-            *s1p3_1, *s1p3, *s1p2_1, *s1p2, *s1p1_1, *s1p1, *s1p0_1, *s1p0);
-        __m256 _ms1 = _mm256_mul_ps(_s1p0p3, _a);
-
-        __m256 _rows0 = _mm256_hadd_ps(_ms0, _ms0);
-        __m256 _rows1 = _mm256_hadd_ps(_ms1, _ms1);
-
-        __m256 _rs0 = _mm256_castpd_ps(
-            _mm256_permute4x64_pd(_mm256_castps_pd(_rows0), 0b11011000));
-        __m256 _rs1 = _mm256_castpd_ps(
-            _mm256_permute4x64_pd(_mm256_castps_pd(_rows1), 0b11011000));
-        _mm_storeu_ps(rows0p + dx, _mm256_castps256_ps128(_rs0));
-        _mm_storeu_ps(rows1p + dx, _mm256_castps256_ps128(_rs1));
-
-        alphap += 8;
-      }
-#endif
-
-      // w_bound remain loop
-      for (; dx < w_bound; ++dx) {
-        int sx = xofs[dx];
-        const float* s0p = s0 + sx;
-        float a0 = alphap[0];
-        float a1 = alphap[1];
-        rows0p[dx] = s0p[0] * a0 + s0p[1] * a1;
-        rows1p[dx] = rows0p[dx];
-
-        alphap += 2;
-      }
-
-      float param = *(src + sy * w_in + w_in - 1);
-      const float buffer1[2] = {param, param};
-
-#ifdef __AVX__
-      __m256 _s0p0p3 = _mm256_set1_ps(param);
-      __m256 _s1p0p3 = _mm256_set1_ps(param);
-
-      // w_bound - w_out loop
-      for (; dx + 3 < w_out; dx += 4) {
-        __m256 _a = _mm256_loadu_ps(alphap);
-
-        __m256 _ms0 = _mm256_mul_ps(_s0p0p3, _a);
-        __m256 _ms1 = _mm256_mul_ps(_s1p0p3, _a);
-
-        __m256 _rows0 = _mm256_hadd_ps(_ms0, _ms0);
-        __m256 _rows1 = _mm256_hadd_ps(_ms1, _ms1);
-
-        __m256 _rs0 = _mm256_castpd_ps(
-            _mm256_permute4x64_pd(_mm256_castps_pd(_rows0), 0b11011000));
-        __m256 _rs1 = _mm256_castpd_ps(
-            _mm256_permute4x64_pd(_mm256_castps_pd(_rows1), 0b11011000));
-        _mm_storeu_ps(rows0p + dx, _mm256_castps256_ps128(_rs0));
-        _mm_storeu_ps(rows1p + dx, _mm256_castps256_ps128(_rs1));
-
-        alphap += 8;
-      }
-#endif
-
-      // w_bound - wout remain loop
-      for (; dx < w_out; dx++) {
-        const float* s0p = buffer1;
-        float a0 = alphap[0];
-        float a1 = alphap[1];
-        rows0p[dx] = s0p[0] * a0 + s0p[1] * a1;
-        rows1p[dx] = rows0p[dx];
-        alphap += 2;
-      }
-
-      float b0 = betap[0];
-      float b1 = betap[1];
-
-      float* dp = dst + dy * w_out;
-
-      int nn = 0;
+    for (int dy = 0; dy < h_out; dy++) {
+      int sy0 = dy < h_bound ? yofs[dy] : h_in - 1;
+      int sy1 = dy < h_bound ? sy0 + 1 : sy0;
+      int r0 = fetch_row(sy0, -1);
+      int r1 = fetch_row(sy1, r0);
+      bilinear_blend_rows(rows[r0],
+                          rows[r1],
+                          beta0[dy],
+                          beta1[dy],
+                          dst + dy * w_out,
+                          w_out);
+    }
+    lite::host::free(rowsbuf);
+  }
+  lite::host::free(buf);
+}
 
+// Upsample by 2 without align_corners, every input pixel is copied into a
+// 2x2 block of the output.
+static void nearest_upsample2x(const float* src,
+                               float* dst,
+                               const int in_h,
+                               const int in_w) {
+  const int out_w = in_w * 2;
+  for (int y = 0; y < in_h; ++y) {
+    const float* sp = src + y * in_w;
+    float* dp = dst + 2 * y * out_w;
+    int x = 0;
 #ifdef __AVX__
-      // 8 float
-      __m256 _b0 = _mm256_set1_ps(b0);
-      __m256 _b1 = _mm256_set1_ps(b1);
-      // calculate and store results
-      for (; nn + 7 < w_out; nn += 8) {
-        __m256 _rows0 = _mm256_loadu_ps(rows0p);
-        __m256 _rows1 = _mm256_loadu_ps(rows1p);
-
-        __m256 _d = _mm256_add_ps(_mm256_mul_ps(_rows0, _b0),
-                                  _mm256_mul_ps(_rows1, _b1));
-        _mm256_storeu_ps(dp, _d);
-
-        dp += 8;
-        rows0p += 8;
-        rows1p += 8;
-      }
-
-      // 4 float
-      __m128 _c0 = _mm_set1_ps(b0);
-      __m128 _c1 = _mm_set1_ps(b1);
-      for (; nn + 3 < w_out; nn += 4) {
-        __m128 _rows0 = _mm_loadu_ps(rows0p);
-        __m128 _rows1 = _mm_loadu_ps(rows1p);
-
-        __m128 _d =
-            _mm_add_ps(_mm_mul_ps(_rows0, _c0), _mm_mul_ps(_rows1, _c1));
-        _mm_storeu_ps(dp, _d);
-
-        dp += 4;
-        rows0p += 4;
-        rows1p += 4;
-      }
+    for (; x + 7 < in_w; x += 8) {
+      __m256 _s = _mm256_loadu_ps(sp + x);
+      __m256 _lo = _mm256_unpacklo_ps(_s, _s);
+      __m256 _hi = _mm256_unpackhi_ps(_s, _s);
+      _mm256_storeu_ps(dp + 2 * x, _mm256_permute2f128_ps(_lo, _hi, 0x20));
+      _mm256_storeu_ps(dp + 2 * x + 8, _mm256_permute2f128_ps(_lo, _hi, 0x31));
+    }
 #endif
-      // calculate and store remain results
-      for (; nn < w_out; ++nn) {
-        *dp++ = *rows0p++ * b0 + *rows1p++ * b1;
-      }
-
-      betap += 2;
-    }  // end h_bound - h_out loop
-    lite::host::free(rowsbuf0);
-    lite::host::free(rowsbuf1);
+    for (; x < in_w; ++x) {
+      dp[2 * x] = sp[x];
+      dp[2 * x + 1] = sp[x];
+    }
+    std::memcpy(dp + out_w, dp, sizeof(float) * out_w);
   }
-  lite::host::free(buf);
 }
 
 void nearest_interp(const float* input_data,
@@ -463,44 +236,57 @@ void nearest_interp(const float* input_data,
                     const int out_w,
                     const bool align_corners) {
   int total_count = n * c;
-  if (align_corners) {
+  int in_stride = in_h * in_w;
+  int out_stride = out_h * out_w;
+  if (!align_corners && out_h == 2 * in_h && out_w == 2 * in_w) {
 #ifdef PADDLE_WITH_MKLML
-#if !defined(WIN32)
-#pragma omp parallel for collapse(3)
-#else
 #pragma omp parallel for
-#endif  // WIN32
-#endif  // PADDLE_WITH_MKLML
+#endif
     for (int i = 0; i < total_count; ++i) {
-      for (int h = 0; h < out_h; ++h) {
-        for (int w = 0; w < out_w; ++w) {
-          const float* input_data_ptr = input_data + i * in_h * in_w;
-          float* output_data_ptr =
-              output_data + i * out_h * out_w + h * out_w + w;
-          int near_y = static_cast<int>(ratio_h * h + 0.5);
-          int near_x = static_cast<int>(ratio_w * w + 0.5);
-          *output_data_ptr = input_data_ptr[near_y * in_w + near_x];
-        }
-      }
+      nearest_upsample2x(input_data + i * in_stride,
+                         output_data + i * out_stride,
+                         in_h,
+                         in_w);
     }
-  } else {
+    return;
+  }
+
+  // The source index tables are shared by all the channels.
+  std::vector<int> xofs(out_w);
+  std::vector<int> yofs(out_h);
+  for (int w = 0; w < out_w; ++w) {
+    xofs[w] = align_corners ? static_cast<int>(ratio_w * w + 0.5)
+                            : static_cast<int>(ratio_w * w);
+  }
+  for (int h = 0; h < out_h; ++h) {
+    yofs[h] = align_corners ? static_cast<int>(ratio_h * h + 0.5)
+                            : static_cast<int>(ratio_h * h);
+  }
+
 #ifdef PADDLE_WITH_MKLML
-#if !defined(WIN32)
-#pragma omp parallel for collapse(3)
-#else
 #pragma omp parallel for
-#endif  // WIN32
-#endif  // PADDLE_WITH_MKLML
-    for (int i = 0; i < total_count; ++i) {
-      for (int h = 0; h < out_h; ++h) {
-        for (int w = 0; w < out_w; ++w) {
-          const float* input_data_ptr = input_data + i * in_h * in_w;
-          float* output_data_ptr =
-              output_data + i * out_h * out_w + h * out_w + w;
-          int near_y = static_cast<int>(ratio_h * h);
-          int near_x = static_cast<int>(ratio_w * w);
-          *output_data_ptr = input_data_ptr[near_y * in_w + near_x];
-        }
+#endif
+  for (int i = 0; i < total_count; ++i) {
+    const float* src = input_data + i * in_stride;
+    float* dst = output_data + i * out_stride;
+    for (int h = 0; h < out_h; ++h) {
+      float* dp = dst + h * out_w;
+      // Rows sampling the same input row are equal.
+      if (h > 0 && yofs[h] == yofs[h - 1]) {
+        std::memcpy(dp, dp - out_w, sizeof(float) * out_w);
+        continue;
+      }
+      const float* sp = src + yofs[h] * in_w;
+      int w = 0;
+#ifdef __AVX2__
+      for (; w + 7 < out_w; w += 8) {
+        __m256i _x =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&xofs[w]));
+        _mm256_storeu_ps(dp + w, _mm256_i32gather_ps(sp, _x, 4));
+      }
+#endif
+      for (; w < out_w; ++w) {
+        dp[w] = sp[xofs[w]];
       }
     }
   }
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <algorithm>
+#include "lite/utils/trace.h"
 #ifdef PADDLE_WITH_MKLML
 #include <omp.h>
 #include "lite/backends/x86/mklml.h"
@@ -63,6 +64,7 @@ static inline void RunParallelFor(const int64_t begin,
       int64_t tid = omp_get_thread_num();
       int64_t chunk_size = (end - begin + num_threads - 1) / num_threads;
       int64_t begin_tid = begin + tid * chunk_size;
+      TraceScope trace("parallel_for", "chunk", "begin", begin_tid);
       f(begin_tid, (std::min)(end, chunk_size + begin_tid));
     }
     return;
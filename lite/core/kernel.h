@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <set>
@@ -55,6 +56,29 @@ class KernelBase {
   /// Run kernel initialization if needed at every run (eg. input shape changed)
   virtual void ReInitWhenNeeded() {}
 
+  /// Estimated time of one `Run` in microseconds on the current shapes of the
+  /// param, which is used to choose among the interchangeable kernels of an op.
+  /// A negative value means that the cost is unknown.
+  virtual float EstimateCost() const { return -1.f; }
+
+  /// The tag of the weights the kernel packs in `PrepareForRun`, which names
+  /// the target, the kernel, the instruction set, the packing and its
+  /// version, e.g. "x86/depthwise_conv/avx/pack8/v1". An empty tag means that
+  /// the kernel doesn't pack its weights. It is valid after `SetParam`.
+  virtual std::string PrepackedWeightsTag() const { return ""; }
+
+  /// The input argument holding the weights the kernel packs, e.g. "Filter".
+  /// They may be left out of the saved model if no other op reads them.
+  virtual std::string PrepackedWeightsInput() const { return ""; }
+
+  /// Pack the weights into `packed` as `PrepareForRun` does, so that they can
+  /// be saved with the model.
+  virtual void PackWeights(Tensor* packed) const {}
+
+  /// Use the weights packed by a kernel of the same tag instead of packing
+  /// them in `PrepareForRun`. It is called before the first run.
+  virtual void SetPrepackedWeights(const Tensor& packed) {}
+
   /// Run the kernel. Before Run, both the param_ and context_ should be valid.
   virtual void Run() = 0;
 
@@ -200,6 +224,20 @@ class KernelBase {
   void Torch() {}
 
  protected:
+  /// The `EstimateCost` of a kernel spending `ns_per_call` nanoseconds on
+  /// every run, e.g. to set up its loops, and `ns_per_element` nanoseconds on
+  /// every element of a tensor of `dims`. The unknown dimensions, e.g. the
+  /// batch size, are taken as 1.
+  static float ElementwiseCost(const DDim& dims,
+                               float ns_per_element,
+                               float ns_per_call = 0.f) {
+    int64_t num = 1;
+    for (size_t i = 0; i < dims.size(); ++i) {
+      num *= (std::max)(dims[i], static_cast<int64_t>(1));
+    }
+    return (num * ns_per_element + ns_per_call) * 1e-3f;
+  }
+
   std::unique_ptr<KernelContext> ctx_{nullptr};
   mutable operators::param_t param_;
   // The corresponding op type.
@@ -58,5 +58,75 @@ TEST(tensor, shared_memory) {
 #endif
 }
 
+TEST(tensor, share_data_until_write) {
+  TensorLite x;
+  x.Resize({2, 3});
+  float* x_data = x.mutable_data<float>();
+  for (int i = 0; i < 6; i++) {
+    x_data[i] = i;
+  }
+
+  TensorLite y;
+  y.ShareDataUntilWrite(x);
+  EXPECT_EQ(y.data<float>(), x.data<float>());
+  EXPECT_EQ(y.dims(), x.dims());
+
+  // Writing x moves it to a copy of the buffer and leaves y untouched.
+  float* new_x_data = x.mutable_data<float>();
+  EXPECT_NE(new_x_data, y.data<float>());
+  for (int i = 0; i < 6; i++) {
+    EXPECT_EQ(new_x_data[i], i);
+    new_x_data[i] = -1;
+    EXPECT_EQ(y.data<float>()[i], i);
+  }
+
+  // Once nothing else refers to the buffer, writes happen in place.
+  const float* y_data = y.data<float>();
+  EXPECT_EQ(y.mutable_data<float>(), y_data);
+  EXPECT_EQ(x.mutable_data<float>(), new_x_data);
+}
+
+TEST(tensor, share_data_until_write_sharers) {
+  TensorLite x;
+  x.Resize({4});
+  float* x_data = x.mutable_data<float>();
+  for (int i = 0; i < 4; i++) {
+    x_data[i] = i;
+  }
+
+  // Plain aliases do not make writes move to a new buffer.
+  TensorLite view;
+  view.ShareDataWith(x);
+  EXPECT_EQ(x.mutable_data<float>(), x_data);
+
+  // Neither does an alias which has gone away.
+  {
+    TensorLite y;
+    y.ShareDataUntilWrite(x);
+  }
+  EXPECT_EQ(x.mutable_data<float>(), x_data);
+
+  TensorLite z;
+  z.ShareDataUntilWrite(x);
+  z.clear();
+  EXPECT_EQ(x.mutable_data<float>(), x_data);
+
+  // A copy into a shared tensor does not reach the other sharers.
+  TensorLite w;
+  w.ShareDataUntilWrite(x);
+  TensorLite other;
+  other.Resize({4});
+  float* other_data = other.mutable_data<float>();
+  for (int i = 0; i < 4; i++) {
+    other_data[i] = -i - 1;
+  }
+  w.CopyDataFrom(other);
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(x.data<float>()[i], i);
+    EXPECT_EQ(w.data<float>()[i], -i - 1);
+  }
+  EXPECT_EQ(x.mutable_data<float>(), x_data);
+}
+
 }  // namespace lite
 }  // namespace paddle
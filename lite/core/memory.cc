@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "lite/core/memory.h"
+#include <atomic>
 
 #ifdef LITE_WITH_METAL
 #include "lite/backends/metal/target_wrapper.h"
@@ -22,6 +23,41 @@
 namespace paddle {
 namespace lite {
 
+namespace {
+
+// Relaxed atomics, since the counters don't order any other memory access.
+std::atomic<uint64_t> buffer_bytes{0};
+std::atomic<uint64_t> buffer_peak_bytes{0};
+std::atomic<uint64_t> buffer_allocs{0};
+std::atomic<uint64_t> buffer_frees{0};
+
+}  // namespace
+
+BufferMemoryStats GetBufferMemoryStats() {
+  BufferMemoryStats stats;
+  stats.bytes = buffer_bytes.load(std::memory_order_relaxed);
+  stats.peak_bytes = buffer_peak_bytes.load(std::memory_order_relaxed);
+  stats.num_allocs = buffer_allocs.load(std::memory_order_relaxed);
+  stats.num_frees = buffer_frees.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void RecordBufferAlloc(size_t size) {
+  buffer_allocs.fetch_add(1, std::memory_order_relaxed);
+  const uint64_t bytes =
+      buffer_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+  uint64_t peak = buffer_peak_bytes.load(std::memory_order_relaxed);
+  while (peak < bytes &&
+         !buffer_peak_bytes.compare_exchange_weak(
+             peak, bytes, std::memory_order_relaxed)) {
+  }
+}
+
+void RecordBufferFree(size_t size) {
+  buffer_frees.fetch_add(1, std::memory_order_relaxed);
+  buffer_bytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
 void* TargetMalloc(TargetType target, size_t size) {
   void* data{nullptr};
   switch (target) {
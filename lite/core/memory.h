@@ -60,6 +60,19 @@ void LITE_API TargetFree(TargetType target,
                          void* data,
                          std::string free_flag = "");
 
+// The memory held by the buffers owning their data, counted across the
+// process.
+struct BufferMemoryStats {
+  uint64_t bytes{0};
+  uint64_t peak_bytes{0};
+  uint64_t num_allocs{0};
+  uint64_t num_frees{0};
+};
+
+LITE_API BufferMemoryStats GetBufferMemoryStats();
+void RecordBufferAlloc(size_t size);
+void RecordBufferFree(size_t size);
+
 // Copy a buffer from host to another target.
 void TargetCopy(TargetType target, void* dst, const void* src, size_t size);
 #ifdef LITE_WITH_OPENCL
@@ -133,13 +146,21 @@ class Buffer {
   size_t space() const { return space_; }
   bool own_data() const { return own_data_; }
 
+  // An unowned buffer can not be reset unless it is replaceable, like the
+  // views of a privately mapped model file. Then it moves to memory of its
+  // own, leaving the unowned data untouched.
+  bool replaceable() const { return replaceable_; }
+  void set_replaceable(bool replaceable) { replaceable_ = replaceable; }
+
   void ResetLazy(TargetType target, size_t size) {
     if (target != target_ || space_ < size) {
-      CHECK_EQ(own_data_, true) << "Can not reset unowned buffer.";
+      CHECK(own_data_ || replaceable_) << "Can not reset unowned buffer.";
       Free();
+      own_data_ = true;
       data_ = TargetMalloc(target, size);
       target_ = target;
       space_ = size;
+      RecordBufferAlloc(space_);
 #ifdef LITE_WITH_OPENCL
       cl_use_image2d_ = false;
 #endif
@@ -170,6 +191,7 @@ class Buffer {
       space_ = sizeof(T) * cl_image2d_width_ * cl_image2d_height_ *
                4;  // un-used for opencl Image2D, 4 for RGBA,
       cl_use_image2d_ = true;
+      RecordBufferAlloc(space_);
     }
   }
 #endif
@@ -188,6 +210,7 @@ class Buffer {
       metal_use_image2d_ = true;
       space_ = sizeof(T) * dim.production();
       dim_ = dim;
+      RecordBufferAlloc(space_);
     }
   }
 
@@ -209,6 +232,7 @@ class Buffer {
       metal_use_image2d_ = false;
       space_ = sizeof(T) * dim.production();
       dim_ = dim;
+      RecordBufferAlloc(space_);
       transpose_ = transpose;
       to_nhwc_ = to_nhwc;
       pad_when_one_c_ = pad_when_one_c;
@@ -218,6 +242,7 @@ class Buffer {
 
   void Free() {
     if (space_ > 0 && own_data_) {
+      RecordBufferFree(space_);
       if (!cl_use_image2d_ && !metal_use_image2d_) {
         TargetFree(target_, data_);
       } else if (cl_use_image2d_) {
@@ -261,6 +286,7 @@ class Buffer {
 
   void* data_{nullptr};
   bool own_data_{true};
+  bool replaceable_{false};
   TargetType target_{TargetType::kHost};
 };
 
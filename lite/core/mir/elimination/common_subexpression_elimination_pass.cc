@@ -0,0 +1,284 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "lite/core/mir/pass.h"
+#include "lite/core/mir/pass_registry.h"
+#include "lite/core/mir/pattern_matcher.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+// Ops with side effects, randomness or sub-blocks are never merged.
+const std::set<std::string> kNonPureOps = {
+    "feed",
+    "fetch",
+    "while",
+    "conditional_block",
+    "conditional_block_infer",
+    "subgraph",
+    "write_to_array",
+    "read_from_array",
+    "print",
+    "dropout",
+    "uniform_random",
+    "gaussian_random",
+    "randint",
+    "randperm",
+    "sampling_id",
+};
+
+const std::set<std::string> kControlFlowOps = {
+    "while", "conditional_block", "conditional_block_infer"};
+
+// Ops whose result doesn't depend on the order of the inputs X and Y.
+const std::set<std::string> kCommutativeBinaryOps = {
+    "elementwise_add",
+    "elementwise_mul",
+    "elementwise_max",
+    "elementwise_min",
+    "logical_and",
+    "logical_or",
+    "logical_xor",
+    "equal",
+    "not_equal",
+};
+
+// Ops whose result doesn't depend on the order of the vars in input X.
+const std::set<std::string> kCommutativeListOps = {"sum"};
+
+// Attributes which only describe where an op comes from.
+const std::set<std::string> kIgnoredAttrs = {
+    "op_callstack", "op_namescope", "op_role", "op_role_var", "op_device"};
+
+template <typename T>
+void AppendPod(const T& value, std::string* key) {
+  key->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void AppendString(const std::string& value, std::string* key) {
+  AppendPod(value.size(), key);
+  key->append(value);
+}
+
+template <typename T>
+void AppendPods(const std::vector<T>& values, std::string* key) {
+  AppendPod(values.size(), key);
+  for (auto& value : values) AppendPod(value, key);
+}
+
+Node* FindArg(const std::list<Node*>& links, const std::string& name) {
+  for (auto* link : links) {
+    if (link->arg()->name == name) return link;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+/*
+ * mir::CommonSubexpressionEliminationPass
+ * Merge the statements which compute the same op type with the same
+ * attributes on the same input nodes, the consumers of the later one read the
+ * outputs of the first one instead. Inputs of commutative ops are compared as
+ * a set. A statement whose outputs are fetched is only kept, never removed, as
+ * the fetched names must stay. The ops reading the outputs of a merged
+ * statement become candidates
+ * themselves, so duplicated chains, e.g. shape -> slice -> cast, are merged
+ * in a single sweep.
+ */
+class CommonSubexpressionEliminationPass : public mir::ProgramPass {
+ public:
+  void Apply(const std::unique_ptr<SSAGraph>& graph) override {
+    write_counts_.clear();
+    for (auto& node : graph->mutable_nodes()) {
+      if (node.IsArg() && !node.inlinks.empty()) {
+        write_counts_[node.arg()->name]++;
+      }
+    }
+
+    std::unordered_map<std::string, Node*> computed;
+    int num_merged = 0;
+    for (auto* node : graph->StmtTopologicalOrder()) {
+      std::string key;
+      if (!HashKey(node, &key)) continue;
+      auto it = computed.find(key);
+      if (it == computed.end()) {
+        computed.emplace(key, node);
+        continue;
+      }
+      if (Merge(graph.get(), it->second, node)) num_merged++;
+    }
+    VLOG(3) << "common_subexpression_elimination_pass merged " << num_merged
+            << " ops";
+  }
+
+ private:
+  // The output vars are written only once and not read by control-flow ops,
+  // whose sub-blocks refer to the vars by name.
+  bool IsMergeable(Node* node) {
+    for (auto* out : node->outlinks) {
+      if (write_counts_[out->arg()->name] != 1) return false;
+      for (auto* consumer : out->outlinks) {
+        if (kControlFlowOps.count(consumer->AsStmt().op_type())) return false;
+      }
+    }
+    return true;
+  }
+
+  bool HashKey(Node* node, std::string* key) {
+    auto& stmt = node->AsStmt();
+    auto* op_info = stmt.op_info();
+    const auto op_type = op_info->Type();
+    if (kNonPureOps.count(op_type) || node->outlinks.empty()) return false;
+    if (!IsMergeable(node)) return false;
+
+    AppendString(op_type, key);
+    auto input_argnames = op_info->input_argnames();
+    std::sort(input_argnames.begin(), input_argnames.end());
+    bool commutative = kCommutativeBinaryOps.count(op_type) &&
+                       (!op_info->HasAttr("axis") ||
+                        op_info->GetAttr<int>("axis") == -1);
+    std::vector<const Node*> commutative_inputs;
+    for (auto& argname : input_argnames) {
+      std::vector<const Node*> inputs;
+      for (auto& name : op_info->Input(argname)) {
+        auto* in = FindArg(node->inlinks, name);
+        if (in == nullptr) return false;
+        inputs.push_back(in);
+      }
+      if (commutative && (argname == "X" || argname == "Y")) {
+        commutative_inputs.insert(
+            commutative_inputs.end(), inputs.begin(), inputs.end());
+        continue;
+      }
+      if (kCommutativeListOps.count(op_type) && argname == "X") {
+        std::sort(inputs.begin(), inputs.end());
+      }
+      AppendString(argname, key);
+      AppendPods(inputs, key);
+    }
+    std::sort(commutative_inputs.begin(), commutative_inputs.end());
+    AppendPods(commutative_inputs, key);
+
+    auto output_argnames = op_info->output_argnames();
+    std::sort(output_argnames.begin(), output_argnames.end());
+    for (auto& argname : output_argnames) {
+      AppendString(argname, key);
+      AppendPod(op_info->Output(argname).size(), key);
+    }
+
+    for (auto& attr : op_info->attr_types()) {
+      const auto& name = attr.first;
+      if (kIgnoredAttrs.count(name)) continue;
+      AppendString(name, key);
+      AppendPod(attr.second, key);
+      switch (attr.second) {
+#define APPEND_ATTR(attr_type, cpp_type, append_func)   \
+  case OpAttrType::attr_type:                           \
+    append_func(op_info->GetAttr<cpp_type>(name), key); \
+    break
+        APPEND_ATTR(INT, int32_t, AppendPod);
+        APPEND_ATTR(FLOAT, float, AppendPod);
+        APPEND_ATTR(BOOLEAN, bool, AppendPod);
+        APPEND_ATTR(LONG, int64_t, AppendPod);
+        APPEND_ATTR(STRING, std::string, AppendString);
+        APPEND_ATTR(INTS, std::vector<int32_t>, AppendPods);
+        APPEND_ATTR(FLOATS, std::vector<float>, AppendPods);
+        APPEND_ATTR(LONGS, std::vector<int64_t>, AppendPods);
+#undef APPEND_ATTR
+        case OpAttrType::STRINGS: {
+          auto values = op_info->GetAttr<std::vector<std::string>>(name);
+          AppendPod(values.size(), key);
+          for (auto& value : values) AppendString(value, key);
+          break;
+        }
+        default:
+          // Ops with sub-blocks or unknown attributes are not merged.
+          return false;
+      }
+    }
+    return true;
+  }
+
+  // Whether an output var of the statement is fetched, the user looks it up
+  // by its name, so it can't be renamed.
+  bool IsFetched(Node* node) {
+    for (auto* out : node->outlinks) {
+      for (auto* consumer : out->outlinks) {
+        if (consumer->AsStmt().op_type() == "fetch") return true;
+      }
+    }
+    return false;
+  }
+
+  bool Merge(SSAGraph* graph, Node* to_keep, Node* to_remove) {
+    if (IsFetched(to_remove)) return false;
+    auto* keep_info = to_keep->AsStmt().op_info();
+    auto* remove_info = to_remove->AsStmt().op_info();
+    std::set<const Node*> nodes2rm = {to_remove};
+    std::vector<std::pair<Node*, Node*>> replacements;
+    for (auto& argname : remove_info->output_argnames()) {
+      auto keep_names = keep_info->Output(argname);
+      auto remove_names = remove_info->Output(argname);
+      CHECK_EQ(keep_names.size(), remove_names.size());
+      for (size_t i = 0; i < remove_names.size(); i++) {
+        auto* keep_arg = FindArg(to_keep->outlinks, keep_names[i]);
+        auto* remove_arg = FindArg(to_remove->outlinks, remove_names[i]);
+        if (keep_arg == nullptr || remove_arg == nullptr) return false;
+        replacements.emplace_back(keep_arg, remove_arg);
+      }
+    }
+
+    VLOG(4) << "Merge " << remove_info->Type() << " into the same op writing "
+            << replacements.front().first->arg()->name;
+    for (auto& replacement : replacements) {
+      auto* keep_arg = replacement.first;
+      auto* remove_arg = replacement.second;
+      nodes2rm.insert(remove_arg);
+      const auto& keep_name = keep_arg->arg()->name;
+      const auto& remove_name = remove_arg->arg()->name;
+      for (auto* consumer : remove_arg->outlinks) {
+        auto& stmt = consumer->AsStmt();
+        auto op_info = *stmt.op_info();
+        op_info.UpdateAllInputs(remove_name, keep_name);
+        stmt.ResetOp(op_info, graph->valid_places());
+        if (FindArg(consumer->inlinks, keep_name) == nullptr) {
+          DirectedLink(keep_arg, consumer);
+        }
+      }
+    }
+    GraphSafeRemoveNodes(graph, nodes2rm);
+    return true;
+  }
+
+  std::map<std::string, int> write_counts_;
+};
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_MIR_PASS(common_subexpression_elimination_pass,
+                  paddle::lite::mir::CommonSubexpressionEliminationPass)
+    .BindTargets({TARGET(kAny)});
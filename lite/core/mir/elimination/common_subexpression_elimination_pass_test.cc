@@ -0,0 +1,171 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "lite/core/mir/pass_registry.h"
+#include "lite/core/mir/pass_test_helper.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+const std::vector<Place> kPlaces{{TARGET(kHost), PRECISION(kFloat)}};
+
+void ApplyPass(const std::unique_ptr<SSAGraph>& graph) {
+  auto* pass =
+      PassManager::Global().LookUp("common_subexpression_elimination_pass");
+  ASSERT_TRUE(pass);
+  pass->Apply(graph);
+}
+
+void AddScale(ProgramBuilderForTest* builder,
+              const std::string& x,
+              const std::string& out) {
+  auto* op_desc = builder->AddOp("scale", {{"X", {x}}}, {{"Out", {out}}});
+  op_desc->SetAttr<float>("scale", 2.f);
+  op_desc->SetAttr<float>("bias", 0.f);
+  op_desc->SetAttr<bool>("bias_after_scale", true);
+}
+
+// A conditional_block_infer op running the empty block 1 on `input`. It is
+// built as a conditional_block, as only the latter is registered, and renamed
+// once the graph is built.
+void AddConditionalBlock(ProgramBuilderForTest* builder,
+                         const std::string& input,
+                         const std::string& out) {
+  auto* op_desc = builder->AddOp("conditional_block",
+                                 {{"Cond", {"cond"}}, {"Input", {input}}},
+                                 {{"Out", {out}}});
+  op_desc->SetAttr<bool>("is_scalar_condition", true);
+  op_desc->SetAttr<int32_t>("sub_block", 1);
+}
+
+void RenameConditionalBlocks(SSAGraph* graph) {
+  for (auto* node : FindStmts(graph, "conditional_block")) {
+    node->AsStmt().mutable_op_info()->SetType("conditional_block_infer");
+  }
+}
+
+}  // namespace
+
+TEST(CommonSubexpressionEliminationPass, merge_same_ops) {
+  // x -> scale -> a -> elementwise_add -> out
+  //   -> scale -> b ->
+  ProgramBuilderForTest builder;
+  for (auto* name : {"x", "a", "b", "out"}) builder.AddVar(name, {2, 3});
+  builder.AddFeed("x", 0);
+  AddScale(&builder, "x", "a");
+  AddScale(&builder, "x", "b");
+  builder
+      .AddOp("elementwise_add",
+             {{"X", {"a"}}, {"Y", {"b"}}},
+             {{"Out", {"out"}}})
+      ->SetAttr<int>("axis", -1);
+  builder.AddFetch("out", 0);
+  auto graph = builder.BuildGraph(kPlaces);
+
+  ApplyPass(graph);
+
+  ASSERT_EQ(FindStmts(graph.get(), "scale").size(), 1u);
+  EXPECT_FALSE(HasArg(graph.get(), "b"));
+  auto* add = FindStmts(graph.get(), "elementwise_add").front();
+  EXPECT_EQ(add->AsStmt().op_info()->Input("X"),
+            std::vector<std::string>({"a"}));
+  EXPECT_EQ(add->AsStmt().op_info()->Input("Y"),
+            std::vector<std::string>({"a"}));
+}
+
+TEST(CommonSubexpressionEliminationPass, keep_fetched_names) {
+  // x -> scale -> a -> fetch
+  //   -> scale -> b -> fetch
+  //   -> scale -> c -> elementwise_add -> out -> fetch
+  // b is fetched by its name, so its scale stays, while c is replaced by a.
+  ProgramBuilderForTest builder;
+  for (auto* name : {"x", "a", "b", "c", "out"}) builder.AddVar(name, {2, 3});
+  builder.AddFeed("x", 0);
+  AddScale(&builder, "x", "a");
+  AddScale(&builder, "x", "b");
+  AddScale(&builder, "x", "c");
+  builder
+      .AddOp("elementwise_add",
+             {{"X", {"c"}}, {"Y", {"c"}}},
+             {{"Out", {"out"}}})
+      ->SetAttr<int>("axis", -1);
+  builder.AddFetch("a", 0);
+  builder.AddFetch("b", 1);
+  builder.AddFetch("out", 2);
+  auto graph = builder.BuildGraph(kPlaces);
+
+  ApplyPass(graph);
+
+  EXPECT_EQ(FindStmts(graph.get(), "scale").size(), 2u);
+  EXPECT_TRUE(HasArg(graph.get(), "a"));
+  EXPECT_TRUE(HasArg(graph.get(), "b"));
+  EXPECT_FALSE(HasArg(graph.get(), "c"));
+  std::vector<std::string> fetched;
+  for (auto* fetch : FindStmts(graph.get(), "fetch")) {
+    fetched.push_back(fetch->AsStmt().op_info()->Input("X").front());
+  }
+  std::sort(fetched.begin(), fetched.end());
+  EXPECT_EQ(fetched, std::vector<std::string>({"a", "b", "out"}));
+  auto* add = FindStmts(graph.get(), "elementwise_add").front();
+  EXPECT_EQ(add->AsStmt().op_info()->Input("X"),
+            std::vector<std::string>({"a"}));
+}
+
+TEST(CommonSubexpressionEliminationPass, keep_conditional_block_infer) {
+  // The vars read by conditional_block_infer are referred to by name in its
+  // sub-block, so the scales writing them are not merged. Neither are the two
+  // conditional_block_infer ops, as they run a sub-block.
+  ProgramBuilderForTest builder;
+  for (auto* name : {"x", "a", "b", "out0", "out1"}) {
+    builder.AddVar(name, {2, 3});
+  }
+  builder.AddVar("cond", {1});
+  builder.AddBlock();
+  builder.AddFeed("x", 0);
+  builder.AddFeed("cond", 1);
+  AddScale(&builder, "x", "a");
+  AddScale(&builder, "x", "b");
+  AddConditionalBlock(&builder, "a", "out0");
+  AddConditionalBlock(&builder, "a", "out1");
+  builder.AddFetch("b", 0);
+  builder.AddFetch("out0", 1);
+  builder.AddFetch("out1", 2);
+  auto graph = builder.BuildGraph(kPlaces);
+  RenameConditionalBlocks(graph.get());
+
+  ApplyPass(graph);
+
+  EXPECT_EQ(FindStmts(graph.get(), "scale").size(), 2u);
+  EXPECT_EQ(FindStmts(graph.get(), "conditional_block_infer").size(), 2u);
+  EXPECT_TRUE(HasArg(graph.get(), "b"));
+  EXPECT_TRUE(HasArg(graph.get(), "out1"));
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(feed)
+USE_LITE_OP(fetch)
+USE_LITE_OP(scale)
+USE_LITE_OP(elementwise_add)
+USE_LITE_OP(conditional_block)
+USE_MIR_PASS(common_subexpression_elimination_pass)
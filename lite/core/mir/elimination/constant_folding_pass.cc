@@ -0,0 +1,244 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/mir/elimination/constant_folding_pass.h"
+#include <algorithm>
+#include <set>
+#include <vector>
+#include "lite/core/context.h"
+#include "lite/core/mir/pass_registry.h"
+#include "lite/core/mir/pattern_matcher.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+// Ops which must stay in the graph even if all of their inputs are weights.
+const std::set<std::string> kUnfoldableOps = {
+    "feed",
+    "fetch",
+    "while",
+    "conditional_block",
+    "conditional_block_infer",
+    "subgraph",
+    "write_to_array",
+    "read_from_array",
+    "print",
+    "dropout",
+    "uniform_random",
+    "gaussian_random",
+    "randint",
+    "randperm",
+    "sampling_id",
+    "io_copy",
+    "io_copy_once",
+    "layout",
+    "layout_once",
+    "calib",
+    "calib_once",
+};
+
+// Ops without any input which are still constant.
+const std::set<std::string> kSourceOps = {"fill_constant", "assign_value"};
+
+const std::set<std::string> kControlFlowOps = {
+    "while", "conditional_block", "conditional_block_infer"};
+
+bool IsHostTarget(TargetType target) {
+  switch (target) {
+    case TARGET(kHost):
+#ifdef LITE_WITH_X86
+    case TARGET(kX86):
+#endif
+#ifdef LITE_WITH_ARM
+    case TARGET(kARM):
+#endif
+      return true;
+    default:
+      return false;
+  }
+}
+
+const Tensor* FindTensor(const Scope* scope, const std::string& name) {
+  auto* var = scope->FindVar(name);
+  if (var == nullptr || !var->IsType<Tensor>()) return nullptr;
+  return &var->Get<Tensor>();
+}
+
+// Whether the dims of the tensor are those of its VarDesc without any unknown
+// dimension, e.g. the batch size, so they don't change at inference time.
+bool HasStaticDims(const Tensor& tensor) {
+  auto dims = tensor.dims();
+  if (dims.empty()) return false;
+  for (size_t i = 0; i < dims.size(); ++i) {
+    if (dims[i] <= 0) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+void ConstantFoldingPass::Apply(const std::unique_ptr<SSAGraph>& graph) {
+  // The number of times every var is written, a folded output must not be
+  // overwritten by another op and a folded input must not be written at all.
+  std::map<std::string, int> write_counts;
+  for (auto& node : graph->mutable_nodes()) {
+    if (node.IsArg() && !node.inlinks.empty()) {
+      write_counts[node.arg()->name]++;
+    }
+  }
+
+  int num_folded = 0;
+  for (auto* node : graph->StmtTopologicalOrder()) {
+    if (!IsFoldable(node, write_counts)) continue;
+    std::vector<std::string> out_names;
+    for (auto* out : node->outlinks) {
+      out_names.push_back(out->arg()->name);
+    }
+    if (!Fold(graph.get(), node)) continue;
+    for (auto& name : out_names) {
+      write_counts[name]--;
+    }
+    num_folded++;
+  }
+  VLOG(3) << "constant_folding_pass folded " << num_folded << " ops";
+}
+
+bool ConstantFoldingPass::IsFoldable(
+    Node* node, const std::map<std::string, int>& write_counts) const {
+  if (!node->IsStmt()) return false;
+  auto& stmt = node->AsStmt();
+  const auto op_type = stmt.op_type();
+  if (kUnfoldableOps.count(op_type)) return false;
+  if (node->inlinks.empty() && !kSourceOps.count(op_type)) return false;
+
+  auto* scope = stmt.op()->scope();
+  for (auto* in : node->inlinks) {
+    auto& arg = in->AsArg();
+    // shape only reads the dims of its input, which may be an activation.
+    if (op_type == "shape") {
+      auto* tensor = FindTensor(scope, arg.name);
+      if (tensor == nullptr || !HasStaticDims(*tensor)) return false;
+      continue;
+    }
+    auto it = write_counts.find(arg.name);
+    if (!arg.is_weight || (it != write_counts.end() && it->second > 0)) {
+      return false;
+    }
+    auto* tensor = FindTensor(scope, arg.name);
+    if (tensor == nullptr || !tensor->IsInitialized()) return false;
+  }
+  if (node->outlinks.empty()) return false;
+  for (auto* out : node->outlinks) {
+    auto& arg = out->AsArg();
+    if (arg.is_weight || write_counts.at(arg.name) != 1) return false;
+    if (FindTensor(scope, arg.name) == nullptr) return false;
+    for (auto* consumer : out->outlinks) {
+      if (kControlFlowOps.count(consumer->AsStmt().op_type())) return false;
+    }
+  }
+  return true;
+}
+
+KernelBase* ConstantFoldingPass::PickHostKernel(Node* node) const {
+  auto& stmt = node->AsStmt();
+  auto* op_info = stmt.op_info();
+  auto* scope = stmt.op()->scope();
+  for (auto& kernel : stmt.kernels()) {
+    if (!IsHostTarget(kernel->target())) continue;
+    bool matched = true;
+    for (auto* in : node->inlinks) {
+      const auto& name = in->AsArg().name;
+      std::string arg_name;
+      CHECK(op_info->GetInputArgname(name, &arg_name));
+      const auto* decl_type = kernel->GetInputDeclType(arg_name);
+      auto precision = FindTensor(scope, name)->precision();
+      if (!decl_type->IsTensor() ||
+          (decl_type->target() != TARGET(kAny) &&
+           !IsHostTarget(decl_type->target())) ||
+          (decl_type->precision() != PRECISION(kAny) &&
+           decl_type->precision() != precision)) {
+        matched = false;
+        break;
+      }
+    }
+    if (matched) return kernel.get();
+  }
+  return nullptr;
+}
+
+bool ConstantFoldingPass::Fold(SSAGraph* graph, Node* node) {
+  auto& stmt = node->AsStmt();
+  auto* kernel = PickHostKernel(node);
+  if (kernel == nullptr) return false;
+  auto op = stmt.op();
+  auto* op_info = stmt.op_info();
+  auto* scope = op->scope();
+  if (!op->CheckShape()) return false;
+  op->InferShape();
+
+  int64_t in_bytes = 0;
+  for (auto* in : node->inlinks) {
+    in_bytes += FindTensor(scope, in->AsArg().name)->memory_size();
+  }
+  int64_t out_bytes = 0;
+  for (auto* out : node->outlinks) {
+    const auto& name = out->AsArg().name;
+    std::string arg_name;
+    CHECK(op_info->GetOutputArgname(name, &arg_name));
+    auto precision = kernel->GetOutputDeclType(arg_name)->precision();
+    int64_t elem_bytes = lite_api::PrecisionTypeLength(precision);
+    if (elem_bytes == 0) elem_bytes = 4;
+    out_bytes += FindTensor(scope, name)->dims().production() * elem_bytes;
+  }
+  if (out_bytes > in_bytes + kMaxFoldedBytesGrowth) {
+    VLOG(4) << "Skip folding " << stmt.op_type() << ", it grows the model by "
+            << out_bytes - in_bytes << " bytes";
+    return false;
+  }
+
+  VLOG(4) << "Fold " << stmt.op_type() << " with kernel "
+          << kernel->summary();
+  kernel->SetContext(ContextScheduler::Global().NewContext(kernel->target()));
+  kernel->Launch();
+
+  std::set<const Node*> nodes2rm;
+  nodes2rm.insert(node);
+  for (auto* out : node->outlinks) {
+    auto* var = scope->FindVar(out->AsArg().name);
+    var->GetMutable<Tensor>()->set_persistable(true);
+    out->AsArg().is_weight = true;
+    if (out->outlinks.empty()) nodes2rm.insert(out);
+  }
+  // Drop the input weights only read by the folded op.
+  for (auto* in : node->inlinks) {
+    if (in->AsArg().is_weight &&
+        std::all_of(in->outlinks.begin(),
+                    in->outlinks.end(),
+                    [&](Node* x) { return x == node; })) {
+      nodes2rm.insert(in);
+    }
+  }
+  GraphSafeRemoveNodes(graph, nodes2rm);
+  return true;
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_MIR_PASS(constant_folding_pass, paddle::lite::mir::ConstantFoldingPass)
+    .BindTargets({TARGET(kAny)});
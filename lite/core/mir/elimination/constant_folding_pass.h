@@ -0,0 +1,64 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include "lite/core/kernel.h"
+#include "lite/core/mir/pass.h"
+#include "lite/core/tensor.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+/*
+ * mir::ConstantFoldingPass
+ * Evaluate the ops whose inputs are all weights (or which have no inputs at
+ * all, such as fill_constant and assign_value) with one of their host
+ * kernels at optimization time, and replace their outputs with persistable
+ * tensors. The folding is repeated along the topological order, so a whole
+ * weight-only subgraph, e.g. transpose -> scale -> reshape applied to a
+ * filter, collapses into a single weight.
+ *
+ * An op is skipped if
+ *   - it is nondeterministic, has side effects or is a control-flow op,
+ *   - any of its inputs is written by some op in the graph, except for shape,
+ *     which is folded if the dims of its input, set from the VarDesc by
+ *     Program::PrepareWorkspace, have no unknown dimension,
+ *   - any of its outputs is written more than once, read by a control-flow
+ *     op or is not a lite::Tensor,
+ *   - none of its kernels runs on host memory with the input precisions,
+ *   - its outputs are more than kMaxFoldedBytesGrowth bytes larger than its
+ *     inputs, to avoid bloating the optimized model with e.g. large
+ *     fill_constant outputs.
+ */
+class ConstantFoldingPass : public mir::StmtPass {
+ public:
+  void Apply(const std::unique_ptr<SSAGraph>& graph) override;
+
+ private:
+  static constexpr int64_t kMaxFoldedBytesGrowth = 1 << 20;
+
+  bool IsFoldable(Node* node,
+                  const std::map<std::string, int>& write_counts) const;
+  KernelBase* PickHostKernel(Node* node) const;
+  bool Fold(SSAGraph* graph, Node* node);
+};
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,205 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "lite/core/mir/pass_registry.h"
+#include "lite/core/mir/pass_test_helper.h"
+#include "lite/core/op_registry.h"
+#include "lite/core/types.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+const std::vector<Place> kPlaces{{TARGET(kX86), PRECISION(kFloat)},
+                                 {TARGET(kHost), PRECISION(kFloat)}};
+
+void ApplyPass(const std::unique_ptr<SSAGraph>& graph) {
+  auto* pass = PassManager::Global().LookUp("constant_folding_pass");
+  ASSERT_TRUE(pass);
+  pass->Apply(graph);
+}
+
+void AddFillConstant(ProgramBuilderForTest* builder,
+                     const std::string& out,
+                     const std::vector<int64_t>& shape,
+                     float value) {
+  builder->AddVar(out, shape);
+  auto* op_desc = builder->AddOp("fill_constant", {}, {{"Out", {out}}});
+  op_desc->SetAttr<int>("dtype", static_cast<int>(core::FluidType::FP32));
+  op_desc->SetAttr<std::vector<int64_t>>("shape", shape);
+  op_desc->SetAttr<float>("value", value);
+  op_desc->SetAttr<bool>("force_cpu", false);
+}
+
+void AddScale(ProgramBuilderForTest* builder,
+              const std::string& x,
+              const std::string& out,
+              float scale,
+              float bias) {
+  auto* op_desc = builder->AddOp("scale", {{"X", {x}}}, {{"Out", {out}}});
+  op_desc->SetAttr<float>("scale", scale);
+  op_desc->SetAttr<float>("bias", bias);
+  op_desc->SetAttr<bool>("bias_after_scale", true);
+}
+
+void AddAdd(ProgramBuilderForTest* builder,
+            const std::string& x,
+            const std::string& y,
+            const std::string& out) {
+  builder->AddOp("elementwise_add", {{"X", {x}}, {"Y", {y}}}, {{"Out", {out}}})
+      ->SetAttr<int>("axis", -1);
+}
+
+bool IsPersistable(ProgramBuilderForTest* builder, const std::string& name) {
+  return builder->exec_scope()->FindVar(name)->Get<Tensor>().persistable();
+}
+
+}  // namespace
+
+TEST(ConstantFoldingPass, fold_chain) {
+  // fill_constant -> c -> scale -> s -> elementwise_add -> out
+  //                             x ->
+  ProgramBuilderForTest builder;
+  builder.AddVar("x", {4, 8});
+  builder.AddVar("s", {4, 8});
+  builder.AddVar("out", {4, 8});
+  builder.AddFeed("x", 0);
+  AddFillConstant(&builder, "c", {4, 8}, 2.f);
+  AddScale(&builder, "c", "s", 3.f, 1.f);
+  AddAdd(&builder, "x", "s", "out");
+  builder.AddFetch("out", 0);
+  auto graph = builder.BuildGraph(kPlaces);
+
+  ApplyPass(graph);
+
+  EXPECT_TRUE(FindStmts(graph.get(), "fill_constant").empty());
+  EXPECT_TRUE(FindStmts(graph.get(), "scale").empty());
+  EXPECT_FALSE(HasArg(graph.get(), "c"));
+  auto* add = FindStmts(graph.get(), "elementwise_add").front();
+  for (auto* in : add->inlinks) {
+    EXPECT_EQ(in->AsArg().is_weight, in->AsArg().name == "s");
+  }
+  auto* s = builder.exec_scope()->FindVar("s")->GetMutable<Tensor>();
+  EXPECT_TRUE(s->persistable());
+  ASSERT_EQ(s->dims(), DDim(std::vector<int64_t>({4, 8})));
+  for (int64_t i = 0; i < s->numel(); i++) {
+    EXPECT_EQ(s->data<float>()[i], 7.f);
+  }
+}
+
+TEST(ConstantFoldingPass, limit_growth) {
+  // A fill_constant writing 1 MiB is within kMaxFoldedBytesGrowth and folded,
+  // one writing a row more is left to run at inference time.
+  ProgramBuilderForTest builder;
+  builder.AddVar("x", {512, 512});
+  builder.AddVar("small_out", {512, 512});
+  builder.AddVar("large_out", {512, 513});
+  builder.AddFeed("x", 0);
+  AddFillConstant(&builder, "small", {512, 512}, 1.f);
+  AddFillConstant(&builder, "large", {512, 513}, 1.f);
+  AddAdd(&builder, "x", "small", "small_out");
+  AddScale(&builder, "large", "large_out", 1.f, 0.f);
+  builder.AddFetch("small_out", 0);
+  builder.AddFetch("large_out", 1);
+  auto graph = builder.BuildGraph(kPlaces);
+
+  ApplyPass(graph);
+
+  auto fill_constants = FindStmts(graph.get(), "fill_constant");
+  ASSERT_EQ(fill_constants.size(), 1u);
+  EXPECT_EQ(fill_constants.front()->outlinks.front()->AsArg().name, "large");
+  // The scale reads a var which is still computed at inference time.
+  EXPECT_EQ(FindStmts(graph.get(), "scale").size(), 1u);
+  EXPECT_TRUE(IsPersistable(&builder, "small"));
+  EXPECT_FALSE(IsPersistable(&builder, "large"));
+}
+
+TEST(ConstantFoldingPass, skip_unfoldable) {
+  // The scale reads a fed var and the dropout, though it only reads a
+  // weight, is never folded.
+  ProgramBuilderForTest builder;
+  builder.AddVar("x", {4, 8});
+  builder.AddVar("w", {4, 8}, true, 1.f);
+  for (auto* name : {"s", "d", "out"}) builder.AddVar(name, {4, 8});
+  builder.AddFeed("x", 0);
+  AddScale(&builder, "x", "s", 2.f, 0.f);
+  auto* dropout = builder.AddOp("dropout", {{"X", {"w"}}}, {{"Out", {"d"}}});
+  dropout->SetAttr<float>("dropout_prob", 0.5f);
+  dropout->SetAttr<bool>("is_test", true);
+  dropout->SetAttr<bool>("fix_seed", false);
+  dropout->SetAttr<int>("seed", 0);
+  AddAdd(&builder, "s", "d", "out");
+  builder.AddFetch("out", 0);
+  auto graph = builder.BuildGraph(kPlaces);
+  const auto num_nodes = graph->nodes().size();
+
+  ApplyPass(graph);
+
+  EXPECT_EQ(graph->nodes().size(), num_nodes);
+  EXPECT_EQ(FindStmts(graph.get(), "scale").size(), 1u);
+  EXPECT_EQ(FindStmts(graph.get(), "dropout").size(), 1u);
+  EXPECT_FALSE(IsPersistable(&builder, "s"));
+  EXPECT_FALSE(IsPersistable(&builder, "d"));
+}
+
+TEST(ConstantFoldingPass, fold_static_shape) {
+  // The shape of x is known, the one of y has an unknown batch size.
+  ProgramBuilderForTest builder;
+  builder.AddVar("x", {4, 8});
+  builder.AddVar("y", {-1, 8});
+  builder.AddVar("x_shape", {2});
+  builder.AddVar("y_shape", {2});
+  builder.AddFeed("x", 0);
+  builder.AddFeed("y", 1);
+  builder.AddOp("shape", {{"Input", {"x"}}}, {{"Out", {"x_shape"}}});
+  builder.AddOp("shape", {{"Input", {"y"}}}, {{"Out", {"y_shape"}}});
+  builder.AddFetch("x_shape", 0);
+  builder.AddFetch("y_shape", 1);
+  auto graph = builder.BuildGraph(kPlaces);
+
+  ApplyPass(graph);
+
+  auto shapes = FindStmts(graph.get(), "shape");
+  ASSERT_EQ(shapes.size(), 1u);
+  EXPECT_EQ(shapes.front()->inlinks.front()->AsArg().name, "y");
+  // The fed x is kept.
+  EXPECT_TRUE(HasArg(graph.get(), "x"));
+  auto* x_shape = builder.exec_scope()->FindVar("x_shape")->GetMutable<Tensor>();
+  EXPECT_TRUE(x_shape->persistable());
+  ASSERT_EQ(x_shape->numel(), 2);
+  EXPECT_EQ(x_shape->data<int>()[0], 4);
+  EXPECT_EQ(x_shape->data<int>()[1], 8);
+  EXPECT_FALSE(IsPersistable(&builder, "y_shape"));
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(feed)
+USE_LITE_OP(fetch)
+USE_LITE_OP(fill_constant)
+USE_LITE_OP(scale)
+USE_LITE_OP(dropout)
+USE_LITE_OP(elementwise_add)
+USE_LITE_OP(shape)
+USE_LITE_KERNEL(fill_constant, kHost, kAny, kNCHW, def);
+USE_LITE_KERNEL(scale, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(shape, kHost, kAny, kAny, def);
+USE_MIR_PASS(constant_folding_pass)
@@ -0,0 +1,121 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "lite/core/mir/pass.h"
+#include "lite/core/mir/pass_registry.h"
+#include "lite/core/mir/pattern_matcher.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+// Ops kept whether or not their outputs are used: the inputs and outputs of
+// the program, and the ops running sub-blocks, which may write variables of
+// the parent block.
+const std::set<std::string> kRootOps = {
+    "feed",
+    "fetch",
+    "while",
+    "conditional_block",
+    "conditional_block_infer",
+};
+
+}  // namespace
+
+/*
+ * DeadCodeEliminationPass removes the ops of the main block whose outputs
+ * never reach a fetch op, e.g. auxiliary training heads or debug print ops,
+ * with the variables and the weights only they use. The weights removed from
+ * the graph are not saved by SaveModel, as the saved program only refers to
+ * the variables of the remaining ops.
+ */
+class DeadCodeEliminationPass : public mir::ProgramPass {
+ public:
+  void Apply(const std::unique_ptr<SSAGraph>& graph) override {
+    // The outputs of a sub-block are read by its op in the parent block.
+    if (graph->blockIdx() != kRootBlockIdx) return;
+
+    // Mark the producers of every input of a live op, from the roots.
+    std::set<Node*> live;
+    std::vector<Node*> worklist;
+    bool has_fetch = false;
+    for (auto& node : graph->mutable_nodes()) {
+      if (!node.IsStmt()) continue;
+      auto& stmt = node.AsStmt();
+      has_fetch |= stmt.op_type() == "fetch";
+      if (IsRoot(&node)) {
+        live.insert(&node);
+        worklist.push_back(&node);
+      }
+    }
+    if (!has_fetch) return;
+    while (!worklist.empty()) {
+      auto* stmt = worklist.back();
+      worklist.pop_back();
+      for (auto* in : stmt->inlinks) {
+        for (auto* producer : in->inlinks) {
+          if (live.insert(producer).second) worklist.push_back(producer);
+        }
+      }
+    }
+
+    std::set<const Node*> nodes2rm;
+    for (auto& node : graph->mutable_nodes()) {
+      if (node.IsStmt() && !live.count(&node)) nodes2rm.insert(&node);
+    }
+    if (nodes2rm.empty()) return;
+    int num_ops = nodes2rm.size();
+    // The variables only linked to the removed ops go with them.
+    for (auto& node : graph->mutable_nodes()) {
+      if (!node.IsArg()) continue;
+      if (node.inlinks.empty() && node.outlinks.empty()) continue;
+      bool dead = true;
+      for (auto* link : node.inlinks) dead &= nodes2rm.count(link) > 0;
+      for (auto* link : node.outlinks) dead &= nodes2rm.count(link) > 0;
+      if (dead) {
+        VLOG(4) << "Remove the dead variable " << node.arg()->name;
+        nodes2rm.insert(&node);
+      }
+    }
+    VLOG(3) << "dead_code_elimination_pass removes " << num_ops << " ops and "
+            << nodes2rm.size() - num_ops << " variables";
+    GraphSafeRemoveNodes(graph.get(), nodes2rm);
+  }
+
+ private:
+  bool IsRoot(Node* node) const {
+    if (kRootOps.count(node->AsStmt().op_type())) return true;
+    // The ops without outputs are only run for their side effects, and the
+    // ops writing weights update the state.
+    if (node->outlinks.empty()) return true;
+    for (auto* out : node->outlinks) {
+      if (out->arg()->is_weight || out->arg()->is_persist) return true;
+    }
+    return false;
+  }
+};
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_MIR_PASS(dead_code_elimination_pass,
+                  paddle::lite::mir::DeadCodeEliminationPass)
+    .BindTargets({TARGET(kAny)});
@@ -0,0 +1,163 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+#include <vector>
+#include "lite/core/mir/pass_registry.h"
+#include "lite/core/mir/pass_test_helper.h"
+#include "lite/core/mir/pattern_matcher.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+const std::vector<Place> kPlaces{{TARGET(kHost), PRECISION(kFloat)}};
+
+void ApplyPass(const std::unique_ptr<SSAGraph>& graph) {
+  auto* pass = PassManager::Global().LookUp("dead_code_elimination_pass");
+  ASSERT_TRUE(pass);
+  pass->Apply(graph);
+}
+
+void AddAdd(ProgramBuilderForTest* builder,
+            const std::string& x,
+            const std::string& y,
+            const std::string& out) {
+  builder->AddOp("elementwise_add", {{"X", {x}}, {"Y", {y}}}, {{"Out", {out}}})
+      ->SetAttr<int>("axis", -1);
+}
+
+void AddRelu(ProgramBuilderForTest* builder,
+             const std::string& x,
+             const std::string& out) {
+  builder->AddOp("relu", {{"X", {x}}}, {{"Out", {out}}});
+}
+
+}  // namespace
+
+TEST(DeadCodeEliminationPass, remove_unused_branch) {
+  // x -> relu -> a -> elementwise_add -> out -> fetch
+  //                             w2 ->
+  //   -> elementwise_add -> b -> elementwise_add -> c
+  //                 w1 ->                  w2 ->
+  ProgramBuilderForTest builder;
+  for (auto* name : {"x", "a", "b", "c", "out"}) builder.AddVar(name, {2, 3});
+  builder.AddVar("w1", {2, 3}, true);
+  builder.AddVar("w2", {2, 3}, true);
+  builder.AddFeed("x", 0);
+  AddRelu(&builder, "x", "a");
+  AddAdd(&builder, "a", "w2", "out");
+  AddAdd(&builder, "x", "w1", "b");
+  AddAdd(&builder, "b", "w2", "c");
+  builder.AddFetch("out", 0);
+  auto graph = builder.BuildGraph(kPlaces);
+
+  ApplyPass(graph);
+
+  auto adds = FindStmts(graph.get(), "elementwise_add");
+  ASSERT_EQ(adds.size(), 1u);
+  EXPECT_EQ(adds.front()->outlinks.front()->AsArg().name, "out");
+  EXPECT_EQ(FindStmts(graph.get(), "relu").size(), 1u);
+  for (auto* name : {"b", "c", "w1"}) {
+    EXPECT_FALSE(HasArg(graph.get(), name)) << name;
+  }
+  for (auto* name : {"x", "a", "w2", "out"}) {
+    EXPECT_TRUE(HasArg(graph.get(), name)) << name;
+  }
+}
+
+TEST(DeadCodeEliminationPass, keep_roots) {
+  // None of these ops reach the fetch, but the while and conditional_block
+  // ops may write the vars of the main block, the relu without outputs is
+  // run for its side effects and the scale updates a weight. The ops they
+  // read from are kept with them.
+  ProgramBuilderForTest builder;
+  for (auto* name : {"x", "a", "b", "c", "d", "while_out", "cond_out"}) {
+    builder.AddVar(name, {2, 3});
+  }
+  builder.AddVar("cond", {1});
+  builder.AddVar("w", {2, 3}, true);
+  builder.AddBlock();
+  builder.AddFeed("x", 0);
+  builder.AddFeed("cond", 1);
+  AddRelu(&builder, "x", "a");
+  auto* while_op = builder.AddOp("while",
+                                 {{"Condition", {"cond"}}, {"X", {"a"}}},
+                                 {{"Out", {"while_out"}}});
+  while_op->SetAttr<int32_t>("sub_block", 1);
+  AddRelu(&builder, "x", "b");
+  auto* cond_op = builder.AddOp("conditional_block",
+                                {{"Cond", {"cond"}}, {"Input", {"b"}}},
+                                {{"Out", {"cond_out"}}});
+  cond_op->SetAttr<bool>("is_scalar_condition", true);
+  cond_op->SetAttr<int32_t>("sub_block", 1);
+  AddRelu(&builder, "x", "c");
+  AddRelu(&builder, "c", "d");
+  auto* scale = builder.AddOp("scale", {{"X", {"x"}}}, {{"Out", {"w"}}});
+  scale->SetAttr<float>("scale", 1.f);
+  scale->SetAttr<float>("bias", 0.f);
+  scale->SetAttr<bool>("bias_after_scale", true);
+  builder.AddFetch("x", 0);
+  auto graph = builder.BuildGraph(kPlaces);
+  // Drop the output of the last relu, as if it were a print op.
+  for (auto& node : graph->mutable_nodes()) {
+    if (node.IsArg() && node.AsArg().name == "d") {
+      GraphSafeRemoveNodes(graph.get(), {&node});
+      break;
+    }
+  }
+  const auto num_nodes = graph->nodes().size();
+
+  ApplyPass(graph);
+
+  EXPECT_EQ(graph->nodes().size(), num_nodes);
+  EXPECT_EQ(FindStmts(graph.get(), "while").size(), 1u);
+  EXPECT_EQ(FindStmts(graph.get(), "conditional_block").size(), 1u);
+  EXPECT_EQ(FindStmts(graph.get(), "relu").size(), 4u);
+  EXPECT_EQ(FindStmts(graph.get(), "scale").size(), 1u);
+}
+
+TEST(DeadCodeEliminationPass, skip_without_fetch) {
+  // The outputs of a program without fetch ops are unknown, so the pass
+  // leaves it alone.
+  ProgramBuilderForTest builder;
+  for (auto* name : {"x", "a", "b"}) builder.AddVar(name, {2, 3});
+  builder.AddFeed("x", 0);
+  AddRelu(&builder, "x", "a");
+  AddRelu(&builder, "a", "b");
+  auto graph = builder.BuildGraph(kPlaces);
+  const auto num_nodes = graph->nodes().size();
+
+  ApplyPass(graph);
+
+  EXPECT_EQ(graph->nodes().size(), num_nodes);
+  EXPECT_EQ(FindStmts(graph.get(), "relu").size(), 2u);
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(feed)
+USE_LITE_OP(fetch)
+USE_LITE_OP(relu)
+USE_LITE_OP(scale)
+USE_LITE_OP(elementwise_add)
+USE_LITE_OP(while)
+USE_LITE_OP(conditional_block)
+USE_MIR_PASS(dead_code_elimination_pass)
@@ -0,0 +1,251 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/mir/fusion/elementwise_chain_fuse_pass.h"
+#include <algorithm>
+#include <utility>
+#include "lite/backends/host/math/fused_elementwise.h"
+#include "lite/core/mir/pass_registry.h"
+#include "lite/core/mir/pattern_matcher.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+using host::math::FusedElementwiseOpcode;
+
+const std::map<std::string, FusedElementwiseOpcode> kBinaryOps = {
+    {"elementwise_add", FusedElementwiseOpcode::kAdd},
+    {"elementwise_sub", FusedElementwiseOpcode::kSub},
+    {"elementwise_mul", FusedElementwiseOpcode::kMul},
+    {"elementwise_div", FusedElementwiseOpcode::kDiv},
+    {"elementwise_max", FusedElementwiseOpcode::kMax},
+    {"elementwise_min", FusedElementwiseOpcode::kMin},
+    {"elementwise_pow", FusedElementwiseOpcode::kPow},
+};
+
+// The unary ops and the float attributes they pass to the kernel, in order.
+const std::map<std::string,
+               std::pair<FusedElementwiseOpcode, std::vector<std::string>>>
+    kUnaryOps = {
+        {"relu", {FusedElementwiseOpcode::kRelu, {}}},
+        {"relu6", {FusedElementwiseOpcode::kRelu6, {"threshold"}}},
+        {"leaky_relu", {FusedElementwiseOpcode::kLeakyRelu, {"alpha"}}},
+        {"sigmoid", {FusedElementwiseOpcode::kSigmoid, {}}},
+        {"tanh", {FusedElementwiseOpcode::kTanh, {}}},
+        {"exp", {FusedElementwiseOpcode::kExp, {}}},
+        {"log", {FusedElementwiseOpcode::kLog, {}}},
+        {"abs", {FusedElementwiseOpcode::kAbs, {}}},
+        {"sqrt", {FusedElementwiseOpcode::kSqrt, {}}},
+        {"rsqrt", {FusedElementwiseOpcode::kRsqrt, {}}},
+        {"square", {FusedElementwiseOpcode::kSquare, {}}},
+        {"hard_sigmoid",
+         {FusedElementwiseOpcode::kHardSigmoid, {"slope", "offset"}}},
+        {"swish", {FusedElementwiseOpcode::kSwish, {"beta"}}},
+        {"hard_swish",
+         {FusedElementwiseOpcode::kHardSwish,
+          {"threshold", "scale", "offset"}}},
+        {"scale", {FusedElementwiseOpcode::kScale, {"scale", "bias"}}},
+        {"clip", {FusedElementwiseOpcode::kClip, {"min", "max"}}},
+};
+
+// The attributes of the already fused variants, which run more than the op.
+const std::vector<std::string> kFusedAttrs = {
+    "enable_int8", "fuse_scaleact", "fuse_scale"};
+
+Node* FindArg(const std::list<Node*>& links, const std::string& name) {
+  for (auto* link : links) {
+    if (link->arg()->name == name) return link;
+  }
+  return nullptr;
+}
+
+bool IsFloat(const Node* arg) {
+  auto* type = arg->arg()->type;
+  return type != nullptr && type->precision() == PRECISION(kFloat);
+}
+
+}  // namespace
+
+bool ElementwiseChainFusePass::IsFusible(Node* node) const {
+  if (!node->IsStmt()) return false;
+  auto* op_info = node->AsStmt().op_info();
+  const auto op_type = op_info->Type();
+  bool binary = kBinaryOps.count(op_type) > 0;
+  if (!binary && !kUnaryOps.count(op_type)) return false;
+  for (auto& attr : kFusedAttrs) {
+    if (op_info->HasAttr(attr) && op_info->GetAttr<bool>(attr)) return false;
+  }
+  if (op_info->HasAttr("activation_type") &&
+      !op_info->GetAttr<std::string>("activation_type").empty()) {
+    return false;
+  }
+  // e.g. the Min and Max inputs of clip or the ScaleTensor of scale.
+  for (auto& argname : op_info->input_argnames()) {
+    if (argname == "X" || (binary && argname == "Y")) {
+      if (op_info->Input(argname).size() != 1) return false;
+    } else if (!op_info->Input(argname).empty()) {
+      return false;
+    }
+  }
+  if (!op_info->HasInput("X") || (binary && !op_info->HasInput("Y"))) {
+    return false;
+  }
+  if (node->outlinks.size() != 1) return false;
+  for (auto* in : node->inlinks) {
+    if (!IsFloat(in)) return false;
+  }
+  return IsFloat(node->outlinks.front());
+}
+
+int ElementwiseChainFusePass::EmitInput(Node* stmt,
+                                        const std::string& argname,
+                                        Group* group) const {
+  const auto name = stmt->AsStmt().op_info()->Input(argname).front();
+  auto* arg = FindArg(stmt->inlinks, name);
+  CHECK(arg) << "missing input " << name;
+  if (!arg->inlinks.empty() && group->stmts.count(arg->inlinks.front())) {
+    return EmitStmt(arg->inlinks.front(), group);
+  }
+  auto it = std::find(group->inputs.begin(), group->inputs.end(), arg);
+  int index = it - group->inputs.begin();
+  if (it == group->inputs.end()) group->inputs.push_back(arg);
+  group->instructions.insert(
+      group->instructions.end(),
+      {static_cast<int>(FusedElementwiseOpcode::kLoad), index, -1, -1, -1});
+  return group->instructions.size() / host::math::kFusedElementwiseInstrSize -
+         1;
+}
+
+int ElementwiseChainFusePass::EmitStmt(Node* stmt, Group* group) const {
+  auto* op_info = stmt->AsStmt().op_info();
+  const auto op_type = op_info->Type();
+  std::vector<int> instr(host::math::kFusedElementwiseInstrSize, -1);
+  instr[1] = EmitInput(stmt, "X", group);
+  if (kBinaryOps.count(op_type)) {
+    instr[0] = static_cast<int>(kBinaryOps.at(op_type));
+    instr[2] = EmitInput(stmt, "Y", group);
+    instr[4] = op_info->GetAttr<int>("axis");
+  } else {
+    auto& unary = kUnaryOps.at(op_type);
+    instr[0] = static_cast<int>(unary.first);
+    if (!unary.second.empty() || op_type == "scale") {
+      instr[3] = group->params.size();
+    }
+    for (auto& attr : unary.second) {
+      group->params.push_back(op_info->GetAttr<float>(attr));
+    }
+    if (op_type == "scale") {
+      group->params.push_back(
+          op_info->GetAttr<bool>("bias_after_scale") ? 1.f : 0.f);
+    }
+  }
+  group->instructions.insert(
+      group->instructions.end(), instr.begin(), instr.end());
+  return group->instructions.size() / host::math::kFusedElementwiseInstrSize -
+         1;
+}
+
+void ElementwiseChainFusePass::Fuse(SSAGraph* graph,
+                                    Node* root,
+                                    Group* group) const {
+  EmitStmt(root, group);
+  auto* out = root->outlinks.front();
+
+  cpp::OpDesc op_desc;
+  op_desc.SetType("fused_elementwise");
+  std::vector<std::string> input_names;
+  for (auto* in : group->inputs) input_names.push_back(in->arg()->name);
+  op_desc.SetInput("X", input_names);
+  op_desc.SetOutput("Out", {out->arg()->name});
+  op_desc.SetAttr("instructions", group->instructions);
+  op_desc.SetAttr("params", group->params);
+
+  auto old_op = root->AsStmt().op();
+  auto op = LiteOpRegistry::Global().Create("fused_elementwise");
+  op->Attach(op_desc, old_op->scope());
+  auto* new_op_node =
+      graph->GraphCreateInstructNode(op, old_op->valid_places());
+
+  std::set<const Node*> nodes2rm;
+  for (auto* stmt : group->stmts) {
+    nodes2rm.insert(stmt);
+    if (stmt != root) nodes2rm.insert(stmt->outlinks.front());
+  }
+  GraphSafeRemoveNodes(graph, nodes2rm);
+  for (auto* in : group->inputs) {
+    IR_NODE_LINK_TO(in, new_op_node);
+  }
+  IR_NODE_LINK_TO(new_op_node, out);
+}
+
+void ElementwiseChainFusePass::Apply(const std::unique_ptr<SSAGraph>& graph) {
+  auto order = graph->StmtTopologicalOrder();
+  std::set<Node*> fusible;
+  for (auto* node : order) {
+    if (IsFusible(node)) fusible.insert(node);
+  }
+
+  // Grow a group backwards from its last op, absorbing a producer when the
+  // group is the only reader of its output, so that every group is a tree.
+  std::set<Node*> grouped;
+  int num_fused = 0;
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    auto* root = *it;
+    if (!fusible.count(root) || grouped.count(root)) continue;
+    Group group;
+    group.stmts.insert(root);
+    std::vector<Node*> queue = {root};
+    while (!queue.empty()) {
+      auto* stmt = queue.back();
+      queue.pop_back();
+      auto* op_info = stmt->AsStmt().op_info();
+      std::vector<std::string> names = op_info->Input("X");
+      if (op_info->HasInput("Y")) names.push_back(op_info->Input("Y").front());
+      // An op reading one var twice, e.g. x * x, keeps it as an input.
+      if (names.size() == 2 && names[0] == names[1]) continue;
+      for (auto& name : names) {
+        auto* arg = FindArg(stmt->inlinks, name);
+        if (arg == nullptr || arg->inlinks.empty()) continue;
+        auto* producer = arg->inlinks.front();
+        if (arg->outlinks.size() != 1 || !fusible.count(producer) ||
+            grouped.count(producer) || group.stmts.count(producer)) {
+          continue;
+        }
+        group.stmts.insert(producer);
+        queue.push_back(producer);
+      }
+    }
+    if (group.stmts.size() < 2) continue;
+    grouped.insert(group.stmts.begin(), group.stmts.end());
+    VLOG(4) << "Fuse " << group.stmts.size() << " ops into the one writing "
+            << root->outlinks.front()->arg()->name;
+    Fuse(graph.get(), root, &group);
+    num_fused++;
+  }
+  VLOG(3) << "lite_elementwise_chain_fuse_pass created " << num_fused
+          << " fused_elementwise ops";
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_MIR_PASS(lite_elementwise_chain_fuse_pass,
+                  paddle::lite::mir::ElementwiseChainFusePass)
+    .BindTargets({TARGET(kX86)})
+    .ExcludeTargets({TARGET(kXPU), TARGET(kOpenCL)})
+    .BindKernel("fused_elementwise");
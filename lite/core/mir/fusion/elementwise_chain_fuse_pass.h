@@ -0,0 +1,58 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "lite/core/mir/pass.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+/*
+ * ElementwiseChainFusePass replaces every tree of float elementwise,
+ * activation and scale ops whose intermediate results have a single consumer
+ * with one fused_elementwise op. The fused kernel interprets a small program
+ * over blocks of the output, so the intermediate tensors are never
+ * materialized and the inputs are read only once.
+ */
+class ElementwiseChainFusePass : public ProgramPass {
+ public:
+  void Apply(const std::unique_ptr<SSAGraph>& graph) override;
+
+ private:
+  // The state of the group being emitted.
+  struct Group {
+    std::set<Node*> stmts;
+    std::vector<int> instructions;
+    std::vector<float> params;
+    std::vector<Node*> inputs;
+  };
+
+  bool IsFusible(Node* node) const;
+  // Appends the instructions computing the output of `stmt` and returns the
+  // register holding it.
+  int EmitStmt(Node* stmt, Group* group) const;
+  int EmitInput(Node* stmt, const std::string& argname, Group* group) const;
+  void Fuse(SSAGraph* graph, Node* root, Group* group) const;
+};
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,230 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/mir/fusion/elementwise_chain_fuse_pass.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "lite/backends/host/math/fused_elementwise.h"
+#include "lite/core/mir/pass_registry.h"
+#include "lite/core/mir/pass_test_helper.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+using host::math::FusedElementwiseOpcode;
+
+const std::vector<Place> kPlaces{{TARGET(kX86), PRECISION(kFloat)},
+                                 {TARGET(kHost), PRECISION(kFloat)}};
+
+void ApplyPass(const std::unique_ptr<SSAGraph>& graph) {
+  auto* pass =
+      PassManager::Global().LookUp("lite_elementwise_chain_fuse_pass");
+  ASSERT_TRUE(pass);
+  pass->Apply(graph);
+}
+
+cpp::OpDesc* AddBinary(ProgramBuilderForTest* builder,
+                       const std::string& op_type,
+                       const std::string& x,
+                       const std::string& y,
+                       const std::string& out) {
+  auto* op_desc =
+      builder->AddOp(op_type, {{"X", {x}}, {"Y", {y}}}, {{"Out", {out}}});
+  op_desc->SetAttr<int>("axis", -1);
+  return op_desc;
+}
+
+void AddActivation(ProgramBuilderForTest* builder,
+                   const std::string& op_type,
+                   const std::string& x,
+                   const std::string& out) {
+  builder->AddOp(op_type, {{"X", {x}}}, {{"Out", {out}}});
+}
+
+// An instruction of the fused program, see FusedElementwiseOpcode.
+std::vector<int> Instr(FusedElementwiseOpcode opcode,
+                       int a,
+                       int b = -1,
+                       int param = -1,
+                       int axis = -1) {
+  return {static_cast<int>(opcode), a, b, param, axis};
+}
+
+std::vector<int> Instructions(const std::vector<std::vector<int>>& instrs) {
+  std::vector<int> program;
+  for (auto& instr : instrs) {
+    program.insert(program.end(), instr.begin(), instr.end());
+  }
+  return program;
+}
+
+}  // namespace
+
+TEST(ElementwiseChainFusePass, fuse_tree) {
+  // x -> elementwise_add -> a -> relu -> r -> elementwise_mul -> m -> scale
+  // y ->                     z -> sigmoid -> s ->
+  ProgramBuilderForTest builder;
+  for (auto* name : {"x", "y", "z", "a", "r", "s", "m", "out"}) {
+    builder.AddVar(name, {2, 8});
+  }
+  builder.AddFeed("x", 0);
+  builder.AddFeed("y", 1);
+  builder.AddFeed("z", 2);
+  AddBinary(&builder, "elementwise_add", "x", "y", "a");
+  AddActivation(&builder, "relu", "a", "r");
+  AddActivation(&builder, "sigmoid", "z", "s");
+  AddBinary(&builder, "elementwise_mul", "r", "s", "m");
+  auto* scale = builder.AddOp("scale", {{"X", {"m"}}}, {{"Out", {"out"}}});
+  scale->SetAttr<float>("scale", 2.f);
+  scale->SetAttr<float>("bias", 1.f);
+  scale->SetAttr<bool>("bias_after_scale", true);
+  builder.AddFetch("out", 0);
+  auto graph = builder.BuildGraph(kPlaces);
+
+  ApplyPass(graph);
+
+  auto fused = FindStmts(graph.get(), "fused_elementwise");
+  ASSERT_EQ(fused.size(), 1u);
+  for (auto* op_type :
+       {"elementwise_add", "relu", "sigmoid", "elementwise_mul", "scale"}) {
+    EXPECT_TRUE(FindStmts(graph.get(), op_type).empty()) << op_type;
+  }
+  for (auto* name : {"a", "r", "s", "m"}) {
+    EXPECT_FALSE(HasArg(graph.get(), name)) << name;
+  }
+  // The tree is emitted depth first from the last op, X before Y, and every
+  // input is loaded in the order it is first met.
+  auto* op_info = fused.front()->AsStmt().op_info();
+  EXPECT_EQ(op_info->Input("X"), std::vector<std::string>({"x", "y", "z"}));
+  EXPECT_EQ(op_info->Output("Out"), std::vector<std::string>({"out"}));
+  EXPECT_EQ(op_info->GetAttr<std::vector<int>>("instructions"),
+            Instructions({Instr(FusedElementwiseOpcode::kLoad, 0),
+                          Instr(FusedElementwiseOpcode::kLoad, 1),
+                          Instr(FusedElementwiseOpcode::kAdd, 0, 1),
+                          Instr(FusedElementwiseOpcode::kRelu, 2),
+                          Instr(FusedElementwiseOpcode::kLoad, 2),
+                          Instr(FusedElementwiseOpcode::kSigmoid, 4),
+                          Instr(FusedElementwiseOpcode::kMul, 3, 5),
+                          Instr(FusedElementwiseOpcode::kScale, 6, -1, 0)}));
+  EXPECT_EQ(op_info->GetAttr<std::vector<float>>("params"),
+            std::vector<float>({2.f, 1.f, 1.f}));
+}
+
+TEST(ElementwiseChainFusePass, stop_at_square) {
+  // x -> relu -> t -> elementwise_mul(t, t) -> m -> sigmoid -> out
+  // The square reads t twice, so t stays an input and its relu is kept.
+  ProgramBuilderForTest builder;
+  for (auto* name : {"x", "t", "m", "out"}) builder.AddVar(name, {2, 8});
+  builder.AddFeed("x", 0);
+  AddActivation(&builder, "relu", "x", "t");
+  AddBinary(&builder, "elementwise_mul", "t", "t", "m");
+  AddActivation(&builder, "sigmoid", "m", "out");
+  builder.AddFetch("out", 0);
+  auto graph = builder.BuildGraph(kPlaces);
+
+  ApplyPass(graph);
+
+  EXPECT_EQ(FindStmts(graph.get(), "relu").size(), 1u);
+  auto fused = FindStmts(graph.get(), "fused_elementwise");
+  ASSERT_EQ(fused.size(), 1u);
+  auto* op_info = fused.front()->AsStmt().op_info();
+  EXPECT_EQ(op_info->Input("X"), std::vector<std::string>({"t"}));
+  EXPECT_EQ(op_info->GetAttr<std::vector<int>>("instructions"),
+            Instructions({Instr(FusedElementwiseOpcode::kLoad, 0),
+                          Instr(FusedElementwiseOpcode::kLoad, 0),
+                          Instr(FusedElementwiseOpcode::kMul, 0, 1),
+                          Instr(FusedElementwiseOpcode::kSigmoid, 2)}));
+}
+
+TEST(ElementwiseChainFusePass, keep_shared_and_fetched_values) {
+  // x -> elementwise_add -> a -> relu -> r
+  // y ->                      -> sigmoid -> s
+  // x -> elementwise_sub -> b -> tanh -> t
+  // y ->
+  // a is read twice and b is fetched, so both stay materialized and no op
+  // is fused.
+  ProgramBuilderForTest builder;
+  for (auto* name : {"x", "y", "a", "r", "s", "b", "t"}) {
+    builder.AddVar(name, {2, 8});
+  }
+  builder.AddFeed("x", 0);
+  builder.AddFeed("y", 1);
+  AddBinary(&builder, "elementwise_add", "x", "y", "a");
+  AddActivation(&builder, "relu", "a", "r");
+  AddActivation(&builder, "sigmoid", "a", "s");
+  AddBinary(&builder, "elementwise_sub", "x", "y", "b");
+  AddActivation(&builder, "tanh", "b", "t");
+  builder.AddFetch("r", 0);
+  builder.AddFetch("s", 1);
+  builder.AddFetch("b", 2);
+  builder.AddFetch("t", 3);
+  auto graph = builder.BuildGraph(kPlaces);
+  const auto num_nodes = graph->nodes().size();
+
+  ApplyPass(graph);
+
+  EXPECT_TRUE(FindStmts(graph.get(), "fused_elementwise").empty());
+  EXPECT_EQ(graph->nodes().size(), num_nodes);
+}
+
+TEST(ElementwiseChainFusePass, skip_fused_variants) {
+  // The add already runs its activation and the mul its scale, which the
+  // fused program doesn't know about.
+  ProgramBuilderForTest builder;
+  for (auto* name : {"x", "y", "a", "r", "m", "s"}) {
+    builder.AddVar(name, {2, 8});
+  }
+  builder.AddFeed("x", 0);
+  builder.AddFeed("y", 1);
+  AddBinary(&builder, "elementwise_add", "x", "y", "a")
+      ->SetAttr<std::string>("activation_type", "relu");
+  AddActivation(&builder, "relu", "a", "r");
+  auto* mul = AddBinary(&builder, "elementwise_mul", "x", "y", "m");
+  mul->SetAttr<bool>("fuse_scale", true);
+  mul->SetAttr<float>("scale", 2.f);
+  mul->SetAttr<float>("alpha", 1.f);
+  mul->SetAttr<float>("bias", 0.f);
+  AddActivation(&builder, "sigmoid", "m", "s");
+  builder.AddFetch("r", 0);
+  builder.AddFetch("s", 1);
+  auto graph = builder.BuildGraph(kPlaces);
+
+  ApplyPass(graph);
+
+  EXPECT_TRUE(FindStmts(graph.get(), "fused_elementwise").empty());
+  EXPECT_EQ(FindStmts(graph.get(), "elementwise_add").size(), 1u);
+  EXPECT_EQ(FindStmts(graph.get(), "elementwise_mul").size(), 1u);
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(feed)
+USE_LITE_OP(fetch)
+USE_LITE_OP(elementwise_add)
+USE_LITE_OP(elementwise_sub)
+USE_LITE_OP(elementwise_mul)
+USE_LITE_OP(relu)
+USE_LITE_OP(sigmoid)
+USE_LITE_OP(tanh)
+USE_LITE_OP(scale)
+USE_LITE_OP(fused_elementwise)
+USE_LITE_KERNEL(fused_elementwise, kX86, kFloat, kNCHW, def);
+USE_MIR_PASS(lite_elementwise_chain_fuse_pass)
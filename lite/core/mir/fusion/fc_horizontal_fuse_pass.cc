@@ -0,0 +1,266 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/mir/fusion/fc_horizontal_fuse_pass.h"
+#include <cstring>
+#include <map>
+#include <set>
+#include "lite/core/mir/pass_registry.h"
+#include "lite/core/mir/pattern_matcher.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+Node* FindArg(const std::list<Node*>& links, const std::string& name) {
+  for (auto* link : links) {
+    if (link->arg()->name == name) return link;
+  }
+  return nullptr;
+}
+
+const Tensor* FindFloatWeight(Scope* scope, const Node* arg) {
+  if (arg == nullptr || !arg->arg()->is_weight) return nullptr;
+  auto* var = scope->FindVar(arg->arg()->name);
+  if (var == nullptr || !var->IsType<Tensor>()) return nullptr;
+  auto* tensor = &var->Get<Tensor>();
+  return tensor->precision() == PRECISION(kFloat) ? tensor : nullptr;
+}
+
+std::string UniqueVarName(Scope* scope, const std::string& prefix) {
+  auto name = prefix;
+  for (int i = 1; scope->FindVar(name) != nullptr; ++i) {
+    name = prefix + "_" + std::to_string(i);
+  }
+  return name;
+}
+
+}  // namespace
+
+bool FcHorizontalFusePass::Match(Node* x,
+                                 Node* stmt,
+                                 Sibling* sibling,
+                                 std::string* key) const {
+  if (!stmt->IsStmt() || stmt->outlinks.size() != 1) return false;
+  auto* op_info = stmt->AsStmt().op_info();
+  const auto op_type = op_info->Type();
+  std::string x_argname, w_argname, num_col_dims_attr;
+  if (op_type == "fc") {
+    x_argname = "Input";
+    w_argname = "W";
+    num_col_dims_attr = "in_num_col_dims";
+  } else if (op_type == "mul") {
+    x_argname = "X";
+    w_argname = "Y";
+    num_col_dims_attr = "x_num_col_dims";
+    if (op_info->GetAttr<int>("y_num_col_dims") != 1) return false;
+  } else {
+    return false;
+  }
+  if (op_info->Input(x_argname) != std::vector<std::string>{x->arg()->name}) {
+    return false;
+  }
+  for (auto attr : {"enable_int8", "padding_weights"}) {
+    if (op_info->HasAttr(attr) && op_info->GetAttr<bool>(attr)) return false;
+  }
+  std::string act_type;
+  if (op_info->HasAttr("activation_type")) {
+    act_type = op_info->GetAttr<std::string>("activation_type");
+  }
+  // The alpha of prelu is per output column.
+  if (act_type == "prelu") return false;
+
+  auto* scope = stmt->AsStmt().op()->scope();
+  sibling->stmt = stmt;
+  sibling->out = stmt->outlinks.front();
+  sibling->weight = FindArg(stmt->inlinks, op_info->Input(w_argname).front());
+  sibling->bias = nullptr;
+  auto* w = FindFloatWeight(scope, sibling->weight);
+  if (w == nullptr || w->dims().size() != 2) return false;
+  if (op_type == "fc" && op_info->HasInput("Bias") &&
+      !op_info->Input("Bias").empty()) {
+    sibling->bias = FindArg(stmt->inlinks, op_info->Input("Bias").front());
+    auto* bias = FindFloatWeight(scope, sibling->bias);
+    if (bias == nullptr || bias->numel() != w->dims()[1]) return false;
+  }
+  *key = op_type + "/" +
+         std::to_string(op_info->GetAttr<int>(num_col_dims_attr)) + "/" +
+         act_type + "/" + std::to_string(w->dims()[0]);
+  return true;
+}
+
+void FcHorizontalFusePass::Fuse(SSAGraph* graph,
+                                Node* x,
+                                const std::vector<Sibling>& group) const {
+  auto& first = group.front();
+  auto first_op = first.stmt->AsStmt().op();
+  auto* scope = first_op->scope();
+  auto op_desc = *first.stmt->AsStmt().op_info();
+  const bool is_fc = op_desc.Type() == "fc";
+
+  std::vector<const Tensor*> weights;
+  std::vector<int> sections;
+  int64_t n = 0;
+  bool has_bias = false;
+  for (auto& sibling : group) {
+    auto* var = scope->FindVar(sibling.weight->arg()->name);
+    weights.push_back(&var->Get<Tensor>());
+    sections.push_back(weights.back()->dims()[1]);
+    n += sections.back();
+    has_bias |= sibling.bias != nullptr;
+  }
+  const int64_t k = weights.front()->dims()[0];
+
+  // The weights side by side, [k, n].
+  auto w_name = UniqueVarName(scope, first.weight->arg()->name + "_hfused");
+  auto* w_t = scope->NewTensor(w_name);
+  w_t->Resize({k, n});
+  w_t->set_precision(PRECISION(kFloat));
+  w_t->set_persistable(true);
+  auto* w_data = w_t->mutable_data<float>();
+  int64_t col = 0;
+  for (size_t i = 0; i < group.size(); ++i) {
+    const auto* src = weights[i]->data<float>();
+    for (int64_t row = 0; row < k; ++row) {
+      std::memcpy(w_data + row * n + col,
+                  src + row * sections[i],
+                  sections[i] * sizeof(float));
+    }
+    col += sections[i];
+  }
+  auto* w_node = graph->NewArgumentNode(w_name);
+  w_node->arg()->is_weight = true;
+  w_node->arg()->type = first.weight->arg()->type;
+
+  Node* bias_node = nullptr;
+  if (has_bias) {
+    // The ops without bias add zeros.
+    auto bias_name = UniqueVarName(scope, w_name + "_bias");
+    auto* bias_t = scope->NewTensor(bias_name);
+    bias_t->Resize({n});
+    bias_t->set_precision(PRECISION(kFloat));
+    bias_t->set_persistable(true);
+    auto* bias_data = bias_t->mutable_data<float>();
+    std::memset(bias_data, 0, n * sizeof(float));
+    for (size_t i = 0; i < group.size(); ++i) {
+      if (group[i].bias != nullptr) {
+        auto* var = scope->FindVar(group[i].bias->arg()->name);
+        std::memcpy(bias_data,
+                    var->Get<Tensor>().data<float>(),
+                    sections[i] * sizeof(float));
+      }
+      bias_data += sections[i];
+    }
+    bias_node = graph->NewArgumentNode(bias_name);
+    bias_node->arg()->is_weight = true;
+    bias_node->arg()->type = w_node->arg()->type;
+  }
+
+  auto out_name = UniqueVarName(scope, first.out->arg()->name + "_hfused");
+  scope->NewTensor(out_name);
+  auto* out_node = graph->NewArgumentNode(out_name);
+  out_node->arg()->type = first.out->arg()->type;
+
+  op_desc.mutable_inputs()->clear();
+  op_desc.mutable_outputs()->clear();
+  op_desc.SetInput(is_fc ? "Input" : "X", {x->arg()->name});
+  op_desc.SetInput(is_fc ? "W" : "Y", {w_name});
+  if (has_bias) {
+    op_desc.SetInput("Bias", {bias_node->arg()->name});
+  }
+  op_desc.SetOutput("Out", {out_name});
+  auto fused_op = LiteOpRegistry::Global().Create(op_desc.Type());
+  fused_op->Attach(op_desc, scope);
+  auto* fused_node =
+      graph->GraphCreateInstructNode(fused_op, first_op->valid_places());
+
+  std::vector<std::string> out_names;
+  for (auto& sibling : group) out_names.push_back(sibling.out->arg()->name);
+  cpp::OpDesc split_desc;
+  split_desc.SetType("split");
+  split_desc.SetInput("X", {out_name});
+  split_desc.SetOutput("Out", out_names);
+  split_desc.SetAttr(
+      "axis",
+      op_desc.GetAttr<int>(is_fc ? "in_num_col_dims" : "x_num_col_dims"));
+  split_desc.SetAttr("num", 0);
+  split_desc.SetAttr("sections", sections);
+  split_desc.SetAttr("inplace", true);
+  auto split_op = LiteOpRegistry::Global().Create("split");
+  split_op->Attach(split_desc, scope);
+  auto* split_node =
+      graph->GraphCreateInstructNode(split_op, first_op->valid_places());
+
+  // The weights are removed unless read by other ops.
+  std::set<const Node*> nodes2rm;
+  for (auto& sibling : group) nodes2rm.insert(sibling.stmt);
+  for (auto& sibling : group) {
+    for (auto* arg : {sibling.weight, sibling.bias}) {
+      if (arg == nullptr) continue;
+      bool unused = true;
+      for (auto* reader : arg->outlinks) unused &= nodes2rm.count(reader) > 0;
+      if (unused) nodes2rm.insert(arg);
+    }
+  }
+  GraphSafeRemoveNodes(graph, nodes2rm);
+
+  IR_NODE_LINK_TO(x, fused_node);
+  IR_NODE_LINK_TO(w_node, fused_node);
+  if (bias_node != nullptr) {
+    IR_NODE_LINK_TO(bias_node, fused_node);
+  }
+  IR_NODE_LINK_TO(fused_node, out_node);
+  IR_NODE_LINK_TO(out_node, split_node);
+  for (auto& sibling : group) {
+    IR_NODE_LINK_TO(split_node, sibling.out);
+  }
+}
+
+void FcHorizontalFusePass::Apply(const std::unique_ptr<SSAGraph>& graph) {
+  std::vector<Node*> inputs;
+  for (auto& node : graph->mutable_nodes()) {
+    if (node.IsArg() && !node.arg()->is_weight && node.outlinks.size() > 1) {
+      inputs.push_back(&node);
+    }
+  }
+  int num_fused = 0;
+  for (auto* x : inputs) {
+    // The groups are collected before any fusion changes the readers of x.
+    std::map<std::string, std::vector<Sibling>> groups;
+    for (auto* stmt : x->outlinks) {
+      Sibling sibling;
+      std::string key;
+      if (Match(x, stmt, &sibling, &key)) groups[key].push_back(sibling);
+    }
+    for (auto& group : groups) {
+      if (group.second.size() < 2) continue;
+      VLOG(4) << "Fuse " << group.second.size() << " " << group.first
+              << " ops reading " << x->arg()->name;
+      Fuse(graph.get(), x, group.second);
+      num_fused++;
+    }
+  }
+  VLOG(3) << "lite_fc_horizontal_fuse_pass fused " << num_fused << " groups";
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_MIR_PASS(lite_fc_horizontal_fuse_pass,
+                  paddle::lite::mir::FcHorizontalFusePass)
+    .BindTargets({TARGET(kX86), TARGET(kARM)})
+    .BindKernel("split", paddle::lite::Place{TARGET(kHost), PRECISION(kFloat)});
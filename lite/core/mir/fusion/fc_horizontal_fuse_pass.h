@@ -0,0 +1,61 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "lite/core/mir/pass.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+/*
+ * FcHorizontalFusePass merges the fc or mul ops which read the same input
+ * with float weights of the same height, e.g. the Q/K/V projections of a
+ * transformer, into one op whose weights (and biases) are the columns of all
+ * of them. Its output is split back into the original outputs by an inplace
+ * split, which shares the buffer of the fused output instead of copying when
+ * the input is a single row.
+ *
+ *   x -> fc(W0, b0) -> out0           x -> fc([W0 W1], [b0 b1]) -> split
+ *   x -> fc(W1, b1) -> out1    ==>         -> out0, out1
+ *
+ * The matmul ops with 2-D weights are turned into mul by
+ * lite_matmul_fuse_pass and covered as well.
+ */
+class FcHorizontalFusePass : public ProgramPass {
+ public:
+  void Apply(const std::unique_ptr<SSAGraph>& graph) override;
+
+ private:
+  // The op of a group, with its weight, bias (or nullptr) and output.
+  struct Sibling {
+    Node* stmt;
+    Node* weight;
+    Node* bias;
+    Node* out;
+  };
+
+  // Returns false if `stmt` can't be merged with others reading `x`, or else
+  // fills `sibling` and the `key` the ops of a group must share.
+  bool Match(Node* x, Node* stmt, Sibling* sibling, std::string* key) const;
+  void Fuse(SSAGraph* graph, Node* x, const std::vector<Sibling>& group) const;
+};
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,249 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/mir/fusion/fc_horizontal_fuse_pass.h"
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "lite/api/cxx_api.h"
+#include "lite/api/paddle_use_passes.h"
+#include "lite/core/mir/pass_registry.h"
+#include "lite/core/mir/pass_test_helper.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+// The split writing the outputs of a fused fc only has a host kernel.
+const std::vector<Place> kPlaces{{TARGET(kX86), PRECISION(kFloat)},
+                                 {TARGET(kHost), PRECISION(kFloat)}};
+
+// An fc reading x, its weight is "<out>_w" and its bias, if any, "<out>_b".
+struct FcSpec {
+  std::string out;
+  int64_t n;
+  bool with_bias;
+  std::string act_type;
+  int num_col_dims;
+};
+
+void ApplyPass(const std::unique_ptr<SSAGraph>& graph) {
+  auto* pass = PassManager::Global().LookUp("lite_fc_horizontal_fuse_pass");
+  ASSERT_TRUE(pass);
+  pass->Apply(graph);
+}
+
+// A weight of distinct values, so that a misplaced column is caught.
+void AddWeight(ProgramBuilderForTest* builder,
+               const std::string& name,
+               const std::vector<int64_t>& shape,
+               float offset) {
+  builder->AddVar(name, shape, true);
+  auto* tensor = builder->scope()->FindVar(name)->GetMutable<Tensor>();
+  auto* data = tensor->mutable_data<float>();
+  for (int64_t i = 0; i < tensor->numel(); i++) {
+    data[i] = offset + 0.1f * i;
+  }
+}
+
+void AddFc(ProgramBuilderForTest* builder,
+           const std::vector<int64_t>& x_shape,
+           const FcSpec& spec,
+           float offset) {
+  int64_t k = 1;
+  for (size_t i = spec.num_col_dims; i < x_shape.size(); ++i) {
+    k *= x_shape[i];
+  }
+  std::map<std::string, std::vector<std::string>> inputs{
+      {"Input", {"x"}}, {"W", {spec.out + "_w"}}};
+  AddWeight(builder, spec.out + "_w", {k, spec.n}, offset);
+  if (spec.with_bias) {
+    AddWeight(builder, spec.out + "_b", {spec.n}, -offset);
+    inputs["Bias"] = {spec.out + "_b"};
+  }
+  std::vector<int64_t> out_shape(x_shape.begin(),
+                                 x_shape.begin() + spec.num_col_dims);
+  out_shape.push_back(spec.n);
+  builder->AddVar(spec.out, out_shape);
+  auto* op_desc = builder->AddOp("fc", inputs, {{"Out", {spec.out}}});
+  op_desc->SetAttr<int>("in_num_col_dims", spec.num_col_dims);
+  op_desc->SetAttr<std::string>("activation_type", spec.act_type);
+}
+
+// A program feeding x to the fcs and fetching their outputs. Only the fc at
+// `only` is added if it's not negative, with the same weights.
+void BuildProgram(ProgramBuilderForTest* builder,
+                  const std::vector<int64_t>& x_shape,
+                  const std::vector<FcSpec>& specs,
+                  int only = -1) {
+  builder->AddVar("x", x_shape);
+  builder->AddFeed("x", 0);
+  int col = 0;
+  for (int i = 0; i < static_cast<int>(specs.size()); ++i) {
+    if (only >= 0 && i != only) continue;
+    AddFc(builder, x_shape, specs[i], 0.5f * (i + 1));
+    builder->AddFetch(specs[i].out, col++);
+  }
+}
+
+// Run the program built by BuildProgram with the whole optimizer, and return
+// its outputs and the number of ops of every type it ran.
+std::vector<std::vector<float>> RunProgram(
+    const std::vector<int64_t>& x_shape,
+    const std::vector<FcSpec>& specs,
+    int only,
+    std::map<std::string, int>* num_ops) {
+  ProgramBuilderForTest builder;
+  BuildProgram(&builder, x_shape, specs, only);
+  Predictor predictor(builder.root_scope());
+  predictor.Build(builder.program_desc(), kPlaces);
+  auto* x = predictor.GetInput(0);
+  x->Resize(x_shape);
+  auto* x_data = x->mutable_data<float>();
+  for (int64_t i = 0; i < x->numel(); i++) {
+    x_data[i] = (i % 7) * 0.3f - 1.f;
+  }
+
+  predictor.Run();
+
+  for (auto& inst : predictor.runtime_program().instructions(kRootBlockIdx)) {
+    (*num_ops)[inst.op()->op_info()->Type()]++;
+  }
+  std::vector<std::vector<float>> outputs;
+  for (auto* out : predictor.GetOutputs()) {
+    outputs.emplace_back(out->data<float>(),
+                         out->data<float>() + out->numel());
+  }
+  return outputs;
+}
+
+const Tensor& GetTensor(ProgramBuilderForTest* builder,
+                        const std::string& name) {
+  auto* var = builder->exec_scope()->FindVar(name);
+  CHECK(var) << name;
+  return var->Get<Tensor>();
+}
+
+}  // namespace
+
+TEST(FcHorizontalFusePass, concat_weights_by_column) {
+  // x -> fc -> out0
+  //   -> fc -> out1
+  // The weights [4, 3] and [4, 5] are put side by side and the fc without
+  // bias adds zeros.
+  const std::vector<FcSpec> specs{{"out0", 3, true, "", 1},
+                                  {"out1", 5, false, "", 1}};
+  ProgramBuilderForTest builder;
+  BuildProgram(&builder, {2, 4}, specs);
+  auto graph = builder.BuildGraph(kPlaces);
+
+  ApplyPass(graph);
+
+  auto fcs = FindStmts(graph.get(), "fc");
+  ASSERT_EQ(fcs.size(), 1u);
+  auto* op_info = fcs.front()->AsStmt().op_info();
+  ASSERT_EQ(op_info->Input("W"), std::vector<std::string>({"out0_w_hfused"}));
+  ASSERT_EQ(op_info->Input("Bias"),
+            std::vector<std::string>({"out0_w_hfused_bias"}));
+  for (auto* name : {"out0_w", "out1_w", "out0_b"}) {
+    EXPECT_FALSE(HasArg(graph.get(), name)) << name;
+  }
+
+  auto& w = GetTensor(&builder, "out0_w_hfused");
+  auto& w0 = GetTensor(&builder, "out0_w");
+  auto& w1 = GetTensor(&builder, "out1_w");
+  ASSERT_EQ(w.dims(), DDim(std::vector<int64_t>({4, 8})));
+  for (int row = 0; row < 4; ++row) {
+    for (int col = 0; col < 8; ++col) {
+      float expected = col < 3 ? w0.data<float>()[row * 3 + col]
+                               : w1.data<float>()[row * 5 + col - 3];
+      EXPECT_EQ(w.data<float>()[row * 8 + col], expected) << row << "," << col;
+    }
+  }
+  auto& bias = GetTensor(&builder, "out0_w_hfused_bias");
+  auto& b0 = GetTensor(&builder, "out0_b");
+  ASSERT_EQ(bias.numel(), 8);
+  for (int col = 0; col < 8; ++col) {
+    float expected = col < 3 ? b0.data<float>()[col] : 0.f;
+    EXPECT_EQ(bias.data<float>()[col], expected) << col;
+  }
+
+  auto splits = FindStmts(graph.get(), "split");
+  ASSERT_EQ(splits.size(), 1u);
+  auto* split_info = splits.front()->AsStmt().op_info();
+  EXPECT_EQ(split_info->GetAttr<std::vector<int>>("sections"),
+            std::vector<int>({3, 5}));
+  EXPECT_EQ(split_info->Output("Out"),
+            std::vector<std::string>({"out0", "out1"}));
+}
+
+TEST(FcHorizontalFusePass, same_output_as_unfused) {
+  // Two groups are fused, the fcs without and with relu, and every output
+  // matches the one of its fc run alone.
+  const std::vector<int64_t> x_shape{2, 3, 4};
+  const std::vector<FcSpec> specs{{"out0", 3, true, "", 2},
+                                  {"out1", 5, false, "", 2},
+                                  {"out2", 2, true, "relu", 2},
+                                  {"out3", 6, true, "relu", 2}};
+  std::map<std::string, int> num_ops;
+  auto fused = RunProgram(x_shape, specs, -1, &num_ops);
+  EXPECT_EQ(num_ops["fc"], 2);
+  EXPECT_EQ(num_ops["split"], 2);
+  ASSERT_EQ(fused.size(), specs.size());
+
+  for (int i = 0; i < static_cast<int>(specs.size()); ++i) {
+    std::map<std::string, int> unfused_num_ops;
+    auto unfused = RunProgram(x_shape, specs, i, &unfused_num_ops);
+    ASSERT_EQ(unfused.size(), 1u);
+    ASSERT_EQ(fused[i].size(), unfused.front().size()) << specs[i].out;
+    for (size_t j = 0; j < fused[i].size(); ++j) {
+      EXPECT_NEAR(fused[i][j], unfused.front()[j], 1e-5) << specs[i].out;
+    }
+  }
+}
+
+TEST(FcHorizontalFusePass, skip_different_attrs) {
+  // All the weights are [4, 3], but the fcs differ in activation or in
+  // in_num_col_dims, so none of them are fused.
+  const std::vector<FcSpec> specs{{"out0", 3, true, "", 2},
+                                  {"out1", 3, true, "relu", 2},
+                                  {"out2", 3, true, "", 1}};
+  ProgramBuilderForTest builder;
+  BuildProgram(&builder, {2, 1, 4}, specs);
+  auto graph = builder.BuildGraph(kPlaces);
+  const auto num_nodes = graph->nodes().size();
+
+  ApplyPass(graph);
+
+  EXPECT_EQ(graph->nodes().size(), num_nodes);
+  EXPECT_EQ(FindStmts(graph.get(), "fc").size(), 3u);
+  EXPECT_TRUE(FindStmts(graph.get(), "split").empty());
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(feed)
+USE_LITE_OP(fetch)
+USE_LITE_OP(fc)
+USE_LITE_OP(split)
+USE_LITE_KERNEL(feed, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(fetch, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(fc, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(split, kHost, kFloat, kNCHW, def);
@@ -0,0 +1,350 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/mir/layout_assignment_pass.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <set>
+#include <utility>
+#include "lite/core/mir/pass_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+// The bytes a layout cast is assumed to move per microsecond, which converts
+// the cast bytes to the unit of KernelBase::EstimateCost.
+const float kCastBytesPerMicrosecond = 2000.f;
+const int kMaxSweeps = 4;
+const double kInfinity = 1e18;
+
+// Dinic's max-flow, only used to find the min-cut of an expansion move.
+class MinCut {
+ public:
+  explicit MinCut(int num_nodes) : graph_(num_nodes), level_(num_nodes) {}
+
+  void AddEdge(int from, int to, double capacity) {
+    if (capacity <= 0) return;
+    graph_[from].push_back(static_cast<int>(edges_.size()));
+    edges_.push_back({to, capacity});
+    graph_[to].push_back(static_cast<int>(edges_.size()));
+    edges_.push_back({from, 0});
+  }
+
+  // Returns whether every node is on the source side of the min-cut.
+  std::vector<bool> Solve(int source, int sink) {
+    while (BuildLevels(source, sink)) {
+      iter_.assign(graph_.size(), 0);
+      while (Augment(source, sink, kInfinity) > 0) {
+      }
+    }
+    std::vector<bool> source_side(graph_.size());
+    for (size_t i = 0; i < graph_.size(); ++i) source_side[i] = level_[i] >= 0;
+    return source_side;
+  }
+
+ private:
+  struct FlowEdge {
+    int to;
+    double capacity;
+  };
+
+  bool BuildLevels(int source, int sink) {
+    level_.assign(graph_.size(), -1);
+    std::queue<int> queue;
+    level_[source] = 0;
+    queue.push(source);
+    while (!queue.empty()) {
+      int node = queue.front();
+      queue.pop();
+      for (int e : graph_[node]) {
+        if (edges_[e].capacity > 0 && level_[edges_[e].to] < 0) {
+          level_[edges_[e].to] = level_[node] + 1;
+          queue.push(edges_[e].to);
+        }
+      }
+    }
+    return level_[sink] >= 0;
+  }
+
+  double Augment(int node, int sink, double flow) {
+    if (node == sink) return flow;
+    for (auto& i = iter_[node]; i < graph_[node].size(); ++i) {
+      int e = graph_[node][i];
+      auto& edge = edges_[e];
+      if (edge.capacity <= 0 || level_[edge.to] != level_[node] + 1) continue;
+      double pushed = Augment(edge.to, sink, (std::min)(flow, edge.capacity));
+      if (pushed > 0) {
+        edge.capacity -= pushed;
+        edges_[e ^ 1].capacity += pushed;
+        return pushed;
+      }
+    }
+    return 0;
+  }
+
+  std::vector<std::vector<int>> graph_;
+  std::vector<FlowEdge> edges_;
+  std::vector<int> level_;
+  std::vector<size_t> iter_;
+};
+
+DataLayoutType DeclLayout(const KernelBase& kernel,
+                          const std::string& arg_name,
+                          bool is_input) {
+  auto& registry = ParamTypeRegistry::Global();
+  const auto* type =
+      is_input ? registry.RetrieveInArgument(
+                     kernel.place(), kernel.GenParamTypeKey(), arg_name)
+               : registry.RetrieveOutArgument(
+                     kernel.place(), kernel.GenParamTypeKey(), arg_name);
+  return type ? type->type->layout() : DATALAYOUT(kAny);
+}
+
+// The kernel the kernel pick would most likely prefer for the statement, i.e.
+// the first kernel matching the earliest valid place.
+const KernelBase* PreferredKernel(Node::Stmt* stmt,
+                                  const std::vector<Place>& valid_places) {
+  for (auto& place : valid_places) {
+    for (auto& kernel : stmt->kernels()) {
+      if (kernel->target() == place.target &&
+          (kernel->precision() == place.precision ||
+           kernel->precision() == PRECISION(kAny)) &&
+          (kernel->layout() == place.layout ||
+           kernel->layout() == DATALAYOUT(kAny))) {
+        return kernel.get();
+      }
+    }
+  }
+  return stmt->kernels().front().get();
+}
+
+}  // namespace
+
+void LayoutAssignmentPass::Apply(const std::unique_ptr<SSAGraph>& graph) {
+  stmts_.clear();
+  allowed_.clear();
+  preferred_.clear();
+  preferred_kernels_.clear();
+  switch_costs_.clear();
+  edges_.clear();
+
+  std::map<Node*, int> index;
+  std::set<DataLayoutType> concrete_layouts;
+  std::vector<DataLayoutType> all_layouts;
+  for (auto* node : graph->StmtTopologicalOrder()) {
+    auto& stmt = node->AsStmt();
+    if (stmt.kernels().empty()) continue;
+    index[node] = static_cast<int>(stmts_.size());
+    stmts_.push_back(node);
+    const auto* preferred = PreferredKernel(&stmt, graph->valid_places());
+    preferred_kernels_.push_back(preferred);
+    preferred_.push_back(preferred->layout());
+    std::vector<DataLayoutType> allowed;
+    for (auto& kernel : stmt.kernels()) {
+      if (!IsCandidate(index[node], *kernel)) continue;
+      auto layout = kernel->layout();
+      if (std::find(allowed.begin(), allowed.end(), layout) == allowed.end()) {
+        allowed.push_back(layout);
+      }
+      if (std::find(all_layouts.begin(), all_layouts.end(), layout) ==
+          all_layouts.end()) {
+        all_layouts.push_back(layout);
+      }
+      if (layout != DATALAYOUT(kAny)) concrete_layouts.insert(layout);
+    }
+    allowed_.push_back(allowed);
+  }
+  // Nothing to choose if all kernels share a layout.
+  if (concrete_layouts.size() < 2) return;
+
+  // Leaving the preferred layout costs at least the cast of one element.
+  switch_costs_.assign(stmts_.size(), sizeof(float) / kCastBytesPerMicrosecond);
+
+  for (auto* consumer : stmts_) {
+    auto* op_info = consumer->AsStmt().op_info();
+    for (auto* in : consumer->inlinks) {
+      // The weights are cast only once.
+      if (in->AsArg().is_weight || in->inlinks.empty()) continue;
+      auto* producer = in->inlinks.front();
+      if (!index.count(producer)) continue;
+      const auto& name = in->AsArg().name;
+      Edge edge;
+      edge.producer = index[producer];
+      edge.consumer = index[consumer];
+      CHECK(producer->AsStmt().op_info()->GetOutputArgname(
+          name, &edge.producer_arg));
+      CHECK(op_info->GetInputArgname(name, &edge.consumer_arg));
+      float bytes = sizeof(float);
+      auto* var = consumer->AsStmt().op()->scope()->FindVar(name);
+      if (var != nullptr && var->IsType<Tensor>()) {
+        // The unknown dimensions, e.g. batch size, are taken as 1.
+        for (auto dim : var->Get<Tensor>().dims().Vectorize()) {
+          bytes *= (std::max)(std::abs(dim), static_cast<int64_t>(1));
+        }
+      }
+      edge.cast_cost = bytes / kCastBytesPerMicrosecond;
+      edges_.push_back(edge);
+      for (int stmt : {edge.producer, edge.consumer}) {
+        switch_costs_[stmt] = (std::max)(switch_costs_[stmt], edge.cast_cost);
+      }
+    }
+  }
+
+  auto labels = preferred_;
+  float energy = Energy(labels);
+  bool improved = true;
+  for (int sweep = 0; improved && sweep < kMaxSweeps; ++sweep) {
+    improved = false;
+    for (auto alpha : all_layouts) {
+      improved |= Expand(alpha, &labels);
+    }
+  }
+  VLOG(3) << "layout_assignment_pass reduces the energy from " << energy
+          << " to " << Energy(labels);
+
+  for (size_t i = 0; i < stmts_.size(); ++i) {
+    if (labels[i] == preferred_[i]) continue;
+    auto& kernels = stmts_[i]->AsStmt().kernels();
+    std::vector<std::unique_ptr<KernelBase>> kept;
+    for (auto& kernel : kernels) {
+      if (kernel->layout() == labels[i] && IsCandidate(i, *kernel)) {
+        kept.emplace_back(std::move(kernel));
+      }
+    }
+    CHECK(!kept.empty());
+    VLOG(4) << "Assign " << DataLayoutToStr(labels[i]) << " to "
+            << stmts_[i]->AsStmt().op_type();
+    kernels = std::move(kept);
+  }
+}
+
+bool LayoutAssignmentPass::IsCandidate(int stmt,
+                                       const KernelBase& kernel) const {
+  const auto* preferred = preferred_kernels_[stmt];
+  return kernel.target() == preferred->target() &&
+         kernel.precision() == preferred->precision();
+}
+
+KernelBase* LayoutAssignmentPass::KernelOf(int stmt,
+                                           DataLayoutType layout) const {
+  for (auto& kernel : stmts_[stmt]->AsStmt().kernels()) {
+    if (kernel->layout() == layout && IsCandidate(stmt, *kernel)) {
+      return kernel.get();
+    }
+  }
+  return nullptr;
+}
+
+float LayoutAssignmentPass::UnaryCost(int stmt, DataLayoutType layout) const {
+  auto* kernel = KernelOf(stmt, layout);
+  if (kernel == nullptr) return std::numeric_limits<float>::infinity();
+  float cost = (std::max)(kernel->EstimateCost(), 0.f);
+  if (layout != preferred_[stmt]) cost += switch_costs_[stmt];
+  return cost;
+}
+
+float LayoutAssignmentPass::PairwiseCost(const Edge& edge,
+                                         DataLayoutType producer_layout,
+                                         DataLayoutType consumer_layout) const {
+  auto from = DeclLayout(
+      *KernelOf(edge.producer, producer_layout), edge.producer_arg, false);
+  auto to = DeclLayout(
+      *KernelOf(edge.consumer, consumer_layout), edge.consumer_arg, true);
+  if (from == DATALAYOUT(kAny) || to == DATALAYOUT(kAny) || from == to) {
+    return 0.f;
+  }
+  return edge.cast_cost;
+}
+
+float LayoutAssignmentPass::Energy(
+    const std::vector<DataLayoutType>& labels) const {
+  float energy = 0.f;
+  for (size_t i = 0; i < stmts_.size(); ++i) {
+    energy += UnaryCost(i, labels[i]);
+  }
+  for (auto& edge : edges_) {
+    energy +=
+        PairwiseCost(edge, labels[edge.producer], labels[edge.consumer]);
+  }
+  return energy;
+}
+
+bool LayoutAssignmentPass::Expand(DataLayoutType alpha,
+                                  std::vector<DataLayoutType>* labels) {
+  // x[i] = 0 keeps the label of the i-th op, x[i] = 1 switches it to alpha.
+  // The source side of the cut is x = 0, the sink side x = 1.
+  const int num = static_cast<int>(stmts_.size());
+  const int source = num;
+  const int sink = num + 1;
+  std::vector<bool> switchable(num);
+  std::vector<double> cost0(num, 0.), cost1(num, 0.);
+  for (int i = 0; i < num; ++i) {
+    const auto& allowed = allowed_[i];
+    switchable[i] = (*labels)[i] != alpha &&
+                    std::find(allowed.begin(), allowed.end(), alpha) !=
+                        allowed.end();
+    cost0[i] = UnaryCost(i, (*labels)[i]);
+    cost1[i] = switchable[i] ? UnaryCost(i, alpha) : kInfinity;
+  }
+
+  MinCut cut(num + 2);
+  for (auto& edge : edges_) {
+    int u = edge.producer;
+    int v = edge.consumer;
+    auto lu = (*labels)[u];
+    auto lv = (*labels)[v];
+    auto au = switchable[u] ? alpha : lu;
+    auto av = switchable[v] ? alpha : lv;
+    double a = PairwiseCost(edge, lu, lv);
+    double b = PairwiseCost(edge, lu, av);
+    double c = PairwiseCost(edge, au, lv);
+    double d = PairwiseCost(edge, au, av);
+    // E(xu, xv) = a + (c - a) xu + (d - c) xv + (b + c - a - d) (1 - xu) xv,
+    // the last term is truncated if negative, the move is verified below.
+    cost1[u] += c - a;
+    cost1[v] += d - c;
+    cut.AddEdge(u, v, b + c - a - d);
+  }
+  for (int i = 0; i < num; ++i) {
+    if (cost1[i] > cost0[i]) {
+      cut.AddEdge(source, i, cost1[i] - cost0[i]);
+    } else {
+      cut.AddEdge(i, sink, cost0[i] - cost1[i]);
+    }
+  }
+
+  auto source_side = cut.Solve(source, sink);
+  auto expanded = *labels;
+  for (int i = 0; i < num; ++i) {
+    if (switchable[i] && !source_side[i]) expanded[i] = alpha;
+  }
+  if (Energy(expanded) + 1e-6f < Energy(*labels)) {
+    *labels = std::move(expanded);
+    return true;
+  }
+  return false;
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_MIR_PASS(layout_assignment_pass,
+                  paddle::lite::mir::LayoutAssignmentPass)
+    .BindTargets({TARGET(kAny)});
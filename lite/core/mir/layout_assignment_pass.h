@@ -0,0 +1,88 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lite/core/mir/pass.h"
+#include "lite/core/types.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+/*
+ * LayoutAssignmentPass chooses a data layout for every op before
+ * StaticKernelPickPass, so that the layout casts inserted later by
+ * TypeLayoutTransformPass are minimized over the whole graph instead of being
+ * decided by each kernel pick alone.
+ *
+ * The energy of an assignment is the sum of
+ *   - the estimated cost of the kernel each op would run with its layout,
+ *   - for every op leaving the layout StaticKernelPickPass would prefer, the
+ *     cost of casting its largest activation, as the preferred kernel is
+ *     assumed to be faster even though most kernels don't estimate their
+ *     cost; an op thus only switches if that saves more than one cast,
+ *   - the estimated cost of casting every activation whose producer and
+ *     consumer declare different layouts for it, proportional to its bytes.
+ * It is minimized with alpha-expansion: for every layout in turn, a min-cut
+ * decides which ops switch to it, and the move is kept if it lowers the
+ * energy. Only the kernels with the target and precision of the preferred
+ * kernel are considered, so the pass never moves an op to another device.
+ * The ops which end up with a layout other than their preferred one keep only
+ * these kernels of that layout.
+ */
+class LayoutAssignmentPass : public mir::StmtPass {
+ public:
+  void Apply(const std::unique_ptr<SSAGraph>& graph) override;
+
+ private:
+  // An activation passed from one op to another.
+  struct Edge {
+    int producer;
+    int consumer;
+    std::string producer_arg;
+    std::string consumer_arg;
+    float cast_cost;
+  };
+
+  // Whether the kernel has the target and precision of the preferred kernel
+  // of the statement.
+  bool IsCandidate(int stmt, const KernelBase& kernel) const;
+  // The first candidate kernel of the statement with the given layout.
+  KernelBase* KernelOf(int stmt, DataLayoutType layout) const;
+  float UnaryCost(int stmt, DataLayoutType layout) const;
+  float PairwiseCost(const Edge& edge,
+                     DataLayoutType producer_layout,
+                     DataLayoutType consumer_layout) const;
+  float Energy(const std::vector<DataLayoutType>& labels) const;
+  // Returns true if switching some ops to `alpha` lowers the energy.
+  bool Expand(DataLayoutType alpha, std::vector<DataLayoutType>* labels);
+
+  std::vector<Node*> stmts_;
+  std::vector<std::vector<DataLayoutType>> allowed_;
+  // The layout preferred by the kernel pick for every op, and the cost of
+  // leaving it.
+  std::vector<DataLayoutType> preferred_;
+  std::vector<const KernelBase*> preferred_kernels_;
+  std::vector<float> switch_costs_;
+  std::vector<Edge> edges_;
+};
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
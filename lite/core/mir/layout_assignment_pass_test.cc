@@ -0,0 +1,223 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/mir/layout_assignment_pass.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "lite/core/mir/pass_registry.h"
+#include "lite/core/mir/pass_test_helper.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+// The NHWC place comes first, so the relu prefers the NHWC kernel registered
+// below, while the sigmoid and tanh only run in NCHW.
+const std::vector<Place> kPlaces{
+    {TARGET(kHost), PRECISION(kFloat), DATALAYOUT(kNHWC)},
+    {TARGET(kHost), PRECISION(kFloat), DATALAYOUT(kNCHW)}};
+
+void ApplyPass(const std::unique_ptr<SSAGraph>& graph) {
+  auto* pass = PassManager::Global().LookUp("layout_assignment_pass");
+  ASSERT_TRUE(pass);
+  pass->Apply(graph);
+}
+
+void AddActivation(ProgramBuilderForTest* builder,
+                   const std::string& op_type,
+                   const std::string& x,
+                   const std::string& out) {
+  builder->AddOp(op_type, {{"X", {x}}}, {{"Out", {out}}});
+}
+
+// A relu reading and writing NHWC tensors, which only gives the pass a
+// choice and is never run.
+class ReluNHWCCompute
+    : public KernelLite<TARGET(kHost), PRECISION(kFloat), DATALAYOUT(kNHWC)> {
+ public:
+  void Run() override {}
+};
+
+// Fake kernels of a mixed OpenCL/ARM place list, where only OpenCL runs the
+// relu in images and only ARM the others in NCHW.
+template <TargetType Target, DataLayoutType Layout>
+class FakeCompute : public KernelLite<Target, PRECISION(kFloat), Layout> {
+ public:
+  void Run() override {}
+};
+using ReluImageCompute =
+    FakeCompute<TARGET(kOpenCL), DATALAYOUT(kImageDefault)>;
+using ARMCompute = FakeCompute<TARGET(kARM), DATALAYOUT(kNCHW)>;
+
+bool HasKernelOfLayout(Node* node, DataLayoutType layout) {
+  for (auto& kernel : node->AsStmt().kernels()) {
+    if (kernel->layout() == layout) return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+TEST(LayoutAssignmentPass, keep_preferred_layout) {
+  // x -> relu -> a -> relu -> b -> sigmoid -> c
+  // Running both relus in NCHW would save the casts of x, written by the
+  // feed in NCHW, and of b, one per relu, but that's no more than giving up
+  // their preferred kernels costs, so they keep them.
+  ProgramBuilderForTest builder;
+  for (auto* name : {"x", "a", "b", "c"}) builder.AddVar(name, {1, 8, 16, 16});
+  builder.AddFeed("x", 0);
+  AddActivation(&builder, "relu", "x", "a");
+  AddActivation(&builder, "relu", "a", "b");
+  AddActivation(&builder, "sigmoid", "b", "c");
+  builder.AddFetch("c", 0);
+  auto graph = builder.BuildGraph(kPlaces);
+
+  ApplyPass(graph);
+
+  for (auto* relu : FindStmts(graph.get(), "relu")) {
+    EXPECT_TRUE(HasKernelOfLayout(relu, DATALAYOUT(kNHWC)));
+  }
+}
+
+TEST(LayoutAssignmentPass, switch_to_save_casts) {
+  // x -> sigmoid -> a -> relu -> b -> tanh -> c
+  // Running the relu in NCHW saves the casts of both a and b.
+  ProgramBuilderForTest builder;
+  for (auto* name : {"x", "a", "b", "c"}) builder.AddVar(name, {1, 8, 16, 16});
+  builder.AddFeed("x", 0);
+  AddActivation(&builder, "sigmoid", "x", "a");
+  AddActivation(&builder, "relu", "a", "b");
+  AddActivation(&builder, "tanh", "b", "c");
+  builder.AddFetch("c", 0);
+  auto graph = builder.BuildGraph(kPlaces);
+
+  ApplyPass(graph);
+
+  auto* relu = FindStmts(graph.get(), "relu").front();
+  EXPECT_FALSE(HasKernelOfLayout(relu, DATALAYOUT(kNHWC)));
+  EXPECT_TRUE(HasKernelOfLayout(relu, DATALAYOUT(kNCHW)));
+}
+
+TEST(LayoutAssignmentPass, keep_preferred_target) {
+  // x -> sigmoid -> a -> relu -> b -> tanh -> c
+  // Running the relu in NCHW would save the casts of a and b, but only the ARM
+  // relu does, and the kernel pick prefers the OpenCL one, so it is kept.
+  // The feed and fetch run on the host.
+  const std::vector<Place> places{
+      {TARGET(kOpenCL), PRECISION(kFloat), DATALAYOUT(kImageDefault)},
+      {TARGET(kARM), PRECISION(kFloat), DATALAYOUT(kNCHW)},
+      {TARGET(kHost), PRECISION(kFloat), DATALAYOUT(kNCHW)}};
+  auto build_graph = [&](ProgramBuilderForTest* builder) {
+    for (auto* name : {"x", "a", "b", "c"}) {
+      builder->AddVar(name, {1, 8, 16, 16});
+    }
+    builder->AddFeed("x", 0);
+    AddActivation(builder, "sigmoid", "x", "a");
+    AddActivation(builder, "relu", "a", "b");
+    AddActivation(builder, "tanh", "b", "c");
+    builder->AddFetch("c", 0);
+    return builder->BuildGraph(places);
+  };
+  auto* pick = PassManager::Global().LookUp("static_kernel_pick_pass");
+  ASSERT_TRUE(pick);
+  auto picked_targets = [](SSAGraph* graph) {
+    std::vector<TargetType> targets;
+    for (auto* op_type : {"sigmoid", "relu", "tanh"}) {
+      auto& kernels = FindStmts(graph, op_type).front()->AsStmt().kernels();
+      EXPECT_EQ(kernels.size(), 1u) << op_type;
+      targets.push_back(kernels.front()->target());
+    }
+    return targets;
+  };
+
+  ProgramBuilderForTest reference_builder;
+  auto reference = build_graph(&reference_builder);
+  pick->Apply(reference);
+  auto expected = picked_targets(reference.get());
+  EXPECT_EQ(expected[1], TARGET(kOpenCL));
+
+  ProgramBuilderForTest builder;
+  auto graph = build_graph(&builder);
+  ApplyPass(graph);
+  EXPECT_TRUE(HasKernelOfLayout(FindStmts(graph.get(), "relu").front(),
+                                DATALAYOUT(kImageDefault)));
+  pick->Apply(graph);
+  EXPECT_EQ(picked_targets(graph.get()), expected);
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_KERNEL(relu,
+                     kOpenCL,
+                     kFloat,
+                     kImageDefault,
+                     paddle::lite::mir::ReluImageCompute,
+                     layout_test)
+    .BindInput("X",
+               {LiteType::GetTensorTy(TARGET(kOpenCL),
+                                      PRECISION(kFloat),
+                                      DATALAYOUT(kImageDefault))})
+    .BindOutput("Out",
+                {LiteType::GetTensorTy(TARGET(kOpenCL),
+                                       PRECISION(kFloat),
+                                       DATALAYOUT(kImageDefault))})
+    .Finalize();
+
+#define REGISTER_ARM_ACTIVATION(op_type)                                     \
+  REGISTER_LITE_KERNEL(op_type,                                              \
+                       kARM,                                                 \
+                       kFloat,                                               \
+                       kNCHW,                                                \
+                       paddle::lite::mir::ARMCompute,                        \
+                       layout_test)                                          \
+      .BindInput("X", {LiteType::GetTensorTy(TARGET(kARM))})                 \
+      .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kARM))})              \
+      .Finalize();
+
+REGISTER_ARM_ACTIVATION(relu)
+REGISTER_ARM_ACTIVATION(sigmoid)
+REGISTER_ARM_ACTIVATION(tanh)
+
+REGISTER_LITE_KERNEL(relu,
+                     kHost,
+                     kFloat,
+                     kNHWC,
+                     paddle::lite::mir::ReluNHWCCompute,
+                     layout_test)
+    .BindInput("X",
+               {LiteType::GetTensorTy(
+                   TARGET(kHost), PRECISION(kFloat), DATALAYOUT(kNHWC))})
+    .BindOutput("Out",
+                {LiteType::GetTensorTy(
+                    TARGET(kHost), PRECISION(kFloat), DATALAYOUT(kNHWC))})
+    .Finalize();
+
+USE_LITE_OP(feed)
+USE_LITE_OP(fetch)
+USE_LITE_OP(relu)
+USE_LITE_OP(sigmoid)
+USE_LITE_OP(tanh)
+USE_LITE_KERNEL(feed, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(fetch, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(relu, kHost, kFloat, kNCHW, def);
+USE_LITE_KERNEL(sigmoid, kHost, kFloat, kNCHW, def);
+USE_LITE_KERNEL(tanh, kHost, kFloat, kNCHW, def);
+USE_MIR_PASS(layout_assignment_pass)
+USE_MIR_PASS(static_kernel_pick_pass)
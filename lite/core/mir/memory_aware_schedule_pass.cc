@@ -0,0 +1,246 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/mir/memory_aware_schedule_pass.h"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <set>
+#include <string>
+#include "lite/core/mir/pass_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+// The ops running sub-blocks, which may touch variables not linked to them.
+const std::set<std::string> kBarrierOps = {
+    "while", "conditional_block", "conditional_block_infer"};
+
+int64_t VarBytes(const Node* var, Scope* scope) {
+  size_t elem_size = sizeof(float);
+  auto* type = var->arg()->type;
+  if (type != nullptr && type->precision() != PRECISION(kUnk) &&
+      type->precision() != PRECISION(kAny)) {
+    elem_size = lite_api::PrecisionTypeLength(type->precision());
+  }
+  int64_t bytes = elem_size;
+  auto* v = scope->FindVar(var->arg()->name);
+  if (v != nullptr && v->IsType<Tensor>()) {
+    // The unknown dimensions, e.g. batch size, are taken as 1.
+    for (auto dim : v->Get<Tensor>().dims().Vectorize()) {
+      bytes *= (std::max)(std::abs(dim), static_cast<int64_t>(1));
+    }
+  }
+  return bytes;
+}
+
+}  // namespace
+
+void MemoryAwareSchedulePass::BuildDependencies(SSAGraph* graph) {
+  stmts_ = graph->StmtTopologicalOrder();
+  const int num = static_cast<int>(stmts_.size());
+  std::map<Node*, int> index;
+  for (int i = 0; i < num; ++i) index[stmts_[i]] = i;
+
+  deps_.assign(num, {});
+  vars_.assign(num, {});
+  var_bytes_.clear();
+  // The buffer of a variable is shared by all of its versions, i.e. the arg
+  // nodes written by different ops, so the variables are keyed by name.
+  std::map<std::string, int> var_index;
+  // The versions of every variable in the default order, starting with the
+  // one read before any op writes it.
+  std::map<std::string, std::vector<Node*>> versions;
+  for (int i = 0; i < num; ++i) {
+    auto* stmt = stmts_[i];
+    std::set<Node*> vars(stmt->inlinks.begin(), stmt->inlinks.end());
+    vars.insert(stmt->outlinks.begin(), stmt->outlinks.end());
+    std::set<int> touched;
+    for (auto* var : vars) {
+      const auto& name = var->arg()->name;
+      if (var->inlinks.empty() && !versions.count(name)) {
+        versions[name].push_back(var);
+      }
+      if (var->arg()->is_weight || var->arg()->is_persist) continue;
+      if (!var_index.count(name)) {
+        var_index[name] = static_cast<int>(var_bytes_.size());
+        var_bytes_.push_back(VarBytes(var, stmt->AsStmt().op()->scope()));
+      }
+      if (touched.insert(var_index[name]).second) {
+        vars_[i].push_back(var_index[name]);
+      }
+    }
+    for (auto* out : stmt->outlinks) {
+      versions[out->arg()->name].push_back(out);
+    }
+    for (auto* in : stmt->inlinks) {
+      for (auto* producer : in->inlinks) {
+        if (producer != stmt) deps_[i].push_back(index.at(producer));
+      }
+    }
+    if (kBarrierOps.count(stmt->AsStmt().op_type())) {
+      for (int j = 0; j < i; ++j) deps_[i].push_back(j);
+      for (int j = i + 1; j < num; ++j) deps_[j].push_back(i);
+    }
+  }
+  // The variables written by several ops, e.g. tensor arrays or in-place
+  // updates, are overwritten only after the previous version is written and
+  // read. The graph doesn't order the writers, so the default order may not
+  // either, but the nodes of the versions are created in program order.
+  std::map<Node*, int> created;
+  for (auto& node : graph->mutable_nodes()) {
+    created[&node] = static_cast<int>(created.size());
+  }
+  for (auto& item : versions) {
+    auto& chain = item.second;
+    std::stable_sort(chain.begin(), chain.end(), [&](Node* a, Node* b) {
+      return created.at(a) < created.at(b);
+    });
+    for (size_t k = 1; k < chain.size(); ++k) {
+      auto* prev = chain[k - 1];
+      std::vector<Node*> before(prev->inlinks.begin(), prev->inlinks.end());
+      before.insert(before.end(), prev->outlinks.begin(), prev->outlinks.end());
+      for (auto* writer : chain[k]->inlinks) {
+        for (auto* stmt : before) {
+          if (stmt != writer) deps_[index.at(writer)].push_back(index.at(stmt));
+        }
+      }
+    }
+  }
+}
+
+int64_t MemoryAwareSchedulePass::PeakBytes(
+    const std::vector<int>& order) const {
+  std::vector<int> touches(var_bytes_.size(), 0);
+  for (auto& vars : vars_) {
+    for (int var : vars) touches[var]++;
+  }
+  std::vector<bool> alive(var_bytes_.size(), false);
+  int64_t live = 0;
+  int64_t peak = 0;
+  for (int stmt : order) {
+    for (int var : vars_[stmt]) {
+      if (!alive[var]) {
+        alive[var] = true;
+        live += var_bytes_[var];
+      }
+    }
+    peak = (std::max)(peak, live);
+    for (int var : vars_[stmt]) {
+      if (--touches[var] == 0) live -= var_bytes_[var];
+    }
+  }
+  return peak;
+}
+
+bool MemoryAwareSchedulePass::FollowsDependencies(
+    const std::vector<int>& order) const {
+  std::vector<bool> done(stmts_.size(), false);
+  for (int stmt : order) {
+    for (int dep : deps_[stmt]) {
+      if (!done[dep]) return false;
+    }
+    done[stmt] = true;
+  }
+  return true;
+}
+
+std::vector<int> MemoryAwareSchedulePass::GreedySchedule() const {
+  const int num = static_cast<int>(stmts_.size());
+  std::vector<int> pending(num, 0);
+  std::vector<std::vector<int>> dependents(num);
+  for (int i = 0; i < num; ++i) {
+    std::set<int> deps(deps_[i].begin(), deps_[i].end());
+    pending[i] = static_cast<int>(deps.size());
+    for (int dep : deps) dependents[dep].push_back(i);
+  }
+  std::vector<int> touches(var_bytes_.size(), 0);
+  for (auto& vars : vars_) {
+    for (int var : vars) touches[var]++;
+  }
+  std::vector<bool> alive(var_bytes_.size(), false);
+
+  // The ready statements by their default position, which breaks the ties.
+  std::set<int> ready;
+  for (int i = 0; i < num; ++i) {
+    if (pending[i] == 0) ready.insert(i);
+  }
+  std::vector<int> order;
+  while (!ready.empty()) {
+    int best = -1;
+    int64_t best_delta = std::numeric_limits<int64_t>::max();
+    for (int stmt : ready) {
+      int64_t delta = 0;
+      for (int var : vars_[stmt]) {
+        if (!alive[var]) delta += var_bytes_[var];
+        if (touches[var] == 1) delta -= var_bytes_[var];
+      }
+      if (delta < best_delta) {
+        best = stmt;
+        best_delta = delta;
+      }
+    }
+    ready.erase(best);
+    order.push_back(best);
+    for (int var : vars_[best]) {
+      alive[var] = true;
+      touches[var]--;
+    }
+    for (int next : dependents[best]) {
+      if (--pending[next] == 0) ready.insert(next);
+    }
+  }
+  CHECK_EQ(order.size(), stmts_.size()) << "the graph has a cycle";
+  return order;
+}
+
+void MemoryAwareSchedulePass::Apply(const std::unique_ptr<SSAGraph>& graph) {
+  BuildDependencies(graph.get());
+  if (stmts_.size() < 3) return;
+
+  std::vector<int> default_order(stmts_.size());
+  for (size_t i = 0; i < stmts_.size(); ++i) default_order[i] = i;
+  auto order = GreedySchedule();
+  int64_t default_peak = PeakBytes(default_order);
+  int64_t peak = PeakBytes(order);
+  VLOG(3) << "memory_aware_schedule_pass: the peak of the live bytes is "
+          << default_peak << " in the default order, " << peak
+          << " in the scheduled order";
+  if (peak >= default_peak && FollowsDependencies(default_order)) return;
+
+  std::vector<Node*> stmt_order;
+  for (int stmt : order) stmt_order.push_back(stmts_[stmt]);
+  graph->SetStmtOrder(stmt_order);
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_MIR_PASS(memory_aware_schedule_pass,
+                  paddle::lite::mir::MemoryAwareSchedulePass)
+    .BindTargets({TARGET(kARM), TARGET(kOpenCL)})
+    .ExcludeTargets({TARGET(kNPU),
+                     TARGET(kXPU),
+                     TARGET(kBM),
+                     TARGET(kRKNPU),
+                     TARGET(kAPU),
+                     TARGET(kMLU),
+                     TARGET(kHuaweiAscendNPU),
+                     TARGET(kImaginationNNA),
+                     TARGET(kMetal)});
@@ -0,0 +1,59 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "lite/core/mir/pass.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+/*
+ * MemoryAwareSchedulePass chooses the order of the statements over which
+ * memory_optimize_pass computes the lifetimes of the variables, so that the
+ * branches of a network don't keep their large intermediate tensors alive
+ * while the other branches run. Among the statements whose inputs are ready
+ * it greedily runs the one which grows the live bytes the least, and keeps
+ * the new order if its peak is lower than the one of the default order, or
+ * if the default order breaks the dependencies below.
+ * The ops with sub-blocks keep their default order, and an op overwriting a
+ * variable runs after the ops writing and reading its previous version.
+ */
+class MemoryAwareSchedulePass : public ProgramPass {
+ public:
+  void Apply(const std::unique_ptr<SSAGraph>& graph) override;
+
+ private:
+  // The statements in the default order, and for every statement the ones it
+  // must run after and the variables it reads or writes.
+  std::vector<Node*> stmts_;
+  std::vector<std::vector<int>> deps_;
+  std::vector<std::vector<int>> vars_;
+  std::vector<int64_t> var_bytes_;
+
+  void BuildDependencies(SSAGraph* graph);
+  // The peak of the bytes of the variables alive along `order`.
+  int64_t PeakBytes(const std::vector<int>& order) const;
+  // Whether every statement in `order` runs after the ones it depends on,
+  // which the default order may not do for the overwritten variables.
+  bool FollowsDependencies(const std::vector<int>& order) const;
+  std::vector<int> GreedySchedule() const;
+};
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,147 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "lite/core/mir/pass_registry.h"
+#include "lite/core/mir/pass_test_helper.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+const std::vector<Place> kPlaces{{TARGET(kHost), PRECISION(kFloat)}};
+
+void ApplyPass(const std::unique_ptr<SSAGraph>& graph) {
+  auto* pass = PassManager::Global().LookUp("memory_aware_schedule_pass");
+  ASSERT_TRUE(pass);
+  pass->Apply(graph);
+}
+
+void AddRelu(ProgramBuilderForTest* builder,
+             const std::string& x,
+             const std::string& out) {
+  builder->AddOp("relu", {{"X", {x}}}, {{"Out", {out}}});
+}
+
+void AddReduceSum(ProgramBuilderForTest* builder,
+                  const std::string& x,
+                  const std::string& out) {
+  auto* op_desc = builder->AddOp("reduce_sum", {{"X", {x}}}, {{"Out", {out}}});
+  op_desc->SetAttr<std::vector<int>>("dim", {1});
+  op_desc->SetAttr<bool>("keep_dim", true);
+}
+
+void AddAdd(ProgramBuilderForTest* builder,
+            const std::string& x,
+            const std::string& y,
+            const std::string& out) {
+  builder->AddOp("elementwise_add", {{"X", {x}}, {"Y", {y}}}, {{"Out", {out}}})
+      ->SetAttr<int>("axis", -1);
+}
+
+// The position in `order` of the op of `op_type` reading or writing `var`.
+int Position(const std::vector<Node*>& order,
+             const std::string& op_type,
+             const std::string& var) {
+  for (size_t i = 0; i < order.size(); ++i) {
+    auto* op_info = order[i]->AsStmt().op_info();
+    auto vars = op_info->input_names();
+    auto outputs = op_info->output_names();
+    vars.insert(vars.end(), outputs.begin(), outputs.end());
+    if (op_info->Type() == op_type &&
+        std::find(vars.begin(), vars.end(), var) != vars.end()) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+}  // namespace
+
+TEST(MemoryAwareSchedulePass, interleave_branches) {
+  // x -> relu -> a1 -> reduce_sum -> a2 -> elementwise_add -> out
+  //   -> relu -> b1 -> reduce_sum -> b2 ->
+  // Both relus run first in the default order, which keeps a1 and b1 alive
+  // at once. Each branch is reduced before the other one starts instead.
+  ProgramBuilderForTest builder;
+  for (auto* name : {"x", "a1", "b1"}) builder.AddVar(name, {1, 1024});
+  for (auto* name : {"a2", "b2", "out"}) builder.AddVar(name, {1, 1});
+  builder.AddFeed("x", 0);
+  AddRelu(&builder, "x", "a1");
+  AddRelu(&builder, "x", "b1");
+  AddReduceSum(&builder, "a1", "a2");
+  AddReduceSum(&builder, "b1", "b2");
+  AddAdd(&builder, "a2", "b2", "out");
+  builder.AddFetch("out", 0);
+  auto graph = builder.BuildGraph(kPlaces);
+
+  ApplyPass(graph);
+
+  auto order = graph->StmtTopologicalOrder();
+  int relu_a = Position(order, "relu", "a1");
+  int relu_b = Position(order, "relu", "b1");
+  int reduce_a = Position(order, "reduce_sum", "a1");
+  int reduce_b = Position(order, "reduce_sum", "b1");
+  EXPECT_TRUE(reduce_a < relu_b || reduce_b < relu_a);
+}
+
+TEST(MemoryAwareSchedulePass, keep_rewritten_var_order) {
+  // t is written by two reduce_sums. Running the second one right after y is
+  // computed frees y the soonest, but it must wait until the first version
+  // of t is read.
+  //   x -> relu -> z -> reduce_sum -> t (v1) -> elementwise_add(z, t) -> r
+  //     -> relu -> y -> reduce_sum -> t (v2) -> elementwise_add(r, t) -> out
+  ProgramBuilderForTest builder;
+  for (auto* name : {"x", "y", "z", "r", "out"}) {
+    builder.AddVar(name, {1, 1024});
+  }
+  builder.AddVar("t", {1, 1});
+  builder.AddFeed("x", 0);
+  AddRelu(&builder, "x", "y");
+  AddRelu(&builder, "x", "z");
+  AddReduceSum(&builder, "z", "t");
+  AddAdd(&builder, "z", "t", "r");
+  AddReduceSum(&builder, "y", "t");
+  AddAdd(&builder, "r", "t", "out");
+  builder.AddFetch("out", 0);
+  auto graph = builder.BuildGraph(kPlaces);
+
+  ApplyPass(graph);
+
+  auto order = graph->StmtTopologicalOrder();
+  int write_v1 = Position(order, "reduce_sum", "z");
+  int read_v1 = Position(order, "elementwise_add", "z");
+  int write_v2 = Position(order, "reduce_sum", "y");
+  int read_v2 = Position(order, "elementwise_add", "out");
+  ASSERT_GE(write_v1, 0);
+  EXPECT_LT(write_v1, read_v1);
+  EXPECT_LT(read_v1, write_v2);
+  EXPECT_LT(write_v2, read_v2);
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(feed)
+USE_LITE_OP(fetch)
+USE_LITE_OP(relu)
+USE_LITE_OP(reduce_sum)
+USE_LITE_OP(elementwise_add)
+USE_MIR_PASS(memory_aware_schedule_pass)
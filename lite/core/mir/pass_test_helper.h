@@ -0,0 +1,146 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lite/core/mir/ssa_graph.h"
+#include "lite/core/program.h"
+#include "lite/core/scope.h"
+#include "lite/model_parser/cpp_desc.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+// Builds a small program by hand and the SSA graph of its main block, for the
+// tests of the passes.
+class ProgramBuilderForTest {
+ public:
+  ProgramBuilderForTest()
+      : program_desc_(std::make_shared<cpp::ProgramDesc>()),
+        scope_(std::make_shared<Scope>()) {
+    program_desc_->SetVersion(0);
+    AddBlock();
+  }
+
+  // Add an empty block, e.g. the sub-block of a control flow op.
+  cpp::BlockDesc* AddBlock() {
+    auto* block_desc = program_desc_->AddBlock<cpp::BlockDesc>();
+    block_desc->SetIdx(program_desc_->BlocksSize() - 1);
+    block_desc->SetParentIdx(program_desc_->BlocksSize() > 1 ? 0 : -1);
+    return block_desc;
+  }
+
+  // Declare a float tensor. The persistable ones are weights created in the
+  // root scope and filled with `value`.
+  void AddVar(const std::string& name,
+              const std::vector<int64_t>& shape,
+              bool persistable = false,
+              float value = 0.f,
+              int block_idx = 0) {
+    auto* var_desc = program_desc_->GetBlock<cpp::BlockDesc>(block_idx)
+                         ->AddVar<cpp::VarDesc>();
+    var_desc->SetName(name);
+    var_desc->SetType(VarDescAPI::Type::LOD_TENSOR);
+    var_desc->SetDataType(VarDescAPI::VarDataType::FP32);
+    var_desc->SetPersistable(persistable);
+    var_desc->SetShape(shape);
+    if (!persistable) return;
+    auto* tensor = scope_->Var(name)->GetMutable<Tensor>();
+    tensor->Resize(shape);
+    auto* data = tensor->mutable_data<float>();
+    for (int64_t i = 0; i < tensor->numel(); i++) {
+      data[i] = value;
+    }
+    tensor->set_persistable(true);
+    tensor->set_precision(PRECISION(kFloat));
+  }
+
+  // Append an op to a block, its attributes are set on the returned desc.
+  cpp::OpDesc* AddOp(
+      const std::string& type,
+      const std::map<std::string, std::vector<std::string>>& inputs,
+      const std::map<std::string, std::vector<std::string>>& outputs,
+      int block_idx = 0) {
+    auto* op_desc = program_desc_->GetBlock<cpp::BlockDesc>(block_idx)
+                        ->AddOp<cpp::OpDesc>();
+    op_desc->SetType(type);
+    for (auto& input : inputs) {
+      op_desc->SetInput(input.first, input.second);
+    }
+    for (auto& output : outputs) {
+      op_desc->SetOutput(output.first, output.second);
+    }
+    return op_desc;
+  }
+
+  void AddFeed(const std::string& name, int col) {
+    AddOp("feed", {{"X", {"feed"}}}, {{"Out", {name}}})
+        ->SetAttr<int>("col", col);
+  }
+
+  void AddFetch(const std::string& name, int col) {
+    AddOp("fetch", {{"X", {name}}}, {{"Out", {"fetch"}}})
+        ->SetAttr<int>("col", col);
+  }
+
+  // Create the ops of the program and the graph of its main block. The
+  // program is kept alive by the builder, as the graph refers to its ops.
+  std::unique_ptr<SSAGraph> BuildGraph(const std::vector<Place>& valid_places) {
+    program_.reset(new Program(program_desc_, scope_, valid_places));
+    std::unique_ptr<SSAGraph> graph(new SSAGraph);
+    graph->Build(*program_, valid_places);
+    graph->SetValidPlaces(valid_places);
+    return graph;
+  }
+
+  const std::shared_ptr<cpp::ProgramDesc>& program_desc() const {
+    return program_desc_;
+  }
+  Scope* scope() { return scope_.get(); }
+  // The root scope holding the weights, e.g. to build a Predictor with.
+  const std::shared_ptr<Scope>& root_scope() const { return scope_; }
+  Scope* exec_scope() { return program_->exec_scope(); }
+
+ private:
+  std::shared_ptr<cpp::ProgramDesc> program_desc_;
+  std::shared_ptr<Scope> scope_;
+  std::unique_ptr<Program> program_;
+};
+
+// The statements of `graph` running an op of `op_type`, in topological order.
+inline std::vector<Node*> FindStmts(SSAGraph* graph,
+                                    const std::string& op_type) {
+  std::vector<Node*> stmts;
+  for (auto* node : graph->StmtTopologicalOrder()) {
+    if (node->AsStmt().op_type() == op_type) stmts.push_back(node);
+  }
+  return stmts;
+}
+
+// Whether any argument node of `graph` is named `name`.
+inline bool HasArg(SSAGraph* graph, const std::string& name) {
+  for (auto& node : graph->mutable_nodes()) {
+    if (node.IsArg() && node.AsArg().name == name) return true;
+  }
+  return false;
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
@@ -14,7 +14,10 @@
 
 #include <algorithm>
 #include <array>
+#include <list>
+#include <set>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "lite/core/mir/dot.h"
@@ -115,19 +118,85 @@ void PatternMatcher::operator()(SSAGraph *graph,
 
 bool PatternMatcher::MarkPMNodesInGraph(SSAGraph *graph) {
   VLOG(3) << "mark pmnodes in graph";
+  pmnodes2nodes_.clear();
   if (graph->nodes().empty()) return false;
+  std::vector<Node *> all_nodes;
+  std::map<std::string, std::vector<Node *>> op_index;
   for (auto &node : graph->mutable_nodes()) {
-    for (const auto &pmnode : pattern_.nodes()) {
-      if (pmnode->Tell(&node)) {
-        pmnodes2nodes_[pmnode.get()].insert(&node);
-      }
+    all_nodes.push_back(&node);
+    if (node.IsStmt() && node.stmt()->op()) {
+      op_index[node.stmt()->op_type()].push_back(&node);
+    }
+  }
+
+  auto mark = [&](PMNode *pmnode, const std::vector<Node *> &candidates) {
+    auto &marked = pmnodes2nodes_[pmnode];
+    for (auto *node : candidates) {
+      if (pmnode->Tell(node)) marked.insert(node);
     }
+    VLOG(5) << pmnode->name() << " tests " << candidates.size()
+            << " nodes, marks " << marked.size();
+  };
+  std::set<PMNode *> linked;
+  for (auto &edge : pattern_.edges()) {
+    linked.insert(edge.first);
+    linked.insert(edge.second);
   }
-  // Check to early stop if some PMNode can't find matched Node.
+
+  // The PMNodes asserting an op type only test the statements of that type.
+  std::vector<PMNode *> pending;
   for (auto &pmnode : pattern_.nodes()) {
-    if (!pmnodes2nodes_.count(pmnode.get())) {
+    const auto &op_type = pmnode->indexed_op_type();
+    if (op_type.empty()) {
+      pending.push_back(pmnode.get());
+      continue;
+    }
+    auto it = op_index.find(op_type);
+    mark(pmnode.get(),
+         it == op_index.end() ? std::vector<Node *>() : it->second);
+  }
+  // A PMNode linked to a marked one only tests the neighbors of its nodes,
+  // since every subgraph links them.
+  while (!pending.empty()) {
+    std::vector<PMNode *> still_pending;
+    for (auto *pmnode : pending) {
+      const std::set<Node *> *anchors = nullptr;
+      bool from_anchor = false;
+      for (auto &edge : pattern_.edges()) {
+        PMNode *other = edge.first == pmnode
+                            ? edge.second
+                            : (edge.second == pmnode ? edge.first : nullptr);
+        if (other == nullptr || !pmnodes2nodes_.count(other)) continue;
+        auto *nodes = &pmnodes2nodes_.at(other);
+        if (anchors == nullptr || nodes->size() < anchors->size()) {
+          anchors = nodes;
+          from_anchor = edge.first == other;
+        }
+      }
+      if (anchors == nullptr) {
+        still_pending.push_back(pmnode);
+        continue;
+      }
+      std::set<Node *> neighbors;
+      for (auto *anchor : *anchors) {
+        auto &links = from_anchor ? anchor->outlinks : anchor->inlinks;
+        neighbors.insert(links.begin(), links.end());
+      }
+      mark(pmnode, std::vector<Node *>(neighbors.begin(), neighbors.end()));
+    }
+    // The rest are not linked to any marked PMNode, test all the nodes.
+    if (still_pending.size() == pending.size()) {
+      mark(still_pending.front(), all_nodes);
+      still_pending.erase(still_pending.begin());
+    }
+    pending = std::move(still_pending);
+  }
+
+  // Early stop if some PMNode in the links can't find any matched Node.
+  for (auto *pmnode : linked) {
+    if (pmnodes2nodes_.at(pmnode).empty()) {
       VLOG(4) << pmnode->name() << " can't find matched Node, early stop";
-      // return false;
+      return false;
     }
   }
   VLOG(3) << pmnodes2nodes_.size() << " nodes marked";
@@ -191,14 +260,9 @@ struct HitGroup {
   std::set<Node *> nodes_;
 };
 
-// Tell whether Node a links to b.
-bool IsNodesLink(Node *a, Node *b) {
-  for (auto *node : a->outlinks) {
-    if (b == node) {
-      return true;
-    }
-  }
-  return false;
+// The distinct nodes of the links, in the order of the node pointers.
+std::set<Node *> UniqueLinks(const std::list<Node *> &links) {
+  return std::set<Node *>(links.begin(), links.end());
 }
 
 std::vector<PatternMatcher::subgraph_t> PatternMatcher::DetectPatterns() {
@@ -229,25 +293,49 @@ std::vector<PatternMatcher::subgraph_t> PatternMatcher::DetectPatterns() {
     auto &cur_groups = bi_records[1 - (step++ % 2)];
     cur_groups.clear();
     if (pre_groups.empty()) break;
-    // source -> target
-    for (Node *source : pmnodes2nodes_[edge.first]) {
-      for (Node *target : pmnodes2nodes_[edge.second]) {
-        // TODO(Superjomn) add some prune strategies.
-        for (const auto &group : pre_groups) {
-          if (IsNodesLink(source, target)) {
-            HitGroup new_group = group;
-            bool flag = new_group.Match(source, edge.first) &&
-                        new_group.Match(target, edge.second);
-            if (flag) {
-              new_group.Register(source, edge.first);
-              new_group.Register(target, edge.second);
-              cur_groups.push_back(new_group);
-              // TODO(Superjomn) need to unique
-            }
+    const auto &sources = pmnodes2nodes_[edge.first];
+    const auto &targets = pmnodes2nodes_[edge.second];
+    // source -> target, only the links of the nodes already in a group are
+    // visited. The hits are sorted by (source, target, group) afterwards,
+    // which is the order of a scan over all the marked nodes.
+    std::vector<std::tuple<Node *, Node *, size_t>> hits;
+    auto add_hit = [&](Node *source, Node *target, size_t index) {
+      if (!sources.count(source) || !targets.count(target)) return;
+      auto &group = pre_groups[index];
+      if (group.Match(source, edge.first) &&
+          group.Match(target, edge.second)) {
+        hits.emplace_back(source, target, index);
+      }
+    };
+    for (size_t i = 0; i < pre_groups.size(); ++i) {
+      const auto &roles = pre_groups[i].roles;
+      auto source_it = roles.find(edge.first);
+      auto target_it = roles.find(edge.second);
+      if (source_it != roles.end()) {
+        auto *source = source_it->second;
+        for (auto *target : UniqueLinks(source->outlinks)) {
+          add_hit(source, target, i);
+        }
+      } else if (target_it != roles.end()) {
+        auto *target = target_it->second;
+        for (auto *source : UniqueLinks(target->inlinks)) {
+          add_hit(source, target, i);
+        }
+      } else {
+        for (auto *source : sources) {
+          for (auto *target : UniqueLinks(source->outlinks)) {
+            add_hit(source, target, i);
           }
         }
       }
     }
+    std::sort(hits.begin(), hits.end());
+    for (auto &hit : hits) {
+      HitGroup new_group = pre_groups[std::get<2>(hit)];
+      new_group.Register(std::get<0>(hit), edge.first);
+      new_group.Register(std::get<1>(hit), edge.second);
+      cur_groups.push_back(new_group);
+    }
     VLOG(3) << "step " << step << " get records: " << cur_groups.size();
   }
 
@@ -371,6 +459,7 @@ PMNode *PMNode::assert_only_one_output() {
 }
 
 PMNode *PMNode::assert_is_op(const std::string &op_type) {
+  if (indexed_op_type_.empty()) indexed_op_type_ = op_type;
   asserts_.emplace_back([op_type](const Node *x) {
     if (x && x->IsStmt()) {
       auto *op_info = x->stmt()->op_info();
@@ -521,9 +610,18 @@ bool HasInput(const Node &op, const std::string &argument) {
 
 void GraphSafeRemoveNodes(SSAGraph *graph,
                           const std::set<const Node *> &nodes) {
-  for (auto *node : nodes) {
-    graph->RemoveNode(node);
+  // Erase the nodes in one sweep instead of searching the graph for each.
+  auto &storage = graph->mutable_nodes();
+  size_t num_removed = 0;
+  for (auto it = storage.begin(); it != storage.end();) {
+    if (nodes.count(&*it)) {
+      it = storage.erase(it);
+      num_removed++;
+    } else {
+      it++;
+    }
   }
+  CHECK_EQ(num_removed, nodes.size()) << "some nodes are not in the graph";
 
   for (auto &node : graph->mutable_nodes()) {
     for (auto it = node.inlinks.begin(); it != node.inlinks.end();) {
@@ -116,6 +116,13 @@ struct PMNode {
 
   void set_op_type(const std::string& op_type) { op_type_ = op_type; }
 
+  // The op type every node told by this PMNode has, or empty if unknown. The
+  // matcher only tests the nodes of this type.
+  const std::string& indexed_op_type() const {
+    static const std::string kUnknown;
+    return teller_ ? kUnknown : indexed_op_type_;
+  }
+
   bool IsIntermediate() const { return role_ == Role::kIntermediate; }
   bool IsInput() const { return role_ == Role::kInput; }
   bool IsOutput() const { return role_ == Role::kOutput; }
@@ -195,6 +202,7 @@ struct PMNode {
   PMPattern* pattern_;
   std::string name_;
   std::string op_type_;
+  std::string indexed_op_type_;
   Type type_;
   Role role_{Role::kUnknown};
 };
@@ -264,9 +272,13 @@ class PMPattern {
  * This helper can be used to support fuse(conv+batchnorm => batchnorm e.g.).
  *
  * The algorithm has three phases:
- *   1. Mark the nodes that match the defined PMNodes in a PMPattern,
+ *   1. Mark the nodes that match the defined PMNodes in a PMPattern. The
+ *      PMNodes asserting an op type only test the statements of that type,
+ *      the others only test the neighbors of the nodes marked for the PMNodes
+ *      they are linked to,
  *   2. Extend a PMNode to subgraphs by deducing the connection relation defined
- *      in PAPattern(the edges),
+ *      in PAPattern(the edges), only the neighbors of the nodes already in a
+ *      subgraph are visited,
  *   3. Get the filtered subgraphs and treat them with a pre-defined handler.
  *
  * Usage:
@@ -298,7 +310,8 @@ class PatternMatcher {
   PMPattern* mutable_pattern() { return &pattern_; }
 
  private:
-  // Mark the nodes that fits the pattern.
+  // Mark the nodes that fits the pattern, returns false if some PMNode linked
+  // in the pattern can't be matched.
   bool MarkPMNodesInGraph(SSAGraph* graph);
 
   // Detect all the pattern and output the hit records.
@@ -228,6 +228,30 @@ TEST(PatternMatcher, IntermediateCheck) {
   ASSERT_EQ(count, 1);
 }
 
+TEST(PatternMatcher, GraphSafeRemoveNodes) {
+  SSAGraph graph;
+  BuildGraph(&graph);
+
+  // Remove o3 and v4, o5 only reads v3 then.
+  std::set<const Node*> nodes2rm;
+  Node* o5 = nullptr;
+  for (auto& node : graph.mutable_nodes()) {
+    if (node.IsStmt() && node.stmt()->desc == "op3") nodes2rm.insert(&node);
+    if (node.IsArg() && node.arg()->name == "var4") nodes2rm.insert(&node);
+    if (node.IsStmt() && node.stmt()->desc == "op5") o5 = &node;
+  }
+  GraphSafeRemoveNodes(&graph, nodes2rm);
+
+  ASSERT_EQ(graph.nodes().size(), 7UL);
+  ASSERT_EQ(o5->inlinks.size(), 1UL);
+  ASSERT_EQ(o5->inlinks.front()->arg()->name, "var3");
+  for (auto& node : graph.nodes()) {
+    if (node.IsArg() && node.arg()->name == "var2") {
+      ASSERT_EQ(node.outlinks.size(), 1UL);
+    }
+  }
+}
+
 }  // namespace mir
 }  // namespace lite
 }  // namespace paddle
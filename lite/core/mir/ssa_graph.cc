@@ -102,9 +102,39 @@ void SSAGraph::SortHelper(
   ret->push_back(node);
 }
 
+bool SSAGraph::IsValidStmtOrder(const std::vector<mir::Node *> &order) {
+  std::map<mir::Node *, int> position;
+  for (auto &n : node_storage_) {
+    if (n.IsStmt()) position[&n] = -1;
+  }
+  if (position.size() != order.size()) return false;
+  // The removed nodes are not dereferenced.
+  for (size_t i = 0; i < order.size(); ++i) {
+    auto it = position.find(order[i]);
+    if (it == position.end() || it->second >= 0) return false;
+    it->second = static_cast<int>(i);
+  }
+  for (auto *stmt : order) {
+    for (auto *var : stmt->inlinks) {
+      for (auto *producer : var->inlinks) {
+        if (producer != stmt && position[producer] > position[stmt]) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
 std::vector<mir::Node *> SSAGraph::StmtTopologicalOrder() {
   CheckBidirectionalConnection();
 
+  if (!stmt_order_.empty()) {
+    if (IsValidStmtOrder(stmt_order_)) return stmt_order_;
+    VLOG(4) << "Drop the statement order which doesn't match the graph";
+    stmt_order_.clear();
+  }
+
   std::stack<mir::Node *> stack;
   std::set<mir::Node *> visited;
   std::vector<mir::Node *> res;
@@ -49,6 +49,13 @@ class SSAGraph : GraphBase {
 
   std::vector<mir::Node *> StmtTopologicalOrder();
 
+  // Make StmtTopologicalOrder return `order` for as long as it holds exactly
+  // the statements of the graph and follows their dependencies, e.g. the
+  // schedule chosen by memory_aware_schedule_pass.
+  void SetStmtOrder(const std::vector<mir::Node *> &order) {
+    stmt_order_ = order;
+  }
+
   std::vector<mir::Node *> NodeTopologicalOrder();
 
   // The inputs of the graph.
@@ -105,11 +112,14 @@ class SSAGraph : GraphBase {
                   std::set<mir::Node *> *visited,
                   std::vector<mir::Node *> *ret);
 
+  bool IsValidStmtOrder(const std::vector<mir::Node *> &order);
+
  private:
   std::list<mir::Node> node_storage_;
   std::map<std::string, mir::Node *> arguments_;
   std::vector<Place> valid_places_;
   int block_idx_ = kRootBlockIdx;
+  std::vector<mir::Node *> stmt_order_;
 };
 
 // Remove the link between a -> b.
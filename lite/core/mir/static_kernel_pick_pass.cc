@@ -14,19 +14,90 @@
 
 #include "lite/core/mir/static_kernel_pick_pass.h"
 #include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
+#include "lite/core/context.h"
 #include "lite/core/mir/graph_visualize_pass.h"
 #include "lite/core/mir/pass_registry.h"
+#include "lite/utils/env.h"
 
 namespace paddle {
 namespace lite {
 namespace mir {
 
+namespace {
+
+const int kBenchmarkRepeats = 5;
+
+// The ops which are never timed, for they have side effects or depend on the
+// content of their inputs, such as LoD, rather than the shapes.
+const std::set<std::string> kUntimedOps = {"feed",
+                                           "fetch",
+                                           "while",
+                                           "conditional_block",
+                                           "subgraph",
+                                           "print",
+                                           "write_to_array",
+                                           "read_from_array",
+                                           "lod_reset"};
+
+bool IsHostTarget(TargetType target) {
+  switch (target) {
+    case TARGET(kHost):
+#ifdef LITE_WITH_X86
+    case TARGET(kX86):
+#endif
+#ifdef LITE_WITH_ARM
+    case TARGET(kARM):
+#endif
+      return true;
+    default:
+      return false;
+  }
+}
+
+const Type* DeclType(const KernelBase& kernel,
+                     const std::string& arg_name,
+                     bool is_input) {
+  auto& registry = ParamTypeRegistry::Global();
+  const auto* type =
+      is_input ? registry.RetrieveInArgument(
+                     kernel.place(), kernel.GenParamTypeKey(), arg_name)
+               : registry.RetrieveOutArgument(
+                     kernel.place(), kernel.GenParamTypeKey(), arg_name);
+  return type ? type->type : nullptr;
+}
+
+// Whether kernel b can replace kernel a without any cast of the arguments.
+bool Interchangeable(const KernelBase& a,
+                     const KernelBase& b,
+                     const OpInfo& op_info) {
+  auto same = [&](const std::string& arg_name, bool is_input) {
+    const auto* x = DeclType(a, arg_name, is_input);
+    const auto* y = DeclType(b, arg_name, is_input);
+    if (x == nullptr || y == nullptr) return x == y;
+    return TargetCompatibleTo(*x, *y) && x->precision() == y->precision() &&
+           x->layout() == y->layout();
+  };
+  for (auto& arg_name : op_info.InputArgumentNames()) {
+    if (!same(arg_name, true)) return false;
+  }
+  for (auto& arg_name : op_info.OutputArgumentNames()) {
+    if (!same(arg_name, false)) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
 bool KernelScoreCmp(const std::pair<float, std::unique_ptr<KernelBase>>& a,
                     const std::pair<float, std::unique_ptr<KernelBase>>& b) {
   return a.first > b.first;
@@ -39,11 +110,14 @@ void StaticKernelPickPass::Apply(const std::unique_ptr<SSAGraph>& graph) {
   CHECK(kernel_pick_factors_.any_factor_considered())
       << "kernel_pick_factors should be specified first";
   CHECK(graph) << "graph not valid";
+  benchmark_ = GetBoolFromEnv(KERNEL_PICK_BENCHMARK);
 
   // sort kernels by the factors.
   VLOG(4) << "graph->mutable_nodes().size():" << graph->mutable_nodes().size();
-  for (auto& node : graph->mutable_nodes()) {
-    if (!node.IsStmt()) continue;
+  // Visit the ops in topological order, so that the benchmark mode can
+  // propagate the shapes from the inputs of the model.
+  for (auto* node_ptr : graph->StmtTopologicalOrder()) {
+    auto& node = *node_ptr;
     auto& instruct = node.AsStmt();
 
     std::map<std::string, PrecisionType> in_types;
@@ -83,6 +157,7 @@ void StaticKernelPickPass::Apply(const std::unique_ptr<SSAGraph>& graph) {
     instruct.kernels().clear();
 
     if (!instruct.op_info()->HasAttr("enable_int8")) {
+      PickByCost(graph.get(), &node, in_types, &scored);
       // Move kernel back
       // Just keep a single best kernel.
       // TODO(Superjomn) reconsider this.
@@ -176,6 +251,116 @@ void StaticKernelPickPass::Apply(const std::unique_ptr<SSAGraph>& graph) {
   }
 }
 
+void StaticKernelPickPass::PickByCost(
+    SSAGraph* graph,
+    Node* node,
+    const std::map<std::string, PrecisionType>& in_types,
+    ScoredKernels* scored) {
+  auto& instruct = node->AsStmt();
+  bool benchmark = benchmark_ && PrepareBenchmark(node, in_types);
+  std::vector<size_t> candidates;
+  for (size_t i = 0; i < scored->size(); ++i) {
+    if (Interchangeable(*scored->front().second,
+                        *(*scored)[i].second,
+                        *instruct.op_info())) {
+      candidates.push_back(i);
+    }
+  }
+  if (candidates.size() < 2) return;
+  // The timed kernels are replaced below, so either all of them are timed or
+  // none, in which case the estimates decide.
+  for (auto i : candidates) {
+    if (!IsHostTarget((*scored)[i].second->target())) benchmark = false;
+  }
+
+  size_t winner = 0;
+  float winner_cost = -1.f;
+  for (auto i : candidates) {
+    auto* kernel = (*scored)[i].second.get();
+    float cost = benchmark ? MeasureKernel(kernel) : kernel->EstimateCost();
+    VLOG(4) << "kernel->summary():" << kernel->summary() << " cost:" << cost;
+    // Fall back to the static score if any cost is unknown.
+    if (cost < 0) return;
+    if (winner_cost < 0 || cost < winner_cost) {
+      winner = i;
+      winner_cost = cost;
+    }
+  }
+  std::rotate(scored->begin(),
+              scored->begin() + winner,
+              scored->begin() + winner + 1);
+  VLOG(2) << "pick " << scored->front().second->summary() << " by cost "
+          << winner_cost;
+  if (!benchmark) return;
+
+  // The timed kernels have been prepared with a temporary context, replace
+  // the winner with a fresh one.
+  auto summary = scored->front().second->summary();
+  instruct.ResetKernels(graph->valid_places());
+  for (auto& kernel : instruct.kernels()) {
+    if (kernel->summary() == summary) {
+      scored->front().second = std::move(kernel);
+      break;
+    }
+  }
+  instruct.kernels().clear();
+}
+
+bool StaticKernelPickPass::PrepareBenchmark(
+    Node* node, const std::map<std::string, PrecisionType>& in_types) {
+  auto& instruct = node->AsStmt();
+  const auto op_type = instruct.op_type();
+  if (kUntimedOps.count(op_type) || op_type.find("sequence_") == 0 ||
+      instruct.op_info()->HasAttr("enable_int8")) {
+    return false;
+  }
+  auto op = instruct.op();
+  auto* scope = op->scope();
+  for (auto* in : node->inlinks) {
+    const auto& name = in->arg()->name;
+    auto* var = scope->FindVar(name);
+    if (var == nullptr || !var->IsType<Tensor>()) return false;
+    auto* tensor = var->GetMutable<Tensor>();
+    auto dims = tensor->dims();
+    if (dims.empty()) return false;
+    for (size_t i = 0; i < dims.size(); ++i) {
+      if (dims[i] <= 0) return false;
+    }
+    if (in->arg()->is_weight) {
+      if (!tensor->IsInitialized()) return false;
+      continue;
+    }
+    // Only the float activations are filled, the content of the others may
+    // decide the shapes or indices.
+    if (!in_types.count(name) || in_types.at(name) != PRECISION(kFloat)) {
+      return false;
+    }
+    if (!tensor->IsInitialized() ||
+        tensor->precision() != PRECISION(kFloat)) {
+      std::memset(tensor->mutable_data<float>(), 0, tensor->memory_size());
+    }
+  }
+  if (!op->CheckShape()) return false;
+  op->InferShape();
+  return true;
+}
+
+float StaticKernelPickPass::MeasureKernel(KernelBase* kernel) {
+  CHECK(IsHostTarget(kernel->target())) << kernel->summary();
+  kernel->SetContext(ContextScheduler::Global().NewContext(kernel->target()));
+  // The first run also prepares the kernel, e.g. transforms the weights.
+  kernel->Launch();
+  float best = (std::numeric_limits<float>::max)();
+  for (int i = 0; i < kBenchmarkRepeats; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    kernel->Launch();
+    std::chrono::duration<float, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = (std::min)(best, elapsed.count());
+  }
+  return best;
+}
+
 }  // namespace mir
 }  // namespace lite
 }  // namespace paddle
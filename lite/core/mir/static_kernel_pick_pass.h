@@ -28,9 +28,12 @@ namespace mir {
 
 /*
  * StaticKernelPickPass is a simple strategy for picking the kernel for each
- * Operator using operator developer defined rule, there are many other tactics
- * such as considering IO or kernel execution latency and we will implement them
- * latter.
+ * Operator using operator developer defined rule. Among the kernels which are
+ * interchangeable with the best scored one, i.e. they declare the same
+ * precision and layout for every argument on compatible targets, the cheapest
+ * one is picked if their costs are known. The costs are measured by running
+ * the kernels on the real shapes if KERNEL_PICK_BENCHMARK is set, otherwise
+ * they are estimated by the kernels themselves.
  *
  * There are two argument for this pass:
  * - place, the target place.
@@ -214,6 +217,24 @@ class StaticKernelPickPass : public mir::StmtPass {
     return final_score;
   }
 
+  using ScoredKernels =
+      std::vector<std::pair<float, std::unique_ptr<KernelBase>>>;
+
+  // Move the cheapest kernel interchangeable with the front one to the front.
+  void PickByCost(SSAGraph* graph,
+                  Node* node,
+                  const std::map<std::string, PrecisionType>& in_types,
+                  ScoredKernels* scored);
+
+  // Allocate the float inputs and infer the output shapes of the op, so that
+  // its kernels can be timed. Returns false if any input shape is unknown.
+  bool PrepareBenchmark(Node* node,
+                        const std::map<std::string, PrecisionType>& in_types);
+
+  // Returns the best time of several runs in microseconds. Only the kernels
+  // running on host can be timed.
+  float MeasureKernel(KernelBase* kernel);
+
   // Compatible for PrecisionType.
   // For cuda, in the process of choosing kernel, fp16 and fp32 are compatiable.
   // If kernel's declared type is kAny, it is matched.
@@ -230,6 +251,7 @@ class StaticKernelPickPass : public mir::StmtPass {
 
  private:
   core::KernelPickFactor kernel_pick_factors_;
+  bool benchmark_{false};
 };
 
 }  // namespace mir
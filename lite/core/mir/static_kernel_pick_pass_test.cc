@@ -0,0 +1,108 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/mir/static_kernel_pick_pass.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "lite/core/mir/pass_registry.h"
+#include "lite/core/mir/pass_test_helper.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+TEST(StaticKernelPickPass, pick_cheaper_interchangeable_kernel) {
+  // The host kernels come first in the valid places, so they have the best
+  // scores, but the vectorized x86 relu and reduce_sum read and write the
+  // same types and are estimated to be cheaper.
+  ProgramBuilderForTest builder;
+  builder.AddVar("x", {1, 1024});
+  builder.AddVar("r", {1, 1024});
+  builder.AddVar("s", {1, 1});
+  builder.AddFeed("x", 0);
+  builder.AddOp("relu", {{"X", {"x"}}}, {{"Out", {"r"}}});
+  auto* reduce = builder.AddOp("reduce_sum", {{"X", {"r"}}}, {{"Out", {"s"}}});
+  reduce->SetAttr<std::vector<int>>("dim", {1});
+  reduce->SetAttr<bool>("keep_dim", true);
+  builder.AddFetch("s", 0);
+  auto graph = builder.BuildGraph({Place{TARGET(kHost), PRECISION(kFloat)},
+                                   Place{TARGET(kX86), PRECISION(kFloat)}});
+
+  for (auto* op_type : {"relu", "reduce_sum"}) {
+    auto& kernels = FindStmts(graph.get(), op_type).front()->AsStmt().kernels();
+    float host_cost = -1.f;
+    float x86_cost = -1.f;
+    for (auto& kernel : kernels) {
+      if (kernel->target() == TARGET(kHost)) host_cost = kernel->EstimateCost();
+      if (kernel->target() == TARGET(kX86)) x86_cost = kernel->EstimateCost();
+    }
+    EXPECT_GT(x86_cost, 0.f) << op_type;
+    EXPECT_GT(host_cost, x86_cost) << op_type;
+  }
+
+  auto* pass = PassManager::Global().LookUp("static_kernel_pick_pass");
+  ASSERT_TRUE(pass);
+  pass->Apply(graph);
+
+  for (auto* op_type : {"relu", "reduce_sum"}) {
+    auto& kernels = FindStmts(graph.get(), op_type).front()->AsStmt().kernels();
+    ASSERT_EQ(kernels.size(), 1u) << op_type;
+    EXPECT_EQ(kernels.front()->target(), TARGET(kX86)) << op_type;
+  }
+}
+
+TEST(StaticKernelPickPass, pick_host_kernel_for_small_tensor) {
+  // On a few elements, the per-call overhead of the x86 kernels outweighs
+  // their vectorized loops.
+  ProgramBuilderForTest builder;
+  builder.AddVar("x", {1, 16});
+  builder.AddVar("r", {1, 16});
+  builder.AddVar("s", {1, 1});
+  builder.AddFeed("x", 0);
+  builder.AddOp("relu", {{"X", {"x"}}}, {{"Out", {"r"}}});
+  auto* reduce = builder.AddOp("reduce_sum", {{"X", {"r"}}}, {{"Out", {"s"}}});
+  reduce->SetAttr<std::vector<int>>("dim", {1});
+  reduce->SetAttr<bool>("keep_dim", true);
+  builder.AddFetch("s", 0);
+  auto graph = builder.BuildGraph({Place{TARGET(kX86), PRECISION(kFloat)},
+                                   Place{TARGET(kHost), PRECISION(kFloat)}});
+
+  auto* pass = PassManager::Global().LookUp("static_kernel_pick_pass");
+  ASSERT_TRUE(pass);
+  pass->Apply(graph);
+
+  for (auto* op_type : {"relu", "reduce_sum"}) {
+    auto& kernels = FindStmts(graph.get(), op_type).front()->AsStmt().kernels();
+    ASSERT_EQ(kernels.size(), 1u) << op_type;
+    EXPECT_EQ(kernels.front()->target(), TARGET(kHost)) << op_type;
+  }
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(feed)
+USE_LITE_OP(fetch)
+USE_LITE_OP(relu)
+USE_LITE_OP(reduce_sum)
+USE_LITE_KERNEL(feed, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(fetch, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(relu, kHost, kFloat, kNCHW, def);
+USE_LITE_KERNEL(relu, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(reduce_sum, kHost, kFloat, kNCHW, def);
+USE_LITE_KERNEL(reduce_sum, kX86, kFloat, kNCHW, def);
+USE_MIR_PASS(static_kernel_pick_pass)
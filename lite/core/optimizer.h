@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #pragma once
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <map>
 #include <memory>
 #include <set>
@@ -84,7 +86,10 @@ class Optimizer {
     InitControlFlowOpSharedInputsAndOutputsPlaceSyncPass();
 
     std::vector<std::string> passes_local{
-        {"lite_quant_dequant_fuse_pass",             //
+        {// Remove the ops whose outputs never reach a fetch op, so that
+         // their readers don't block the fusions below.
+         "dead_code_elimination_pass",
+         "lite_quant_dequant_fuse_pass",             //
          "weight_quantization_preprocess_pass",      //
          "op_convertion_pass",                       //
          "remove_scale1_pass",                       //
@@ -147,6 +152,17 @@ class Optimizer {
          "__xpu__logit_fuse_pass",
          "__xpu__link_previous_out_max_pass",
          "ssd_boxes_calc_offline_pass",
+         // Merge the ops computing the same values.
+         "common_subexpression_elimination_pass",
+         // Evaluate the ops which only depend on weights and replace their
+         // outputs with weights.
+         "constant_folding_pass",
+         // Fuse the trees of elementwise and activation ops left by the
+         // passes above into fused_elementwise ops.
+         "lite_elementwise_chain_fuse_pass",
+         // Merge the fc and mul ops reading the same input into one wider
+         // GEMM followed by a split.
+         "lite_fc_horizontal_fuse_pass",
          // Only for fully quantized model, infer the output scale and fix the
          // attribute 'enable_int8' for all of the quantized ops.
          "quantized_op_attributes_inference_pass",
@@ -162,6 +178,7 @@ class Optimizer {
          "rknpu_subgraph_pass",
          "mlu_subgraph_pass",
          "control_flow_op_unused_inputs_and_outputs_eliminate_pass",
+         "layout_assignment_pass",   // choose the layouts over the graph
          "static_kernel_pick_pass",  // pick original kernel from graph
 
          "remove_tf_redundant_ops_pass",
@@ -207,6 +224,9 @@ class Optimizer {
          "argument_type_display_pass",
          "lite_inplace_fuse_pass",
 #if !(defined(LITE_WITH_FPGA) || defined(LITE_WITH_PRECISION_PROFILE))
+         // Order the ops to lower the peak of the live tensors, then reuse
+         // their memory.
+         "memory_aware_schedule_pass",
          "memory_optimize_pass"
 #endif
         }};
@@ -331,6 +351,8 @@ class Optimizer {
 
   // Specify the passes and run them.
   void RunPasses(const std::vector<std::string>& passes) {
+    // The total milliseconds spent in each pass.
+    std::map<std::string, float> pass_times;
     for (auto& x : passes) {
       LOG(INFO) << "== Running pass: " << x;
       mir::Pass* pass = mir::PassManager::Global().LookUp(x);
@@ -348,6 +370,7 @@ class Optimizer {
         LOG(INFO) << "   - Skip " << x
                   << " because the target or kernel does not match.";
       } else {
+        auto start = std::chrono::steady_clock::now();
         // Check the pass whether it is supported for processing subblocks
         if (kSubblockUnsupportedPasses.count(x)) {
           pass->Apply(graphs_[kRootBlockIdx]);
@@ -356,9 +379,28 @@ class Optimizer {
             pass->Apply(graph);
           }
         }
-        LOG(INFO) << "== Finished running: " << x;
+        std::chrono::duration<float, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        pass_times[x] += elapsed.count();
+        LOG(INFO) << "== Finished running: " << x << " in " << elapsed.count()
+                  << " ms";
       }
     }
+
+    float total = 0.f;
+    std::vector<std::pair<float, std::string>> slowest;
+    for (auto& t : pass_times) {
+      total += t.second;
+      slowest.emplace_back(t.second, t.first);
+    }
+    std::sort(slowest.rbegin(), slowest.rend());
+    LOG(INFO) << "== Ran " << pass_times.size() << " passes in " << total
+              << " ms, the slowest ones:";
+    const size_t kNumSlowest = 10;
+    for (size_t i = 0; i < slowest.size() && i < kNumSlowest; ++i) {
+      LOG(INFO) << "   - " << slowest[i].second << ": " << slowest[i].first
+                << " ms";
+    }
   }
 
  private:
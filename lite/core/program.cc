@@ -22,6 +22,7 @@
 #include "lite/operators/conditional_block_op.h"
 #include "lite/operators/subgraph_op.h"
 #include "lite/operators/while_op.h"
+#include "lite/utils/string.h"
 #ifdef LITE_WITH_PRECISION_PROFILE
 #include "lite/core/profile/precision_profiler.h"
 #endif
@@ -30,8 +31,96 @@ namespace paddle {
 namespace lite {
 
 #ifndef LITE_ON_TINY_PUBLISH
+namespace {
+
+// The instruction set in a tag "<target>/<kernel>/<isa>/<packing>/<version>".
+std::string PrepackedWeightsIsa(const std::string& tag) {
+  auto fields = Split(tag, "/");
+  return fields.size() == 5 ? fields[2] : tag;
+}
+
+// Don't save the weights which `kernel` packs if `op_desc` is their only
+// reader, the packed weights replace them and only their dims are kept. The
+// op can only be run by the kernels built for the same instruction set.
+void DropPackedSource(cpp::OpDesc* op_desc,
+                      const KernelBase* kernel,
+                      Scope* scope,
+                      cpp::BlockDesc* block_desc,
+                      const std::map<std::string, int>& num_readers) {
+  auto arg_name = kernel->PrepackedWeightsInput();
+  if (arg_name.empty() || !op_desc->HasInput(arg_name)) return;
+  auto sources = op_desc->Input(arg_name);
+  if (sources.size() != 1 || num_readers.at(sources.front()) != 1) return;
+  const auto& source = sources.front();
+  auto* var = scope->FindVar(source);
+  if (var == nullptr || !var->IsType<Tensor>()) return;
+  for (size_t i = 0; i < block_desc->VarsSize(); ++i) {
+    auto* v = block_desc->GetVar<cpp::VarDesc>(i);
+    if (v->Name() == source) v->SetPersistable(false);
+  }
+  op_desc->SetAttr<std::string>(kPrepackedWeightsSourceAttr, source);
+  op_desc->SetAttr<std::vector<int64_t>>(
+      kPrepackedWeightsSourceDimsAttr, var->Get<Tensor>().dims().Vectorize());
+  op_desc->SetAttr<std::string>(
+      kPrepackedWeightsIsaAttr,
+      PrepackedWeightsIsa(kernel->PrepackedWeightsTag()));
+  VLOG(3) << "Drop " << source << " replaced by its packed weights";
+}
+
+// Add the weights packed by `kernel` to `block_desc`, reusing the ones loaded
+// with the model if they are of the same tag.
+void SavePrepackedWeights(cpp::OpDesc* op_desc,
+                          const KernelBase* kernel,
+                          Scope* scope,
+                          cpp::BlockDesc* block_desc,
+                          bool save_prepacked_weights,
+                          bool drop_prepacked_sources,
+                          const std::map<std::string, int>& num_readers) {
+  auto tag = kernel->PrepackedWeightsTag();
+  if (tag.empty()) return;
+  std::string name;
+  if (op_desc->HasAttr(kPrepackedWeightsAttr) &&
+      op_desc->GetAttr<std::string>(kPrepackedWeightsTagAttr) == tag) {
+    name = op_desc->GetAttr<std::string>(kPrepackedWeightsAttr);
+  }
+  auto* var = name.empty() ? nullptr : scope->FindVar(name);
+  if (var == nullptr) {
+    if (!save_prepacked_weights) return;
+    auto prefix = op_desc->output_vars().front() + "@prepacked";
+    name = prefix;
+    for (int i = 1; scope->FindVar(name) != nullptr; ++i) {
+      name = prefix + "_" + std::to_string(i);
+    }
+    auto* packed = scope->NewTensor(name);
+    kernel->PackWeights(packed);
+    packed->set_persistable(true);
+    var = scope->FindVar(name);
+  }
+  auto& packed = var->Get<Tensor>();
+  CHECK(packed.precision() == PRECISION(kFloat))
+      << "Only the float weights can be prepacked, but got "
+      << PrecisionToStr(packed.precision()) << " for " << name;
+  auto* v = block_desc->AddVar<cpp::VarDesc>();
+  v->SetName(name);
+  v->SetType(cpp::VarDesc::Type::LOD_TENSOR);
+  v->SetPersistable(true);
+  v->SetShape(packed.dims().data());
+  v->SetDataType(VarDescAPI::VarDataType::FP32);
+  op_desc->SetAttr<std::string>(kPrepackedWeightsAttr, name);
+  op_desc->SetAttr<std::string>(kPrepackedWeightsTagAttr, tag);
+  VLOG(3) << "Save the weights of " << op_desc->Type() << " packed as " << tag
+          << " into " << name;
+  if (save_prepacked_weights && drop_prepacked_sources) {
+    DropPackedSource(op_desc, kernel, scope, block_desc, num_readers);
+  }
+}
+
+}  // namespace
+
 void RuntimeProgram::SaveToProgram(
-    std::shared_ptr<cpp::ProgramDesc> program_desc) {
+    std::shared_ptr<cpp::ProgramDesc> program_desc,
+    bool save_prepacked_weights,
+    bool drop_prepacked_sources) {
   LOG(INFO) << "Into SaveToProgram";
   CHECK(program_desc);
   auto block_size = program_desc->BlocksSize();
@@ -41,6 +130,16 @@ void RuntimeProgram::SaveToProgram(
   CHECK_LE(block_size, instructions_.size())
       << "Invalid block size, expected (0," << instructions_.size()
       << "] but got " << block_size;
+  // The ops of all blocks reading every var, the sub-blocks may read the
+  // weights of the main block.
+  std::map<std::string, int> num_readers;
+  for (auto& insts : instructions_) {
+    for (auto& inst : insts) {
+      for (auto& name : inst.op()->op_info()->input_names()) {
+        num_readers[name]++;
+      }
+    }
+  }
   for (size_t block_idx = 0; block_idx < block_size; ++block_idx) {
     auto block_desc = program_desc->GetBlock<cpp::BlockDesc>(block_idx);
     // Record all of the origin vars in the origin block
@@ -143,6 +242,16 @@ void RuntimeProgram::SaveToProgram(
       auto op_desc = block_desc->AddOp<cpp::OpDesc>();
       *op_desc = *op_info;
       op_desc->SetAttr(kKernelTypeAttr, kernel->SerializedKernelType());
+      // Only the persistable vars of the main block are saved with the model.
+      if (block_idx == kRootBlockIdx) {
+        SavePrepackedWeights(op_desc,
+                             kernel,
+                             scope,
+                             block_desc,
+                             save_prepacked_weights,
+                             drop_prepacked_sources,
+                             num_readers);
+      }
       if (op_type == "subgraph" && !op_info->GetAttr<int32_t>("sub_block")) {
         // It's a new subgraph op when its sub_block_idx = 0, Now we add its
         // subblock desc to the program desc, Then update its sub_block_idx to
@@ -323,7 +432,42 @@ void RuntimeProgram::SaveOutput() {
 }
 #endif
 
+void RuntimeProgram::set_runtime_stats(bool enabled) {
+  if (!enabled) {
+    stats_.reset();
+  } else if (!stats_) {
+    stats_.reset(new RuntimeStatsRecorder(instructions_[kRootBlockIdx].size()));
+  }
+}
+
+lite_api::RuntimeStats RuntimeProgram::GetRuntimeStats() const {
+  lite_api::RuntimeStats stats;
+  if (!stats_) return stats;
+  stats.enabled = true;
+  stats.run_latency = stats_->run.Summary();
+  auto& insts = instructions_[kRootBlockIdx];
+  for (size_t i = 0; i < insts.size(); ++i) {
+    lite_api::OpRuntimeStats op_stats;
+    op_stats.op_type = insts[i].op()->Type();
+    if (insts[i].kernel()) {
+      op_stats.kernel = insts[i].kernel()->name();
+    }
+    op_stats.latency = stats_->ops[i].Summary();
+    stats.ops.push_back(std::move(op_stats));
+  }
+  const auto memory = GetBufferMemoryStats();
+  stats.memory_bytes = memory.bytes;
+  stats.peak_memory_bytes = memory.peak_bytes;
+  stats.num_allocations = memory.num_allocs;
+  stats.num_frees = memory.num_frees;
+  return stats;
+}
+
 void RuntimeProgram::Run() {
+  RuntimeStatsRecorder* stats = stats_.get();
+  const uint64_t run_start_ns = stats ? SteadyNowNs() : 0;
+  const bool tracing = Tracer::Global().enabled();
+  TraceScope trace_run("run", "run");
 #ifdef LITE_WITH_PRECISION_PROFILE
   auto inst_precision_profiler = paddle::lite::profile::PrecisionProfiler();
   std::string precision_profiler_summary =
@@ -368,7 +512,20 @@ void RuntimeProgram::Run() {
     }
 #endif
 
-    inst.Run();
+    if (stats || tracing) {
+      const uint64_t start_ns = SteadyNowNs();
+      inst.Run();
+      const uint64_t end_ns = SteadyNowNs();
+      if (stats) {
+        stats->ops[idx].Add(end_ns - start_ns);
+      }
+      if (tracing) {
+        Tracer::Global().AddComplete(
+            "op", inst.op()->Type().c_str(), start_ns, end_ns, "idx", idx);
+      }
+    } else {
+      inst.Run();
+    }
 
 #ifdef LITE_WITH_PRECISION_PROFILE
 #ifndef LITE_WITH_FPGA
@@ -383,6 +540,9 @@ void RuntimeProgram::Run() {
 #ifdef LITE_WITH_METAL
   TargetWrapperMetal::WaitForCompleted();
 #endif
+  if (stats) {
+    stats->run.Add(SteadyNowNs() - run_start_ns);
+  }
 
 #ifdef LITE_WITH_PROFILE
   LOG(INFO) << "\n" << profiler_.Summary(profile::Type::kDispatch, false, 1);
@@ -544,6 +704,65 @@ void Instruction::SaveOutput() {
 }
 #endif
 
+void Instruction::AdoptPrepackedWeights() {
+  if (kernel_ == nullptr) return;
+  auto* op_info = op_->op_info();
+  if (!op_info->HasAttr(kPrepackedWeightsAttr)) return;
+  auto name = op_info->GetAttr<std::string>(kPrepackedWeightsAttr);
+  auto tag = op_info->GetAttr<std::string>(kPrepackedWeightsTagAttr);
+  std::string source;
+  if (op_info->HasAttr(kPrepackedWeightsSourceAttr)) {
+    // The original weights weren't saved, restore their dims, which the
+    // shape inference and the tag of the kernel depend on.
+    source = op_info->GetAttr<std::string>(kPrepackedWeightsSourceAttr);
+    auto* source_var = op_->scope()->FindVar(source);
+    CHECK(source_var) << "The weights " << source << " are not found";
+    auto* tensor = source_var->GetMutable<Tensor>();
+    if (tensor->dims().empty()) {
+      tensor->Resize(op_info->GetAttr<std::vector<int64_t>>(
+          kPrepackedWeightsSourceDimsAttr));
+      tensor->set_precision(PRECISION(kFloat));
+    }
+  }
+  auto* var = op_->scope()->FindVar(name);
+  if (var == nullptr || !var->IsType<Tensor>()) {
+    CHECK(source.empty()) << "The prepacked weights " << name << " of "
+                          << op_info->Type() << " are not found, and "
+                          << source << " wasn't saved with the model";
+    LOG(WARNING) << "The prepacked weights " << name << " of "
+                 << op_info->Type() << " are not found";
+    return;
+  }
+  if (kernel_->PrepackedWeightsTag() != tag) {
+    CHECK(source.empty()) << "The weights of " << op_info->Type()
+                          << " were packed as " << tag << ", which doesn't "
+                          << "match the kernel " << kernel_->name() << ", and "
+                          << source << " wasn't saved with the model, so it "
+                          << "must be run by a kernel built for "
+                          << op_info->GetAttr<std::string>(
+                                 kPrepackedWeightsIsaAttr);
+    VLOG(3) << "The weights of " << op_info->Type() << " were packed as "
+            << tag << ", which doesn't match the kernel " << kernel_->name()
+            << ", pack the original weights";
+    return;
+  }
+  kernel_->SetPrepackedWeights(var->Get<Tensor>());
+}
+
+void Instruction::FindOverwrittenOutputs() {
+  auto* op_info = op_->op_info();
+  if (is_feed_fetch_op_ || op_info->HasAttr("sub_block")) return;
+  auto inputs = op_info->input_names();
+  std::set<std::string> input_names(inputs.begin(), inputs.end());
+  for (auto& name : op_info->output_names()) {
+    if (input_names.count(name)) continue;
+    auto* var = op_->scope()->FindVar(name);
+    if (var != nullptr && var->IsType<Tensor>()) {
+      overwritten_outputs_.push_back(var->GetMutable<Tensor>());
+    }
+  }
+}
+
 void Instruction::Run() {
 #ifdef LITE_WITH_PROFILE
   CHECK(profiler_) << "Profiler pointer of kernel can not be nullptr. "
@@ -558,6 +777,7 @@ void Instruction::Run() {
   if (first_epoch_) {
     first_epoch_ = false;
     CHECK(op_->CheckShape());
+    FindOverwrittenOutputs();
   }
 
   if (op_->run_once() && has_run_) {
@@ -565,6 +785,9 @@ void Instruction::Run() {
   }
 
   op_->InferShape();
+  for (auto* out : overwritten_outputs_) {
+    out->DetachSharedBuffer(false);
+  }
   kernel_->Launch();
   has_run_ = true;
 
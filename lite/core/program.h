@@ -22,6 +22,7 @@
 #include "lite/core/kernel.h"
 #include "lite/core/op_lite.h"
 #include "lite/core/op_registry.h"
+#include "lite/core/runtime_stats.h"
 #include "lite/model_parser/cpp_desc.h"
 #ifdef LITE_WITH_PROFILE
 #include "lite/core/profile/profiler.h"
@@ -37,6 +38,20 @@ namespace paddle {
 namespace lite {
 
 static const char kKernelTypeAttr[] = "__@kernel_type_attr@__";
+// The persistable variable holding the weights packed by the kernel of an op,
+// and the tag of the kernel which packed them.
+static const char kPrepackedWeightsAttr[] = "__@prepacked_weights_attr@__";
+static const char kPrepackedWeightsTagAttr[] =
+    "__@prepacked_weights_tag_attr@__";
+// The weights replaced by the packed ones in the saved model, their dims,
+// which are restored for the shape inference, and the instruction set of the
+// kernels which can run the op without them.
+static const char kPrepackedWeightsSourceAttr[] =
+    "__@prepacked_weights_source_attr@__";
+static const char kPrepackedWeightsSourceDimsAttr[] =
+    "__@prepacked_weights_source_dims_attr@__";
+static const char kPrepackedWeightsIsaAttr[] =
+    "__@prepacked_weights_isa_attr@__";
 
 // A program is used to represent a code program, in Paddle, a code program
 // contains:
@@ -114,6 +129,7 @@ struct Instruction {
     if (op_type == "feed" || op_type == "fetch") {
       is_feed_fetch_op_ = true;
     }
+    AdoptPrepackedWeights();
   }
 
   // Run the instruction.
@@ -182,8 +198,18 @@ struct Instruction {
 #endif
 
  private:
+  // Hand the weights saved with the model to the kernel if it packs them the
+  // same way, otherwise the kernel packs the original weights as usual.
+  void AdoptPrepackedWeights();
+  // Find the output tensors which the op overwrites, i.e. the ones it doesn't
+  // read, unless it runs a sub-block which may leave them as they are.
+  void FindOverwrittenOutputs();
+
   std::shared_ptr<OpLite> op_;
   std::unique_ptr<KernelBase> kernel_;
+  // Detached from the buffers they share until write without copying them
+  // before every run.
+  std::vector<Tensor*> overwritten_outputs_;
   bool is_feed_fetch_op_{false};
   bool first_epoch_{true};
   bool has_run_{false};
@@ -253,16 +279,28 @@ class LITE_API RuntimeProgram {
 
   size_t block_size() { return instructions_.size(); }
 
+  // Record the latencies of the runs and of the instructions of the main
+  // block, see lite_api::ConfigBase::set_runtime_stats.
+  void set_runtime_stats(bool enabled);
+  lite_api::RuntimeStats GetRuntimeStats() const;
+
 #ifndef LITE_ON_TINY_PUBLISH
   // Update the ops and vars of all of blocks to the given program_desc
-  // according to the instructions
-  void SaveToProgram(std::shared_ptr<cpp::ProgramDesc> program_desc);
+  // according to the instructions. If `save_prepacked_weights` is true, the
+  // weights packed by the kernels of the main block are added to it as
+  // persistable variables, and if `drop_prepacked_sources` is true too, the
+  // weights they replace are left out, see
+  // CxxConfig::set_drop_prepacked_sources.
+  void SaveToProgram(std::shared_ptr<cpp::ProgramDesc> program_desc,
+                     bool save_prepacked_weights = false,
+                     bool drop_prepacked_sources = false);
 #endif
 
  private:
   RuntimeProgram(const RuntimeProgram&) = delete;
   std::vector<std::vector<Instruction>> instructions_;
   Scope* exec_scope_{};
+  std::unique_ptr<RuntimeStatsRecorder> stats_;
 
 #ifdef LITE_WITH_PROFILE
   profile::Profiler profiler_;
@@ -0,0 +1,72 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/runtime_stats.h"
+#include <limits>
+
+namespace paddle {
+namespace lite {
+
+constexpr int LatencyRecorder::kNumBuckets;
+
+namespace {
+
+int Log2Floor(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return 63 - __builtin_clzll(x);
+#else
+  int log2 = 0;
+  while (x >>= 1) ++log2;
+  return log2;
+#endif
+}
+
+double NsToMs(uint64_t ns) { return ns / 1e6; }
+
+}  // namespace
+
+int LatencyRecorder::BucketIndex(uint64_t ns) {
+  if (ns < (uint64_t(1) << kMinLog2)) return 0;
+  const int log2 = Log2Floor(ns);
+  if (log2 >= kMaxLog2) return kNumBuckets - 1;
+  // The bits after the leading one pick the bucket in the power of two.
+  const int sub = (ns >> (log2 - kSubBucketsLog2)) & (kSubBuckets - 1);
+  return 1 + (log2 - kMinLog2) * kSubBuckets + sub;
+}
+
+uint64_t LatencyRecorder::BucketBound(int index) {
+  if (index == 0) return uint64_t(1) << kMinLog2;
+  if (index == kNumBuckets - 1) return UINT64_MAX;
+  const int log2 = kMinLog2 + (index - 1) / kSubBuckets;
+  const uint64_t sub = (index - 1) % kSubBuckets + 1;
+  return (uint64_t(1) << log2) + (sub << (log2 - kSubBucketsLog2));
+}
+
+lite_api::LatencyHistogram LatencyRecorder::Summary() const {
+  lite_api::LatencyHistogram histogram;
+  histogram.count = count_;
+  histogram.total_ms = NsToMs(total_ns_);
+  histogram.min_ms = count_ > 0 ? NsToMs(min_ns_) : 0;
+  histogram.max_ms = NsToMs(max_ns_);
+  histogram.bucket_bounds_ms.resize(kNumBuckets);
+  for (int i = 0; i < kNumBuckets - 1; ++i) {
+    histogram.bucket_bounds_ms[i] = NsToMs(BucketBound(i));
+  }
+  histogram.bucket_bounds_ms.back() = std::numeric_limits<double>::infinity();
+  histogram.bucket_counts.assign(buckets_, buckets_ + kNumBuckets);
+  return histogram;
+}
+
+}  // namespace lite
+}  // namespace paddle
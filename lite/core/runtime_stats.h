@@ -0,0 +1,70 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "lite/api/paddle_api.h"
+#include "lite/utils/trace.h"
+
+namespace paddle {
+namespace lite {
+
+// Count latencies in fixed log-linear buckets, so that recording one is a
+// few integer ops and the memory doesn't grow with the number of runs,
+// unlike profile::TimeList. The first bucket counts the latencies below
+// 2^kMinLog2 ns, then every power of two up to 2^kMaxLog2 ns, about 69s, is
+// split into kSubBuckets buckets, and the last bucket counts the rest.
+class LatencyRecorder {
+ public:
+  static constexpr int kMinLog2 = 10;
+  static constexpr int kMaxLog2 = 36;
+  static constexpr int kSubBucketsLog2 = 2;
+  static constexpr int kSubBuckets = 1 << kSubBucketsLog2;
+  static constexpr int kNumBuckets = (kMaxLog2 - kMinLog2) * kSubBuckets + 2;
+
+  static int BucketIndex(uint64_t ns);
+  // The upper bound of the bucket `index` in ns, exclusive.
+  static uint64_t BucketBound(int index);
+
+  void Add(uint64_t ns) {
+    ++count_;
+    total_ns_ += ns;
+    min_ns_ = ns < min_ns_ ? ns : min_ns_;
+    max_ns_ = ns > max_ns_ ? ns : max_ns_;
+    ++buckets_[BucketIndex(ns)];
+  }
+
+  uint64_t count() const { return count_; }
+  lite_api::LatencyHistogram Summary() const;
+
+ private:
+  uint64_t count_{0};
+  uint64_t total_ns_{0};
+  uint64_t min_ns_{UINT64_MAX};
+  uint64_t max_ns_{0};
+  uint64_t buckets_[kNumBuckets]{};
+};
+
+// The latencies of the runs of a RuntimeProgram and of its instructions.
+struct RuntimeStatsRecorder {
+  explicit RuntimeStatsRecorder(size_t num_ops) : ops(num_ops) {}
+
+  LatencyRecorder run;
+  std::vector<LatencyRecorder> ops;
+};
+
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,56 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/runtime_stats.h"
+#include <gtest/gtest.h>
+
+namespace paddle {
+namespace lite {
+
+TEST(LatencyRecorder, buckets) {
+  EXPECT_EQ(LatencyRecorder::BucketIndex(0), 0);
+  EXPECT_EQ(LatencyRecorder::BucketIndex(1023), 0);
+  EXPECT_EQ(LatencyRecorder::BucketIndex(1024), 1);
+  EXPECT_EQ(LatencyRecorder::BucketIndex(UINT64_MAX),
+            LatencyRecorder::kNumBuckets - 1);
+  // Every latency falls below the bound of its bucket, and at or above the
+  // bound of the previous one.
+  for (uint64_t ns = 1; ns < (uint64_t(1) << 40); ns = ns * 5 / 4 + 1) {
+    const int index = LatencyRecorder::BucketIndex(ns);
+    EXPECT_LT(ns, LatencyRecorder::BucketBound(index));
+    if (index > 0) {
+      EXPECT_GE(ns, LatencyRecorder::BucketBound(index - 1));
+    }
+  }
+}
+
+TEST(LatencyRecorder, summary) {
+  LatencyRecorder recorder;
+  for (uint64_t us = 1; us <= 100; ++us) {
+    recorder.Add(us * 1000);
+  }
+  auto histogram = recorder.Summary();
+  EXPECT_EQ(histogram.count, 100u);
+  EXPECT_DOUBLE_EQ(histogram.total_ms, 5.05);
+  EXPECT_DOUBLE_EQ(histogram.min_ms, 0.001);
+  EXPECT_DOUBLE_EQ(histogram.max_ms, 0.1);
+  ASSERT_EQ(histogram.bucket_counts.size(),
+            static_cast<size_t>(LatencyRecorder::kNumBuckets));
+  uint64_t count = 0;
+  for (auto bucket_count : histogram.bucket_counts) count += bucket_count;
+  EXPECT_EQ(count, 100u);
+}
+
+}  // namespace lite
+}  // namespace paddle
@@ -15,12 +15,21 @@
 #ifndef LITE_WITH_FPGA
 
 #include "lite/core/tensor.h"
+#include <algorithm>
+#include <atomic>
 #include <string>
 #include "lite/utils/string.h"
 
 namespace paddle {
 namespace lite {
 
+namespace {
+
+// Relaxed atomics, since the counter doesn't order any other memory access.
+std::atomic<uint64_t> total_detached_bytes{0};
+
+}  // namespace
+
 void TensorLite::ShareDataWith(const TensorLite &other) {
   buffer_ = other.buffer_;
   dims_ = other.dims_;
@@ -29,9 +38,46 @@ void TensorLite::ShareDataWith(const TensorLite &other) {
   memory_size_ = other.memory_size_;
   precision_ = other.precision_;
   offset_ = other.offset_;
+  until_write_sharers_.reset();
+}
+
+void TensorLite::ShareDataUntilWrite(const TensorLite &other) {
+  if (!other.until_write_sharers_) {
+    other.until_write_sharers_ = std::make_shared<char>();
+  }
+  auto sharers = other.until_write_sharers_;
+  ShareDataWith(other);
+  until_write_sharers_ = sharers;
+}
+
+void TensorLite::DetachSharedBuffer(bool keep_data) {
+  if (!until_write_sharers_) return;
+  if (until_write_sharers_.use_count() > 1) {
+    auto buffer = std::make_shared<Buffer>();
+    size_t size = buffer_->space() > offset_
+                      ? std::min(memory_size_, buffer_->space() - offset_)
+                      : 0;
+    if (keep_data && size > 0) {
+      buffer->ResetLazy(buffer_->target(), size);
+      TargetCopy(buffer_->target(),
+                 buffer->data(),
+                 static_cast<char *>(buffer_->data()) + offset_,
+                 size);
+      total_detached_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    buffer_ = buffer;
+    offset_ = 0;
+  }
+  // The last sharer writes in place.
+  until_write_sharers_.reset();
+}
+
+uint64_t TensorLite::detached_bytes_copied() {
+  return total_detached_bytes.load(std::memory_order_relaxed);
 }
 
 void TensorLite::CopyDataFrom(const TensorLite &other) {
+  DetachSharedBuffer(false);
   dims_ = other.dims_;
   target_ = other.target_;
   lod_ = other.lod_;
@@ -42,6 +88,7 @@ void TensorLite::CopyDataFrom(const TensorLite &other) {
 }
 
 void *TensorLite::mutable_data(size_t memory_size) {
+  DetachSharedBuffer();
   memory_size_ = memory_size;
   buffer_->ResetLazy(target_, memory_size_);
   return buffer_->data();
@@ -63,6 +110,7 @@ void TensorLite::ResetBuffer(std::shared_ptr<Buffer> buffer,
         << "The buffer is smaller than the specified minimum size.";
   }
   buffer_ = buffer;
+  until_write_sharers_.reset();
   memory_size_ = memory_size;
   target_ = buffer->target();
 }
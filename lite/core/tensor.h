@@ -85,6 +85,7 @@ class TensorLite {
   // For other devices, T and R may be the same type.
   template <typename T, typename R = T>
   R *mutable_data() {
+    DetachSharedBuffer();
     precision_ = lite_api::PrecisionTypeTrait<T>::Type();
     memory_size_ = dims_.production() * sizeof(T);
     buffer_->ResetLazy(target_, memory_size_);
@@ -152,6 +153,7 @@ class TensorLite {
 
   template <typename T, typename R = T>
   R *mutable_data(TargetType target, size_t memory_size) {
+    DetachSharedBuffer();
     precision_ = lite_api::PrecisionTypeTrait<T>::Type();
     memory_size_ = memory_size;
     buffer_->ResetLazy(target, memory_size_);
@@ -174,7 +176,12 @@ class TensorLite {
   }
 
   void clear() {
-    buffer_->Free();
+    if (until_write_sharers_.use_count() > 1) {
+      buffer_ = std::make_shared<Buffer>();
+    } else {
+      buffer_->Free();
+    }
+    until_write_sharers_.reset();
     offset_ = 0;
   }
   size_t data_size() const { return this->dims().production(); }
@@ -188,6 +195,22 @@ class TensorLite {
   // Other share data to this.
   void ShareDataWith(const TensorLite &other);
 
+  // Like ShareDataWith, but whichever of the sharing tensors is written next
+  // through mutable_data() or CopyDataFrom() moves to a copy of the buffer of
+  // its own, so the others keep their data. Tensors aliasing the buffer
+  // through ShareDataWith are not protected this way.
+  void ShareDataUntilWrite(const TensorLite &other);
+
+  // Before a write, moves this tensor to a buffer of its own if the current
+  // one is still shared through ShareDataUntilWrite. The contents are copied
+  // over unless keep_data is false, as kernels may read an input through
+  // mutable_data() or write an output in place. The outputs which are
+  // overwritten as a whole are detached without copying before their ops run.
+  void DetachSharedBuffer(bool keep_data = true);
+
+  // The bytes copied so far to detach tensors from their shared buffers.
+  static uint64_t detached_bytes_copied();
+
   void CopyDataFrom(const TensorLite &other);
 
   void ResetBuffer(std::shared_ptr<Buffer> buffer, size_t memory_size);
@@ -224,6 +247,10 @@ class TensorLite {
 
   /// @brief Buffer may be shared with other tensors
   size_t offset_{0};
+
+  // Held by each tensor sharing buffer_ through ShareDataUntilWrite, so its
+  // use count is the number of them. Reset whenever buffer_ is replaced.
+  mutable std::shared_ptr<char> until_write_sharers_;
 };
 
 template <typename T>
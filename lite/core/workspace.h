@@ -17,6 +17,7 @@
 #include "lite/core/memory.h"
 #include "lite/core/types.h"
 #include "lite/utils/macros.h"
+#include "lite/utils/trace.h"
 
 namespace paddle {
 namespace lite {
@@ -46,6 +47,7 @@ class WorkSpace {
     buffer_.ResetLazy(target_, cursor_ + size);
     auto* data = static_cast<core::byte_t*>(buffer_.data()) + cursor_;
     cursor_ += size;
+    Tracer::Global().AddCounter("memory", "workspace", "bytes", cursor_);
     return data;
   }
 
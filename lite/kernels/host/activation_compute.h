@@ -22,12 +22,24 @@ namespace lite {
 namespace kernels {
 namespace host {
 
+// The estimated nanoseconds per element of the scalar loops of the
+// activations, for the cheap ones and the ones computing exp, tanh or sqrt, and
+// per run.
+const float kCheapActivationCost = 1.f;
+const float kMathActivationCost = 8.f;
+const float kActivationCallCost = 50.f;
+
 class ReluCompute : public KernelLite<TARGET(kHost), PRECISION(kFloat)> {
  public:
   using param_t = operators::ActivationParam;
 
   void Run() override;
 
+  float EstimateCost() const override {
+    return ElementwiseCost(
+        Param<param_t>().X->dims(), kCheapActivationCost, kActivationCallCost);
+  }
+
   virtual ~ReluCompute() = default;
 };
 
@@ -37,6 +49,11 @@ class LeakyReluCompute : public KernelLite<TARGET(kHost), PRECISION(kFloat)> {
 
   void Run() override;
 
+  float EstimateCost() const override {
+    return ElementwiseCost(
+        Param<param_t>().X->dims(), kCheapActivationCost, kActivationCallCost);
+  }
+
   virtual ~LeakyReluCompute() = default;
 };
 
@@ -64,6 +81,11 @@ class SigmoidCompute : public KernelLite<TARGET(kHost), PRECISION(kFloat)> {
 
   void Run() override;
 
+  float EstimateCost() const override {
+    return ElementwiseCost(
+        Param<param_t>().X->dims(), kMathActivationCost, kActivationCallCost);
+  }
+
   virtual ~SigmoidCompute() = default;
 };
 
@@ -73,6 +95,11 @@ class TanhCompute : public KernelLite<TARGET(kHost), PRECISION(kFloat)> {
 
   void Run() override;
 
+  float EstimateCost() const override {
+    return ElementwiseCost(
+        Param<param_t>().X->dims(), kMathActivationCost, kActivationCallCost);
+  }
+
   virtual ~TanhCompute() = default;
 };
 
@@ -91,6 +118,11 @@ class Relu6Compute : public KernelLite<TARGET(kHost), PRECISION(kFloat)> {
 
   void Run() override;
 
+  float EstimateCost() const override {
+    return ElementwiseCost(
+        Param<param_t>().X->dims(), kCheapActivationCost, kActivationCallCost);
+  }
+
   virtual ~Relu6Compute() = default;
 };
 
@@ -136,6 +168,11 @@ class RsqrtCompute : public KernelLite<TARGET(kHost), PRECISION(kFloat)> {
 
   void Run() override;
 
+  float EstimateCost() const override {
+    return ElementwiseCost(
+        Param<param_t>().X->dims(), kMathActivationCost, kActivationCallCost);
+  }
+
   virtual ~RsqrtCompute() = default;
 };
 
@@ -145,6 +182,11 @@ class SquareCompute : public KernelLite<TARGET(kHost), PRECISION(kFloat)> {
 
   void Run() override;
 
+  float EstimateCost() const override {
+    return ElementwiseCost(
+        Param<param_t>().X->dims(), kCheapActivationCost, kActivationCallCost);
+  }
+
   virtual ~SquareCompute() = default;
 };
 
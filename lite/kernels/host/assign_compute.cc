@@ -25,7 +25,7 @@ void AssignCompute::Run() {
     if (param.X == param.Out) {
       return;
     }
-    param.Out->CopyDataFrom(*param.X);
+    param.Out->ShareDataUntilWrite(*param.X);
   } else if (param.X_array != nullptr) {
     if (param.X_array == param.Out_array) {
       return;
@@ -34,7 +34,7 @@ void AssignCompute::Run() {
     auto out_array = param.Out_array;
     out_array->resize(x_array->size());
     for (size_t i = 0; i < x_array->size(); i++) {
-      out_array->at(i).CopyDataFrom(x_array->at(i));
+      out_array->at(i).ShareDataUntilWrite(x_array->at(i));
     }
   } else {
     LOG(FATAL) << "x or x_array of assign must be set.";
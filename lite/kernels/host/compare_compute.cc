@@ -14,6 +14,12 @@
 
 #include "lite/kernels/host/compare_compute.h"
 #include <math.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
 #include <vector>
 
 namespace paddle {
@@ -74,20 +80,152 @@ inline void get_mid_dims(const lite::DDim &x_dims,
   }
 }
 
+// Elements compared per task when running in parallel.
+static const int64_t kCompareChunk = 16384;
+
+// Vectorized compares turn lanes into 0/-1 masks which are narrowed to the
+// 0/1 bytes of the bool output, 16 elements at a time.
+template <typename Functor>
+struct SseCompare {
+  static const bool value = false;
+};
+
+#ifdef __SSE2__
+// Smallest float not below 1e-8, so that comparing |a - b| in float gives the
+// same result as the double comparison of _EqualFunctor<float>.
+static const float kFloatEqualEps =
+    static_cast<double>(1e-8f) < 1e-8 ? std::nextafter(1e-8f, 1.f) : 1e-8f;
+
+inline __m128i sse_float_equal(__m128 a, __m128 b) {
+  __m128 diff = _mm_andnot_ps(_mm_set1_ps(-0.f), _mm_sub_ps(a, b));
+  return _mm_castps_si128(_mm_cmplt_ps(diff, _mm_set1_ps(kFloatEqualEps)));
+}
+
+inline __m128i sse_not(__m128i a) {
+  return _mm_xor_si128(a, _mm_set1_epi32(-1));
+}
+
+#define SSE_COMPARE(functor, type, vtype, expr)   \
+  template <>                                     \
+  struct SseCompare<functor<type>> {              \
+    static const bool value = true;               \
+    static inline __m128i Cmp(vtype a, vtype b) { \
+      return expr;                                \
+    }                                             \
+  };
+
+SSE_COMPARE(_EqualFunctor, float, __m128, sse_float_equal(a, b));
+SSE_COMPARE(_NotEqualFunctor, float, __m128, sse_not(sse_float_equal(a, b)));
+SSE_COMPARE(_LessThanFunctor,
+            float,
+            __m128,
+            _mm_castps_si128(_mm_cmplt_ps(a, b)));
+SSE_COMPARE(_LessEqualFunctor,
+            float,
+            __m128,
+            _mm_castps_si128(_mm_cmple_ps(a, b)));
+SSE_COMPARE(_GreaterThanFunctor,
+            float,
+            __m128,
+            _mm_castps_si128(_mm_cmpgt_ps(a, b)));
+SSE_COMPARE(_GreaterEqualFunctor,
+            float,
+            __m128,
+            _mm_castps_si128(_mm_cmpge_ps(a, b)));
+SSE_COMPARE(_EqualFunctor, int32_t, __m128i, _mm_cmpeq_epi32(a, b));
+SSE_COMPARE(_NotEqualFunctor, int32_t, __m128i, sse_not(_mm_cmpeq_epi32(a, b)));
+SSE_COMPARE(_LessThanFunctor, int32_t, __m128i, _mm_cmplt_epi32(a, b));
+SSE_COMPARE(_LessEqualFunctor,
+            int32_t,
+            __m128i,
+            sse_not(_mm_cmpgt_epi32(a, b)));
+SSE_COMPARE(_GreaterThanFunctor, int32_t, __m128i, _mm_cmpgt_epi32(a, b));
+SSE_COMPARE(_GreaterEqualFunctor,
+            int32_t,
+            __m128i,
+            sse_not(_mm_cmplt_epi32(a, b)));
+#undef SSE_COMPARE
+
+inline __m128 sse_load(const float* x) { return _mm_loadu_ps(x); }
+inline __m128i sse_load(const int32_t* x) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(x));
+}
+inline __m128 sse_set1(float x) { return _mm_set1_ps(x); }
+inline __m128i sse_set1(int32_t x) { return _mm_set1_epi32(x); }
+
+template <typename Functor, typename T>
+int64_t compare_row_simd(const T* x,
+                         const T* y,
+                         bool broadcast,
+                         bool* z,
+                         int64_t size,
+                         std::true_type) {
+  typedef SseCompare<Functor> Op;
+  auto vy = sse_set1(y[0]);
+  int64_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m128i c0 = Op::Cmp(sse_load(x + i), broadcast ? vy : sse_load(y + i));
+    __m128i c1 =
+        Op::Cmp(sse_load(x + i + 4), broadcast ? vy : sse_load(y + i + 4));
+    __m128i c2 =
+        Op::Cmp(sse_load(x + i + 8), broadcast ? vy : sse_load(y + i + 8));
+    __m128i c3 =
+        Op::Cmp(sse_load(x + i + 12), broadcast ? vy : sse_load(y + i + 12));
+    __m128i bytes = _mm_packs_epi16(_mm_packs_epi32(c0, c1),
+                                    _mm_packs_epi32(c2, c3));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(z + i),
+                     _mm_and_si128(bytes, _mm_set1_epi8(1)));
+  }
+  return i;
+}
+#endif
+
+template <typename Functor, typename T>
+int64_t compare_row_simd(const T* x,
+                         const T* y,
+                         bool broadcast,
+                         bool* z,
+                         int64_t size,
+                         std::false_type) {
+  return 0;
+}
+
+// Writes Functor(x[i], y[i]), or Functor(x[i], y[0]) when broadcast.
+template <typename Functor, typename T>
+void compare_row(
+    const T* x, const T* y, bool broadcast, bool* z, int64_t size) {
+  int64_t i = compare_row_simd<Functor>(
+      x,
+      y,
+      broadcast,
+      z,
+      size,
+      std::integral_constant<bool, SseCompare<Functor>::value>());
+  Functor functor;
+  for (; i < size; ++i) {
+    z[i] = functor(x[i], broadcast ? y[0] : y[i]);
+  }
+}
+
 template <PrecisionType PType, typename CompareFunctor>
 void CompareCompute<PType, CompareFunctor>::Run() {
   auto &param = this->template Param<operators::CompareParam>();
   using DType = typename CompareFunctor::TYPE;
-  const size_t x_size = param.X->numel();
-  const size_t y_size = param.Y->numel();
+  const int64_t x_size = param.X->numel();
+  const int64_t y_size = param.Y->numel();
   auto x_dims = param.X->dims();
   auto y_dims = param.Y->dims();
   bool *z = param.Out->template mutable_data<bool>();
   const auto *x = param.X->template data<DType>();
   const auto *y = param.Y->template data<DType>();
   if (x_size == y_size) {
-    for (int i = 0; i < x_size; ++i) {
-      z[i] = CompareFunctor()(x[i], y[i]);
+    int64_t chunks = (x_size + kCompareChunk - 1) / kCompareChunk;
+#pragma omp parallel for if (chunks > 1)
+    for (int64_t c = 0; c < chunks; ++c) {
+      int64_t begin = c * kCompareChunk;
+      int64_t size = std::min(kCompareChunk, x_size - begin);
+      compare_row<CompareFunctor>(
+          x + begin, y + begin, false, z + begin, size);
     }
   } else {
     int axis = (param.axis == -1 ? x_dims.size() - y_dims.size() : param.axis);
@@ -98,14 +236,13 @@ void CompareCompute<PType, CompareFunctor>::Run() {
     }
     int outer_num, mid_num, inner_num;
     get_mid_dims(x_dims, y_dims, axis, &outer_num, &mid_num, &inner_num);
-    for (int outer_id = 0; outer_id < outer_num; ++outer_id) {
-      for (int mid_id = 0; mid_id < mid_num; ++mid_id) {
-        auto y_data = y[mid_id];
-        for (int inner_id = 0; inner_id < inner_num; ++inner_id) {
-          int index = (outer_id * mid_num + mid_id) * inner_num + inner_id;
-          z[index] = CompareFunctor()(x[index], y_data);
-        }
-      }
+    // Every (outer, mid) row compares inner_num elements against one y.
+    int64_t rows = static_cast<int64_t>(outer_num) * mid_num;
+#pragma omp parallel for if (x_size > kCompareChunk)
+    for (int64_t row = 0; row < rows; ++row) {
+      int64_t offset = row * inner_num;
+      compare_row<CompareFunctor>(
+          x + offset, y + row % mid_num, true, z + offset, inner_num);
     }
   }
 }
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "lite/kernels/host/cumsum_compute.h"
+#include "lite/backends/host/math/reduce.h"
 
 namespace paddle {
 namespace lite {
@@ -29,30 +30,17 @@ void CumsumCompute<T, PType>::Run() {
   const T* x_data = x->template data<T>();
   T* out_data = out->template mutable_data<T>();
 
-  if (param.flatten || x_dims.size() == 1) {
-    int64_t x_size = x->numel();
-    out_data[0] = x_data[0];
-    for (int64_t i = 1; i < x_size; i++) {
-      out_data[i] = x_data[i] + out_data[i - 1];
-    }
-  } else {
+  int64_t outer = 1;
+  int64_t count = x->numel();
+  int64_t inner = 1;
+  if (!param.flatten && x_dims.size() > 1) {
     int axis = param.axis < 0 ? param.axis + x_dims.size() : param.axis;
-    int64_t pre = x_dims.count(0, axis);
-    int64_t count = x_dims[axis];
-    int64_t post = x_dims.count(axis + 1, x_dims.size());
-
-    for (int64_t i = 0; i < pre; i++) {
-      for (int64_t j = 0; j < post; j++) {
-        int64_t step = i * count * post + j;
-        const T* src = x_data + step;
-        T* dst = out_data + step;
-        dst[0] = src[0];
-        for (int64_t k = 1; k < count; k++) {
-          dst[k * post] = src[k * post] + dst[(k - 1) * post];
-        }
-      }
-    }
+    outer = x_dims.count(0, axis);
+    count = x_dims[axis];
+    inner = x_dims.count(axis + 1, x_dims.size());
   }
+  lite::host::math::cumsum<T>(
+      x_data, out_data, outer, count, inner, param.exclusive, param.reverse);
 
   return;
 }
@@ -0,0 +1,65 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include "lite/core/op_registry.h"
+#include "lite/kernels/host/assign_compute.h"
+#include "lite/kernels/host/fill_constant_compute.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace host {
+
+// fill_constant reads its ValueTensor through mutable_data(), which must not
+// lose the value when the tensor is shared with the output of an assign.
+TEST(fill_constant, value_tensor_assigned) {
+  lite::Tensor value, assigned;
+  value.Resize({1});
+  value.mutable_data<float>()[0] = 3.5f;
+
+  AssignCompute assign;
+  operators::AssignParam assign_param;
+  assign_param.X = &value;
+  assign_param.Out = &assigned;
+  assign.SetParam(assign_param);
+  assign.PrepareForRun();
+  assign.Run();
+
+  for (auto* value_tensor : {&assigned, &value}) {
+    lite::Tensor out;
+    out.Resize({3, 7});
+    FillConstantCompute fill_constant;
+    operators::FillConstantParam param;
+    param.dtype = static_cast<int32_t>(lite::core::FluidType::FP32);
+    param.value_tensor = value_tensor;
+    param.out = &out;
+    fill_constant.SetParam(param);
+    fill_constant.PrepareForRun();
+    fill_constant.Run();
+    for (int i = 0; i < out.numel(); i++) {
+      EXPECT_EQ(out.data<float>()[i], 3.5f);
+    }
+  }
+  EXPECT_EQ(value.data<float>()[0], 3.5f);
+  EXPECT_EQ(assigned.data<float>()[0], 3.5f);
+}
+
+}  // namespace host
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_KERNEL(assign, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(fill_constant, kHost, kAny, kNCHW, def);
@@ -21,7 +21,7 @@ namespace host {
 
 void LodResetCompute::Run() {
   auto& param = this->Param<param_t>();
-  param.Out->CopyDataFrom(*param.X);
+  param.Out->ShareDataUntilWrite(*param.X);
   auto lod = param.Out->mutable_lod();
   if (param.Y) {
     if (param.Y->lod().size()) {
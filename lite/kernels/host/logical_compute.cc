@@ -13,53 +13,106 @@
 // limitations under the License.
 
 #include "lite/kernels/host/logical_compute.h"
+#include <stdint.h>
+#include <algorithm>
+#include <cstring>
 
 namespace paddle {
 namespace lite {
 namespace kernels {
 namespace host {
 
-#define LOGICAL_FUNCTOR(name, op)                                \
-  struct _##name##Functor {                                      \
-    inline bool operator()(const bool& a, const bool& b) const { \
-      return a op b;                                             \
-    }                                                            \
-  };
+// Bools are 0/1 bytes, so the functors also apply bitwise to 8 bools packed
+// in a uint64_t.
+struct _LogicalAndFunctor {
+  inline bool operator()(const bool& a, const bool& b) const { return a && b; }
+  inline uint64_t operator()(uint64_t a, uint64_t b) const { return a & b; }
+};
 
-LOGICAL_FUNCTOR(LogicalAnd, &&);
-LOGICAL_FUNCTOR(LogicalOr, ||);
+struct _LogicalOrFunctor {
+  inline bool operator()(const bool& a, const bool& b) const { return a || b; }
+  inline uint64_t operator()(uint64_t a, uint64_t b) const { return a | b; }
+};
 
 struct _LogicalXorFunctor {
   inline bool operator()(const bool& a, const bool& b) const {
     return (a || b) && !(a && b);
   }
+  inline uint64_t operator()(uint64_t a, uint64_t b) const { return a ^ b; }
 };
 
 struct _LogicalNotFunctor {
   inline bool operator()(const bool& a) const { return !a; }
+  inline uint64_t operator()(uint64_t a) const {
+    return a ^ 0x0101010101010101ULL;
+  }
 };
 
+// Bools processed per task when running in parallel.
+static const int64_t kLogicalChunk = 65536;
+
+template <class Functor>
+void logical_bytes(const bool* x, const bool* y, bool* z, int64_t size) {
+  Functor functor;
+  int64_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t a, b;
+    std::memcpy(&a, x + i, 8);
+    std::memcpy(&b, y + i, 8);
+    uint64_t c = functor(a, b);
+    std::memcpy(z + i, &c, 8);
+  }
+  for (; i < size; ++i) {
+    z[i] = functor(x[i], y[i]);
+  }
+}
+
+template <class Functor>
+void logical_bytes(const bool* x, bool* z, int64_t size) {
+  Functor functor;
+  int64_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t a;
+    std::memcpy(&a, x + i, 8);
+    uint64_t c = functor(a);
+    std::memcpy(z + i, &c, 8);
+  }
+  for (; i < size; ++i) {
+    z[i] = functor(x[i]);
+  }
+}
+
 template <class Functor>
 // template<typename Functor>
 void BinaryLogicalCompute<Functor>::Run() {
   auto& param = this->Param<operators::LogicalParam>();
-  const size_t count = param.X->numel();
+  const int64_t count = param.X->numel();
   bool* z = param.Out->template mutable_data<bool>();
   const bool* x = param.X->template data<bool>();
   const bool* y = param.Y->template data<bool>();
-  for (size_t i = 0; i < count; ++i) {
-    z[i] = Functor()(x[i], y[i]);
+  int64_t chunks = (count + kLogicalChunk - 1) / kLogicalChunk;
+#pragma omp parallel for if (chunks > 1)
+  for (int64_t c = 0; c < chunks; ++c) {
+    int64_t begin = c * kLogicalChunk;
+    logical_bytes<Functor>(x + begin,
+                           y + begin,
+                           z + begin,
+                           std::min(kLogicalChunk, count - begin));
   }
 }
 
 template <class Functor>
 void UnaryLogicalCompute<Functor>::Run() {
   auto& param = this->Param<operators::LogicalParam>();
-  const size_t count = param.X->numel();
+  const int64_t count = param.X->numel();
   bool* z = param.Out->template mutable_data<bool>();
   const auto x = param.X->template data<bool>();
-  for (size_t i = 0; i < count; ++i) {
-    z[i] = Functor()(x[i]);
+  int64_t chunks = (count + kLogicalChunk - 1) / kLogicalChunk;
+#pragma omp parallel for if (chunks > 1)
+  for (int64_t c = 0; c < chunks; ++c) {
+    int64_t begin = c * kLogicalChunk;
+    logical_bytes<Functor>(
+        x + begin, z + begin, std::min(kLogicalChunk, count - begin));
   }
 }
 
@@ -27,8 +27,7 @@ void ReadFromArrayCompute::Run() {
   int in_num = param.X->size();
   CHECK_LE(id, in_num) << "id is not valid";
 
-  param.Out->Resize((*param.X)[id].dims());
-  param.Out->CopyDataFrom((*param.X)[id]);
+  param.Out->ShareDataUntilWrite((*param.X)[id]);
 }
 
 }  // namespace host
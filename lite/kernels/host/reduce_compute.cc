@@ -13,8 +13,6 @@
 // limitations under the License.
 
 #include "lite/kernels/host/reduce_compute.h"
-#include <set>
-#include <string>
 #include <vector>
 #include "lite/backends/host/math/reduce.h"
 
@@ -32,76 +30,26 @@ void ReduceCompute<T, Functor>::Run() {
   T* output = param.Out->template mutable_data<T>();
 
   std::vector<int> dim = param.dim;
-  bool reduce_all = param.reduce_all;
-
-  if (!dim.empty()) {
-    for (size_t i = 0; i < dim.size(); i++) {
-      if (dim[i] < 0) {
-        dim[i] += x_rank;
-      }
-    }
-  }
-
-  std::set<int> dims_set(dim.begin(), dim.end());
-  bool full_dim = true;
-  for (int i = 0; i < static_cast<int>(x_dims.size()); i++) {
-    if (dims_set.find(i) == dims_set.end()) {
-      full_dim = false;
-      break;
+  if (param.reduce_all || dim.empty()) {
+    dim.resize(x_rank);
+    for (int i = 0; i < x_rank; i++) {
+      dim[i] = i;
     }
   }
-  reduce_all = (reduce_all || full_dim);
+  lite::host::math::reduce_dims<T, Functor>(
+      input, output, x_dims.Vectorize(), dim);
+}
 
-  if (reduce_all) {
-    lite::host::math::reduce_all<T, Functor>(
-        input, output, x_dims.production());
-  } else {
-    // TODO(zhiqiang, juncai): update according to Paddle
-    int new_dims[] = {1, 1, 1, 1};
-    for (size_t j = 0; j < x_dims.size(); ++j) {
-      new_dims[j] = static_cast<int>(x_dims[j]);
-    }
-    int n_in = new_dims[0];
-    int c_in = new_dims[1];
-    int h_in = new_dims[2];
-    int w_in = new_dims[3];
-    if (dim.size() == 1) {
-      switch (dim[0]) {
-        case 0:
-          lite::host::math::reduce_n<T, Functor>(
-              input, output, n_in, c_in, h_in, w_in);
-          break;
-        case 1:
-          lite::host::math::reduce_c<T, Functor>(
-              input, output, n_in, c_in, h_in, w_in);
-          break;
-        case 2:
-          lite::host::math::reduce_h<T, Functor>(
-              input, output, n_in, c_in, h_in, w_in);
-          break;
-        case 3:
-          lite::host::math::reduce_w<T, Functor>(
-              input, output, n_in, c_in, h_in, w_in);
-          break;
-        default:
-          LOG(FATAL) << "not support reduce dim == " << dim[0];
-      }
-    } else if (dim.size() == 2) {
-      if (dim[0] == 0 && dim[1] == 1) {
-        lite::host::math::reduce_nc<T, Functor>(
-            input, output, n_in, c_in, h_in, w_in);
-      } else if (dim[0] == 1 && dim[1] == 2) {
-        lite::host::math::reduce_ch<T, Functor>(
-            input, output, n_in, c_in, h_in, w_in);
-      } else if (dim[0] == 2 && dim[1] == 3) {
-        lite::host::math::reduce_hw<T, Functor>(
-            input, output, n_in, c_in, h_in, w_in);
-      } else {
-        LOG(FATAL) << "invalid dim!!";
-      }
-    } else {
-      LOG(FATAL) << "dim's size over than 2, which is not supported now!!";
-    }
+template <typename T>
+void ReduceMeanCompute<T>::Run() {
+  auto& param = this->template Param<operators::ReduceParam>();
+  CHECK_GT(param.X->numel(), 0) << "The input of reduce_mean is empty.";
+  ReduceCompute<T, lite::host::math::Sum>::Run();
+  T* output = param.Out->template mutable_data<T>();
+  int64_t out_size = param.Out->numel();
+  T scale = static_cast<T>(out_size) / static_cast<T>(param.X->numel());
+  for (int64_t i = 0; i < out_size; i++) {
+    output[i] *= scale;
   }
 }
 
@@ -123,3 +71,36 @@ REGISTER_LITE_KERNEL(reduce_any, kHost, kFloat, kNCHW, ReduceAny, def)
     .BindInput("X", {LiteType::GetTensorTy(TARGET(kHost), PRECISION(kBool))})
     .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kHost), PRECISION(kBool))})
     .Finalize();
+
+using ReduceSumFloat32 = paddle::lite::kernels::host::
+    ReduceCompute<float, paddle::lite::host::math::Sum>;
+REGISTER_LITE_KERNEL(reduce_sum, kHost, kFloat, kNCHW, ReduceSumFloat32, def)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kHost), PRECISION(kFloat))})
+    .BindOutput("Out",
+                {LiteType::GetTensorTy(TARGET(kHost), PRECISION(kFloat))})
+    .Finalize();
+
+using ReduceProdFloat32 = paddle::lite::kernels::host::
+    ReduceCompute<float, paddle::lite::host::math::Prod>;
+REGISTER_LITE_KERNEL(
+    reduce_prod, kHost, kFloat, kNCHW, ReduceProdFloat32, def)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kHost), PRECISION(kFloat))})
+    .BindOutput("Out",
+                {LiteType::GetTensorTy(TARGET(kHost), PRECISION(kFloat))})
+    .Finalize();
+
+using ReduceMaxFloat32 = paddle::lite::kernels::host::
+    ReduceCompute<float, paddle::lite::host::math::Max>;
+REGISTER_LITE_KERNEL(reduce_max, kHost, kFloat, kNCHW, ReduceMaxFloat32, def)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kHost), PRECISION(kFloat))})
+    .BindOutput("Out",
+                {LiteType::GetTensorTy(TARGET(kHost), PRECISION(kFloat))})
+    .Finalize();
+
+using ReduceMeanFloat32 = paddle::lite::kernels::host::ReduceMeanCompute<float>;
+REGISTER_LITE_KERNEL(
+    reduce_mean, kHost, kFloat, kNCHW, ReduceMeanFloat32, def)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kHost), PRECISION(kFloat))})
+    .BindOutput("Out",
+                {LiteType::GetTensorTy(TARGET(kHost), PRECISION(kFloat))})
+    .Finalize();
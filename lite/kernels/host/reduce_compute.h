@@ -15,6 +15,7 @@
 #pragma once
 #include <stdint.h>
 #include "lite/core/kernel.h"
+#include "lite/backends/host/math/reduce.h"
 #include "lite/core/op_registry.h"
 
 namespace paddle {
@@ -27,11 +28,26 @@ class ReduceCompute : public KernelLite<TARGET(kHost), PRECISION(kFloat)> {
  public:
   void Run() override;
 
+  // The scalar loop of reduce_dims costs about 2 ns per input element, plus
+  // about 50 ns per run.
+  float EstimateCost() const override {
+    return ElementwiseCost(
+        Param<operators::ReduceParam>().X->dims(), 2.f, 50.f);
+  }
+
   virtual ~ReduceCompute() = default;
 
  private:
 };
 
+template <typename T>
+class ReduceMeanCompute : public ReduceCompute<T, lite::host::math::Sum> {
+ public:
+  void Run() override;
+
+  virtual ~ReduceMeanCompute() = default;
+};
+
 }  // namespace host
 }  // namespace kernels
 }  // namespace lite
@@ -21,7 +21,7 @@ namespace host {
 
 void SelectInputCompute::Run() {
   auto& param = this->Param<param_t>();
-  param.Out->CopyDataFrom(*param.X[*param.Mask->data<int>()]);
+  param.Out->ShareDataUntilWrite(*param.X[*param.Mask->data<int>()]);
 }
 
 }  // namespace host
@@ -38,6 +38,40 @@ void SplitCompute<T, PType>::Run() {
     axis += static_cast<int>(param.x->dims().size());
   }
 
+  if (param.inplace) {
+    // The outputs are contiguous slices of x if all the dims before the axis
+    // are 1, e.g. a batch of one row split by columns.
+    if (in_dim.count(0, axis) == 1 && in_dim.production() > 0) {
+      lite::Tensor flat;
+      flat.ShareDataWith(*param.x);
+      flat.Resize({in_dim.production()});
+      int64_t begin = 0;
+      for (auto* out : dout) {
+        auto out_dims = out->dims();
+        auto out_lod = out->lod();
+        int64_t end = begin + out_dims.production();
+        out->ShareDataWith(flat.Slice<T>(begin, end));
+        out->Resize(out_dims);
+        out->set_lod(out_lod);
+        // Only records the size and precision, the slice fits the buffer.
+        out->template mutable_data<T>();
+        begin = end;
+      }
+      shared_outputs_ = true;
+      return;
+    }
+    // Give the outputs buffers of their own again before writing them.
+    if (shared_outputs_) {
+      for (auto* out : dout) {
+        lite::Tensor tensor;
+        tensor.Resize(out->dims());
+        tensor.set_lod(out->lod());
+        *out = tensor;
+      }
+      shared_outputs_ = false;
+    }
+  }
+
   lite::host::math::split(din, dout, axis, in_strides);
 }
 
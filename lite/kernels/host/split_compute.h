@@ -27,6 +27,10 @@ class SplitCompute : public KernelLite<TARGET(kHost), PType> {
   void Run() override;
 
   virtual ~SplitCompute() = default;
+
+ private:
+  // Whether the outputs share the buffer of x since the last run.
+  bool shared_outputs_{false};
 };
 
 }  // namespace host
@@ -0,0 +1,96 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "lite/core/op_registry.h"
+#include "lite/kernels/host/split_compute.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace host {
+
+void RunSplit(SplitFloat* split,
+              int rows,
+              const std::vector<int>& sections,
+              bool inplace,
+              lite::Tensor* x,
+              std::vector<lite::Tensor>* outs) {
+  int cols = 0;
+  for (auto section : sections) cols += section;
+  x->Resize({rows, cols});
+  auto* x_data = x->mutable_data<float>();
+  for (int i = 0; i < rows * cols; ++i) x_data[i] = i;
+
+  operators::SplitParam param;
+  param.x = x;
+  param.axis = 1;
+  param.sections = sections;
+  param.inplace = inplace;
+  for (size_t i = 0; i < sections.size(); ++i) {
+    (*outs)[i].Resize({rows, sections[i]});
+    param.output.push_back(&(*outs)[i]);
+  }
+  split->SetParam(param);
+  split->Run();
+
+  int begin = 0;
+  for (size_t i = 0; i < sections.size(); ++i) {
+    const auto* out_data = (*outs)[i].data<float>();
+    for (int r = 0; r < rows; ++r) {
+      for (int c = 0; c < sections[i]; ++c) {
+        EXPECT_EQ(out_data[r * sections[i] + c], r * cols + begin + c);
+      }
+    }
+    begin += sections[i];
+  }
+}
+
+TEST(split_host, copy) {
+  SplitFloat split;
+  lite::Tensor x;
+  std::vector<lite::Tensor> outs(3);
+  RunSplit(&split, 1, {2, 3, 4}, false, &x, &outs);
+  for (auto& out : outs) EXPECT_NE(out.data<float>(), x.data<float>());
+}
+
+TEST(split_host, inplace) {
+  SplitFloat split;
+  lite::Tensor x;
+  std::vector<lite::Tensor> outs(3);
+  // A single row is split without copying.
+  RunSplit(&split, 1, {2, 3, 4}, true, &x, &outs);
+  EXPECT_EQ(outs[0].data<float>(), x.data<float>());
+  EXPECT_EQ(outs[1].data<float>(), x.data<float>() + 2);
+  EXPECT_EQ(outs[2].data<float>(), x.data<float>() + 5);
+  EXPECT_EQ(outs[2].memory_size(), 4 * sizeof(float));
+
+  // More rows are copied into buffers of the outputs' own.
+  RunSplit(&split, 3, {2, 3, 4}, true, &x, &outs);
+  for (auto& out : outs) {
+    EXPECT_TRUE(out.data<float>() < x.data<float>() ||
+                out.data<float>() >= x.data<float>() + x.numel());
+  }
+
+  RunSplit(&split, 1, {2, 3, 4}, true, &x, &outs);
+  EXPECT_EQ(outs[1].data<float>(), x.data<float>() + 2);
+}
+
+}  // namespace host
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
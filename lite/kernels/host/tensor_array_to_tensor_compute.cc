@@ -39,11 +39,6 @@ void TensorArrayToTensorCompute::Run() {
 
   bool use_stack = param.use_stack;
   auto out = param.Out;
-  if (use_stack) {
-    lite::host::math::stack_func<float>(inputs, axis, out);
-  } else {
-    lite::host::math::concat_func<float>(inputs, axis, out);
-  }
 
 #define PROCESS(precision, dtype)                              \
   case PRECISION(precision): {                                 \
@@ -13,6 +13,10 @@
 // limitations under the License.
 
 #include "lite/kernels/host/where_compute.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include <algorithm>
 #include <string>
 #include <vector>
 #include "lite/core/op_registry.h"
@@ -23,6 +27,74 @@ namespace lite {
 namespace kernels {
 namespace host {
 
+// Elements selected per task when running in parallel.
+static const int64_t kWhereChunk = 16384;
+
+#ifdef __SSE2__
+// Widens 16 byte masks to lane masks of Bytes each, filling Bytes vectors.
+template <int Bytes>
+inline void widen_mask(__m128i mask, __m128i* out);
+
+template <>
+inline void widen_mask<1>(__m128i mask, __m128i* out) {
+  out[0] = mask;
+}
+
+template <>
+inline void widen_mask<2>(__m128i mask, __m128i* out) {
+  out[0] = _mm_unpacklo_epi8(mask, mask);
+  out[1] = _mm_unpackhi_epi8(mask, mask);
+}
+
+template <>
+inline void widen_mask<4>(__m128i mask, __m128i* out) {
+  __m128i half[2];
+  widen_mask<2>(mask, half);
+  for (int k = 0; k < 2; ++k) {
+    out[2 * k] = _mm_unpacklo_epi16(half[k], half[k]);
+    out[2 * k + 1] = _mm_unpackhi_epi16(half[k], half[k]);
+  }
+}
+
+template <>
+inline void widen_mask<8>(__m128i mask, __m128i* out) {
+  __m128i quarter[4];
+  widen_mask<4>(mask, quarter);
+  for (int k = 0; k < 4; ++k) {
+    out[2 * k] = _mm_unpacklo_epi32(quarter[k], quarter[k]);
+    out[2 * k + 1] = _mm_unpackhi_epi32(quarter[k], quarter[k]);
+  }
+}
+#endif
+
+template <typename T>
+void where_row(
+    const bool* cond, const T* x, const T* y, T* out, int64_t size) {
+  int64_t i = 0;
+#ifdef __SSE2__
+  // 16 elements span sizeof(T) vectors; the selection is bitwise.
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= size; i += 16) {
+    __m128i is_false = _mm_cmpeq_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(cond + i)), zero);
+    __m128i masks[sizeof(T)];
+    widen_mask<sizeof(T)>(is_false, masks);
+    const __m128i* vx = reinterpret_cast<const __m128i*>(x + i);
+    const __m128i* vy = reinterpret_cast<const __m128i*>(y + i);
+    __m128i* vo = reinterpret_cast<__m128i*>(out + i);
+    for (size_t k = 0; k < sizeof(T); ++k) {
+      __m128i selected =
+          _mm_or_si128(_mm_andnot_si128(masks[k], _mm_loadu_si128(vx + k)),
+                       _mm_and_si128(masks[k], _mm_loadu_si128(vy + k)));
+      _mm_storeu_si128(vo + k, selected);
+    }
+  }
+#endif
+  for (; i < size; ++i) {
+    out[i] = cond[i] ? x[i] : y[i];
+  }
+}
+
 template <typename T>
 void where_kernel(const operators::WhereParam& param) {
   auto* x = param.x;
@@ -30,13 +102,20 @@ void where_kernel(const operators::WhereParam& param) {
   auto* condition = param.condition;
   auto* out = param.out;
   auto dims = x->dims();
-  auto numel = dims.production();
+  int64_t numel = dims.production();
   const T* x_data = x->template data<T>();
   const T* y_data = y->template data<T>();
   const bool* cond_data = condition->template data<bool>();
   T* out_data = out->template mutable_data<T>();
-  for (int i = 0; i < numel; i++) {
-    out_data[i] = cond_data[i] ? x_data[i] : y_data[i];
+  int64_t chunks = (numel + kWhereChunk - 1) / kWhereChunk;
+#pragma omp parallel for if (chunks > 1)
+  for (int64_t c = 0; c < chunks; ++c) {
+    int64_t begin = c * kWhereChunk;
+    where_row(cond_data + begin,
+              x_data + begin,
+              y_data + begin,
+              out_data + begin,
+              std::min(kWhereChunk, numel - begin));
   }
 }
 
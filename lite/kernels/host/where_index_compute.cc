@@ -13,8 +13,10 @@
 // limitations under the License.
 
 #include "lite/kernels/host/where_index_compute.h"
+#include <algorithm>
 #include <string>
 #include <vector>
+#include "lite/backends/host/math/mask.h"
 #include "lite/core/op_registry.h"
 #include "lite/core/tensor.h"
 
@@ -23,97 +25,42 @@ namespace lite {
 namespace kernels {
 namespace host {
 
-static void where_index_rank4(const int64_t* true_index,
-                              int true_num,
-                              const int64_t* stride,
-                              int64_t* out) {
-  int cnt = true_num >> 1;
-  register int64_t stride0 = stride[0];
-  register int64_t stride1 = stride[1];
-  register int64_t stride2 = stride[2];
-  register int64_t stride3 = stride[3];
-  for (int i = 0; i < cnt; ++i) {
-    int64_t index0 = true_index[i * 2];
-    int64_t index1 = true_index[i * 2 + 1];
-    int out_index = i * 8;
-    // rank0
-    register int64_t oindex0 = index0 / stride0;
-    register int64_t oindex1 = index1 / stride0;
-    out[out_index] = oindex0;
-    index0 -= oindex0 * stride0;
-    index1 -= oindex1 * stride0;
-    out[out_index + 4] = oindex1;
-    out_index++;
-    // rank1
-    oindex0 = index0 / stride1;
-    oindex1 = index1 / stride1;
-    out[out_index] = oindex0;
-    index0 -= oindex0 * stride1;
-    index1 -= oindex1 * stride1;
-    out[out_index + 4] = oindex1;
-    out_index++;
-    // rank2
-    oindex0 = index0 / stride2;
-    oindex1 = index1 / stride2;
-    out[out_index] = oindex0;
-    index0 -= oindex0 * stride2;
-    index1 -= oindex1 * stride2;
-    out[out_index + 4] = oindex1;
-    out_index++;
-    // rank3
-    oindex0 = index0 / stride3;
-    oindex1 = index1 / stride3;
-    out[out_index] = oindex0;
-    out[out_index + 4] = oindex1;
-  }
-  // remain
-  for (int r = cnt * 2; r < true_num; ++r) {
-    int out_index = r * 4;
-    int64_t index = true_index[r];
-    for (int i = 0; i < 4; ++i) {
-      out[out_index + i] = index / stride[i];
-      index -= out[out_index + i] * stride[i];
-    }
-  }
-}
-
-inline void where_index_rank1(const int64_t* true_index,
-                              int true_num,
-                              int64_t* out) {
-  memcpy(out, true_index, true_num * sizeof(int64_t));
-}
-
-static void where_index_rankn(const int64_t* true_index,
-                              int true_num,
-                              const int64_t* stride,
-                              int rank,
-                              int64_t* out) {
-  int out_index = 0;
-  for (int i = 0; i < true_num; ++i) {
-    int64_t index = true_index[i];
-    for (int r = 0; r < rank; ++r) {
-      out[out_index] = index / stride[r];
-      index -= out[out_index++] * stride[r];
-    }
-  }
-}
+// Elements per chunk, a multiple of 64 so chunks own whole mask words.
+static const int64_t kWhereIndexChunk = 16384;
 
 template <typename T>
 void WhereIndexKernel(const operators::WhereIndexParam& param) {
   auto* input = param.input;
   auto* output = param.output;
   auto dims = input->dims();
-  auto numel = dims.production();
+  int64_t numel = dims.production();
   int64_t rank = static_cast<int64_t>(dims.size());
   const T* cond_data = input->template data<T>();
-  int64_t true_num = 0;
-  std::vector<int64_t> true_index(numel);
-  for (auto i = 0; i < numel; i++) {
-    if (static_cast<bool>(cond_data[i])) {
-      true_index[true_num] = i;
-      true_num++;
+
+  // The condition is read once into a packed mask, counting the true elements
+  // of every chunk on the way. Chunk offsets then let each chunk write its
+  // coordinates independently.
+  int64_t chunks = (numel + kWhereIndexChunk - 1) / kWhereIndexChunk;
+  std::vector<uint64_t> mask((numel + 63) / 64);
+  std::vector<int64_t> offsets(chunks + 1, 0);
+#pragma omp parallel for if (chunks > 1)
+  for (int64_t c = 0; c < chunks; ++c) {
+    int64_t end = std::min(numel, (c + 1) * kWhereIndexChunk);
+    int64_t count = 0;
+    for (int64_t i = c * kWhereIndexChunk; i < end; i += 64) {
+      uint64_t bits =
+          end - i >= 64
+              ? lite::host::math::nonzero_mask64(cond_data + i)
+              : lite::host::math::nonzero_mask(cond_data + i, end - i);
+      mask[i / 64] = bits;
+      count += lite::host::math::popcount64(bits);
     }
+    offsets[c + 1] = count;
+  }
+  for (int64_t c = 0; c < chunks; ++c) {
+    offsets[c + 1] += offsets[c];
   }
+  int64_t true_num = offsets[chunks];
   output->Resize({true_num, rank});
   if (true_num == 0) {
     return;
@@ -124,13 +71,26 @@ void WhereIndexKernel(const operators::WhereIndexParam& param) {
   for (int i = rank - 2; i >= 0; i--) {
     stride[i] = stride[i + 1] * dims[i + 1];
   }
-  if (rank == 1) {
-    where_index_rank1(true_index.data(), true_num, out_ptr);
-  } else if (rank == 4) {
-    where_index_rank4(true_index.data(), true_num, stride.data(), out_ptr);
-  } else {
-    where_index_rankn(
-        true_index.data(), true_num, stride.data(), rank, out_ptr);
+#pragma omp parallel for if (chunks > 1)
+  for (int64_t c = 0; c < chunks; ++c) {
+    int64_t* out = out_ptr + offsets[c] * rank;
+    int64_t end = std::min(numel, (c + 1) * kWhereIndexChunk);
+    for (int64_t i = c * kWhereIndexChunk; i < end; i += 64) {
+      uint64_t bits = mask[i / 64];
+      while (bits) {
+        int64_t index = i + lite::host::math::ctz64(bits);
+        bits &= bits - 1;
+        if (rank == 1) {
+          *out++ = index;
+          continue;
+        }
+        for (int64_t r = 0; r < rank; ++r) {
+          int64_t coord = index / stride[r];
+          index -= coord * stride[r];
+          *out++ = coord;
+        }
+      }
+    }
   }
 }
 
@@ -0,0 +1,176 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/core/program.h"
+#include "lite/model_parser/cpp_desc.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace host {
+
+static cpp::OpDesc* AddOp(
+    cpp::BlockDesc* block,
+    const std::string& type,
+    const std::map<std::string, std::vector<std::string>>& inputs,
+    const std::map<std::string, std::vector<std::string>>& outputs,
+    PrecisionType precision = PRECISION(kAny),
+    DataLayoutType layout = DATALAYOUT(kAny)) {
+  auto* op = block->AddOp<cpp::OpDesc>();
+  op->SetType(type);
+  for (auto& input : inputs) {
+    op->SetInput(input.first, input.second);
+  }
+  for (auto& output : outputs) {
+    op->SetOutput(output.first, output.second);
+  }
+  op->SetAttr<std::string>(
+      kKernelTypeAttr,
+      KernelBase::SerializeKernelType(
+          type, "def", Place{TARGET(kHost), precision, layout}));
+  return op;
+}
+
+// The loop state is carried by assign and written to arrays each step, so
+// the tensors involved are shared until written, while the body updates them
+// in place and reads them back through mutable_data():
+//
+//   while (i < n) {
+//     xs[i] = x;
+//     y = x + 1;
+//     x = y;
+//     zs[i] = fill_constant(shape = [3], value = x);
+//     i = i + 1;
+//   }
+TEST(while, share_loop_state_until_write) {
+  auto program_desc = std::make_shared<cpp::ProgramDesc>();
+  auto* main_block = program_desc->AddBlock<cpp::BlockDesc>();
+  main_block->SetIdx(0);
+  main_block->SetParentIdx(-1);
+  auto* while_op = AddOp(main_block,
+                         "while",
+                         {{"X", {"x", "i", "n"}}, {"Condition", {"cond"}}},
+                         {{"Out", {"x", "i", "xs", "zs"}}});
+  while_op->SetAttr<int32_t>("sub_block", 1);
+
+  auto* sub_block = program_desc->AddBlock<cpp::BlockDesc>();
+  sub_block->SetIdx(1);
+  sub_block->SetParentIdx(0);
+  AddOp(sub_block,
+        "write_to_array",
+        {{"X", {"x"}}, {"I", {"i"}}},
+        {{"Out", {"xs"}}});
+  AddOp(sub_block,
+        "increment",
+        {{"X", {"x"}}},
+        {{"Out", {"y"}}},
+        PRECISION(kAny),
+        DATALAYOUT(kNCHW))
+      ->SetAttr<float>("step", 1.f);
+  AddOp(sub_block, "assign", {{"X", {"y"}}}, {{"Out", {"x"}}});
+  auto* fill_constant = AddOp(sub_block,
+                              "fill_constant",
+                              {{"ValueTensor", {"x"}}},
+                              {{"Out", {"z"}}},
+                              PRECISION(kAny),
+                              DATALAYOUT(kNCHW));
+  fill_constant->SetAttr<int>(
+      "dtype", static_cast<int>(lite::core::FluidType::FP32));
+  fill_constant->SetAttr<std::vector<int64_t>>("shape", {3});
+  fill_constant->SetAttr<float>("value", 0.f);
+  fill_constant->SetAttr<bool>("force_cpu", false);
+  AddOp(sub_block,
+        "write_to_array",
+        {{"X", {"z"}}, {"I", {"i"}}},
+        {{"Out", {"zs"}}});
+  AddOp(sub_block,
+        "increment",
+        {{"X", {"i"}}},
+        {{"Out", {"i"}}},
+        PRECISION(kAny),
+        DATALAYOUT(kNCHW))
+      ->SetAttr<float>("step", 1.f);
+  auto* less_than = AddOp(sub_block,
+                          "less_than",
+                          {{"X", {"i"}}, {"Y", {"n"}}},
+                          {{"Out", {"cond"}}},
+                          PRECISION(kInt64));
+  less_than->SetAttr<int>("axis", -1);
+  less_than->SetAttr<bool>("force_cpu", false);
+
+  const int64_t steps = 5;
+  Scope scope;
+  auto* x = scope.Var("x")->GetMutable<lite::Tensor>();
+  x->Resize({1});
+  x->mutable_data<float>()[0] = 0.5f;
+  auto* i = scope.Var("i")->GetMutable<lite::Tensor>();
+  i->Resize({1});
+  i->mutable_data<int64_t>()[0] = 0;
+  auto* n = scope.Var("n")->GetMutable<lite::Tensor>();
+  n->Resize({1});
+  n->mutable_data<int64_t>()[0] = steps;
+  auto* cond = scope.Var("cond")->GetMutable<lite::Tensor>();
+  cond->Resize({1});
+  cond->mutable_data<bool>()[0] = true;
+  scope.Var("y")->GetMutable<lite::Tensor>();
+  scope.Var("z")->GetMutable<lite::Tensor>();
+  auto* xs = scope.Var("xs")->GetMutable<std::vector<lite::Tensor>>();
+  auto* zs = scope.Var("zs")->GetMutable<std::vector<lite::Tensor>>();
+
+  RuntimeProgram program(program_desc, &scope, 0);
+  // y and z share the buffers of x and the previous element of zs, but they
+  // are overwritten, so no step copies them. Only fill_constant reading x
+  // through mutable_data() copies x, once a step.
+  const uint64_t bytes_copied = lite::Tensor::detached_bytes_copied();
+  program.Run();
+  EXPECT_EQ(lite::Tensor::detached_bytes_copied() - bytes_copied,
+            steps * sizeof(float));
+
+  EXPECT_EQ(i->data<int64_t>()[0], steps);
+  EXPECT_EQ(x->data<float>()[0], 0.5f + steps);
+  ASSERT_EQ(xs->size(), static_cast<size_t>(steps));
+  ASSERT_EQ(zs->size(), static_cast<size_t>(steps));
+  for (int64_t step = 0; step < steps; step++) {
+    ASSERT_EQ(xs->at(step).numel(), 1);
+    EXPECT_EQ(xs->at(step).data<float>()[0], 0.5f + step);
+    ASSERT_EQ(zs->at(step).numel(), 3);
+    for (int k = 0; k < 3; k++) {
+      EXPECT_EQ(zs->at(step).data<float>()[k], 1.5f + step);
+    }
+  }
+}
+
+}  // namespace host
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(while);
+USE_LITE_OP(write_to_array);
+USE_LITE_OP(increment);
+USE_LITE_OP(assign);
+USE_LITE_OP(fill_constant);
+USE_LITE_OP(less_than);
+USE_LITE_KERNEL(while, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(write_to_array, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(increment, kHost, kAny, kNCHW, def);
+USE_LITE_KERNEL(assign, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(fill_constant, kHost, kAny, kNCHW, def);
+USE_LITE_KERNEL(less_than, kHost, kInt64, kAny, def);
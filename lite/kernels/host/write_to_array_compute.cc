@@ -27,7 +27,9 @@ void WriteToArrayCompute::Run() {
   if (param.Out->size() < id + 1) {
     param.Out->resize(id + 1);
   }
-  param.Out->at(id).CopyDataFrom(*param.X);
+  // X is usually rewritten by the next loop step, which then moves X (not
+  // the array entry) to a new buffer.
+  param.Out->at(id).ShareDataUntilWrite(*param.X);
 }
 
 }  // namespace host
@@ -0,0 +1,106 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/kernels/host/read_from_array_compute.h"
+#include "lite/kernels/host/write_to_array_compute.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace host {
+
+// Fills x as a loop step would, writing it through mutable_data().
+static void FillStep(lite::Tensor* x, float step) {
+  x->Resize({2, 3});
+  auto* data = x->mutable_data<float>();
+  for (int i = 0; i < x->numel(); i++) {
+    data[i] = step * 10 + i;
+  }
+}
+
+static void CheckStep(const lite::Tensor& x, float step) {
+  ASSERT_EQ(x.numel(), 6);
+  for (int i = 0; i < x.numel(); i++) {
+    EXPECT_EQ(x.data<float>()[i], step * 10 + i);
+  }
+}
+
+TEST(write_to_array, keeps_entries_when_x_is_rewritten) {
+  lite::Tensor x, i;
+  std::vector<lite::Tensor> array;
+  i.Resize({1});
+
+  WriteToArrayCompute write_to_array;
+  operators::WriteToArrayParam param;
+  param.X = &x;
+  param.I = &i;
+  param.Out = &array;
+  write_to_array.SetParam(param);
+  write_to_array.PrepareForRun();
+
+  // Each step rewrites x in place after it has been written to the array.
+  for (int step = 0; step < 4; step++) {
+    FillStep(&x, step);
+    i.mutable_data<int64_t>()[0] = step;
+    write_to_array.Run();
+  }
+  ASSERT_EQ(array.size(), 4u);
+  for (int step = 0; step < 4; step++) {
+    CheckStep(array[step], step);
+  }
+
+  // Only the last entry still shares x, writing it moves it away from x.
+  float* entry = array[3].mutable_data<float>();
+  entry[0] = -1;
+  CheckStep(x, 3);
+  EXPECT_EQ(array[3].data<float>()[1], 31);
+}
+
+TEST(read_from_array, reads_then_writes_the_entry) {
+  std::vector<lite::Tensor> array(2);
+  FillStep(&array[0], 0);
+  FillStep(&array[1], 1);
+  lite::Tensor i, out;
+  i.Resize({1});
+  i.mutable_data<int64_t>()[0] = 1;
+
+  ReadFromArrayCompute read_from_array;
+  operators::ReadFromArrayParam param;
+  param.X = &array;
+  param.I = &i;
+  param.Out = &out;
+  read_from_array.SetParam(param);
+  read_from_array.PrepareForRun();
+  read_from_array.Run();
+  CheckStep(out, 1);
+
+  // A kernel updating out in place sees its contents and leaves the array.
+  auto* out_data = out.mutable_data<float>();
+  for (int k = 0; k < out.numel(); k++) {
+    out_data[k] += 10;
+  }
+  CheckStep(out, 2);
+  CheckStep(array[1], 1);
+}
+
+}  // namespace host
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_KERNEL(write_to_array, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(read_from_array, kHost, kAny, kAny, def);
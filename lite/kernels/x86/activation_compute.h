@@ -34,6 +34,14 @@ namespace lite {
 namespace kernels {
 namespace x86 {
 
+// The estimated nanoseconds per element of the Eigen activations, which are
+// vectorized, for the cheap ones and the ones computing exp, tanh or sqrt, and
+// per run, mostly spent building the Eigen expressions. The latter makes the
+// scalar host kernels win on small tensors.
+const float kCheapActivationCost = 0.25f;
+const float kMathActivationCost = 1.f;
+const float kActivationCallCost = 500.f;
+
 enum ActBwdOpFwdDeps {
   kNoDeps = 0x00,  // Do not need any forward input/output
   kDepX = 0x01,    // Only need forward input X
@@ -96,6 +104,11 @@ class SquareCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
     Activate<SquareFunctor<T>>(param.X, param.Out);
   }
 
+  float EstimateCost() const override {
+    return ElementwiseCost(
+        Param<param_t>().X->dims(), kCheapActivationCost, kActivationCallCost);
+  }
+
   virtual ~SquareCompute() = default;
 };
 
@@ -120,6 +133,11 @@ class ReluCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
     Activate<ReluFunctor<T>>(param.X, param.Out);
   }
 
+  float EstimateCost() const override {
+    return ElementwiseCost(
+        Param<param_t>().X->dims(), kCheapActivationCost, kActivationCallCost);
+  }
+
   virtual ~ReluCompute() = default;
 };
 
@@ -154,6 +172,11 @@ class LeakyReluCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
     functor(place, x, out);
   }
 
+  float EstimateCost() const override {
+    return ElementwiseCost(
+        Param<param_t>().X->dims(), kCheapActivationCost, kActivationCallCost);
+  }
+
   virtual ~LeakyReluCompute() = default;
 };
 
@@ -178,6 +201,11 @@ class TanhCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
     Activate<TanhFunctor<T>>(param.X, param.Out);
   }
 
+  float EstimateCost() const override {
+    return ElementwiseCost(
+        Param<param_t>().X->dims(), kMathActivationCost, kActivationCallCost);
+  }
+
   virtual ~TanhCompute() = default;
 };
 
@@ -268,6 +296,11 @@ class SigmoidCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
     Activate<SigmoidFunctor<T>>(param.X, param.Out);
   }
 
+  float EstimateCost() const override {
+    return ElementwiseCost(
+        Param<param_t>().X->dims(), kMathActivationCost, kActivationCallCost);
+  }
+
   virtual ~SigmoidCompute() = default;
 };
 
@@ -304,6 +337,11 @@ class Relu6Compute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
     functor(place, x, out);
   }
 
+  float EstimateCost() const override {
+    return ElementwiseCost(
+        Param<param_t>().X->dims(), kCheapActivationCost, kActivationCallCost);
+  }
+
   virtual ~Relu6Compute() = default;
 };
 
@@ -348,6 +386,11 @@ class RsqrtCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
     Activate<RsqrtFunctor<T>>(param.X, param.Out);
   }
 
+  float EstimateCost() const override {
+    return ElementwiseCost(
+        Param<param_t>().X->dims(), kMathActivationCost, kActivationCallCost);
+  }
+
   virtual ~RsqrtCompute() = default;
 };
 
@@ -21,14 +21,16 @@ namespace lite {
 namespace kernels {
 namespace x86 {
 
-template <>
-void Conv2dCompute<float>::PrepareForRun() {
 #ifdef LITE_WITH_AVX
-  auto& param = this->Param<param_t>();
+namespace {
 
-  const int input_channel = param.x->dims()[1];
-  const int output_channel = param.filter->dims()[0];
+// The depthwise 3x3 convs of stride 1 or 2 run DepthwiseConv. The input
+// channels are taken from the filter, so that the implementation is known
+// before the input shapes are.
+bool UseDepthwiseConv(const operators::ConvParam& param) {
   const int groups = param.groups;
+  const int input_channel = param.filter->dims()[1] * groups;
+  const int output_channel = param.filter->dims()[0];
 
   const int kernel_h = param.filter->dims()[2];
   const int kernel_w = param.filter->dims()[3];
@@ -36,27 +38,66 @@ void Conv2dCompute<float>::PrepareForRun() {
   const int stride_h = param.strides[0];
   const int stride_w = param.strides[1];
 
-  if (input_channel == groups && output_channel == groups &&
-      (groups & 3) == 0) {
-    if (kernel_h == 3 && kernel_w == 3 && stride_h == 1 && stride_w == 1) {
-      impl_ = new DepthwiseConv<float>;
-      VLOG(3) << "invoking conv_depthwise_3x3s1";
-    } else if (kernel_h == 3 && kernel_w == 3 && stride_h == 2 &&
-               stride_w == 2) {
-      impl_ = new DepthwiseConv<float>;
-      VLOG(3) << "invoking conv_depthwise_3x3s2";
-    }
+  return input_channel == groups && output_channel == groups &&
+         (groups & 3) == 0 && kernel_h == 3 && kernel_w == 3 &&
+         stride_h == stride_w && (stride_h == 1 || stride_h == 2);
+}
+
+}  // namespace
+#endif
+
+template <>
+void Conv2dCompute<float>::PrepareForRun() {
+#ifdef LITE_WITH_AVX
+  auto& param = this->Param<param_t>();
+
+  if (UseDepthwiseConv(param)) {
+    impl_ = new DepthwiseConv<float>;
+    VLOG(3) << "invoking conv_depthwise_3x3s" << param.strides[0];
   }
 
   if (impl_) {
     impl_->SetContext(std::move(this->ctx_));
     impl_->SetParam(param);
+    if (!prepacked_weights_.dims().empty()) {
+      impl_->SetPrepackedWeights(prepacked_weights_);
+    }
     impl_->PrepareForRun();
     is_first_epoch_ = false;
   }
 #endif
 }
 
+template <>
+std::string Conv2dCompute<float>::PrepackedWeightsTag() const {
+#ifdef LITE_WITH_AVX
+  auto& param = this->Param<param_t>();
+  if (UseDepthwiseConv(param)) {
+    DepthwiseConv<float> impl;
+    impl.SetParam(param);
+    return impl.PrepackedWeightsTag();
+  }
+#endif
+  return "";
+}
+
+template <>
+void Conv2dCompute<float>::PackWeights(Tensor* packed) const {
+#ifdef LITE_WITH_AVX
+  auto& param = this->Param<param_t>();
+  if (UseDepthwiseConv(param)) {
+    DepthwiseConv<float> impl;
+    impl.SetParam(param);
+    impl.PackWeights(packed);
+  }
+#endif
+}
+
+template <>
+void Conv2dCompute<float>::SetPrepackedWeights(const Tensor& packed) {
+  prepacked_weights_.ShareDataWith(packed);
+}
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
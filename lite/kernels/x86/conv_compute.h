@@ -223,6 +223,12 @@ class Conv2dCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
   }
 #endif
 
+  // The weights are packed by the implementation chosen in PrepareForRun.
+  std::string PrepackedWeightsTag() const override;
+  std::string PrepackedWeightsInput() const override { return "Filter"; }
+  void PackWeights(Tensor* packed) const override;
+  void SetPrepackedWeights(const Tensor& packed) override;
+
   ~Conv2dCompute() {
     if (impl_ != nullptr) {
       delete impl_;
@@ -232,6 +238,7 @@ class Conv2dCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
  private:
   using param_t = operators::ConvParam;
   KernelLite<TARGET(kX86), PRECISION(kFloat)>* impl_{nullptr};
+  Tensor prepacked_weights_;
 };
 
 }  // namespace x86
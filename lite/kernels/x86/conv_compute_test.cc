@@ -92,6 +92,63 @@ TEST(conv2d_x86, run_test) {
   }
 }
 
+#ifdef LITE_WITH_AVX
+TEST(conv2d_x86, prepacked_depthwise) {
+  const int channel = 8;
+  lite::Tensor x, filter, b, out, prepacked_out;
+  x.Resize({1, channel, 6, 6});
+  filter.Resize({channel, 1, 3, 3});
+  b.Resize({channel});
+  auto x_data = x.mutable_data<float>();
+  auto filter_data = filter.mutable_data<float>();
+  auto b_data = b.mutable_data<float>();
+  for (int64_t i = 0; i < x.numel(); i++) x_data[i] = i % 7 - 3;
+  for (int64_t i = 0; i < filter.numel(); i++) filter_data[i] = i % 5 - 2;
+  for (int64_t i = 0; i < b.numel(); i++) b_data[i] = i;
+
+  operators::ConvParam param;
+  param.x = &x;
+  param.filter = &filter;
+  param.bias = &b;
+  param.strides = {1, 1};
+  param.groups = channel;
+  param.paddings = std::make_shared<std::vector<int>>(4, 1);
+  param.dilations = std::make_shared<std::vector<int>>(2, 1);
+
+  auto run = [&](Conv2dCompute<float>* conv2d, lite::Tensor* output) {
+    output->Resize({1, channel, 6, 6});
+    param.output = output;
+    std::unique_ptr<KernelContext> ctx(new KernelContext);
+    ctx->As<X86Context>();
+    conv2d->SetContext(std::move(ctx));
+    conv2d->SetParam(param);
+    conv2d->Launch();
+  };
+  Conv2dCompute<float> conv2d;
+  run(&conv2d, &out);
+#ifdef __AVX__
+  EXPECT_EQ(conv2d.PrepackedWeightsTag(), "x86/depthwise_conv/avx/pack8/v1");
+#else
+  EXPECT_EQ(conv2d.PrepackedWeightsTag(), "x86/depthwise_conv/sse/pack8/v1");
+#endif
+
+  // The kernel adopting the packed filter gets the same output without the
+  // original one.
+  lite::Tensor packed;
+  conv2d.PackWeights(&packed);
+  Conv2dCompute<float> prepacked;
+  param.output = &prepacked_out;
+  prepacked.SetParam(param);
+  ASSERT_EQ(prepacked.PrepackedWeightsTag(), conv2d.PrepackedWeightsTag());
+  prepacked.SetPrepackedWeights(packed);
+  for (int64_t i = 0; i < filter.numel(); i++) filter_data[i] = 0;
+  run(&prepacked, &prepacked_out);
+  for (int64_t i = 0; i < out.numel(); i++) {
+    EXPECT_NEAR(prepacked_out.data<float>()[i], out.data<float>()[i], 1e-5);
+  }
+}
+#endif
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
@@ -22,6 +22,74 @@ namespace lite {
 namespace kernels {
 namespace x86 {
 
+namespace {
+
+// The channels of the filter [oc, 1, kh, kw] are packed by 8 or 4.
+int FilterPackSize(const Tensor& filter) {
+  const int channel = filter.dims()[0];
+  return channel % 8 == 0 ? 8 : channel % 4 == 0 ? 4 : 1;
+}
+
+// The packing of the filter depends on the instruction set it's built for.
+#ifdef __AVX__
+const char kPackIsa[] = "avx";
+#else
+const char kPackIsa[] = "sse";
+#endif
+
+}  // namespace
+
+template <>
+std::string DepthwiseConv<float>::PrepackedWeightsTag() const {
+  auto& param = this->Param<param_t>();
+  const int pack_size = FilterPackSize(*param.filter);
+  if (pack_size == 1) return "";
+  return std::string("x86/depthwise_conv/") + kPackIsa + "/pack" +
+         std::to_string(pack_size) + "/v1";
+}
+
+template <>
+void DepthwiseConv<float>::PackWeights(Tensor* packed) const {
+  auto& param = this->Param<param_t>();
+  CHECK_EQ(param.filter->dims().size(), 4UL);
+  // filter [oc, 1, ih, iw] & pack_size=8 => [oc/8, ih, iw, 8]
+  // filter [oc, 1, ih, iw] & pack_size=4 => [ic/4, ih, iw, 4]
+  const int pack_size = FilterPackSize(*param.filter);
+  const int pack_num = param.filter->dims()[0] / pack_size;
+  if (pack_size == 8) {
+    lite::x86::math::pack8_m256(param.filter, packed, pack_num, true);
+  } else if (pack_size == 4) {
+    lite::x86::math::pack4_m128(param.filter, packed, pack_num, true);
+  }
+}
+
+template <>
+void DepthwiseConv<float>::SetPrepackedWeights(const Tensor& packed) {
+  auto& param = this->Param<param_t>();
+  auto filter_dims = param.filter->dims();
+  const int pack_size = FilterPackSize(*param.filter);
+  const DDim packed_dims({1,
+                          filter_dims[0] / pack_size,
+                          filter_dims[2],
+                          filter_dims[3],
+                          pack_size});
+  if (packed.dims() != packed_dims) {
+    LOG(WARNING) << "The prepacked filter of dims " << packed.dims()
+                 << " doesn't match the filter of dims " << filter_dims;
+    return;
+  }
+  filter_pack_.ShareDataWith(packed);
+  filter_packed_ = true;
+}
+
+template <>
+void DepthwiseConv<float>::PrepareForRun() {
+  if (!filter_packed_) {
+    PackWeights(&filter_pack_);
+    filter_packed_ = true;
+  }
+}
+
 template <>
 void DepthwiseConv<float>::Run() {
   auto& param = this->Param<param_t>();
@@ -57,13 +125,8 @@ void DepthwiseConv<float>::Run() {
   int kernel_h = param.filter->dims()[2];
   int kernel_w = param.filter->dims()[3];
 
-  // filter [oc, 1, ih, iw] & pack_size=8 => [oc/8, ih, iw, 8]
-  // filter [oc, 1, ih, iw] & pack_size=4 => [ic/4, ih, iw, 4]
-  if (pack_size == 8) {
-    lite::x86::math::pack8_m256(param.filter, &filter_pack_, pack_num, true);
-  } else if (pack_size == 4) {
-    lite::x86::math::pack4_m128(param.filter, &filter_pack_, pack_num, true);
-  }
+  // The filter is packed once in PrepareForRun.
+  CHECK(filter_packed_);
 
   // attributes
   const int stride_h = param.strides[0];
@@ -29,8 +29,13 @@ class DepthwiseConv : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
  public:
   DepthwiseConv() = default;
   ~DepthwiseConv() {}
+  virtual void PrepareForRun();
   virtual void Run();
 
+  std::string PrepackedWeightsTag() const override;
+  void PackWeights(Tensor* packed) const override;
+  void SetPrepackedWeights(const Tensor& packed) override;
+
 #ifdef LITE_WITH_PROFILE
   virtual void SetProfileRuntimeKernelInfo(
       paddle::lite::profile::OpCharacter* ch) {
@@ -46,6 +51,7 @@ class DepthwiseConv : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
   Tensor input_padding_;
   Tensor filter_pack_;
   Tensor output_pack_;
+  bool filter_packed_{false};
 };
 
 }  // namespace x86
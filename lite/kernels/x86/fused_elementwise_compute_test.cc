@@ -0,0 +1,95 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/fused_elementwise_compute.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+using host::math::FusedElementwiseOpcode;
+
+int Op(FusedElementwiseOpcode opcode) { return static_cast<int>(opcode); }
+
+TEST(fused_elementwise_x86, retrive_op) {
+  auto fused_elementwise =
+      KernelRegistry::Global().Create("fused_elementwise");
+  ASSERT_FALSE(fused_elementwise.empty());
+  ASSERT_TRUE(fused_elementwise.front());
+}
+
+TEST(fused_elementwise_x86, init) {
+  FusedElementwiseCompute fused_elementwise;
+  ASSERT_EQ(fused_elementwise.precision(), PRECISION(kFloat));
+  ASSERT_EQ(fused_elementwise.target(), TARGET(kX86));
+}
+
+TEST(fused_elementwise_x86, run_test) {
+  // out = scale(relu(x + y), 0.5, 1.0) * z, where y of dims {3} is broadcast
+  // at axis 1 of x and z of dims {4} at the last axis.
+  lite::Tensor x, y, z, out;
+  x.Resize({2, 3, 4});
+  y.Resize({3});
+  z.Resize({4});
+  out.Resize({2, 3, 4});
+  auto* x_data = x.mutable_data<float>();
+  auto* y_data = y.mutable_data<float>();
+  auto* z_data = z.mutable_data<float>();
+  for (int i = 0; i < x.numel(); i++) x_data[i] = i - 12.f;
+  for (int i = 0; i < y.numel(); i++) y_data[i] = i - 1.f;
+  for (int i = 0; i < z.numel(); i++) z_data[i] = i * 0.25f;
+
+  operators::FusedElementwiseParam param;
+  param.X = {&x, &y, &z};
+  param.Out = &out;
+  param.instructions = {
+      Op(FusedElementwiseOpcode::kLoad),  0, -1, -1, -1,
+      Op(FusedElementwiseOpcode::kLoad),  1, -1, -1, -1,
+      Op(FusedElementwiseOpcode::kAdd),   0, 1,  -1, 1,
+      Op(FusedElementwiseOpcode::kRelu),  2, -1, -1, -1,
+      Op(FusedElementwiseOpcode::kScale), 3, -1, 0,  -1,
+      Op(FusedElementwiseOpcode::kLoad),  2, -1, -1, -1,
+      Op(FusedElementwiseOpcode::kMul),   4, 5,  -1, -1,
+  };
+  param.params = {0.5f, 1.f, 1.f};
+
+  FusedElementwiseCompute fused_elementwise;
+  fused_elementwise.SetParam(param);
+  fused_elementwise.Run();
+
+  auto* out_data = out.data<float>();
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < 3; j++) {
+      for (int k = 0; k < 4; k++) {
+        int index = (i * 3 + j) * 4 + k;
+        float ref = (std::max)(x_data[index] + y_data[j], 0.f);
+        ref = (ref * 0.5f + 1.f) * z_data[k];
+        EXPECT_NEAR(out_data[index], ref, 1e-5);
+      }
+    }
+  }
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_KERNEL(fused_elementwise, kX86, kFloat, kNCHW, def);
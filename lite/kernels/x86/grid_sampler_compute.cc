@@ -13,7 +13,12 @@
 // limitations under the License.
 
 #include "lite/kernels/x86/grid_sampler_compute.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#include <cmath>
 #include <string>
+#include <vector>
 #include "lite/backends/x86/math/math_function.h"
 #include "lite/core/op_registry.h"
 #include "lite/fluid/eigen.h"
@@ -29,12 +34,11 @@ template <typename T,
           typename IndexType = Eigen::DenseIndex>
 using EigenTensor = lite::fluid::EigenTensor<T, D, MajorType, IndexType>;
 
-using Array4 = Eigen::DSizes<int64_t, 4>;
-
+// NaN coordinates, e.g. reflected on an input of size 1, are out of bound.
 template <typename T>
 inline bool IsInBound(T x, T y, T x_max, T y_max) {
-  return !(x < static_cast<T>(0) || x > x_max || y < static_cast<T>(0) ||
-           y > y_max);
+  return x >= static_cast<T>(0) && x <= x_max && y >= static_cast<T>(0) &&
+         y <= y_max;
 }
 
 template <typename T>
@@ -116,121 +120,88 @@ void CalcGridLocations(const X86Context& ctx,
   Clip<T>(ctx, grid_y, in_h - 1, align_corners, padding_mode);
 }
 
-template <typename T>
-void GetGridPointValue(const Tensor& input,
-                       Tensor* output,
-                       const Tensor& x,
-                       const Tensor& y) {
-  const int n = input.dims()[0];
-  const int c = input.dims()[1];
-  const int in_h = input.dims()[2];
-  const int in_w = input.dims()[3];
-  const int out_h = x.dims()[1];
-  const int out_w = x.dims()[2];
-  auto x_t = EigenTensor<T, 3>::From(x);
-  auto y_t = EigenTensor<T, 3>::From(y);
-  auto output_t =
-      EigenTensor<T, 4>::From(*output).setConstant(static_cast<T>(0));
-  auto input_t = EigenTensor<T, 4>::From(input);
-
-  for (int i = 0; i < n; i++) {
-    for (int k = 0; k < out_h; k++) {
-      for (int l = 0; l < out_w; l++) {
-        if (IsInBound(x_t(i, k, l),
-                      y_t(i, k, l),
-                      static_cast<T>(in_w - 1),
-                      static_cast<T>(in_h - 1))) {
-          for (int j = 0; j < c; j++) {
-            output_t(i, j, k, l) =
-                input_t(i,
-                        j,
-                        static_cast<int>(round(y_t(i, k, l))),
-                        static_cast<int>(round(x_t(i, k, l))));
-          }
-        }
+// Sample output pixels [begin, size) of one channel with precomputed input
+// offsets and weights of the `K` neighbors of every pixel. The tables are laid
+// out as K planes of `size` elements, and neighbors out of the input have a
+// negative offset.
+template <typename T, int K>
+void SampleChannel(const T* src,
+                   const int* index,
+                   const T* weight,
+                   int begin,
+                   int size,
+                   T* dst) {
+  for (int i = begin; i < size; ++i) {
+    T val = static_cast<T>(0);
+    for (int k = 0; k < K; ++k) {
+      const int idx = index[k * size + i];
+      if (idx >= 0) {
+        val += weight[k * size + i] * src[idx];
       }
     }
+    dst[i] = val;
   }
 }
 
-template <typename T>
-void AllNeigbors(const X86Context& ctx,
-                 const Tensor& input,
-                 Tensor* grid_x,
-                 Tensor* grid_y,
-                 Tensor* x_w,
-                 Tensor* x_e,
-                 Tensor* y_n,
-                 Tensor* y_s,  // positions
-                 Tensor* d_w,
-                 Tensor* d_e,
-                 Tensor* d_n,
-                 Tensor* d_s,  // distance
-                 Tensor* v_wn,
-                 Tensor* v_en,
-                 Tensor* v_ws,
-                 Tensor* v_es) {  // values
-  auto place = lite::fluid::EigenDeviceType<TARGET(kX86)>();
-
-  const int c = input.dims()[1];
-  const int n = grid_x->dims()[0];
-  const int out_h = grid_x->dims()[1];
-  const int out_w = grid_x->dims()[2];
-  // calculate coords of 4 corner points
-  DDim dim{{n, out_h, out_w}};
-  x_w->Resize(dim);
-  x_e->Resize(dim);
-  y_n->Resize(dim);
-  y_s->Resize(dim);
-  x_w->template mutable_data<T>();
-  x_e->template mutable_data<T>();
-  y_n->template mutable_data<T>();
-  y_s->template mutable_data<T>();
-  auto x_w_t = EigenTensor<T, 3>::From(*x_w);
-  auto x_e_t = EigenTensor<T, 3>::From(*x_e);
-  auto y_n_t = EigenTensor<T, 3>::From(*y_n);
-  auto y_s_t = EigenTensor<T, 3>::From(*y_s);
-
-  auto grid_x_t = EigenTensor<T, 3>::From(*grid_x);
-  auto grid_y_t = EigenTensor<T, 3>::From(*grid_y);
-
-  x_w_t.device(place) = grid_x_t.floor();
-  x_e_t.device(place) = x_w_t + static_cast<T>(1);
-  y_n_t.device(place) = grid_y_t.floor();
-  y_s_t.device(place) = y_n_t + static_cast<T>(1);
+template <typename T, int K>
+struct ChannelSampler {
+  static void Run(
+      const T* src, const int* index, const T* weight, int size, T* dst) {
+    SampleChannel<T, K>(src, index, weight, 0, size, dst);
+  }
+};
 
-  // calculate distances to 4 sides
-  d_w->Resize(dim);
-  d_e->Resize(dim);
-  d_n->Resize(dim);
-  d_s->Resize(dim);
-  d_w->template mutable_data<T>();
-  d_e->template mutable_data<T>();
-  d_n->template mutable_data<T>();
-  d_s->template mutable_data<T>();
-  auto d_w_t = EigenTensor<T, 3>::From(*d_w);
-  auto d_e_t = EigenTensor<T, 3>::From(*d_e);
-  auto d_n_t = EigenTensor<T, 3>::From(*d_n);
-  auto d_s_t = EigenTensor<T, 3>::From(*d_s);
-  d_w_t.device(place) = grid_x_t - x_w_t;
-  d_e_t.device(place) = x_e_t - grid_x_t;
-  d_n_t.device(place) = grid_y_t - y_n_t;
-  d_s_t.device(place) = y_s_t - grid_y_t;
+#ifdef __AVX2__
+template <int K>
+struct ChannelSampler<float, K> {
+  static void Run(const float* src,
+                  const int* index,
+                  const float* weight,
+                  int size,
+                  float* dst) {
+    int i = 0;
+    const __m256 _zero = _mm256_setzero_ps();
+    const __m256i _invalid = _mm256_set1_epi32(-1);
+    for (; i + 7 < size; i += 8) {
+      __m256 _val = _zero;
+      for (int k = 0; k < K; ++k) {
+        __m256i _idx = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(index + k * size + i));
+        __m256 _mask = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_idx, _invalid));
+        __m256 _v = _mm256_mask_i32gather_ps(_zero, src, _idx, _mask, 4);
+        __m256 _w = _mm256_loadu_ps(weight + k * size + i);
+        _val = _mm256_add_ps(_val, _mm256_mul_ps(_w, _v));
+      }
+      _mm256_storeu_ps(dst + i, _val);
+    }
+    SampleChannel<float, K>(src, index, weight, i, size, dst);
+  }
+};
+#endif
 
-  // calc 4 corner points value
-  DDim v_dim{{n, c, out_h, out_w}};
-  v_wn->Resize(v_dim);
-  v_en->Resize(v_dim);
-  v_ws->Resize(v_dim);
-  v_es->Resize(v_dim);
-  v_wn->template mutable_data<T>();
-  v_en->template mutable_data<T>();
-  v_ws->template mutable_data<T>();
-  v_es->template mutable_data<T>();
-  GetGridPointValue<T>(input, v_wn, *x_w, *y_n);
-  GetGridPointValue<T>(input, v_en, *x_e, *y_n);
-  GetGridPointValue<T>(input, v_ws, *x_w, *y_s);
-  GetGridPointValue<T>(input, v_es, *x_e, *y_s);
+// Apply the tables of each batch to all of its channels, parallel over N*C.
+template <typename T, int K>
+void SampleByTables(const Tensor& input,
+                    const std::vector<int>& index,
+                    const std::vector<T>& weight,
+                    const int out_hw,
+                    Tensor* out) {
+  const int n = input.dims()[0];
+  const int c = input.dims()[1];
+  const int in_hw = input.dims()[2] * input.dims()[3];
+  const T* input_data = input.data<T>();
+  T* output_data = out->template mutable_data<T>();
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int nc = 0; nc < n * c; ++nc) {
+    const int table_offset = (nc / c) * K * out_hw;
+    ChannelSampler<T, K>::Run(input_data + nc * in_hw,
+                              index.data() + table_offset,
+                              weight.data() + table_offset,
+                              out_hw,
+                              output_data + nc * out_hw);
+  }
 }
 
 template <typename T>
@@ -239,56 +210,79 @@ void BilinearInter(const X86Context& ctx,
                    Tensor* grid_x,
                    Tensor* grid_y,
                    Tensor* out) {
-  auto place = lite::fluid::EigenDeviceType<TARGET(kX86)>();
   const int n = grid_x->dims()[0];
-  const int out_h = grid_x->dims()[1];
-  const int out_w = grid_x->dims()[2];
-  const int c = input.dims()[1];
-
-  Tensor x_w, x_e, y_n, y_s;
-  Tensor d_w, d_e, d_n, d_s;
-  Tensor v_wn, v_en, v_ws, v_es;
+  const int out_hw = grid_x->dims()[1] * grid_x->dims()[2];
+  const int in_h = input.dims()[2];
+  const int in_w = input.dims()[3];
+  const T x_max = static_cast<T>(in_w - 1);
+  const T y_max = static_cast<T>(in_h - 1);
+  const T* grid_x_data = grid_x->template data<T>();
+  const T* grid_y_data = grid_y->template data<T>();
 
-  AllNeigbors<T>(ctx,
-                 input,
-                 grid_x,
-                 grid_y,
-                 &x_w,
-                 &x_e,
-                 &y_n,
-                 &y_s,
-                 &d_w,
-                 &d_e,
-                 &d_n,
-                 &d_s,
-                 &v_wn,
-                 &v_en,
-                 &v_ws,
-                 &v_es);
+  // Offsets and weights of the west-north, east-north, west-south and
+  // east-south neighbors, they are computed once for all the channels.
+  std::vector<int> index(n * 4 * out_hw);
+  std::vector<T> weight(n * 4 * out_hw);
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < out_hw; ++j) {
+      const T x = grid_x_data[i * out_hw + j];
+      const T y = grid_y_data[i * out_hw + j];
+      const T x_w = std::floor(x);
+      const T y_n = std::floor(y);
+      const T x_e = x_w + static_cast<T>(1);
+      const T y_s = y_n + static_cast<T>(1);
+      const T d_w = x - x_w;
+      const T d_e = x_e - x;
+      const T d_n = y - y_n;
+      const T d_s = y_s - y;
+      const T xs[4] = {x_w, x_e, x_w, x_e};
+      const T ys[4] = {y_n, y_n, y_s, y_s};
+      const T ws[4] = {d_e * d_s, d_w * d_s, d_e * d_n, d_w * d_n};
+      for (int k = 0; k < 4; ++k) {
+        const int pos = (i * 4 + k) * out_hw + j;
+        if (IsInBound(xs[k], ys[k], x_max, y_max)) {
+          index[pos] =
+              static_cast<int>(ys[k]) * in_w + static_cast<int>(xs[k]);
+          weight[pos] = ws[k];
+        } else {
+          index[pos] = -1;
+          weight[pos] = static_cast<T>(0);
+        }
+      }
+    }
+  }
+  SampleByTables<T, 4>(input, index, weight, out_hw, out);
+}
 
-  auto d_w_t = EigenTensor<T, 3>::From(d_w);
-  auto d_e_t = EigenTensor<T, 3>::From(d_e);
-  auto d_n_t = EigenTensor<T, 3>::From(d_n);
-  auto d_s_t = EigenTensor<T, 3>::From(d_s);
+template <typename T>
+void NearestInter(const X86Context& ctx,
+                  const Tensor& input,
+                  Tensor* grid_x,
+                  Tensor* grid_y,
+                  Tensor* out) {
+  const int n = grid_x->dims()[0];
+  const int out_hw = grid_x->dims()[1] * grid_x->dims()[2];
+  const int in_h = input.dims()[2];
+  const int in_w = input.dims()[3];
+  const T x_max = static_cast<T>(in_w - 1);
+  const T y_max = static_cast<T>(in_h - 1);
+  const T* grid_x_data = grid_x->template data<T>();
+  const T* grid_y_data = grid_y->template data<T>();
 
-  auto d_w_scaled_t =
-      d_w_t.reshape(Array4(n, 1, out_h, out_w)).broadcast(Array4(1, c, 1, 1));
-  auto d_e_scaled_t =
-      d_e_t.reshape(Array4(n, 1, out_h, out_w)).broadcast(Array4(1, c, 1, 1));
-  auto d_n_scaled_t =
-      d_n_t.reshape(Array4(n, 1, out_h, out_w)).broadcast(Array4(1, c, 1, 1));
-  auto d_s_scaled_t =
-      d_s_t.reshape(Array4(n, 1, out_h, out_w)).broadcast(Array4(1, c, 1, 1));
-  auto v_wn_t = EigenTensor<T, 4>::From(v_wn);
-  auto v_en_t = EigenTensor<T, 4>::From(v_en);
-  auto v_ws_t = EigenTensor<T, 4>::From(v_ws);
-  auto v_es_t = EigenTensor<T, 4>::From(v_es);
-  auto output_t = EigenTensor<T, 4>::From(*out);
-  // bilinear interpolaetion by 4 corner points
-  output_t.device(place) = v_wn_t * d_e_scaled_t * d_s_scaled_t +
-                           v_en_t * d_w_scaled_t * d_s_scaled_t +
-                           v_ws_t * d_e_scaled_t * d_n_scaled_t +
-                           v_es_t * d_w_scaled_t * d_n_scaled_t;
+  std::vector<int> index(n * out_hw);
+  std::vector<T> weight(n * out_hw);
+  for (int i = 0; i < n * out_hw; ++i) {
+    const T x = std::round(grid_x_data[i]);
+    const T y = std::round(grid_y_data[i]);
+    if (IsInBound(x, y, x_max, y_max)) {
+      index[i] = static_cast<int>(y) * in_w + static_cast<int>(x);
+      weight[i] = static_cast<T>(1);
+    } else {
+      index[i] = -1;
+      weight[i] = static_cast<T>(0);
+    }
+  }
+  SampleByTables<T, 1>(input, index, weight, out_hw, out);
 }
 
 template <class T>
@@ -307,10 +301,6 @@ void GridSamplerCompute<T>::Run() {
   const int in_h = input_dims[2];
   const int in_w = input_dims[3];
 
-  output->template mutable_data<T>();
-  lite::x86::math::SetConstant<TARGET(kX86), T> set_zero;
-  set_zero(context, output, static_cast<T>(0));
-
   Tensor grid_x, grid_y;
   CalcGridLocations<T>(context,
                        *grid,
@@ -323,11 +313,9 @@ void GridSamplerCompute<T>::Run() {
   if (mode == "bilinear") {
     BilinearInter<T>(context, *input, &grid_x, &grid_y, output);
   } else if (mode == "nearest") {
-    auto grid_x_t = EigenTensor<T, 3>::From(grid_x);
-    auto grid_y_t = EigenTensor<T, 3>::From(grid_y);
-    grid_x_t = grid_x_t.round();
-    grid_y_t = grid_y_t.round();
-    GetGridPointValue<T>(*input, output, grid_x, grid_y);
+    NearestInter<T>(context, *input, &grid_x, &grid_y, output);
+  } else {
+    LOG(FATAL) << "Unsupported mode of grid_sampler: " << mode;
   }
 #else
   LOG(FATAL) << "Error: This model is not supported on Windows Os yet, because "
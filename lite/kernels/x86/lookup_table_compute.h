@@ -40,9 +40,10 @@ class LookupTableCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
     int64_t row_number = table_t->dims()[0];
     int64_t row_width = table_t->dims()[1];
 
+    // The table may be a view of the memory-mapped model file, only the rows
+    // looked up here are paged in.
     const T *table = table_t->template data<T>();
     T *output = output_t->template mutable_data<T>();
-    memset(output, 0, output_t->dims().production() * sizeof(T));
     for (int64_t i = 0; i < ids_numel; ++i) {
       if (padding_idx != -1 && ids[i] == padding_idx) {
         memset(output + i * row_width, 0, row_width * sizeof(T));
@@ -94,6 +94,12 @@ class ReduceCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
     }
   }
 
+  // The Eigen reductions are vectorized, about 0.5 ns per input element, but
+  // dispatching on the ranks and building the expressions costs about 1 us.
+  float EstimateCost() const override {
+    return ElementwiseCost(Param<param_t>().X->dims(), 0.5f, 1000.f);
+  }
+
   virtual ~ReduceCompute() = default;
 };
 
@@ -0,0 +1,169 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/model_parser/base/integrity.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include "lite/utils/hash.h"
+#include "lite/utils/parallel.h"
+
+namespace paddle {
+namespace lite {
+namespace model_parser {
+
+constexpr size_t ModelIntegrityHeader::kSize;
+
+namespace {
+
+constexpr size_t kHeaderFieldsSize = ModelIntegrityHeader::kSize -
+                                     sizeof(uint32_t);
+
+template <typename T>
+void Put(const T& value, char** dst) {
+  std::memcpy(*dst, &value, sizeof(T));
+  *dst += sizeof(T);
+}
+
+template <typename T>
+T Get(const char** src) {
+  T value;
+  std::memcpy(&value, *src, sizeof(T));
+  *src += sizeof(T);
+  return value;
+}
+
+}  // namespace
+
+std::string ModelIntegrityHeader::ContentHash() const {
+  std::string res;
+  res.reserve(sizeof(content_hash) << 1);
+  char hex[3];
+  for (size_t i = 0; i < sizeof(content_hash); ++i) {
+    snprintf(hex, sizeof(hex), "%02x", content_hash[i]);
+    res.append(hex);
+  }
+  return res;
+}
+
+void SerializeIntegrityHeader(const ModelIntegrityHeader& header, char* dst) {
+  char* pos = dst;
+  Put(header.content_size, &pos);
+  Put(header.section_size, &pos);
+  Put(header.num_sections, &pos);
+  std::memcpy(pos, header.content_hash, sizeof(header.content_hash));
+  pos += sizeof(header.content_hash);
+  Put(Crc32(dst, kHeaderFieldsSize), &pos);
+}
+
+bool ParseIntegrityHeader(const char* data,
+                          uint64_t body_size,
+                          ModelIntegrityHeader* header) {
+  CHECK(header);
+  const char* pos = data;
+  header->content_size = Get<uint64_t>(&pos);
+  header->section_size = Get<uint64_t>(&pos);
+  header->num_sections = Get<uint64_t>(&pos);
+  std::memcpy(header->content_hash, pos, sizeof(header->content_hash));
+  pos += sizeof(header->content_hash);
+  if (Get<uint32_t>(&pos) != Crc32(data, kHeaderFieldsSize)) {
+    return false;
+  }
+  // The sizes are checked without overflow, since the checksum of the header
+  // doesn't protect against a forged one.
+  if (header->section_size == 0 || header->content_size > body_size) {
+    return false;
+  }
+  const uint64_t num_sections =
+      (header->content_size + header->section_size - 1) / header->section_size;
+  return header->num_sections == num_sections &&
+         (body_size - header->content_size) / sizeof(uint32_t) ==
+             num_sections &&
+         (body_size - header->content_size) % sizeof(uint32_t) == 0;
+}
+
+bool VerifyModelContent(const ModelIntegrityHeader& header,
+                        const char* content,
+                        int num_threads) {
+  const char* checksums = content + header.content_size;
+  std::atomic<bool> intact{true};
+  ParallelFor(header.num_sections, num_threads, [&](int64_t i) {
+    if (!intact) return;
+    const uint64_t begin = i * header.section_size;
+    const uint64_t size =
+        (std::min)(header.section_size, header.content_size - begin);
+    uint32_t checksum;
+    std::memcpy(&checksum, checksums + i * sizeof(uint32_t), sizeof(checksum));
+    if (Crc32(content + begin, size) != checksum) {
+      intact = false;
+    }
+  });
+  return intact;
+}
+
+IntegrityWriter::IntegrityWriter(const ByteWriter* writer,
+                                 uint64_t section_size)
+    : writer_(writer), section_size_(section_size) {
+  CHECK(writer_);
+  CHECK_GT(section_size_, 0u);
+}
+
+void IntegrityWriter::Write(const void* src, size_t size) const {
+  writer_->Write(src, size);
+  hasher_.Update(src, size);
+  const char* pos = static_cast<const char*>(src);
+  while (size > 0) {
+    const uint64_t used = content_size_ % section_size_;
+    const size_t n =
+        static_cast<size_t>((std::min)(section_size_ - used, uint64_t(size)));
+    section_checksum_ = Crc32(pos, n, section_checksum_);
+    content_size_ += n;
+    pos += n;
+    size -= n;
+    if (content_size_ % section_size_ == 0) {
+      checksums_.push_back(section_checksum_);
+      section_checksum_ = 0;
+    }
+  }
+}
+
+size_t IntegrityWriter::Align(size_t scalar_size) const {
+  const size_t padding_bytes =
+      (scalar_size - current() % scalar_size) % scalar_size;
+  const std::vector<char> zeros(padding_bytes, 0);
+  if (padding_bytes > 0) {
+    Write(zeros.data(), padding_bytes);
+  }
+  return padding_bytes;
+}
+
+ModelIntegrityHeader IntegrityWriter::Finish() const {
+  if (content_size_ % section_size_ != 0) {
+    checksums_.push_back(section_checksum_);
+    section_checksum_ = 0;
+  }
+  ModelIntegrityHeader header;
+  header.content_size = content_size_;
+  header.section_size = section_size_;
+  header.num_sections = checksums_.size();
+  hasher_.Final(header.content_hash);
+  if (!checksums_.empty()) {
+    writer_->Write(checksums_.data(), checksums_.size() * sizeof(uint32_t));
+  }
+  return header;
+}
+
+}  // namespace model_parser
+}  // namespace lite
+}  // namespace paddle
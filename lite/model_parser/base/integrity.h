@@ -0,0 +1,104 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "lite/model_parser/base/io.h"
+#include "lite/utils/md5.h"
+
+namespace paddle {
+namespace lite {
+namespace model_parser {
+
+/*
+ * The naive buffer models with meta_version 4 carry an integrity header after
+ * the meta_version, so that a model can be identified, and a corrupted one
+ * rejected, without parsing it.
+ * ------------------------------------------------------------------------
+ * |      PART        |   Precision  |            Meaning                 |
+ * |  content_size    |   uint64_t   |  bytes of the content              |
+ * |  section_size    |   uint64_t   |  bytes of a section of the content |
+ * |  num_sections    |   uint64_t   |                                    |
+ * |  content_hash    |  uint8_t[16] |  MD5 of the content                |
+ * |  header_checksum |   uint32_t   |  CRC-32 of the fields above        |
+ * ------------------------------------------------------------------------
+ * The content, i.e. the opt_version, the topology and the params, follows the
+ * header, and the CRC-32 of its sections follow the content.
+ */
+constexpr uint64_t kModelSectionSize = 4 << 20;
+
+struct ModelIntegrityHeader {
+  static constexpr size_t kSize = 3 * sizeof(uint64_t) + 16 + sizeof(uint32_t);
+
+  uint64_t content_size{0};
+  uint64_t section_size{kModelSectionSize};
+  uint64_t num_sections{0};
+  uint8_t content_hash[16]{};
+
+  // The content hash as 32 hex characters, like lite::MD5.
+  std::string ContentHash() const;
+
+  // The bytes taken by the content and the checksums of its sections.
+  uint64_t BodySize() const {
+    return content_size + num_sections * sizeof(uint32_t);
+  }
+};
+
+// Write the header and its checksum into `dst` of ModelIntegrityHeader::kSize
+// bytes.
+void SerializeIntegrityHeader(const ModelIntegrityHeader& header, char* dst);
+
+// Parse the header at `data` and check that it is intact, and that its
+// content and the checksums of the sections take the `body_size` bytes which
+// follow it exactly. It only looks at the header, so a truncated or corrupted
+// model is rejected before anything is allocated for it.
+bool ParseIntegrityHeader(const char* data,
+                          uint64_t body_size,
+                          ModelIntegrityHeader* header);
+
+// Check the sections of the content at `content` against their checksums,
+// which follow the content, on `num_threads` threads.
+bool VerifyModelContent(const ModelIntegrityHeader& header,
+                        const char* content,
+                        int num_threads);
+
+// Forward the content of a model to `writer`, and hash it on the way.
+class IntegrityWriter : public ByteWriter {
+ public:
+  explicit IntegrityWriter(const ByteWriter* writer,
+                           uint64_t section_size = kModelSectionSize);
+
+  void Write(const void* src, size_t size) const override;
+  size_t Align(size_t scalar_size) const override;
+  size_t current() const override { return writer_->current(); }
+
+  // Write the checksums of the sections after the content, and return the
+  // header of the content.
+  ModelIntegrityHeader Finish() const;
+
+ private:
+  const ByteWriter* writer_;
+  uint64_t section_size_;
+  mutable uint64_t content_size_{0};
+  mutable uint32_t section_checksum_{0};
+  mutable std::vector<uint32_t> checksums_;
+  mutable MD5Hasher hasher_;
+};
+
+}  // namespace model_parser
+}  // namespace lite
+}  // namespace paddle
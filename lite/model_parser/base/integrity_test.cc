@@ -0,0 +1,82 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/model_parser/base/integrity.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace lite {
+namespace model_parser {
+
+TEST(ModelIntegrity, WriteAndVerify) {
+  const std::string path{"integrity_test.bin"};
+  const uint64_t section_size = 64;
+  std::string content;
+  for (int i = 0; i < 1000; ++i) {
+    content.push_back(static_cast<char>(i * 7));
+  }
+  size_t padding_bytes = 0;
+  {
+    BinaryFileWriter writer{path};
+    char header[ModelIntegrityHeader::kSize] = {0};
+    writer.Write(header, sizeof(header));
+    IntegrityWriter content_writer(&writer, section_size);
+    content_writer.Write(content.data(), 100);
+    // The content is aligned in the file, and the padding is a part of it.
+    padding_bytes = content_writer.Align(64);
+    EXPECT_EQ(writer.current() % 64, 0u);
+    content_writer.Write(content.data() + 100, content.size() - 100);
+    SerializeIntegrityHeader(content_writer.Finish(), header);
+    writer.WriteAt(0, header, sizeof(header));
+  }
+  content.insert(100, padding_bytes, 0);
+
+  auto file = std::make_shared<MappedFile>(path);
+  const char* data = file->data();
+  const uint64_t body_size = file->length() - ModelIntegrityHeader::kSize;
+  ModelIntegrityHeader header;
+  ASSERT_TRUE(ParseIntegrityHeader(data, body_size, &header));
+  EXPECT_EQ(header.content_size, content.size());
+  EXPECT_EQ(header.section_size, section_size);
+  EXPECT_EQ(header.num_sections, (content.size() + 63) / 64);
+  EXPECT_EQ(header.ContentHash(), MD5(content));
+  const char* stored = data + ModelIntegrityHeader::kSize;
+  EXPECT_TRUE(std::equal(content.begin(), content.end(), stored));
+  EXPECT_TRUE(VerifyModelContent(header, stored, 1));
+  EXPECT_TRUE(VerifyModelContent(header, stored, 4));
+
+  // A truncated model or a corrupted header is rejected by the header.
+  EXPECT_FALSE(ParseIntegrityHeader(data, body_size - 1, &header));
+  std::vector<char> copy(data, data + file->length());
+  copy[3] ^= 1;
+  EXPECT_FALSE(ParseIntegrityHeader(copy.data(), body_size, &header));
+  // A corrupted section is rejected by its checksum.
+  copy[3] ^= 1;
+  copy[ModelIntegrityHeader::kSize + 500] ^= 1;
+  ASSERT_TRUE(ParseIntegrityHeader(copy.data(), body_size, &header));
+  EXPECT_FALSE(VerifyModelContent(
+      header, copy.data() + ModelIntegrityHeader::kSize, 4));
+
+  file.reset();
+  std::remove(path.c_str());
+}
+
+}  // namespace model_parser
+}  // namespace lite
+}  // namespace paddle
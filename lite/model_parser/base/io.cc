@@ -13,6 +13,12 @@
 // limitations under the License.
 
 #include "lite/model_parser/base/io.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace paddle {
 namespace lite {
@@ -63,6 +69,102 @@ void BinaryFileWriter::Write(const void* src, size_t size) const {
   cur_ += size;
 }
 
+void BinaryFileWriter::WriteAt(size_t offset,
+                               const void* src,
+                               size_t size) const {
+  CHECK(src);
+  CHECK_LE(offset + size, cur_) << "Only the written bytes can be overwritten.";
+  CHECK_EQ(fseek(file_, offset, SEEK_SET), 0);
+  CHECK_EQ(fwrite(src, 1, size, file_), size) << "Failed to write " << size
+                                              << " bytes.";
+  CHECK_EQ(fseek(file_, 0L, SEEK_END), 0);
+}
+
+MappedFile::MappedFile(const std::string& path) {
+#ifndef _WIN32
+  int fd = open(path.c_str(), O_RDONLY);
+  CHECK_GE(fd, 0) << "Unable to open file: " << path;
+  struct stat st;
+  CHECK_EQ(fstat(fd, &st), 0) << "Unable to stat file: " << path;
+  length_ = static_cast<size_t>(st.st_size);
+  if (length_ > 0) {
+    // A private writable mapping shares the page cache until a page is
+    // written, e.g. by a kernel transforming its weights in place, which
+    // then gets a copy of the page of its own and leaves the file intact.
+    void* addr =
+        mmap(nullptr, length_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    CHECK(addr != MAP_FAILED) << "Unable to map file: " << path;
+    data_ = static_cast<char*>(addr);
+  }
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+#else
+  BinaryFileReader reader(path);
+  length_ = reader.length();
+  contents_.resize(length_);
+  reader.Read(contents_.data(), length_);
+  data_ = contents_.data();
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+  if (data_) {
+    munmap(data_, length_);
+  }
+#endif
+}
+
+void MappedFile::AdviseRandom(const void* ptr, size_t size) const {
+#ifndef _WIN32
+  // madvise requires a page aligned address.
+  const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t begin = static_cast<const char*>(ptr) - data_;
+  const size_t aligned_begin = begin - begin % page_size;
+  CHECK_LE(begin + size, length_);
+  madvise(data_ + aligned_begin, begin + size - aligned_begin, MADV_RANDOM);
+#endif
+}
+
+std::shared_ptr<lite::Buffer> MappedFile::ShareBuffer(const void* ptr,
+                                                      size_t size) {
+  const char* begin = static_cast<const char*>(ptr);
+  CHECK(begin >= data_ && begin + size <= data_ + length_)
+      << "The shared range is out of the mapped file.";
+  auto file = shared_from_this();
+  // The buffer is unowned, the deleter holds a reference to the mapping until
+  // the last tensor releases it. Kernels repacking their weights into more
+  // space than the view has move them to memory of their own.
+  std::shared_ptr<lite::Buffer> buffer(
+      new lite::Buffer(const_cast<char*>(begin), TargetType::kHost, size),
+      [file](lite::Buffer* buffer) { delete buffer; });
+  buffer->set_replaceable(true);
+  return buffer;
+}
+
+MappedFileReader::MappedFileReader(const std::shared_ptr<MappedFile>& file,
+                                   size_t offset)
+    : file_(file) {
+  CHECK(file_);
+  CHECK_LE(offset, file_->length());
+  buf_ = file_->data() + offset;
+  length_ = file_->length() - offset;
+}
+
+void MappedFileReader::Read(void* dst, size_t size) const {
+  CHECK(dst);
+  CHECK_LE(cur_ + size, length_) << "Failed to read " << size << " bytes.";
+  lite::TargetCopy(TargetType::kHost, dst, buf_ + cur_, size);
+  cur_ += size;
+}
+
+const char* MappedFileReader::Skip(size_t size) const {
+  CHECK_LE(cur_ + size, length_) << "Failed to skip " << size << " bytes.";
+  const char* pos = buf_ + cur_;
+  cur_ += size;
+  return pos;
+}
+
 void StringBufferReader::Read(void* dst, size_t size) const {
   CHECK(dst);
   lite::TargetCopy(TargetType::kHost, dst, buf_ + cur_, size);
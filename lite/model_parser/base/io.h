@@ -17,6 +17,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 #include "lite/core/memory.h"
 
 // Use the no_sanitize attribute on a function or a global variable declaration
@@ -118,6 +119,7 @@ class ByteWriter {
   }
 
   virtual size_t Align(size_t bytes_size) const = 0;
+  virtual size_t current() const = 0;
 
   virtual ~ByteWriter() = default;
 
@@ -158,6 +160,10 @@ class BinaryFileWriter : public ByteWriter {
   }
   void Write(const void* src, size_t size) const override;
 
+  // Overwrite the bytes written at `offset`, e.g. a header which depends on
+  // what follows it, and continue at the end of the file.
+  void WriteAt(size_t offset, const void* src, size_t size) const;
+
   // Fill a number of zero characters to align the number
   // of written bytes to a certain position.
   size_t Align(size_t scalar_size) const override {
@@ -167,6 +173,7 @@ class BinaryFileWriter : public ByteWriter {
     }
     return padding_bytes;
   }
+  size_t current() const override { return cur_; }
 
  private:
   FILE* file_{};
@@ -179,6 +186,61 @@ class BinaryFileWriter : public ByteWriter {
   }
 };
 
+// A copy-on-write memory mapping of a whole file. Pages are loaded by the OS
+// on first access and are shared between the processes mapping the same file
+// until they are written.
+class MappedFile : public std::enable_shared_from_this<MappedFile> {
+ public:
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+  const char* data() const { return data_; }
+  size_t length() const { return length_; }
+  bool Contains(const void* ptr) const {
+    const char* pos = static_cast<const char*>(ptr);
+    return pos >= data_ && pos < data_ + length_;
+  }
+
+  // Hint that [ptr, ptr + size) is accessed in random order, so the OS should
+  // not read ahead around each page fault.
+  void AdviseRandom(const void* ptr, size_t size) const;
+
+  // Wrap [ptr, ptr + size) as an unowned host buffer, which keeps the mapping
+  // alive as long as the buffer is referenced. The buffer is replaceable, as
+  // the mapping is private.
+  std::shared_ptr<lite::Buffer> ShareBuffer(const void* ptr, size_t size);
+
+ private:
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  char* data_{nullptr};
+  size_t length_{0};
+#ifdef _WIN32
+  // Mapping is not implemented on windows, the file is read into memory.
+  std::vector<char> contents_;
+#endif
+};
+
+class MappedFileReader : public ByteReader {
+ public:
+  explicit MappedFileReader(const std::shared_ptr<MappedFile>& file,
+                            size_t offset = 0);
+  void Read(void* dst, size_t size) const override;
+  bool ReachEnd() const override { return cur_ >= length_; }
+  size_t length() const override { return length_; }
+  size_t current() const override { return cur_; }
+
+  // Return the address of the next unread byte and move forward `size` bytes
+  // without copying them.
+  const char* Skip(size_t size) const;
+  MappedFile* file() const { return file_.get(); }
+
+ private:
+  std::shared_ptr<MappedFile> file_;
+  const char* buf_;
+  size_t length_;
+  mutable size_t cur_{0};
+};
+
 class StringBufferReader : public ByteReader {
  public:
   explicit StringBufferReader(const std::string& buffer)
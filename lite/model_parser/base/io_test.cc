@@ -0,0 +1,66 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/model_parser/base/io.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace lite {
+namespace model_parser {
+
+TEST(MappedFile, ReplaceSharedBuffer) {
+  const std::string path{"io_test.mapped.bin"};
+  std::vector<float> values(64);
+  for (size_t i = 0; i < values.size(); ++i) values[i] = 0.5f * i;
+  {
+    BinaryFileWriter writer{path};
+    writer.Write(values.data(), values.size() * sizeof(float));
+  }
+
+  {
+    auto file = std::make_shared<MappedFile>(path);
+    const size_t size = values.size() * sizeof(float);
+    auto buffer = file->ShareBuffer(file->data(), size);
+    EXPECT_FALSE(buffer->own_data());
+    EXPECT_TRUE(buffer->replaceable());
+
+    // The view is large enough, so it is kept.
+    buffer->ResetLazy(TARGET(kHost), size / 2);
+    EXPECT_EQ(buffer->data(), file->data());
+    EXPECT_FALSE(buffer->own_data());
+
+    // A larger buffer, e.g. for repacked weights, is memory of its own and
+    // the file is left as it is.
+    buffer->ResetLazy(TARGET(kHost), 2 * size);
+    EXPECT_TRUE(buffer->own_data());
+    EXPECT_FALSE(file->Contains(buffer->data()));
+    EXPECT_GE(buffer->space(), 2 * size);
+    std::memset(buffer->data(), 0, 2 * size);
+    EXPECT_EQ(std::memcmp(file->data(), values.data(), size), 0);
+
+    // Only the views which may be replaced are.
+    lite::Buffer view(const_cast<char*>(file->data()), TARGET(kHost), size);
+    EXPECT_DEATH(view.ResetLazy(TARGET(kHost), 2 * size), "");
+  }
+  std::remove(path.c_str());
+}
+
+}  // namespace model_parser
+}  // namespace lite
+}  // namespace paddle
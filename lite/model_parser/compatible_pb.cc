@@ -55,13 +55,13 @@ namespace lite {
   }
 
 #ifndef LITE_ON_TINY_PUBLISH
-template <>
-void TransformVarDescAnyToCpp<pb::VarDesc>(const pb::VarDesc &any_desc,
-                                           cpp::VarDesc *cpp_desc) {
+template <typename VarDescType>
+void VarDescWithShapeAnyToCpp(const VarDescType &any_desc,
+                              cpp::VarDesc *cpp_desc) {
   cpp_desc->SetName(any_desc.Name());
   cpp_desc->SetType(any_desc.GetType());
   cpp_desc->SetPersistable(any_desc.Persistable());
-  if (any_desc.Name() != "feed" && any_desc.Name() != "fetch") {
+  if (cpp_desc->Name() != "feed" && cpp_desc->Name() != "fetch") {
     VarDataType type = cpp_desc->GetType();
     if (type == VarDataType::LOD_TENSOR) {
       cpp_desc->SetDataType(any_desc.GetDataType());
@@ -72,22 +72,23 @@ void TransformVarDescAnyToCpp<pb::VarDesc>(const pb::VarDesc &any_desc,
     }
   }
 }
+
+template <>
+void TransformVarDescAnyToCpp<pb::VarDesc>(const pb::VarDesc &any_desc,
+                                           cpp::VarDesc *cpp_desc) {
+  VarDescWithShapeAnyToCpp(any_desc, cpp_desc);
+}
+
 template <>
 void TransformVarDescAnyToCpp<fbs::VarDesc>(const fbs::VarDesc &any_desc,
                                             cpp::VarDesc *cpp_desc) {
-  cpp_desc->SetName(any_desc.Name());
-  cpp_desc->SetType(any_desc.GetType());
-  cpp_desc->SetPersistable(any_desc.Persistable());
-  if (any_desc.Name() != "feed" && any_desc.Name() != "fetch") {
-    VarDataType type = cpp_desc->GetType();
-    if (type == VarDataType::LOD_TENSOR) {
-      cpp_desc->SetDataType(any_desc.GetDataType());
-    }
-    if (type == VarDataType::LOD_TENSOR || type == VarDataType::SELECTED_ROWS ||
-        type == VarDataType::LOD_TENSOR_ARRAY) {
-      cpp_desc->SetShape(any_desc.GetShape());
-    }
-  }
+  VarDescWithShapeAnyToCpp(any_desc, cpp_desc);
+}
+
+template <>
+void TransformVarDescAnyToCpp<fbs::VarDescView>(
+    const fbs::VarDescView &any_desc, cpp::VarDesc *cpp_desc) {
+  VarDescWithShapeAnyToCpp(any_desc, cpp_desc);
 }
 
 template <>
@@ -182,11 +183,12 @@ void OpAttrsAnyToCpp(const OpDescType &any_desc, cpp::OpDesc *cpp_desc) {
   // abandoned these attributes to reduce model_size and run-time memory usage.
   // This process is operated on opt tool, so it will not increase
   // initialization time.
-  std::vector<std::string> skiped_attributes = {"op_callstack",
-                                                "op_namescope",
-                                                "op_role",
-                                                "workspace_size_MB",
-                                                "op_role_var"};
+  static const std::vector<std::string> skiped_attributes = {
+      "op_callstack",
+      "op_namescope",
+      "op_role",
+      "workspace_size_MB",
+      "op_role_var"};
   for (const auto &attr_name : any_desc.AttrNames()) {
     auto it = std::find(
         skiped_attributes.begin(), skiped_attributes.end(), attr_name);
@@ -343,6 +345,50 @@ TRANS_VAR_ANY_WITH_CPP_IMPL(pb::VarDesc);
 TRANS_OP_ANY_WITH_CPP_IMPL(pb::OpDesc);
 TRANS_BLOCK_ANY_WITH_CPP_IMPL(OpDesc, VarDesc, pb, framework);
 TRANS_PROGRAM_ANY_WITH_CPP_IMPL(BlockDesc, pb, framework);
+
+// The read-only views of flatbuffers are transformed without unpacking the
+// buffer into the object API first, so every op and var is copied once.
+template <>
+void TransformOpDescAnyToCpp<fbs::OpDescView>(const fbs::OpDescView &any_desc,
+                                              cpp::OpDesc *cpp_desc) {
+  cpp_desc->SetType(any_desc.Type());
+  OpInputsAnyToCpp<fbs::OpDescView>(any_desc, cpp_desc);
+  OpOutputsAnyToCpp<fbs::OpDescView>(any_desc, cpp_desc);
+  OpAttrsAnyToCpp<fbs::OpDescView>(any_desc, cpp_desc);
+}
+
+template <>
+void TransformBlockDescAnyToCpp<fbs::BlockDescView>(
+    const fbs::BlockDescView &any_desc, cpp::BlockDesc *cpp_desc) {
+  cpp_desc->SetIdx(any_desc.Idx());
+  cpp_desc->SetParentIdx(any_desc.ParentIdx());
+  cpp_desc->SetForwardBlockIdx(any_desc.ForwardBlockIdx());
+
+  cpp_desc->ClearOps();
+  for (size_t i = 0; i < any_desc.OpsSize(); ++i) {
+    TransformOpDescAnyToCpp(*any_desc.GetOp<fbs::OpDescView>(i),
+                            cpp_desc->AddOp<cpp::OpDesc>());
+  }
+
+  cpp_desc->ClearVars();
+  for (size_t i = 0; i < any_desc.VarsSize(); ++i) {
+    TransformVarDescAnyToCpp(*any_desc.GetVar<fbs::VarDescView>(i),
+                             cpp_desc->AddVar<cpp::VarDesc>());
+  }
+}
+
+template <>
+void TransformProgramDescAnyToCpp<fbs::ProgramDescView>(
+    const fbs::ProgramDescView &any_desc, cpp::ProgramDesc *cpp_desc) {
+  if (any_desc.HasVersion()) {
+    cpp_desc->SetVersion(any_desc.Version());
+  }
+  cpp_desc->ClearBlocks();
+  for (size_t i = 0; i < any_desc.BlocksSize(); ++i) {
+    TransformBlockDescAnyToCpp(*any_desc.GetBlock<fbs::BlockDescView>(i),
+                               cpp_desc->AddBlock<cpp::BlockDesc>());
+  }
+}
 #endif
 
 #undef TRANS_VAR_ANY_WITH_CPP_IMPL
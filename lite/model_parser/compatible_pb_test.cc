@@ -441,5 +441,14 @@ TEST(ProgramDesc, FbsCpp) {
   fbs::test::CheckProgramCache(&fbs_program_2);
 }
 
+TEST(ProgramDesc, FbsViewCpp) {
+  const fbs::ProgramDescView fbs_program(fbs::test::GenerateProgramCache());
+  cpp::ProgramDesc cpp_program;
+  TransformProgramDescAnyToCpp(fbs_program, &cpp_program);
+  fbs::ProgramDesc fbs_program_2;
+  TransformProgramDescCppToAny(cpp_program, &fbs_program_2);
+  fbs::test::CheckProgramCache(&fbs_program_2);
+}
+
 }  // namespace lite
 }  // namespace paddle
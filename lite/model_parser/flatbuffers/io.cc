@@ -13,17 +13,83 @@
 // limitations under the License.
 
 #include "lite/model_parser/flatbuffers/io.h"
+#include <algorithm>
 #include <cstring>
 #include <limits>
 #include <memory>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 #include "lite/model_parser/base/io.h"
 #include "lite/model_parser/flatbuffers/traits.h"
+#include "lite/utils/parallel.h"
 
 namespace paddle {
 namespace lite {
 namespace fbs {
+
+namespace {
+
+// A param of version 1, described by its entry in the index.
+class ParamEntryView : public ParamDescReadAPI {
+ public:
+  ParamEntryView(const ParamIndexEntry& entry, const void* data)
+      : entry_(entry), data_(data) {}
+  std::string Name() const override { return entry_.name; }
+  std::vector<int64_t> Dim() const override { return entry_.dims; }
+  VarDataType GetDataType() const override { return entry_.data_type; }
+  const void* GetData() const override { return data_; }
+  size_t byte_size() const override { return entry_.size; }
+
+ private:
+  const ParamIndexEntry& entry_;
+  const void* data_;
+};
+
+size_t IndexEntrySize(const ParamIndexEntry& entry, uint16_t version) {
+  size_t size = sizeof(uint32_t) + entry.name.size() + sizeof(int32_t) +
+                sizeof(uint32_t) + entry.dims.size() * sizeof(int64_t) +
+                2 * sizeof(uint64_t);
+  if (version >= kParamsCompressedVersion) {
+    size += sizeof(uint32_t);
+  }
+  return size;
+}
+
+// The data types ConvertPrecisionType accepts.
+bool IsParamDataType(int32_t data_type) {
+  switch (static_cast<VarDataType>(data_type)) {
+    case VarDataType::BOOL:
+    case VarDataType::INT8:
+    case VarDataType::UINT8:
+    case VarDataType::INT16:
+    case VarDataType::INT32:
+    case VarDataType::INT64:
+    case VarDataType::FP16:
+    case VarDataType::FP32:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// The bytes of the elements of an uncompressed param.
+uint64_t ParamDataSize(const ParamIndexEntry& entry) {
+  uint64_t size =
+      lite_api::PrecisionTypeLength(lite::ConvertPrecisionType(entry.data_type));
+  for (auto dim : entry.dims) {
+    CHECK_GE(dim, 0) << "File format error: The param " << entry.name
+                     << " has a negative dimension.";
+    CHECK(dim == 0 ||
+          size <= (std::numeric_limits<uint64_t>::max)() /
+                      static_cast<uint64_t>(dim))
+        << "File format error: The param " << entry.name << " is too large.";
+    size *= dim;
+  }
+  return size;
+}
+
+}  // namespace
 namespace deprecated {
 void SetCombinedParamsWithScope(const lite::Scope& scope,
                                 const std::set<std::string>& param_names,
@@ -68,9 +134,38 @@ void FillTensor(lite::Tensor* tensor, const ParamDescReadAPI& param) {
   std::memcpy(dst, param.GetData(), param.byte_size());
   tensor->set_persistable(true);
 }
+
+bool IsDataAligned(const ParamDescReadAPI& param) {
+  // The kernels may load the elements with aligned instructions.
+  size_t align = lite_api::PrecisionTypeLength(
+      lite::ConvertPrecisionType(param.GetDataType()));
+  auto address = reinterpret_cast<uintptr_t>(param.GetData());
+  return align == 0 || address % align == 0;
+}
+
+void FillTensorView(lite::Tensor* tensor,
+                    const ParamDescReadAPI& param,
+                    model_parser::MappedFile* file) {
+  CHECK(tensor);
+  CHECK(file);
+  tensor->Resize(param.Dim());
+  tensor->set_precision(lite::ConvertPrecisionType(param.GetDataType()));
+  CHECK(param.GetData());
+  tensor->ResetBuffer(file->ShareBuffer(param.GetData(), param.byte_size()),
+                      param.byte_size());
+  tensor->set_persistable(true);
+}
+
 #ifdef LITE_WITH_FLATBUFFERS_DESC
 void ParamSerializer::ForwardWrite(const lite::Scope& scope,
                                    const std::set<std::string>& param_names) {
+  if (version_ == kParamsIndexedVersion ||
+      version_ == kParamsCompressedVersion) {
+    ForwardWriteIndexed(scope, param_names);
+    return;
+  }
+  CHECK_LE(param_names.size(), (std::numeric_limits<uint16_t>::max)())
+      << "The number of params is out of range.";
   const uint16_t params_size = param_names.size();
   // meta_information
   uint32_t max_tensor_size = 0;
@@ -107,6 +202,86 @@ void ParamSerializer::ForwardWrite(const lite::Scope& scope,
   }
 }
 
+void ParamSerializer::ForwardWriteIndexed(
+    const lite::Scope& scope, const std::set<std::string>& param_names) {
+  CHECK(codec_ == ParamCodec::kNone || version_ >= kParamsCompressedVersion)
+      << "The params of version " << version_ << " can't be encoded.";
+  // 1. Encode the params and lay out the data after the index.
+  std::vector<ParamIndexEntry> index;
+  std::vector<const lite::Tensor*> tensors;
+  for (const auto& name : param_names) {
+    auto& tensor = scope.FindVar(name)->Get<lite::Tensor>();
+    ParamIndexEntry entry;
+    entry.name = name;
+    entry.data_type = lite::ConvertPrecisionType(tensor.precision());
+    entry.dims = tensor.dims().Vectorize();
+    entry.size = tensor.memory_size();
+    index.push_back(entry);
+    tensors.push_back(&tensor);
+  }
+  std::vector<std::vector<char>> encoded(index.size());
+  if (codec_ != ParamCodec::kNone) {
+    ParallelFor(index.size(),
+                (std::max)(std::thread::hardware_concurrency(), 1U),
+                [&](int64_t i) {
+                  auto& entry = index[i];
+                  if (EncodeParamData(codec_,
+                                      entry.data_type,
+                                      tensors[i]->raw_data(),
+                                      entry.size,
+                                      &encoded[i])) {
+                    entry.codec = codec_;
+                    entry.size = encoded[i].size();
+                  }
+                });
+  }
+  uint64_t max_data_size = 0;
+  uint64_t index_size = 0;
+  for (const auto& entry : index) {
+    max_data_size = (std::max)(max_data_size, entry.size);
+    index_size += IndexEntrySize(entry, version_);
+  }
+  const size_t begin = writer_->current();
+  size_t pos = begin + 3 * sizeof(uint64_t) + index_size;
+  for (auto& entry : index) {
+    pos += (kParamsDataAlignment - pos % kParamsDataAlignment) %
+           kParamsDataAlignment;
+    entry.offset = pos - begin;
+    pos += entry.size;
+  }
+
+  // 2. Write the index.
+  writer_->Write<uint64_t>(index.size());
+  writer_->Write<uint64_t>(max_data_size);
+  writer_->Write<uint64_t>(index_size);
+  for (const auto& entry : index) {
+    writer_->Write<uint32_t>(entry.name.size());
+    writer_->Write(entry.name.data(), entry.name.size());
+    writer_->Write<int32_t>(static_cast<int32_t>(entry.data_type));
+    writer_->Write<uint32_t>(entry.dims.size());
+    for (auto dim : entry.dims) {
+      writer_->Write<int64_t>(dim);
+    }
+    writer_->Write<uint64_t>(entry.offset);
+    writer_->Write<uint64_t>(entry.size);
+    if (version_ >= kParamsCompressedVersion) {
+      writer_->Write<uint32_t>(static_cast<uint32_t>(entry.codec));
+    }
+  }
+
+  // 3. Write the data.
+  for (size_t i = 0; i < index.size(); ++i) {
+    writer_->Align(kParamsDataAlignment);
+    CHECK_EQ(writer_->current() - begin, index[i].offset);
+    if (index[i].size > 0) {
+      writer_->Write(index[i].codec == ParamCodec::kNone
+                         ? tensors[i]->raw_data()
+                         : encoded[i].data(),
+                     index[i].size);
+    }
+  }
+}
+
 void ParamSerializer::WriteHeader() {
   // 1. version id
   writer_->Write<uint16_t>(version_);
@@ -117,6 +292,10 @@ void ParamSerializer::WriteHeader() {
 
 void ParamDeserializer::ForwardRead(lite::Scope* scope) {
   CHECK(scope) << "The pointer of scope is nullptr";
+  if (version_ != 0U) {
+    ForwardReadIndexed(scope);
+    return;
+  }
   uint16_t header_size = reader_->Read<uint16_t>();
   ReadBytesToBuffer(header_size);
   char const* data = static_cast<char const*>(buf_->data());
@@ -124,23 +303,187 @@ void ParamDeserializer::ForwardRead(lite::Scope* scope) {
   uint32_t max_tensor_size =
       *reinterpret_cast<uint32_t const*>(data + sizeof(uint16_t));
 
-  buf_->ResetLazy(max_tensor_size);
+  if (!mapped_reader_) {
+    buf_->ResetLazy(max_tensor_size);
+  }
+  std::vector<std::pair<lite::Tensor*, std::unique_ptr<ParamDescReadAPI>>>
+      mapped_params;
   for (size_t i = 0; i < params_size; ++i) {
     uint32_t total_size = reader_->Read<uint32_t>();
     uint32_t offset = reader_->Read<uint32_t>();
     uint32_t param_bytes = total_size - offset;
     ReadBytesToBuffer(offset - sizeof(offset));
+    if (mapped_reader_) {
+      // The param desc is parsed in place, the tensors are filled after all
+      // the params are located.
+      std::unique_ptr<ParamDescReadAPI> param(new fbs::ParamDescView(
+          mapped_reader_->Skip(param_bytes), param_bytes));
+      auto* tensor = scope->Var(param->Name())->GetMutable<lite::Tensor>();
+      mapped_params.emplace_back(tensor, std::move(param));
+      continue;
+    }
     ReadBytesToBuffer(param_bytes);
     fbs::ParamDescView param(buf_.get());
     FillTensor(scope->Var(param.Name())->GetMutable<lite::Tensor>(), param);
   }
+  FillMappedParams(mapped_params);
+}
+
+void ParamDeserializer::FillMappedParams(
+    const std::vector<std::pair<lite::Tensor*,
+                                std::unique_ptr<ParamDescReadAPI>>>& params) {
+  // Only the params which are not shared with the mapping are copied into
+  // their tensors. The tensors are independent, so they are filled on
+  // several threads, which also page in the file in parallel.
+  ParallelFor(params.size(), num_threads_, [&](int64_t i) {
+    auto* tensor = params[i].first;
+    const auto& param = *params[i].second;
+    if (mapped_params_.count(param.Name()) && IsDataAligned(param)) {
+      FillTensorView(tensor, param, mapped_reader_->file());
+    } else {
+      FillTensor(tensor, param);
+    }
+  });
+}
+
+void ParamDeserializer::ReadIndex(uint64_t params_size, uint64_t index_size) {
+  ReadBytesToBuffer(index_size);
+  const char* cur = static_cast<const char*>(buf_->data());
+  const char* end = cur + index_size;
+  auto read = [&](void* dst, size_t size) {
+    CHECK_LE(size, static_cast<size_t>(end - cur))
+        << "File format error: The index of params is truncated.";
+    std::memcpy(dst, cur, size);
+    cur += size;
+  };
+  // Every entry holds at least its fixed size fields.
+  CHECK_LE(params_size, index_size / IndexEntrySize(ParamIndexEntry(), version_))
+      << "File format error: The index of params is truncated.";
+  index_.resize(params_size);
+  for (auto& entry : index_) {
+    uint32_t name_size;
+    read(&name_size, sizeof(name_size));
+    CHECK_LE(name_size, static_cast<size_t>(end - cur))
+        << "File format error: The index of params is truncated.";
+    entry.name.resize(name_size);
+    read(&entry.name[0], name_size);
+    int32_t data_type;
+    read(&data_type, sizeof(data_type));
+    CHECK(IsParamDataType(data_type))
+        << "File format error: The param " << entry.name
+        << " has an illegal data type " << data_type << ".";
+    entry.data_type = static_cast<VarDataType>(data_type);
+    uint32_t rank;
+    read(&rank, sizeof(rank));
+    CHECK_LE(rank, static_cast<size_t>(end - cur) / sizeof(int64_t))
+        << "File format error: The index of params is truncated.";
+    entry.dims.resize(rank);
+    read(entry.dims.data(), rank * sizeof(int64_t));
+    read(&entry.offset, sizeof(entry.offset));
+    read(&entry.size, sizeof(entry.size));
+    if (version_ >= kParamsCompressedVersion) {
+      uint32_t codec;
+      read(&codec, sizeof(codec));
+      entry.codec = static_cast<ParamCodec>(codec);
+    }
+  }
+}
+
+void ParamDeserializer::ForwardReadIndexed(lite::Scope* scope) {
+  const size_t begin = reader_->current();
+  const uint64_t params_size = reader_->Read<uint64_t>();
+  reader_->Read<uint64_t>();  // max_data_size
+  const uint64_t index_size = reader_->Read<uint64_t>();
+  CHECK_LE(index_size, reader_->length() - reader_->current())
+      << "File format error: The index of params is truncated.";
+  ReadIndex(params_size, index_size);
+
+  // The data is read in the order of the index, skipping the padding.
+  std::vector<std::pair<lite::Tensor*, std::unique_ptr<ParamDescReadAPI>>>
+      mapped_params;
+  // The encoded params are decoded after all of them are read.
+  std::vector<std::pair<lite::Tensor*, const ParamIndexEntry*>> encoded_params;
+  std::vector<const void*> encoded_data;
+  std::vector<std::unique_ptr<char[]>> encoded_buffers;
+  for (const auto& entry : index_) {
+    const size_t pos = reader_->current() - begin;
+    CHECK_LE(pos, entry.offset)
+        << "File format error: The params are not sorted by offset.";
+    CHECK_LE(entry.offset - pos, reader_->length() - reader_->current())
+        << "File format error: The param " << entry.name << " is truncated.";
+    CHECK_LE(entry.size,
+             reader_->length() - reader_->current() - (entry.offset - pos))
+        << "File format error: The param " << entry.name << " is truncated.";
+    const uint64_t data_size = ParamDataSize(entry);
+    if (entry.codec == ParamCodec::kNone) {
+      CHECK_EQ(entry.size, data_size)
+          << "File format error: The size of the param " << entry.name
+          << " doesn't match its dimensions.";
+    }
+    auto* tensor = scope->Var(entry.name)->GetMutable<lite::Tensor>();
+    if (mapped_reader_) {
+      mapped_reader_->Skip(entry.offset - pos);
+    } else {
+      ReadBytesToBuffer(entry.offset - pos);
+    }
+    if (entry.codec != ParamCodec::kNone) {
+      if (mapped_reader_) {
+        encoded_data.push_back(mapped_reader_->Skip(entry.size));
+      } else {
+        encoded_buffers.emplace_back(new char[entry.size]);
+        reader_->Read(encoded_buffers.back().get(), entry.size);
+        encoded_data.push_back(encoded_buffers.back().get());
+      }
+      encoded_params.emplace_back(tensor, &entry);
+      continue;
+    }
+    if (mapped_reader_) {
+      std::unique_ptr<ParamDescReadAPI> param(
+          new ParamEntryView(entry, mapped_reader_->Skip(entry.size)));
+      mapped_params.emplace_back(tensor, std::move(param));
+      continue;
+    }
+    // The data is read into the tensor without an intermediate copy.
+    tensor->Resize(entry.dims);
+    tensor->set_precision(lite::ConvertPrecisionType(entry.data_type));
+    if (entry.size > 0) {
+      reader_->Read(tensor->mutable_data(entry.size), entry.size);
+    }
+    tensor->set_persistable(true);
+  }
+  FillMappedParams(mapped_params);
+  FillEncodedParams(encoded_params, encoded_data);
+}
+
+void ParamDeserializer::FillEncodedParams(
+    const std::vector<std::pair<lite::Tensor*, const ParamIndexEntry*>>&
+        params,
+    const std::vector<const void*>& data) {
+  ParallelFor(params.size(), num_threads_, [&](int64_t i) {
+    auto* tensor = params[i].first;
+    const auto& entry = *params[i].second;
+    const auto precision = lite::ConvertPrecisionType(entry.data_type);
+    tensor->Resize(entry.dims);
+    tensor->set_precision(precision);
+    const size_t size =
+        tensor->numel() * lite_api::PrecisionTypeLength(precision);
+    DecodeParamData(entry.codec,
+                    entry.data_type,
+                    data[i],
+                    entry.size,
+                    tensor->mutable_data(size),
+                    size);
+    tensor->set_persistable(true);
+  });
 }
 
 void ParamDeserializer::ReadHeader() {
   // 1. version id
-  uint16_t version = reader_->Read<uint16_t>();
-  CHECK_EQ(version, 0U)
-      << "File format error: The version of params must be zero.";
+  version_ = reader_->Read<uint16_t>();
+  CHECK(version_ == 0U || version_ == kParamsIndexedVersion ||
+        version_ == kParamsCompressedVersion)
+      << "File format error: The version of params " << version_
+      << " is not supported.";
   // 2. meta version
   uint16_t meta_size = reader_->Read<uint16_t>();
   ReadBytesToBuffer(meta_size);
@@ -17,9 +17,11 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 #include "lite/core/scope.h"
 #include "lite/core/variable.h"
+#include "lite/model_parser/flatbuffers/param_codec.h"
 #include "lite/model_parser/flatbuffers/param_desc.h"
 #include "lite/model_parser/flatbuffers/program_desc.h"
 
@@ -33,6 +35,49 @@ void FillParam(const std::string& name,
 
 void FillTensor(lite::Tensor* tensor, const ParamDescReadAPI& param);
 
+// Whether the param data is aligned to the size of its elements, so that a
+// tensor can share it.
+bool IsDataAligned(const ParamDescReadAPI& param);
+
+// Let the tensor share the param data which lives in the mapped file instead
+// of holding a copy of it.
+void FillTensorView(lite::Tensor* tensor,
+                    const ParamDescReadAPI& param,
+                    model_parser::MappedFile* file);
+
+/*
+ * Version 0 of the params, which is used by models with meta_version 2, is a
+ * sequence of param descs whose count and sizes are stored in 16 and 32 bits.
+ * Version 1, which is used by models with meta_version 3, stores the count
+ * and the sizes in 64 bits, and an index of the params before their data:
+ * ----------------------------------------------------------
+ * |   PART           |   Precision   |   Length(byte)      |
+ * |   params_size    |   uint64_t    |         8           |
+ * |   max_data_size  |   uint64_t    |         8           |
+ * |   index_size     |   uint64_t    |         8           |
+ * |   index          |   entries     |   index_size byte   |
+ * |   data           |   char[]      |                     |
+ * ----------------------------------------------------------
+ * Every entry of the index stores the name, the data type and the dims of a
+ * param, and the offset and the size of its data. The offsets are counted
+ * from `params_size`, and the data is aligned to 64 bytes in the file, so it
+ * can be shared with a mapping of the file.
+ * Version 2 adds the codec of the data (uint32_t) to the end of the entries,
+ * and the size is the one of the encoded data.
+ */
+constexpr uint16_t kParamsIndexedVersion = 1;
+constexpr uint16_t kParamsCompressedVersion = 2;
+constexpr size_t kParamsDataAlignment = 64;
+
+struct ParamIndexEntry {
+  std::string name;
+  VarDataType data_type{VarDataType::FP32};
+  std::vector<int64_t> dims;
+  uint64_t offset{0};
+  uint64_t size{0};
+  ParamCodec codec{ParamCodec::kNone};
+};
+
 #ifdef LITE_WITH_FLATBUFFERS_DESC
 class ParamSerializer {
  public:
@@ -45,11 +90,17 @@ class ParamSerializer {
   }
   void ForwardWrite(const lite::Scope& scope,
                     const std::set<std::string>& param_names);
+  // The codec of the params of version 2, which is applied to the params it
+  // makes smaller.
+  void set_codec(ParamCodec codec) { codec_ = codec; }
 
  private:
   void WriteHeader();
+  void ForwardWriteIndexed(const lite::Scope& scope,
+                           const std::set<std::string>& param_names);
   model_parser::ByteWriter* writer_{nullptr};
   uint16_t version_{0};
+  ParamCodec codec_{ParamCodec::kNone};
   std::unique_ptr<model_parser::Buffer> buf_;
 };
 #endif
@@ -62,15 +113,45 @@ class ParamDeserializer {
         << "A valid reader should be passed in the ctor of param deserializer.";
     ReadHeader();
   }
+  // Read params from a mapped file. Tensors of the params in `mapped_params`
+  // view the mapping directly, so their pages are loaded lazily on access.
+  ParamDeserializer(model_parser::MappedFileReader* reader,
+                    const std::set<std::string>& mapped_params)
+      : ParamDeserializer(reader) {
+    mapped_reader_ = reader;
+    mapped_params_ = mapped_params;
+  }
   void ForwardRead(lite::Scope* scope);
 
+  uint16_t version() const { return version_; }
+  // The number of threads filling the tensors of the params read from a
+  // mapped file.
+  void set_num_threads(int num_threads) { num_threads_ = num_threads; }
+  // The index of the params of version 1 or 2, available after ForwardRead.
+  const std::vector<ParamIndexEntry>& index() const { return index_; }
+
  private:
   void ReadBytesToBuffer(size_t size) {
     buf_->ResetLazy(size);
     reader_->Read(buf_->data(), size);
   }
   void ReadHeader();
+  void ForwardReadIndexed(lite::Scope* scope);
+  void ReadIndex(uint64_t params_size, uint64_t index_size);
+  void FillMappedParams(
+      const std::vector<std::pair<lite::Tensor*,
+                                  std::unique_ptr<ParamDescReadAPI>>>& params);
+  // Decode the encoded data of the params of the entries into their tensors.
+  void FillEncodedParams(
+      const std::vector<std::pair<lite::Tensor*, const ParamIndexEntry*>>&
+          params,
+      const std::vector<const void*>& data);
   model_parser::ByteReader* reader_{nullptr};
+  uint16_t version_{0};
+  std::vector<ParamIndexEntry> index_;
+  model_parser::MappedFileReader* mapped_reader_{nullptr};
+  std::set<std::string> mapped_params_;
+  int num_threads_{1};
   std::unique_ptr<model_parser::Buffer> buf_;
 };
 
@@ -14,6 +14,8 @@
 
 #include "lite/model_parser/flatbuffers/io.h"
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
 #include <functional>
 #include <string>
 #include <utility>
@@ -128,6 +130,293 @@ TEST(CombinedParamsDesc, Scope) {
     deserializer.ForwardRead(&scope_3);
     check_params(scope_3);
   }
+
+  {
+    Scope scope_4;
+    LOG(INFO) << "Load params from mapped file...";
+    auto file = std::make_shared<model_parser::MappedFile>(path);
+    model_parser::MappedFileReader reader(file);
+    fbs::ParamDeserializer deserializer(&reader, {param_names[0]});
+    deserializer.ForwardRead(&scope_4);
+    check_params(scope_4);
+    const auto& tensor = scope_4.FindVar(param_names[0])->Get<Tensor>();
+    const char* data = static_cast<const char*>(tensor.raw_data());
+    CHECK(data >= file->data() && data < file->data() + file->length());
+  }
+
+  {
+    Scope scope_5;
+    LOG(INFO) << "Write params shared with mapped file...";
+    auto file = std::make_shared<model_parser::MappedFile>(path);
+    model_parser::MappedFileReader reader(file);
+    fbs::ParamDeserializer deserializer(&reader, params_set);
+    deserializer.ForwardRead(&scope_5);
+    check_params(scope_5);
+    // The written pages are private to the process.
+    auto* tensor = scope_5.FindVar(param_names[0])->GetMutable<Tensor>();
+    CHECK(file->Contains(tensor->raw_data()));
+    auto* data = tensor->mutable_data<float>();
+    for (int64_t i = 0; i < tensor->numel(); ++i) {
+      data[i] = -1.f;
+    }
+    // Repacking a weight into more space than the mapping gives moves it to
+    // memory of its own, the way the kernels transform their filters.
+    Tensor padded;
+    set_tensor<float>(&padded, std::vector<int64_t>({64, 4}));
+    tensor->CopyDataFrom(padded);
+    EXPECT_FALSE(file->Contains(tensor->raw_data()));
+    EXPECT_TRUE(TensorCompareWith(*tensor, padded));
+    Scope scope_6;
+    model_parser::BinaryFileReader file_reader(path);
+    fbs::ParamDeserializer file_deserializer(&file_reader);
+    file_deserializer.ForwardRead(&scope_6);
+    check_params(scope_6);
+  }
+}
+
+TEST(CombinedParamsDesc, Indexed) {
+  const std::string path{"io_test.indexed_params.fbs"};
+  Scope scope;
+  std::vector<std::string> param_names({"var_0", "var_1", "var_2"});
+  Tensor* tensor_0 = scope.Var(param_names[0])->GetMutable<Tensor>();
+  set_tensor<float>(tensor_0, std::vector<int64_t>({3, 2}));
+  Tensor* tensor_1 = scope.Var(param_names[1])->GetMutable<Tensor>();
+  set_tensor<int8_t>(tensor_1, std::vector<int64_t>({10, 1}));
+  Tensor* tensor_2 = scope.Var(param_names[2])->GetMutable<Tensor>();
+  set_tensor<int16_t>(tensor_2, std::vector<int64_t>({16, 1}));
+  std::set<std::string> params_set(param_names.begin(), param_names.end());
+  {
+    model_parser::BinaryFileWriter writer{path};
+    // The params don't start at an aligned position in the file.
+    const uint16_t meta_version = 3;
+    writer.Write(&meta_version, sizeof(uint16_t));
+    fbs::ParamSerializer serializer{&writer, kParamsIndexedVersion};
+    serializer.ForwardWrite(scope, params_set);
+  }
+
+  auto check_params = [&](const lite::Scope& loaded) {
+    CHECK(TensorCompareWith(*tensor_0,
+                            loaded.FindVar(param_names[0])->Get<Tensor>()));
+    CHECK(TensorCompareWith(*tensor_1,
+                            loaded.FindVar(param_names[1])->Get<Tensor>()));
+    CHECK(TensorCompareWith(*tensor_2,
+                            loaded.FindVar(param_names[2])->Get<Tensor>()));
+  };
+
+  {
+    Scope scope_0;
+    model_parser::BinaryFileReader reader(path, sizeof(uint16_t));
+    fbs::ParamDeserializer deserializer(&reader);
+    EXPECT_EQ(deserializer.version(), kParamsIndexedVersion);
+    deserializer.ForwardRead(&scope_0);
+    check_params(scope_0);
+    ASSERT_EQ(deserializer.index().size(), 3u);
+    EXPECT_EQ(deserializer.index()[1].name, param_names[1]);
+    EXPECT_EQ(deserializer.index()[1].size, 10u);
+  }
+
+  {
+    Scope scope_1;
+    auto file = std::make_shared<model_parser::MappedFile>(path);
+    model_parser::MappedFileReader reader(file, sizeof(uint16_t));
+    fbs::ParamDeserializer deserializer(&reader, params_set);
+    deserializer.ForwardRead(&scope_1);
+    check_params(scope_1);
+    // All the data is aligned in the file, so it is shared with the mapping.
+    for (auto& name : param_names) {
+      const auto* data = scope_1.FindVar(name)->Get<Tensor>().raw_data();
+      EXPECT_TRUE(file->Contains(data));
+      const size_t offset = static_cast<const char*>(data) - file->data();
+      EXPECT_EQ(offset % kParamsDataAlignment, 0u);
+    }
+  }
+
+  {
+    Scope scope_2;
+    auto file = std::make_shared<model_parser::MappedFile>(path);
+    model_parser::MappedFileReader reader(file, sizeof(uint16_t));
+    fbs::ParamDeserializer deserializer(&reader, {});
+    // The params are copied out of the mapping on several threads.
+    deserializer.set_num_threads(4);
+    deserializer.ForwardRead(&scope_2);
+    check_params(scope_2);
+    for (auto& name : param_names) {
+      const auto* data = scope_2.FindVar(name)->Get<Tensor>().raw_data();
+      EXPECT_FALSE(file->Contains(data));
+    }
+  }
+}
+
+TEST(CombinedParamsDesc, CorruptedIndex) {
+  const std::string path{"io_test.corrupted_params.fbs"};
+  Scope scope;
+  std::vector<std::string> param_names({"var_0", "var_1"});
+  set_tensor<float>(scope.Var(param_names[0])->GetMutable<Tensor>(),
+                    std::vector<int64_t>({3, 2}));
+  set_tensor<int8_t>(scope.Var(param_names[1])->GetMutable<Tensor>(),
+                     std::vector<int64_t>({10, 1}));
+  {
+    model_parser::BinaryFileWriter writer{path};
+    fbs::ParamSerializer serializer{&writer, kParamsIndexedVersion};
+    serializer.ForwardWrite(
+        scope, std::set<std::string>(param_names.begin(), param_names.end()));
+  }
+  std::string bytes;
+  {
+    model_parser::BinaryFileReader reader(path);
+    bytes = reader.ReadToString(reader.length());
+  }
+  std::remove(path.c_str());
+
+  // Every entry is the name size, the name, the data type, the rank, the
+  // dimensions, the offset and the size of the data, and the entries follow
+  // the number of params, the largest data size and the size of the index.
+  const size_t var_0 = bytes.find(param_names[0]);
+  const size_t var_1 = bytes.find(param_names[1]);
+  ASSERT_NE(var_0, std::string::npos);
+  ASSERT_NE(var_1, std::string::npos);
+  const size_t params_size_pos = var_0 - sizeof(uint32_t) - 3 * sizeof(uint64_t);
+  const size_t data_type_pos = var_1 + param_names[1].size();
+  const size_t rank_pos = data_type_pos + sizeof(int32_t);
+  const size_t data_size_pos =
+      rank_pos + sizeof(uint32_t) + 3 * sizeof(int64_t);
+  auto read = [](const std::string& bytes) {
+    Scope loaded;
+    model_parser::StringBufferReader reader(bytes);
+    fbs::ParamDeserializer deserializer(&reader);
+    deserializer.ForwardRead(&loaded);
+  };
+  auto corrupt = [&](size_t pos, uint64_t value, size_t size) {
+    std::string corrupted = bytes;
+    std::memcpy(&corrupted[pos], &value, size);
+    return corrupted;
+  };
+
+  read(bytes);
+  EXPECT_DEATH(read(corrupt(params_size_pos, 1ULL << 40, sizeof(uint64_t))),
+               "");
+  EXPECT_DEATH(read(corrupt(params_size_pos + 2 * sizeof(uint64_t),
+                            1ULL << 40,
+                            sizeof(uint64_t))),
+               "");
+  EXPECT_DEATH(
+      read(corrupt(var_0 - sizeof(uint32_t), 0xFFFFFFFFU, sizeof(uint32_t))),
+      "");
+  EXPECT_DEATH(read(corrupt(data_type_pos, 100, sizeof(int32_t))), "");
+  EXPECT_DEATH(read(corrupt(rank_pos, 0xFFFFFFFFU, sizeof(uint32_t))), "");
+  // The int8 data of 10 elements takes 10 bytes.
+  EXPECT_DEATH(read(corrupt(data_size_pos, 11, sizeof(uint64_t))), "");
+  EXPECT_DEATH(read(corrupt(data_size_pos, 1ULL << 40, sizeof(uint64_t))), "");
+}
+
+TEST(CombinedParamsDesc, Compressed) {
+  const std::string path{"io_test.compressed_params.fbs"};
+  Scope scope;
+  Tensor* weight = scope.Var("weight")->GetMutable<Tensor>();
+  weight->Resize({64, 16});
+  auto* weight_data = weight->mutable_data<float>();
+  for (int64_t i = 0; i < weight->numel(); ++i) {
+    weight_data[i] = 0.25f * (i % 13) - 1.f;
+  }
+  weight->set_persistable(true);
+  Tensor* ids = scope.Var("ids")->GetMutable<Tensor>();
+  ids->Resize({256});
+  auto* ids_data = ids->mutable_data<int64_t>();
+  for (int64_t i = 0; i < ids->numel(); ++i) ids_data[i] = i % 5;
+  ids->set_persistable(true);
+  // Too small to be made smaller, it is stored as it is.
+  Tensor* bias = scope.Var("bias")->GetMutable<Tensor>();
+  set_tensor<int8_t>(bias, std::vector<int64_t>({3}));
+  const std::set<std::string> params_set({"weight", "ids", "bias"});
+
+  for (auto codec : {ParamCodec::kFP16, ParamCodec::kBF16, ParamCodec::kLZ}) {
+    {
+      model_parser::BinaryFileWriter writer{path};
+      fbs::ParamSerializer serializer{&writer, kParamsCompressedVersion};
+      serializer.set_codec(codec);
+      serializer.ForwardWrite(scope, params_set);
+    }
+    auto check_params = [&](const lite::Scope& loaded) {
+      // The values of the weight are exact in half floats.
+      CHECK(
+          TensorCompareWith(*weight, loaded.FindVar("weight")->Get<Tensor>()));
+      CHECK(TensorCompareWith(*ids, loaded.FindVar("ids")->Get<Tensor>()));
+      CHECK(TensorCompareWith(*bias, loaded.FindVar("bias")->Get<Tensor>()));
+    };
+    {
+      Scope scope_0;
+      model_parser::BinaryFileReader reader(path);
+      fbs::ParamDeserializer deserializer(&reader);
+      EXPECT_EQ(deserializer.version(), kParamsCompressedVersion);
+      deserializer.ForwardRead(&scope_0);
+      check_params(scope_0);
+      for (auto& entry : deserializer.index()) {
+        if (entry.name == "weight") {
+          EXPECT_EQ(entry.codec, codec);
+          EXPECT_LT(entry.size, weight->memory_size());
+        } else if (entry.name == "ids") {
+          // Only the lossless codec applies to the ints.
+          EXPECT_EQ(entry.codec == ParamCodec::kLZ, codec == ParamCodec::kLZ);
+        } else {
+          EXPECT_EQ(entry.codec, ParamCodec::kNone);
+        }
+      }
+    }
+    {
+      Scope scope_1;
+      auto file = std::make_shared<model_parser::MappedFile>(path);
+      model_parser::MappedFileReader reader(file);
+      fbs::ParamDeserializer deserializer(&reader, params_set);
+      deserializer.set_num_threads(4);
+      deserializer.ForwardRead(&scope_1);
+      check_params(scope_1);
+      // The decoded params are not shared with the mapping.
+      const auto* data = scope_1.FindVar("weight")->Get<Tensor>().raw_data();
+      EXPECT_FALSE(file->Contains(data));
+    }
+  }
+}
+
+TEST(ParamCodec, RoundTrip) {
+  // Long runs, short repeats and random bytes.
+  std::vector<int32_t> values(10000);
+  uint32_t seed = 1;
+  for (size_t i = 0; i < values.size(); ++i) {
+    seed = seed * 1103515245U + 12345U;
+    values[i] = i < 3000 ? 7 : i < 6000 ? static_cast<int32_t>(i % 3)
+                                       : static_cast<int32_t>(seed);
+  }
+  const size_t size = values.size() * sizeof(int32_t);
+  std::vector<char> encoded;
+  ASSERT_TRUE(EncodeParamData(
+      ParamCodec::kLZ, VarDataType::INT32, values.data(), size, &encoded));
+  EXPECT_LT(encoded.size(), size);
+  std::vector<int32_t> decoded(values.size());
+  DecodeParamData(ParamCodec::kLZ,
+                  VarDataType::INT32,
+                  encoded.data(),
+                  encoded.size(),
+                  decoded.data(),
+                  size);
+  EXPECT_EQ(decoded, values);
+
+  // bfloat16 keeps the 8 high bits of the mantissa, rounded to nearest even.
+  const float value = 1.00390625f + 1e-6f;
+  ASSERT_TRUE(EncodeParamData(ParamCodec::kBF16,
+                              VarDataType::FP32,
+                              &value,
+                              sizeof(float),
+                              &encoded));
+  float bf16_value;
+  DecodeParamData(ParamCodec::kBF16,
+                  VarDataType::FP32,
+                  encoded.data(),
+                  encoded.size(),
+                  &bf16_value,
+                  sizeof(float));
+  EXPECT_EQ(bf16_value, 1.0078125f);
+  EXPECT_FALSE(EncodeParamData(
+      ParamCodec::kFP16, VarDataType::INT32, values.data(), size, &encoded));
 }
 #endif  // LITE_WITH_FLATBUFFERS_DESC
 
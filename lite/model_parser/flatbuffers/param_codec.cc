@@ -0,0 +1,317 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/model_parser/flatbuffers/param_codec.h"
+#include <algorithm>
+#include <cstring>
+#include "lite/utils/cp_logging.h"
+#include "lite/utils/float16.h"
+
+namespace paddle {
+namespace lite {
+namespace fbs {
+
+namespace {
+
+size_t ElementSize(VarDataType data_type, size_t size) {
+  size_t elem_size = 1;
+  switch (data_type) {
+    case VarDataType::INT16:
+    case VarDataType::FP16:
+      elem_size = 2;
+      break;
+    case VarDataType::INT32:
+    case VarDataType::FP32:
+      elem_size = 4;
+      break;
+    case VarDataType::INT64:
+    case VarDataType::FP64:
+      elem_size = 8;
+      break;
+    default:
+      break;
+  }
+  return size % elem_size == 0 ? elem_size : 1;
+}
+
+// Byte k of every element goes to the plane k.
+void SplitBytePlanes(const char* src,
+                     size_t size,
+                     size_t elem_size,
+                     char* dst) {
+  const size_t num = size / elem_size;
+  for (size_t i = 0; i < num; ++i) {
+    for (size_t k = 0; k < elem_size; ++k) {
+      dst[k * num + i] = src[i * elem_size + k];
+    }
+  }
+}
+
+void MergeBytePlanes(const char* src,
+                     size_t size,
+                     size_t elem_size,
+                     char* dst) {
+  const size_t num = size / elem_size;
+  for (size_t k = 0; k < elem_size; ++k) {
+    for (size_t i = 0; i < num; ++i) {
+      dst[i * elem_size + k] = src[k * num + i];
+    }
+  }
+}
+
+// The LZ4 block format: sequences of a token, whose high and low 4 bits are
+// the number of literals and the length of the match minus 4, the literals,
+// the 16-bit offset of the match, and the lengths of 15 or more continued in
+// bytes of 255. The last sequence only has literals, which include at least
+// the last 5 bytes.
+constexpr size_t kMinMatch = 4;
+constexpr size_t kLastLiterals = 5;
+constexpr size_t kMatchSearchEnd = 12;
+constexpr size_t kMaxOffset = 65535;
+constexpr int kHashLog = 16;
+
+void WriteLength(size_t length, std::vector<char>* out) {
+  for (; length >= 255; length -= 255) out->push_back(static_cast<char>(255));
+  out->push_back(static_cast<char>(length));
+}
+
+void WriteSequence(const uint8_t* literals,
+                   size_t num_literals,
+                   size_t offset,
+                   size_t match_length,
+                   std::vector<char>* out) {
+  const size_t match_code = match_length > 0 ? match_length - kMinMatch : 0;
+  uint8_t token = (std::min<size_t>(num_literals, 15) << 4) |
+                  std::min<size_t>(match_code, 15);
+  out->push_back(static_cast<char>(token));
+  if (num_literals >= 15) WriteLength(num_literals - 15, out);
+  out->insert(out->end(), literals, literals + num_literals);
+  if (match_length == 0) return;
+  out->push_back(static_cast<char>(offset & 0xff));
+  out->push_back(static_cast<char>(offset >> 8));
+  if (match_code >= 15) WriteLength(match_code - 15, out);
+}
+
+uint32_t Load32(const uint8_t* p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+void CompressLZ(const uint8_t* src, size_t size, std::vector<char>* out) {
+  size_t anchor = 0;
+  if (size > kMatchSearchEnd) {
+    // The last position of every 4-byte sequence, plus 1.
+    std::vector<size_t> table(1 << kHashLog, 0);
+    size_t i = 0;
+    while (i < size - kMatchSearchEnd) {
+      const uint32_t seq = Load32(src + i);
+      const uint32_t hash = (seq * 2654435761U) >> (32 - kHashLog);
+      const size_t ref = table[hash];
+      table[hash] = i + 1;
+      if (ref == 0 || i - (ref - 1) > kMaxOffset ||
+          Load32(src + ref - 1) != seq) {
+        ++i;
+        continue;
+      }
+      const size_t match = ref - 1;
+      const size_t max_length = size - kLastLiterals - i;
+      size_t length = kMinMatch;
+      while (length < max_length && src[match + length] == src[i + length]) {
+        ++length;
+      }
+      WriteSequence(src + anchor, i - anchor, i - match, length, out);
+      i += length;
+      anchor = i;
+    }
+  }
+  WriteSequence(src + anchor, size - anchor, 0, 0, out);
+}
+
+size_t ReadLength(const uint8_t* src, size_t size, size_t* pos) {
+  size_t length = 0;
+  uint8_t byte = 255;
+  while (byte == 255) {
+    CHECK_LT(*pos, size) << "File format error: The param data is truncated.";
+    byte = src[(*pos)++];
+    length += byte;
+  }
+  return length;
+}
+
+void DecompressLZ(const uint8_t* src,
+                  size_t src_size,
+                  uint8_t* dst,
+                  size_t dst_size) {
+  size_t ip = 0;
+  size_t op = 0;
+  while (true) {
+    CHECK_LT(ip, src_size) << "File format error: The param data is truncated.";
+    const uint8_t token = src[ip++];
+    size_t num_literals = token >> 4;
+    if (num_literals == 15) num_literals += ReadLength(src, src_size, &ip);
+    CHECK(num_literals <= src_size - ip && num_literals <= dst_size - op)
+        << "File format error: The param data is corrupted.";
+    std::memcpy(dst + op, src + ip, num_literals);
+    ip += num_literals;
+    op += num_literals;
+    if (ip == src_size) break;
+
+    CHECK_LE(ip + 2, src_size)
+        << "File format error: The param data is truncated.";
+    const size_t offset = src[ip] | (src[ip + 1] << 8);
+    ip += 2;
+    CHECK(offset > 0 && offset <= op)
+        << "File format error: The param data is corrupted.";
+    size_t length = token & 15;
+    if (length == 15) length += ReadLength(src, src_size, &ip);
+    length += kMinMatch;
+    CHECK_LE(length, dst_size - op)
+        << "File format error: The param data is corrupted.";
+    // The match may overlap the bytes it produces.
+    for (size_t k = 0; k < length; ++k, ++op) {
+      dst[op] = dst[op - offset];
+    }
+  }
+  CHECK_EQ(op, dst_size) << "File format error: The param data is truncated.";
+}
+
+uint16_t FloatToBF16(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  if ((bits & 0x7fffffffU) > 0x7f800000U) {
+    // Keep NaNs quiet after the mantissa is cut.
+    return static_cast<uint16_t>((bits >> 16) | 0x40);
+  }
+  // Round to the nearest even.
+  bits += 0x7fffU + ((bits >> 16) & 1);
+  return static_cast<uint16_t>(bits >> 16);
+}
+
+float BF16ToFloat(uint16_t value) {
+  uint32_t bits = static_cast<uint32_t>(value) << 16;
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+}  // namespace
+
+bool ParseParamCodec(const std::string& name, ParamCodec* codec) {
+  if (name == "none") {
+    *codec = ParamCodec::kNone;
+  } else if (name == "fp16") {
+    *codec = ParamCodec::kFP16;
+  } else if (name == "bf16") {
+    *codec = ParamCodec::kBF16;
+  } else if (name == "lz") {
+    *codec = ParamCodec::kLZ;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool EncodeParamData(ParamCodec codec,
+                     VarDataType data_type,
+                     const void* data,
+                     size_t size,
+                     std::vector<char>* encoded) {
+  CHECK(encoded);
+  encoded->clear();
+  if (size == 0) return false;
+  switch (codec) {
+    case ParamCodec::kFP16:
+    case ParamCodec::kBF16: {
+      if (data_type != VarDataType::FP32 || size % sizeof(float) != 0) {
+        return false;
+      }
+      const size_t num = size / sizeof(float);
+      encoded->resize(num * sizeof(uint16_t));
+      auto* src = static_cast<const float*>(data);
+      auto* dst = reinterpret_cast<uint16_t*>(encoded->data());
+      for (size_t i = 0; i < num; ++i) {
+        dst[i] = codec == ParamCodec::kFP16 ? float16(src[i]).x
+                                            : FloatToBF16(src[i]);
+      }
+      return true;
+    }
+    case ParamCodec::kLZ: {
+      std::vector<char> planes(size);
+      SplitBytePlanes(static_cast<const char*>(data),
+                      size,
+                      ElementSize(data_type, size),
+                      planes.data());
+      CompressLZ(reinterpret_cast<const uint8_t*>(planes.data()),
+                 size,
+                 encoded);
+      return encoded->size() < size;
+    }
+    default:
+      return false;
+  }
+}
+
+void DecodeParamData(ParamCodec codec,
+                     VarDataType data_type,
+                     const void* encoded,
+                     size_t encoded_size,
+                     void* data,
+                     size_t size) {
+  switch (codec) {
+    case ParamCodec::kNone: {
+      CHECK_EQ(encoded_size, size);
+      std::memcpy(data, encoded, size);
+      break;
+    }
+    case ParamCodec::kFP16:
+    case ParamCodec::kBF16: {
+      CHECK(data_type == VarDataType::FP32);
+      const size_t num = size / sizeof(float);
+      CHECK_EQ(encoded_size, num * sizeof(uint16_t))
+          << "File format error: The param data is truncated.";
+      auto* src = static_cast<const uint16_t*>(encoded);
+      auto* dst = static_cast<float*>(data);
+      for (size_t i = 0; i < num; ++i) {
+        if (codec == ParamCodec::kFP16) {
+          float16 half;
+          half.x = src[i];
+          dst[i] = static_cast<float>(half);
+        } else {
+          dst[i] = BF16ToFloat(src[i]);
+        }
+      }
+      break;
+    }
+    case ParamCodec::kLZ: {
+      std::vector<char> planes(size);
+      DecompressLZ(static_cast<const uint8_t*>(encoded),
+                   encoded_size,
+                   reinterpret_cast<uint8_t*>(planes.data()),
+                   size);
+      MergeBytePlanes(planes.data(),
+                      size,
+                      ElementSize(data_type, size),
+                      static_cast<char*>(data));
+      break;
+    }
+    default:
+      LOG(FATAL) << "File format error: The codec "
+                 << static_cast<uint32_t>(codec) << " of params is unknown.";
+  }
+}
+
+}  // namespace fbs
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,62 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "lite/model_parser/base/traits.h"
+
+namespace paddle {
+namespace lite {
+namespace fbs {
+
+// How the data of a param is stored in the model file.
+enum class ParamCodec : uint32_t {
+  kNone = 0,
+  // The FP32 params are stored as IEEE half or bfloat16 floats, which halves
+  // their size and loses precision.
+  kFP16 = 1,
+  kBF16 = 2,
+  // Lossless: the bytes of the elements are split into planes, e.g. all the
+  // exponent bytes of the floats together, and compressed by an LZ77 codec
+  // in the LZ4 block format.
+  kLZ = 3,
+};
+
+// Parse the codec names "none", "fp16", "bf16" and "lz".
+bool ParseParamCodec(const std::string& name, ParamCodec* codec);
+
+// Encode the `size` bytes of the data of a param into `encoded`. Return false
+// if the codec doesn't apply to the data type or doesn't make the data
+// smaller, in which case the data is stored as it is.
+bool EncodeParamData(ParamCodec codec,
+                     VarDataType data_type,
+                     const void* data,
+                     size_t size,
+                     std::vector<char>* encoded);
+
+// Decode the `encoded_size` bytes of `encoded` into the `size` bytes of
+// `data`.
+void DecodeParamData(ParamCodec codec,
+                     VarDataType data_type,
+                     const void* encoded,
+                     size_t encoded_size,
+                     void* data,
+                     size_t size);
+
+}  // namespace fbs
+}  // namespace lite
+}  // namespace paddle
@@ -25,9 +25,11 @@
 #include "lite/core/variable.h"
 #include "lite/core/version.h"
 #include "lite/model_parser/base/apis.h"
+#include "lite/model_parser/base/integrity.h"
 #include "lite/model_parser/flatbuffers/io.h"
 #include "lite/model_parser/pb/tensor_io.h"
 #ifndef LITE_ON_TINY_PUBLISH
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 #include <cstdio>
 #include "lite/model_parser/naive_buffer/combined_params_desc.h"
 #include "lite/model_parser/naive_buffer/param_desc.h"
@@ -50,13 +52,42 @@ void LoadLoDTensor(model_parser::pb::LoDTensorDeserializer *loader,
   loader->ForwardRead(tensor, reader);
 }
 
+namespace {
+
+// Feeds protobuf from a ByteReader, so that a message is parsed from a file
+// in chunks instead of from a copy of the whole file.
+class ByteReaderInputStream
+    : public google::protobuf::io::CopyingInputStream {
+ public:
+  explicit ByteReaderInputStream(model_parser::ByteReader *reader)
+      : reader_(reader) {}
+
+  int Read(void *buffer, int size) override {
+    size_t remaining = reader_->length() - reader_->current();
+    size_t bytes = (std::min)(static_cast<size_t>(size), remaining);
+    if (bytes > 0) reader_->Read(buffer, bytes);
+    return static_cast<int>(bytes);
+  }
+
+ private:
+  model_parser::ByteReader *reader_;
+};
+
+const int kProgramReadChunkSize = 1 << 20;
+
+}  // namespace
+
 std::unique_ptr<framework::proto::ProgramDesc> LoadProgram(
     const std::string &path, const lite_api::CxxModelBuffer &model_buffer) {
   std::unique_ptr<framework::proto::ProgramDesc> main_program(
       new framework::proto::ProgramDesc);
   if (model_buffer.is_empty()) {
     model_parser::BinaryFileReader file(path);
-    main_program->ParseFromString(file.ReadToString(file.length()));
+    ByteReaderInputStream stream(&file);
+    google::protobuf::io::CopyingInputStreamAdaptor input(
+        &stream, kProgramReadChunkSize);
+    CHECK(main_program->ParsePartialFromZeroCopyStream(&input))
+        << "Failed to parse the program from " << path;
   } else {
     main_program->ParseFromString(model_buffer.get_program());
   }
@@ -498,22 +529,80 @@ void SaveModelNaive(const std::string &model_file,
   const std::string prog_path = model_file + ".nb";
   model_parser::BinaryFileWriter writer{prog_path};
 
+  /* 0. Get param names from cpp::ProgramDesc */
+  auto &main_block_desc = *cpp_prog.GetBlock<cpp::BlockDesc>(0);
+  // set unique_var_names to avoid saving shared params repeatedly
+  std::set<std::string> unique_var_names;
+  bool has_large_param = false;
+  for (size_t i = 0; i < main_block_desc.VarsSize(); ++i) {
+    auto &var = *main_block_desc.GetVar<cpp::VarDesc>(i);
+    if (var.Name() == "feed" || var.Name() == "fetch" || !var.Persistable() ||
+        unique_var_names.count(var.Name()) > 0)
+      continue;
+    unique_var_names.emplace(var.Name());
+    auto *tensor_var = exec_scope.FindVar(var.Name());
+    if (tensor_var != nullptr && tensor_var->IsType<Tensor>() &&
+        tensor_var->Get<Tensor>().memory_size() >=
+            (std::numeric_limits<uint32_t>::max)()) {
+      has_large_param = true;
+    }
+  }
+
   // Meta_version(uint16), default value is 2.
   uint16_t meta_version = 2;
   // You can modify meta_version by register environment variable
-  // 'PADDLE_LITE_MODEL_VERSION1'
+  // 'PADDLE_LITE_MODEL_VERSION1' or 'PADDLE_LITE_MODEL_VERSION3'
   const char *PADDLE_LITE_EXPERIMENTAL_MODEL =
       std::getenv("PADDLE_LITE_MODEL_VERSION1");
   if (PADDLE_LITE_EXPERIMENTAL_MODEL != nullptr) {
     meta_version = 1;
   }
+  // The params of meta_version 3 are indexed and aligned, and their count
+  // and sizes are not limited to 16 and 32 bits.
+  if (std::getenv("PADDLE_LITE_MODEL_VERSION3") != nullptr ||
+      unique_var_names.size() > (std::numeric_limits<uint16_t>::max)() ||
+      has_large_param) {
+    meta_version = 3;
+  }
+  // The params can be encoded by the codec named by the environment variable
+  // 'PADDLE_LITE_PARAMS_CODEC', i.e. 'fp16', 'bf16' or 'lz', which needs
+  // meta_version 3.
+  fbs::ParamCodec params_codec = fbs::ParamCodec::kNone;
+  const char *params_codec_name = std::getenv("PADDLE_LITE_PARAMS_CODEC");
+  if (params_codec_name != nullptr) {
+    CHECK(fbs::ParseParamCodec(params_codec_name, &params_codec))
+        << "Unknown codec of params " << params_codec_name
+        << ", which should be none, fp16, bf16 or lz.";
+    if (params_codec != fbs::ParamCodec::kNone) {
+      meta_version = 3;
+    }
+  }
+  // The models with meta_version 4 carry the hash of their content and the
+  // checksums of its sections in a header, and their params are the same as
+  // meta_version 3. It's set by the environment variable
+  // 'PADDLE_LITE_MODEL_VERSION4'.
+  if (std::getenv("PADDLE_LITE_MODEL_VERSION4") != nullptr) {
+    meta_version = 4;
+  }
   // Save meta_version(uint16) into file
   writer.Write(&meta_version, sizeof(uint16_t));
 
+  // The content is hashed while it is written, and the header is filled
+  // after it.
+  const size_t integrity_header_offset = writer.current();
+  std::unique_ptr<model_parser::IntegrityWriter> integrity_writer;
+  model_parser::ByteWriter *content_writer = &writer;
+  if (meta_version == 4) {
+    char header[model_parser::ModelIntegrityHeader::kSize] = {0};
+    writer.Write(header, sizeof(header));
+    integrity_writer.reset(new model_parser::IntegrityWriter(&writer));
+    content_writer = integrity_writer.get();
+  }
+
   // Save lite_version(char[16]) into file
   const int paddle_version_length = 16 * sizeof(char);
   std::string paddle_version = version();
-  writer.Write(paddle_version.c_str(), paddle_version_length);
+  content_writer->Write(paddle_version.c_str(), paddle_version_length);
   VLOG(4) << "paddle_version:" << paddle_version;
 
   /* 1. Get topolygy description from cpp::ProgramDesc */
@@ -522,22 +611,10 @@ void SaveModelNaive(const std::string &model_file,
   fbs_prog.CopyDataToBuffer(&buffer);
   uint64_t topology_size = buffer.size();
   // Save topolygy description into naive model
-  writer.Write(&topology_size, sizeof(uint64_t));
-  writer.Write(buffer.data(), topology_size);
+  content_writer->Write(&topology_size, sizeof(uint64_t));
+  content_writer->Write(buffer.data(), topology_size);
   VLOG(4) << "save topology_size:" << topology_size;
 
-  /* 2. Get param names from cpp::ProgramDesc */
-  auto &main_block_desc = *cpp_prog.GetBlock<cpp::BlockDesc>(0);
-  // set unique_var_names to avoid saving shared params repeatedly
-  std::set<std::string> unique_var_names;
-  for (size_t i = 0; i < main_block_desc.VarsSize(); ++i) {
-    auto &var = *main_block_desc.GetVar<cpp::VarDesc>(i);
-    if (var.Name() == "feed" || var.Name() == "fetch" || !var.Persistable() ||
-        unique_var_names.count(var.Name()) > 0)
-      continue;
-    unique_var_names.emplace(var.Name());
-  }
-
   /* 3. Save paramdesc info into model file */
   switch (meta_version) {
     case 1: {
@@ -546,21 +623,38 @@ void SaveModelNaive(const std::string &model_file,
       fbs::deprecated::SetCombinedParamsWithScope(
           exec_scope, unique_var_names, &params_prog);
       params_prog.CopyDataToBuffer(&buffer);
-      writer.Write(buffer.data(), buffer.size());
+      content_writer->Write(buffer.data(), buffer.size());
       break;
     }
     case 2: {
-      fbs::ParamSerializer serializer{&writer};
+      fbs::ParamSerializer serializer{content_writer};
       // 3.2 Save params into naive model
       serializer.ForwardWrite(exec_scope, unique_var_names);
       break;
     }
+    case 3:
+    case 4: {
+      fbs::ParamSerializer serializer{
+          content_writer,
+          params_codec == fbs::ParamCodec::kNone
+              ? fbs::kParamsIndexedVersion
+              : fbs::kParamsCompressedVersion};
+      serializer.set_codec(params_codec);
+      // 3.3 Save indexed params into naive model
+      serializer.ForwardWrite(exec_scope, unique_var_names);
+      break;
+    }
     default: {
       LOG(FATAL) << "Error: Unsupported opt meta_version, "
-                    "meta_version should be set as 1 or 2.";
+                    "meta_version should be set as 1, 2, 3 or 4.";
       break;
     }
   }
+  if (integrity_writer) {
+    char header[model_parser::ModelIntegrityHeader::kSize];
+    model_parser::SerializeIntegrityHeader(integrity_writer->Finish(), header);
+    writer.WriteAt(integrity_header_offset, header, sizeof(header));
+  }
   OPT_LOG << "2. Model is optimized and saved into " << prog_path
           << " successfully";
 }
@@ -765,12 +859,58 @@ void LoadModelNaiveFromMemory(const std::string &model_buffer,
  *      opt_version:  lite_version of opt tool that transformed this model.
  *      topo_size:    length of `topo_data`.
  *      topo_data:    contains model's topology data.
- *      param_data:   contains model's params data.
+ *      param_data:   contains model's params data, which are indexed and
+ *                    aligned from meta_version 3, see fbs::ParamSerializer.
+ *  From meta_version 4, an integrity header follows the meta_version, and the
+ *  checksums of the content, i.e. the parts 2 to 5, follow the content, see
+ *  model_parser::ModelIntegrityHeader.
 */
 
+// Check the integrity header of a model with meta_version 4 in the `size`
+// bytes at `data`, and then the sections of its content on `num_threads`
+// threads, before anything is parsed or allocated for the model.
+void VerifyModelIntegrity(const char *data, size_t size, int num_threads) {
+  const size_t header_offset = sizeof(uint16_t);
+  const size_t header_size = model_parser::ModelIntegrityHeader::kSize;
+  model_parser::ModelIntegrityHeader header;
+  CHECK(size >= header_offset + header_size &&
+        model_parser::ParseIntegrityHeader(data + header_offset,
+                                           size - header_offset - header_size,
+                                           &header))
+      << "The model is truncated or corrupted: its integrity header doesn't "
+         "match the size of the model.";
+  CHECK(model_parser::VerifyModelContent(
+      header, data + header_offset + header_size, num_threads))
+      << "The model is corrupted: its content doesn't match the checksums.";
+  VLOG(4) << "Content hash of the model: " << header.ContentHash();
+}
+
+bool ReadModelContentHash(const std::string &filename, std::string *hash) {
+  CHECK(hash);
+  if (!IsFileExists(filename)) return false;
+  model_parser::BinaryFileReader reader(filename, 0);
+  const size_t header_size = model_parser::ModelIntegrityHeader::kSize;
+  uint16_t meta_version = 0;
+  if (reader.length() >= sizeof(uint16_t) + header_size) {
+    reader.Read(&meta_version, sizeof(uint16_t));
+  }
+  if (meta_version != 4) return false;
+  char data[model_parser::ModelIntegrityHeader::kSize];
+  reader.Read(data, header_size);
+  model_parser::ModelIntegrityHeader header;
+  if (!model_parser::ParseIntegrityHeader(
+          data, reader.length() - reader.current(), &header)) {
+    return false;
+  }
+  *hash = header.ContentHash();
+  return true;
+}
+
 void LoadModelNaiveFromFile(const std::string &filename,
                             Scope *scope,
-                            cpp::ProgramDesc *cpp_prog) {
+                            cpp::ProgramDesc *cpp_prog,
+                            ParamsMmapMode mmap_mode,
+                            int num_threads) {
   CHECK(cpp_prog);
   CHECK(scope);
   // ModelFile
@@ -797,8 +937,27 @@ void LoadModelNaiveFromFile(const std::string &filename,
       LoadModelFbsFromFile(&reader, scope, cpp_prog, 1);
       break;
     case 2:
-      LoadModelFbsFromFile(&reader, scope, cpp_prog, 2);
+    case 3:
+      if (mmap_mode != ParamsMmapMode::kNone || num_threads > 1) {
+        auto file = std::make_shared<model_parser::MappedFile>(filename);
+        model_parser::MappedFileReader mapped_reader(file, sizeof(uint16_t));
+        LoadModelFbsFromFile(
+            &mapped_reader, scope, cpp_prog, mmap_mode, num_threads);
+      } else {
+        LoadModelFbsFromFile(&reader, scope, cpp_prog, meta_version);
+      }
       break;
+    case 4: {
+      // The content is checked and loaded through a mapping of the file, so
+      // that its sections are checked in parallel without being copied.
+      auto file = std::make_shared<model_parser::MappedFile>(filename);
+      VerifyModelIntegrity(file->data(), file->length(), num_threads);
+      model_parser::MappedFileReader mapped_reader(
+          file, sizeof(uint16_t) + model_parser::ModelIntegrityHeader::kSize);
+      LoadModelFbsFromFile(
+          &mapped_reader, scope, cpp_prog, mmap_mode, num_threads);
+      break;
+    }
     default:
       LOG(FATAL) << "The model format cannot be recognized. Please make sure "
                     "you use the correct interface and model file.";
@@ -861,12 +1020,10 @@ void LoadModelNaiveV0FromFile(const std::string &filename,
   VLOG(4) << "Load naive buffer model in '" << filename << "' successfully";
 }
 #endif  // LITE_ON_TINY_PUBLISH
-void LoadModelFbsFromFile(model_parser::BinaryFileReader *reader,
-                          Scope *scope,
-                          cpp::ProgramDesc *cpp_prog,
-                          uint16_t meta_version) {
+// Read the opt version and the topology of a model with meta_version 1, 2 or 3.
+void LoadProgramFbs(model_parser::ByteReader *reader,
+                    cpp::ProgramDesc *cpp_prog) {
   CHECK(cpp_prog);
-  CHECK(scope);
   CHECK_EQ(cpp_prog->BlocksSize(), 0);
 
   // get opt version
@@ -900,9 +1057,104 @@ void LoadModelFbsFromFile(model_parser::BinaryFileReader *reader,
 #else
   lite::model_parser::Buffer buf(topo_size);
   reader->Read(buf.data(), topo_size);
-  fbs::ProgramDesc program(buf);
+  fbs::ProgramDescView program(std::move(buf));
   TransformProgramDescAnyToCpp(program, cpp_prog);
 #endif
+}
+
+// Find the embedding tables which are only read by lookup_table ops, so they
+// are safe to be shared with a read-only mapping of the model file.
+std::set<std::string> FindEmbeddingTables(const cpp::ProgramDesc &cpp_prog) {
+  std::set<std::string> tables;
+  std::set<std::string> other_inputs;
+  for (size_t i = 0; i < cpp_prog.BlocksSize(); ++i) {
+    auto *block = cpp_prog.GetBlock<cpp::BlockDesc>(i);
+    for (size_t k = 0; k < block->OpsSize(); ++k) {
+      auto *op_desc = block->GetOp<cpp::OpDesc>(k);
+      const std::string op_type = op_desc->Type();
+      // Quantized tables are dequantized in place after loading.
+      bool is_lookup = (op_type == "lookup_table" ||
+                        op_type == "lookup_table_v2") &&
+                       !op_desc->HasAttr("quantize_weight_bits");
+      for (auto &name : op_desc->input_vars()) {
+        if (is_lookup && op_desc->Input("W").front() == name) {
+          tables.insert(name);
+        } else {
+          other_inputs.insert(name);
+        }
+      }
+    }
+  }
+  for (auto &name : other_inputs) {
+    tables.erase(name);
+  }
+  return tables;
+}
+
+// Find the persistable vars which are not quantized weights, the quantized
+// weights are replaced by the dequantized ones after loading.
+std::set<std::string> FindMappableParams(const cpp::ProgramDesc &cpp_prog) {
+  std::set<std::string> params;
+  std::set<std::string> quantized;
+  for (size_t i = 0; i < cpp_prog.BlocksSize(); ++i) {
+    auto *block = cpp_prog.GetBlock<cpp::BlockDesc>(i);
+    for (size_t k = 0; k < block->VarsSize(); ++k) {
+      auto *var_desc = block->GetVar<cpp::VarDesc>(k);
+      if (var_desc->Persistable()) {
+        params.insert(var_desc->Name());
+      }
+    }
+    for (size_t k = 0; k < block->OpsSize(); ++k) {
+      auto *op_desc = block->GetOp<cpp::OpDesc>(k);
+      if (op_desc->HasAttr("quantize_weight_bits")) {
+        for (auto &name : op_desc->input_vars()) {
+          quantized.insert(name);
+        }
+      }
+    }
+  }
+  for (auto &name : quantized) {
+    params.erase(name);
+  }
+  return params;
+}
+
+void LoadModelFbsFromFile(model_parser::MappedFileReader *reader,
+                          Scope *scope,
+                          cpp::ProgramDesc *cpp_prog,
+                          ParamsMmapMode mmap_mode,
+                          int num_threads) {
+  CHECK(scope);
+  LoadProgramFbs(reader, cpp_prog);
+  std::set<std::string> params;
+  if (mmap_mode == ParamsMmapMode::kAllParams) {
+    params = FindMappableParams(*cpp_prog);
+  } else if (mmap_mode == ParamsMmapMode::kEmbeddingTables) {
+    params = FindEmbeddingTables(*cpp_prog);
+  }
+  VLOG(4) << "Map " << params.size() << " params from model file.";
+  fbs::ParamDeserializer deserializer(reader, params);
+  deserializer.set_num_threads(num_threads);
+  deserializer.ForwardRead(scope);
+  if (mmap_mode == ParamsMmapMode::kEmbeddingTables) {
+    // The rows of the tables are looked up in random order.
+    for (auto &name : params) {
+      auto *var = scope->FindVar(name);
+      if (var == nullptr) continue;
+      const auto &tensor = var->Get<lite::Tensor>();
+      if (reader->file()->Contains(tensor.raw_data())) {
+        reader->file()->AdviseRandom(tensor.raw_data(), tensor.memory_size());
+      }
+    }
+  }
+}
+
+void LoadModelFbsFromFile(model_parser::BinaryFileReader *reader,
+                          Scope *scope,
+                          cpp::ProgramDesc *cpp_prog,
+                          uint16_t meta_version) {
+  CHECK(scope);
+  LoadProgramFbs(reader, cpp_prog);
 
   /* 2. Load scope from params.fbs */
   switch (meta_version) {
@@ -914,8 +1166,10 @@ void LoadModelFbsFromFile(model_parser::BinaryFileReader *reader,
       fbs::deprecated::SetScopeWithCombinedParams(scope, params);
       break;
     }
-    case 2: {
-      /* load scope from param.fbs with meta_version=2 */
+    case 2:
+    case 3: {
+      /* load scope from param.fbs with meta_version=2 or 3, the version of
+       * the params is read from their header */
       fbs::ParamDeserializer deserializer(reader);
       deserializer.ForwardRead(scope);
       break;
@@ -928,7 +1182,8 @@ void LoadModelFbsFromFile(model_parser::BinaryFileReader *reader,
 
 void LoadModelNaiveFromMemory(const std::string &model_buffer,
                               Scope *scope,
-                              cpp::ProgramDesc *cpp_prog) {
+                              cpp::ProgramDesc *cpp_prog,
+                              int num_threads) {
   CHECK(cpp_prog);
   CHECK(scope);
   cpp_prog->ClearBlocks();
@@ -953,8 +1208,17 @@ void LoadModelNaiveFromMemory(const std::string &model_buffer,
       LoadModelFbsFromMemory(&reader, scope, cpp_prog, 1);
       break;
     case 2:
-      LoadModelFbsFromMemory(&reader, scope, cpp_prog, 2);
+    case 3:
+      LoadModelFbsFromMemory(&reader, scope, cpp_prog, meta_version);
+      break;
+    case 4: {
+      VerifyModelIntegrity(
+          model_buffer.data(), model_buffer.size(), num_threads);
+      char header[model_parser::ModelIntegrityHeader::kSize];
+      reader.Read(header, sizeof(header));
+      LoadModelFbsFromMemory(&reader, scope, cpp_prog, meta_version);
       break;
+    }
     default:
       LOG(FATAL) << "The model format cannot be recognized. Please make sure "
                     "you use the correct interface and model file.";
@@ -999,7 +1263,7 @@ void LoadModelNaiveV0FromMemory(const std::string &model_buffer,
 }
 #endif
 ///////////////////////////////////////////////////////////////////
-// Meta_version=1,2
+// Meta_version=1,2,3,4
 ///////////////////////////////////////////////////////////////////
 void LoadModelFbsFromMemory(model_parser::StringBufferReader *reader,
                             Scope *scope,
@@ -1024,7 +1288,7 @@ void LoadModelFbsFromMemory(model_parser::StringBufferReader *reader,
   LOG(FATAL) << "Since no data structure of Flatbuffers has been constructed, "
                 "the model cannot be loaded.";
 #else
-  fbs::ProgramDesc program(prog_data);
+  fbs::ProgramDescView program(std::move(prog_data));
   TransformProgramDescAnyToCpp(program, cpp_prog);
 #endif
   switch (meta_version) {
@@ -1037,7 +1301,9 @@ void LoadModelFbsFromMemory(model_parser::StringBufferReader *reader,
       fbs::deprecated::SetScopeWithCombinedParams(scope, params);
       break;
     }
-    case 2: {
+    case 2:
+    case 3:
+    case 4: {
       fbs::ParamDeserializer deserializer(reader);
       deserializer.ForwardRead(scope);
       break;
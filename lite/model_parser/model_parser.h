@@ -144,13 +144,49 @@ void LoadModelFbsFromFile(model_parser::BinaryFileReader* reader,
                           cpp::ProgramDesc* cpp_prog,
                           uint16_t meta_version);
 
-void LoadModelNaiveFromFile(const std::string& filename,
-                            lite::Scope* scope,
-                            cpp::ProgramDesc* prog);
+// Which params of a naive buffer model file are shared with a memory mapping
+// of the file instead of copied into host memory.
+enum class ParamsMmapMode {
+  kNone = 0,
+  // The embedding tables only read by lookup_table ops.
+  kEmbeddingTables = 1,
+  // All the params except the quantized weights, which are dequantized into
+  // larger tensors after loading.
+  kAllParams = 2,
+};
+
+// Load model from memory-mapped file with meta_version = 2, 3 or 4, after the
+// integrity header of meta_version 4. The params chosen by `mmap_mode` are
+// shared with the mapping instead of copied, and the others are copied on
+// `num_threads` threads.
+void LoadModelFbsFromFile(model_parser::MappedFileReader* reader,
+                          Scope* scope,
+                          cpp::ProgramDesc* cpp_prog,
+                          ParamsMmapMode mmap_mode,
+                          int num_threads = 1);
+
+// The params are loaded on `num_threads` threads through a mapping of the
+// file, when it is greater than 1. The content of a model with meta_version 4
+// is checked on `num_threads` threads through a mapping before it's loaded.
+void LoadModelNaiveFromFile(
+    const std::string& filename,
+    lite::Scope* scope,
+    cpp::ProgramDesc* prog,
+    ParamsMmapMode mmap_mode = ParamsMmapMode::kNone,
+    int num_threads = 1);
 
+// The content of a model with meta_version 4 is checked on `num_threads`
+// threads.
 void LoadModelNaiveFromMemory(const std::string& model_buffer,
                               lite::Scope* scope,
-                              cpp::ProgramDesc* cpp_prog);
+                              cpp::ProgramDesc* cpp_prog,
+                              int num_threads = 1);
+
+// Read the hash of the content of a naive buffer model with meta_version 4
+// from its header without reading the rest of the file, which identifies the
+// model e.g. in caches. Return false for the other models.
+bool ReadModelContentHash(const std::string& filename, std::string* hash);
+
 void LoadModelFbsFromMemory(model_parser::StringBufferReader* reader,
                             Scope* scope,
                             cpp::ProgramDesc* cpp_prog,
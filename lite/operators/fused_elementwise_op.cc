@@ -0,0 +1,65 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/operators/fused_elementwise_op.h"
+#include <vector>
+#include "lite/backends/host/math/fused_elementwise.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace operators {
+
+bool FusedElementwiseOp::CheckShape() const {
+  CHECK_OR_FALSE(!param_.X.empty());
+  CHECK_OR_FALSE(param_.Out);
+  CHECK_OR_FALSE(!param_.instructions.empty());
+  CHECK_EQ_OR_FALSE(param_.instructions.size() %
+                        host::math::kFusedElementwiseInstrSize,
+                    0u);
+  return true;
+}
+
+bool FusedElementwiseOp::InferShapeImpl() const {
+  std::vector<std::vector<int64_t>> input_dims;
+  for (auto* x : param_.X) {
+    input_dims.push_back(x->dims().Vectorize());
+  }
+  auto dims =
+      host::math::FusedElementwiseDims(param_.instructions, input_dims);
+  param_.Out->Resize(dims.back());
+  param_.Out->set_lod(param_.X.front()->lod());
+  return true;
+}
+
+bool FusedElementwiseOp::AttachImpl(const cpp::OpDesc& opdesc,
+                                    lite::Scope* scope) {
+  param_.X.clear();
+  for (auto& name : opdesc.Input("X")) {
+    param_.X.push_back(GetVar<lite::Tensor>(scope, name));
+  }
+  param_.Out = GetMutableVar<lite::Tensor>(scope, opdesc.Output("Out").front());
+  param_.instructions = opdesc.GetAttr<std::vector<int>>("instructions");
+  if (opdesc.HasAttr("params")) {
+    param_.params = opdesc.GetAttr<std::vector<float>>("params");
+  }
+  return true;
+}
+
+}  // namespace operators
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_OP(fused_elementwise,
+                 paddle::lite::operators::FusedElementwiseOp);
@@ -619,6 +619,9 @@ struct SplitParam : ParamBase {
   int axis{-1};
   int num{0};
   std::vector<int> sections;
+  // The outputs may share the buffer of x when they are contiguous slices of
+  // it, the variables are not reused by memory_optimize_pass then.
+  bool inplace{false};
   ///////////////////////////////////////////////////////////////////////////////////
   // get a vector of input tensors
   const std::vector<const Tensor*>* input_tensor_ptrs() override {
@@ -744,6 +747,16 @@ struct FusionElementwiseActivationGradParam : public ElementwiseGradParam {
   std::string act_type;
 };
 
+/// ----------------------- fused_elementwise operators ----------------------
+// A tree of elementwise, activation, scale and clip ops evaluated in one pass,
+// see lite/backends/host/math/fused_elementwise.h for the instructions.
+struct FusedElementwiseParam : ParamBase {
+  std::vector<const lite::Tensor*> X{};
+  lite::Tensor* Out{};
+  std::vector<int> instructions{};
+  std::vector<float> params{};
+};
+
 /// ----------------------- mean operators ----------------------
 struct MeanParam : ParamBase {
   const lite::Tensor* X{};
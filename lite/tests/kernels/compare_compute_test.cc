@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#include <cmath>
 #include "lite/api/paddle_use_kernels.h"
 #include "lite/api/paddle_use_ops.h"
 #include "lite/core/arena/framework.h"
@@ -90,50 +91,23 @@ class CompareComputeTester : public arena::TestCase {
       for (int i = 0; i < x_dims_.production(); i++) {
         out_data[i] = CompareFunc()(x_data[i], y_data_in[i]);
       }
-    } else {
-      auto* y_data =
-          reinterpret_cast<T*>(malloc(x_dims_.production() * sizeof(T)));
-
-      if (axis < 0) {
-        axis = x_dims_.size() - y_dims_.size();
-      }
-      int batch = 1;
-      int channels = 1;
-      int num = 1;
-      for (int i = 0; i < axis; ++i) {
-        batch *= x_dims_[i];
-      }
-      for (int i = 0; i < y_dims_.size(); ++i) {
-        channels *= y_dims_[i];
-      }
-      for (int i = y_dims_.size() + axis; i < x_dims_.size(); ++i) {
-        num *= x_dims_[i];
-      }
-      int ysize = channels * num;
-      T* y_data_t = reinterpret_cast<T*>(y_data);
-      if (num == 1) {
-        for (int i = 0; i < batch; ++i) {
-          memcpy(reinterpret_cast<void*>(y_data_t),
-                 reinterpret_cast<const void*>(&y_data_in[0]),
-                 ysize * sizeof(T));
-          y_data_t += ysize;
-        }
-
-      } else {
-        for (int i = 0; i < channels; i++) {
-          for (int j = 0; j < num; j++) {
-            y_data_t[i * num + j] = y_data_in[i];
-          }
-        }
-        T* tempptr = y_data_t;
-        for (int i = 0; i < batch; ++i) {
-          memcpy(y_data_t, tempptr, ysize * sizeof(T));
-          y_data_t += ysize;
-        }
-      }
-      for (int i = 0; i < x_dims_.production(); i++) {
-        out_data[i] = CompareFunc()(x_data[i], y_data[i]);
-      }
+      return;
+    }
+    // Each y element is compared with a (pre, post) slice of x; a scalar y is
+    // compared with every element of x.
+    if (axis < 0) {
+      axis = x_dims_.size() - y_dims_.size();
+    }
+    int64_t n = y_dims_.production();
+    int64_t post = 1;
+    for (int i = y_dims_.size() + axis; i < x_dims_.size(); ++i) {
+      post *= x_dims_[i];
+    }
+    if (n == 1) {
+      post = 1;
+    }
+    for (int64_t i = 0; i < x_dims_.production(); i++) {
+      out_data[i] = CompareFunc()(x_data[i], y_data_in[(i / post) % n]);
     }
   }
 
@@ -151,6 +125,9 @@ class CompareComputeTester : public arena::TestCase {
     std::vector<T> dy(y_dims_.production());
     fill_data_rand<T>(dx.data(), -5, 5, x_dims_.production());
     fill_data_rand<T>(dy.data(), -5, 5, y_dims_.production());
+    // Integral values make equal elements likely for float inputs too.
+    for (auto& v : dx) v = static_cast<T>(std::round(v));
+    for (auto& v : dy) v = static_cast<T>(std::round(v));
     SetCommonTensor(x_, x_dims_, dx.data());
     SetCommonTensor(y_, y_dims_, dy.data());
   }
@@ -214,8 +191,8 @@ TEST(Compare_OP_NPU, precision) {
       place, abs_error, "less_than", {2, 3, 4, 5}, {2, 3, 4, 5}, -1);
   TestCompare<float>(place, abs_error, "less_than", {2, 3, 4}, {2, 3, 4}, 0);
 }
-#elif defined(LITE_WITH_ARM)
-TEST(Compare_OP_ARM, precision) {
+#elif defined(LITE_WITH_X86) || defined(LITE_WITH_ARM)
+TEST(Compare_OP_Host, precision) {
   Place place{TARGET(kHost)};
   float abs_error = 1e-5;
   for (auto op : std::vector<std::string>{"equal",
@@ -235,6 +212,34 @@ TEST(Compare_OP_ARM, precision) {
   TestCompare<int32_t>(place, abs_error, "less_than", {3, 4}, {3, 4}, -1);
   TestCompare<int64_t>(place, abs_error, "less_than", {3, 4}, {3, 4}, -1);
 }
+
+TEST(Compare_OP_Host, broadcast_and_tail) {
+  Place place{TARGET(kHost)};
+  float abs_error = 1e-5;
+  // Lengths of 37 and 16389 leave tails after the 16-wide vector loop, and
+  // 16389 also spans more than one parallel chunk.
+  for (auto op : std::vector<std::string>{"equal",
+                                          "not_equal",
+                                          "less_than",
+                                          "less_equal",
+                                          "greater_than",
+                                          "greater_equal"}) {
+    TestCompare<float>(place, abs_error, op, {3, 37}, {3, 37}, -1);
+    TestCompare<float>(place, abs_error, op, {2, 16389}, {2, 16389}, -1);
+    TestCompare<float>(place, abs_error, op, {2, 3, 37}, {3}, 1);
+    TestCompare<float>(place, abs_error, op, {2, 3, 37}, {2, 3}, 0);
+    TestCompare<float>(place, abs_error, op, {5, 19}, {1}, -1);
+  }
+
+  for (auto op : std::vector<std::string>{"equal", "less_than"}) {
+    TestCompare<int32_t>(place, abs_error, op, {3, 37}, {3, 37}, -1);
+    TestCompare<int32_t>(place, abs_error, op, {4, 3, 21}, {3}, 1);
+    TestCompare<int32_t>(place, abs_error, op, {5, 19}, {1}, -1);
+    TestCompare<int64_t>(place, abs_error, op, {3, 37}, {3, 37}, -1);
+    TestCompare<int64_t>(place, abs_error, op, {4, 3, 21}, {3}, 1);
+  }
+  TestCompare<int32_t>(place, abs_error, "greater_than", {4, 3, 21}, {3}, 1);
+}
 #endif
 
 }  // namespace lite
@@ -13,9 +13,21 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
 #include "lite/api/paddle_use_kernels.h"
 #include "lite/api/paddle_use_ops.h"
 #include "lite/core/arena/framework.h"
+#include "lite/model_parser/base/io.h"
 #include "lite/tests/utils/fill_data.h"
 #include "lite/tests/utils/naive_math_impl.h"
 
@@ -42,6 +54,9 @@ class ConvTransposeComputeTester : public arena::TestCase {
   std::vector<int> output_padding_{};
   std::string bias_ = "";
   bool fuse_relu_ = false;
+  // Share the filter of the kernel with a mapped file, as the params loaded
+  // with mmap are.
+  std::string mapped_filter_path_ = "";
 
  public:
   ConvTransposeComputeTester(const Place& place,
@@ -184,6 +199,10 @@ class ConvTransposeComputeTester : public arena::TestCase {
     op_desc->SetAttr("fuse_relu", fuse_relu_);
   }
 
+  void set_mapped_filter_path(const std::string& path) {
+    mapped_filter_path_ = path;
+  }
+
   void PrepareData() override {
     std::vector<float> din(dims_.production());
     fill_data_rand(din.data(), -1.f, 1.f, dims_.production());
@@ -194,6 +213,17 @@ class ConvTransposeComputeTester : public arena::TestCase {
     std::vector<float> dfilter(filter_dims.production());
     fill_data_rand(dfilter.data(), -1.f, 1.f, filter_dims.production());
     SetCommonTensor(filter_, filter_dims, dfilter.data(), {}, true);
+    if (!mapped_filter_path_.empty()) {
+      {
+        model_parser::BinaryFileWriter writer(mapped_filter_path_);
+        writer.Write(dfilter.data(), dfilter.size() * sizeof(float));
+      }
+      auto file = std::make_shared<model_parser::MappedFile>(
+          mapped_filter_path_);
+      const size_t size = dfilter.size() * sizeof(float);
+      auto* filter = inst_scope()->FindMutableTensor(filter_);
+      filter->ResetBuffer(file->ShareBuffer(file->data(), size), size);
+    }
 
     if (!bias_.empty()) {
       DDim bias_dims(std::vector<int64_t>{filter_channels_ * groups_});
@@ -353,6 +383,48 @@ void TestConvTransposeBiasRelu(Place place, float abs_error = 2e-5) {
   }
 }
 
+// A new file in the temporary directory, or the working one if TMPDIR is not
+// set, whose name no other test running in parallel uses.
+std::string UniqueFilePath(const std::string& prefix) {
+  const char* dir = std::getenv("TMPDIR");
+  std::string path =
+      (dir != nullptr ? std::string(dir) + "/" : "") + prefix + "XXXXXX";
+#ifdef _WIN32
+  CHECK_EQ(_mktemp_s(&path[0], path.size() + 1), 0) << path;
+#else
+  int fd = mkstemp(&path[0]);
+  CHECK_GE(fd, 0) << "Can not create " << path;
+  close(fd);
+#endif
+  return path;
+}
+
+// The kernels repack the mapped filter into memory of their own, leaving
+// the file as it is.
+void TestConvTransposeMappedFilter(Place place, float abs_error = 2e-5) {
+  const std::string path = UniqueFilePath("conv_transpose_filter.");
+  for (int groups : {1, 2}) {
+    std::unique_ptr<ConvTransposeComputeTester> tester(
+        new ConvTransposeComputeTester(place,
+                                       "def",
+                                       DDim({2, 4, 9, 9}),
+                                       3,
+                                       {3, 3},
+                                       {2, 2},
+                                       {1, 1},
+                                       groups));
+    tester->set_mapped_filter_path(path);
+    auto* base_scope = tester->baseline_scope();
+    arena::Arena arena(std::move(tester), place, abs_error);
+    arena.TestPrecision();
+    const auto* filter = base_scope->FindTensor("filter");
+    model_parser::MappedFile file(path);
+    ASSERT_EQ(file.length(), filter->memory_size());
+    EXPECT_EQ(memcmp(file.data(), filter->raw_data(), file.length()), 0);
+  }
+  std::remove(path.c_str());
+}
+
 TEST(Conv_transpose, precision) {
   float abs_error = 2e-5;
   Place place;
@@ -362,6 +434,7 @@ TEST(Conv_transpose, precision) {
 #elif defined(LITE_WITH_ARM)
   place = TARGET(kARM);
   TestConvTransposeOutputPadding(place, abs_error);
+  TestConvTransposeMappedFilter(place, abs_error);
   return;
 #else
   return;
@@ -59,26 +59,30 @@ class CumsumComputeTester : public arena::TestCase {
     auto* x_data = x->template data<T>();
     auto* out_data = out->template mutable_data<T>();
 
-    if (flatten_ || x_dims.size() == 1) {
-      int64_t x_size = x->numel();
-      out_data[0] = x_data[0];
-      for (int64_t i = 1; i < x_size; i++) {
-        out_data[i] = x_data[i] + out_data[i - 1];
-      }
-    } else {
+    int64_t pre = 1;
+    int64_t count = x->numel();
+    int64_t post = 1;
+    if (!flatten_ && x_dims.size() > 1) {
       int axis = axis_ < 0 ? axis_ + x_dims.size() : axis_;
-      int64_t pre = x_dims.count(0, axis);
-      int64_t count = x_dims[axis];
-      int64_t post = x_dims.count(axis + 1, x_dims.size());
-
-      for (int64_t i = 0; i < pre; i++) {
-        for (int64_t j = 0; j < post; j++) {
-          int64_t step = i * count * post + j;
-          const T* src = x_data + step;
-          T* dst = out_data + step;
-          dst[0] = src[0];
-          for (int64_t k = 1; k < count; k++) {
-            dst[k * post] = src[k * post] + dst[(k - 1) * post];
+      pre = x_dims.count(0, axis);
+      count = x_dims[axis];
+      post = x_dims.count(axis + 1, x_dims.size());
+    }
+
+    for (int64_t i = 0; i < pre; i++) {
+      for (int64_t j = 0; j < post; j++) {
+        int64_t step = i * count * post + j;
+        const T* src = x_data + step;
+        T* dst = out_data + step;
+        T sum = 0;
+        for (int64_t k = 0; k < count; k++) {
+          int64_t idx = (reverse_ ? count - 1 - k : k) * post;
+          if (exclusive_) {
+            dst[idx] = sum;
+            sum += src[idx];
+          } else {
+            sum += src[idx];
+            dst[idx] = sum;
           }
         }
       }
@@ -151,6 +155,19 @@ void TestCumsumAxis(Place place, float abs_error) {
   }
 }
 
+template <class T = float>
+void TestCumsumExclusiveReverse(Place place, float abs_error) {
+  std::vector<int64_t> x_shape{2, 3, 4, 5};
+  for (auto axis : {0, 2, -1}) {
+    for (bool exclusive : {false, true}) {
+      for (bool reverse : {false, true}) {
+        TestCumsumHelper<T>(
+            place, abs_error, x_shape, axis, false, exclusive, reverse);
+      }
+    }
+  }
+}
+
 template <class T = float>
 void TestCumsumFlatten(Place place, float abs_error) {
   std::vector<std::vector<int64_t>> shapes{{10}, {2, 3, 4, 5}};
@@ -170,6 +187,7 @@ TEST(cumsum, precision) {
 
   TestCumsumAxis<float>(place, abs_error);
   TestCumsumFlatten<float>(place, abs_error);
+  TestCumsumExclusiveReverse<float>(place, abs_error);
 
   TestCumsumAxis<int32_t>(place, abs_error);
   TestCumsumFlatten<int32_t>(place, abs_error);
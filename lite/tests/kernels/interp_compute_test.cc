@@ -442,6 +442,45 @@ void TestInterpAlignMode(Place place, float abs_error = 2e-5) {
   }
 }
 
+// The x86 kernels copy 2x2 blocks when upsampling by exactly 2 without
+// align_corners and gather 8 columns at a time otherwise, the odd widths
+// cover the tails of both.
+void TestInterpFastPaths(Place place, float abs_error = 2e-5) {
+  for (auto x_dims :
+       std::vector<std::vector<int64_t>>{{1, 2, 3, 5}, {2, 3, 5, 17}}) {
+    const int in_h = x_dims[2];
+    const int in_w = x_dims[3];
+    for (auto interp_method : std::vector<std::string>{"nearest", "bilinear"}) {
+      for (bool align_corners : {true, false}) {
+        std::unique_ptr<arena::TestCase> tester(
+            new NearestInterpComputeTester(place,
+                                           "def",
+                                           DDim(x_dims),
+                                           interp_method,
+                                           2.f,
+                                           -1,
+                                           -1,
+                                           align_corners));
+        arena::Arena arena(std::move(tester), place, abs_error);
+        arena.TestPrecision();
+        for (auto out_w : {2 * in_w, 2 * in_w + 3, in_w + 8}) {
+          std::unique_ptr<arena::TestCase> tester(
+              new NearestInterpComputeTester(place,
+                                             "def",
+                                             DDim(x_dims),
+                                             interp_method,
+                                             -1.f,
+                                             2 * in_h,
+                                             out_w,
+                                             align_corners));
+          arena::Arena arena(std::move(tester), place, abs_error);
+          arena.TestPrecision();
+        }
+      }
+    }
+  }
+}
+
 TEST(Interp, precision) {
   Place place;
   float abs_error = 2e-5;
@@ -466,6 +505,9 @@ TEST(Interp, precision) {
   TestInterpOutsize(place, abs_error);
   TestInterpAlignCorners(place, abs_error);
   TestInterpAlignMode(place, abs_error);
+  if (place == TARGET(kX86)) {
+    TestInterpFastPaths(place, abs_error);
+  }
 }
 
 }  // namespace lite
@@ -50,8 +50,9 @@ class LogicalTester : public arena::TestCase {
  public:
   LogicalTester(const Place& place,
                 const std::string& alias,
-                const std::string& op_type)
-      : TestCase(place, alias), op_type_(op_type) {}
+                const std::string& op_type,
+                const DDim& dims = DDim({2, 3, 4, 5}))
+      : TestCase(place, alias), op_type_(op_type), dims_(dims) {}
 
   void RunBaseline(Scope* scope) override {
     auto* x = scope->FindTensor(x_);
@@ -87,7 +88,7 @@ class LogicalTester : public arena::TestCase {
       dx[i] = (i % 3 == 0);
     }
     SetCommonTensor(x_, dims_, dx);
-    delete dx;
+    delete[] dx;
 
     if (op_type_ != "logical_not") {
       bool* dy = new bool[dims_.production()];
@@ -95,29 +96,31 @@ class LogicalTester : public arena::TestCase {
         dy[i] = (i % 2 == 0);
       }
       SetCommonTensor(y_, dims_, dy);
-      delete dy;
+      delete[] dy;
     }
   }
 };
 
-void TestLogical(Place place, float abs_error) {
+void TestLogical(Place place,
+                 float abs_error,
+                 const DDim& dims = DDim({2, 3, 4, 5})) {
   std::unique_ptr<arena::TestCase> logical_and_tester(
-      new LogicalTester<_logical_and_func>(place, "def", "logical_and"));
+      new LogicalTester<_logical_and_func>(place, "def", "logical_and", dims));
   arena::Arena arena_and(std::move(logical_and_tester), place, abs_error);
   arena_and.TestPrecision();
 
   std::unique_ptr<arena::TestCase> logical_or_tester(
-      new LogicalTester<_logical_or_func>(place, "def", "logical_or"));
+      new LogicalTester<_logical_or_func>(place, "def", "logical_or", dims));
   arena::Arena arena_or(std::move(logical_or_tester), place, abs_error);
   arena_or.TestPrecision();
 
   std::unique_ptr<arena::TestCase> logical_xor_tester(
-      new LogicalTester<_logical_xor_func>(place, "def", "logical_xor"));
+      new LogicalTester<_logical_xor_func>(place, "def", "logical_xor", dims));
   arena::Arena arena_xor(std::move(logical_xor_tester), place, abs_error);
   arena_xor.TestPrecision();
 
   std::unique_ptr<arena::TestCase> logical_not_tester(
-      new LogicalTester<_logical_not_func>(place, "def", "logical_not"));
+      new LogicalTester<_logical_not_func>(place, "def", "logical_not", dims));
   arena::Arena arena_not(std::move(logical_not_tester), place, abs_error);
   arena_not.TestPrecision();
 }
@@ -125,13 +128,17 @@ void TestLogical(Place place, float abs_error) {
 TEST(Logical, precision) {
   Place place;
   float abs_error = 1e-5;
-#if defined(LITE_WITH_ARM)
+#if defined(LITE_WITH_X86) || defined(LITE_WITH_ARM)
   place = TARGET(kHost);
 #else
   return;
 #endif
 
   TestLogical(place, abs_error);
+  // Tails after the 8-bools-per-word loop, and more than one parallel chunk.
+  TestLogical(place, abs_error, DDim({3, 37}));
+  TestLogical(place, abs_error, DDim({7}));
+  TestLogical(place, abs_error, DDim({2, 65541}));
 }
 
 }  // namespace lite
@@ -447,6 +447,10 @@ TEST(ReduceMax, precision) {
 
   test_reduce_max_4d(place);
   test_reduce_max_3d(place);
+#if defined(LITE_WITH_X86) || defined(LITE_WITH_ARM)
+  test_reduce_max_4d(TARGET(kHost));
+  test_reduce_max_3d(TARGET(kHost));
+#endif
 }
 
 }  // namespace lite
@@ -384,6 +384,9 @@ TEST(ReduceMean, precision) {
   abs_err = 2e-2;  // opencl fp16 torlerance
 #endif
   test_reduce_mean(place, abs_err);
+#if defined(LITE_WITH_X86) || defined(LITE_WITH_ARM)
+  test_reduce_mean(TARGET(kHost), 2e-5);
+#endif
 }
 
 }  // namespace lite
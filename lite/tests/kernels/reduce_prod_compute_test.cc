@@ -342,6 +342,9 @@ TEST(ReduceProd, precision) {
 #endif
 
   test_reduce_prod(place);
+#if defined(LITE_WITH_X86) || defined(LITE_WITH_ARM)
+  test_reduce_prod(TARGET(kHost));
+#endif
 }
 
 }  // namespace lite
@@ -346,6 +346,7 @@ TEST(ReduceSum, precision) {
 #endif
 
   test_reduce_sum(place);
+  test_reduce_sum(TARGET(kHost));
 }
 
 }  // namespace lite
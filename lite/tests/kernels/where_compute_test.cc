@@ -21,6 +21,7 @@
 namespace paddle {
 namespace lite {
 
+template <typename T>
 class WhereComputeTester : public arena::TestCase {
  protected:
   // common attributes for this op.
@@ -42,49 +43,12 @@ class WhereComputeTester : public arena::TestCase {
 
     out->Resize(x->dims());
     auto numel = x_dims_.production();
-    if (x->precision() == PRECISION(kFloat)) {
-      const float* x_data = x->template data<float>();
-      const float* y_data = y->template data<float>();
-      const bool* cond_data = condition->template data<bool>();
-      float* out_data = out->template mutable_data<float>();
-      for (int i = 0; i < numel; i++) {
-        out_data[i] = cond_data[i] ? x_data[i] : y_data[i];
-      }
-    } else if (x->precision() == PRECISION(kInt32)) {
-      const int* x_data1 = x->template data<int>();
-      const int* y_data1 = y->template data<int>();
-      const bool* cond_data1 = condition->template data<bool>();
-      int* out_data1 = out->template mutable_data<int>();
-      for (int i = 0; i < numel; i++) {
-        out_data1[i] = cond_data1[i] ? x_data1[i] : y_data1[i];
-      }
-    } else if (x->precision() == PRECISION(kInt64)) {
-      const int64_t* x_data2 = x->template data<int64_t>();
-      const int64_t* y_data2 = y->template data<int64_t>();
-      const bool* cond_data2 = condition->template data<bool>();
-      int64_t* out_data2 = out->template mutable_data<int64_t>();
-      for (int i = 0; i < numel; i++) {
-        out_data2[i] = cond_data2[i] ? x_data2[i] : y_data2[i];
-      }
-    } else if (x->precision() == PRECISION(kInt8)) {
-      const int8_t* x_data3 = x->template data<int8_t>();
-      const int8_t* y_data3 = y->template data<int8_t>();
-      const bool* cond_data3 = condition->template data<bool>();
-      int8_t* out_data3 = out->template mutable_data<int8_t>();
-      for (int i = 0; i < numel; i++) {
-        out_data3[i] = cond_data3[i] ? x_data3[i] : y_data3[i];
-      }
-    } else if (x->precision() == PRECISION(kBool)) {
-      const bool* x_data4 = x->template data<bool>();
-      const bool* y_data4 = y->template data<bool>();
-      const bool* cond_data4 = condition->template data<bool>();
-      bool* out_data4 = out->template mutable_data<bool>();
-      for (int i = 0; i < numel; i++) {
-        out_data4[i] = cond_data4[i] ? x_data4[i] : y_data4[i];
-      }
-    } else {
-      LOG(FATAL) << "Where does not implement for the "
-                 << "input type:" << static_cast<int>(x->precision());
+    const T* x_data = x->template data<T>();
+    const T* y_data = y->template data<T>();
+    const bool* cond_data = condition->template data<bool>();
+    T* out_data = out->template mutable_data<T>();
+    for (int64_t i = 0; i < numel; i++) {
+      out_data[i] = cond_data[i] ? x_data[i] : y_data[i];
     }
   }
 
@@ -97,38 +61,47 @@ class WhereComputeTester : public arena::TestCase {
   }
 
   void PrepareData() override {
-    std::vector<float> dx(x_dims_.production());
-    std::vector<float> dy(x_dims_.production());
-    fill_data_rand(dx.data(), -1.f, 1.f, x_dims_.production());
-    fill_data_rand(dy.data(), -1.f, 1.f, x_dims_.production());
+    int64_t numel = x_dims_.production();
+    std::vector<T> dx(numel);
+    std::vector<T> dy(numel);
+    fill_data_rand<T>(dx.data(), -100, 100, numel);
+    fill_data_rand<T>(dy.data(), -100, 100, numel);
     SetCommonTensor(x_, x_dims_, dx.data());
     SetCommonTensor(y_, x_dims_, dy.data());
-    std::vector<bool> dc(x_dims_.production());
-    for (int i = 0; i < x_dims_.production(); i++) {
-      dc[i] = (i % 2) ? true : false;
+    std::unique_ptr<bool[]> dc(new bool[numel]);
+    for (int64_t i = 0; i < numel; i++) {
+      dc[i] = (i % 3 == 0) || (i % 7 == 1);
     }
-    SetCommonTensor(condition_, x_dims_, dc);
+    SetCommonTensor(condition_, x_dims_, dc.get());
   }
 };
 
+template <typename T>
 void TestWhere(Place place, float abs_error) {
-  DDimLite dims{{3, 5, 4, 4}};
-  std::unique_ptr<arena::TestCase> tester(
-      new WhereComputeTester(place, "def", dims));
-  arena::Arena arena(std::move(tester), place, abs_error);
-  arena.TestPrecision();
+  // 37 and 16389 leave tails after the 16-wide vector loop, and 16389 also
+  // spans more than one parallel chunk.
+  for (auto dims : std::vector<std::vector<int64_t>>{
+           {3, 5, 4, 4}, {3, 37}, {5}, {2, 16389}}) {
+    std::unique_ptr<arena::TestCase> tester(
+        new WhereComputeTester<T>(place, "def", DDim(dims)));
+    arena::Arena arena(std::move(tester), place, abs_error);
+    arena.TestPrecision();
+  }
 }
 
 TEST(where, precision) {
   Place place;
   float abs_error = 1e-5;
-#ifdef LITE_WITH_ARM
+#if defined(LITE_WITH_X86) || defined(LITE_WITH_ARM)
   place = TARGET(kHost);
 #else
   return;
 #endif
 
-  TestWhere(place, abs_error);
+  TestWhere<float>(place, abs_error);
+  TestWhere<int32_t>(place, abs_error);
+  TestWhere<int64_t>(place, abs_error);
+  TestWhere<int8_t>(place, abs_error);
 }
 
 }  // namespace lite
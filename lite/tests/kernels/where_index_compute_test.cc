@@ -0,0 +1,105 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include "lite/api/paddle_use_kernels.h"
+#include "lite/api/paddle_use_ops.h"
+#include "lite/core/arena/framework.h"
+
+namespace paddle {
+namespace lite {
+
+template <typename T>
+class WhereIndexComputeTester : public arena::TestCase {
+ protected:
+  std::string condition_ = "Condition";
+  std::string out_ = "Out";
+  DDim dims_{{3, 5, 4, 4}};
+
+ public:
+  WhereIndexComputeTester(const Place& place,
+                          const std::string& alias,
+                          DDim dims)
+      : TestCase(place, alias), dims_(dims) {}
+
+  void RunBaseline(Scope* scope) override {
+    auto* condition = scope->FindTensor(condition_);
+    auto* out = scope->NewTensor(out_);
+    const T* cond_data = condition->template data<T>();
+    int64_t numel = dims_.production();
+    int64_t rank = static_cast<int64_t>(dims_.size());
+    std::vector<int64_t> indices;
+    for (int64_t i = 0; i < numel; i++) {
+      if (static_cast<bool>(cond_data[i])) {
+        indices.push_back(i);
+      }
+    }
+    out->Resize({static_cast<int64_t>(indices.size()), rank});
+    int64_t* out_data = out->template mutable_data<int64_t>();
+    for (auto index : indices) {
+      for (int64_t r = rank - 1; r >= 0; r--) {
+        out_data[r] = index % dims_[r];
+        index /= dims_[r];
+      }
+      out_data += rank;
+    }
+  }
+
+  void PrepareOpDesc(cpp::OpDesc* op_desc) {
+    op_desc->SetType("where_index");
+    op_desc->SetInput("Condition", {condition_});
+    op_desc->SetOutput("Out", {out_});
+  }
+
+  void PrepareData() override {
+    int64_t numel = dims_.production();
+    std::unique_ptr<T[]> dc(new T[numel]);
+    for (int64_t i = 0; i < numel; i++) {
+      dc[i] = static_cast<T>((i % 3 == 0) || (i % 7 == 1) ? i % 5 + 1 : 0);
+    }
+    SetCommonTensor(condition_, dims_, dc.get());
+  }
+};
+
+template <typename T>
+void TestWhereIndex(Place place, float abs_error) {
+  // Lengths which are not multiples of the 64-element mask words, and one
+  // which spans more than one parallel chunk.
+  for (auto dims : std::vector<std::vector<int64_t>>{
+           {3, 5, 4, 4}, {3, 37}, {70}, {5}, {2, 3, 29}, {2, 16389}}) {
+    std::unique_ptr<arena::TestCase> tester(
+        new WhereIndexComputeTester<T>(place, "def", DDim(dims)));
+    arena::Arena arena(std::move(tester), place, abs_error);
+    arena.TestPrecision();
+  }
+}
+
+TEST(where_index, precision) {
+  Place place;
+  float abs_error = 1e-5;
+#if defined(LITE_WITH_X86) || defined(LITE_WITH_ARM)
+  place = TARGET(kHost);
+#else
+  return;
+#endif
+
+  TestWhereIndex<float>(place, abs_error);
+  TestWhereIndex<int32_t>(place, abs_error);
+  TestWhereIndex<int64_t>(place, abs_error);
+  TestWhereIndex<int8_t>(place, abs_error);
+  TestWhereIndex<bool>(place, abs_error);
+}
+
+}  // namespace lite
+}  // namespace paddle
@@ -46,6 +46,11 @@
 #define QUANT_INPUT_OUTPUT_SCALE_RESTRICT_METHOD \
   "QUANT_INPUT_OUTPUT_SCALE_RESTRICT_METHOD"
 
+// Time the interchangeable kernels of every op on the real shapes when picking
+// kernels in the analysis phase, and pick the fastest one. Only the ops whose
+// input shapes are fully known in the model are timed.
+#define KERNEL_PICK_BENCHMARK "KERNEL_PICK_BENCHMARK"
+
 namespace paddle {
 namespace lite {
 
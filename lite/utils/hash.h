@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 
 namespace paddle {
@@ -25,5 +27,29 @@ inline void CombineHash(const T& from, size_t* to) {
   *to ^= h(from) + 0x9e3779b9 + (*to << 6) + (*to >> 2);
 }
 
+// The CRC-32 (IEEE 802.3) of `size` bytes, which continues `crc` of the bytes
+// before them.
+inline uint32_t Crc32(const void* data, size_t size, uint32_t crc = 0) {
+  struct Table {
+    uint32_t values[256];
+    Table() {
+      for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+          c = (c & 1) ? 0xedb88320U ^ (c >> 1) : c >> 1;
+        }
+        values[i] = c;
+      }
+    }
+  };
+  static const Table table;
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  crc = ~crc;
+  for (size_t i = 0; i < size; ++i) {
+    crc = table.values[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
 }  // namespace lite
 }  // namespace paddle
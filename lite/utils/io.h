@@ -112,7 +112,7 @@ static std::vector<std::string> ListDir(const std::string& path,
     // Exclude '.', '..' and hidden dir
     std::string name(dp->d_name);
     if (name == "." || name == ".." || name[0] == '.') continue;
-    if (IsDir(Join<std::string>({path, name}, "/"))) {
+    if (!only_dir || IsDir(Join<std::string>({path, name}, "/"))) {
       paths.push_back(name);
     }
   }
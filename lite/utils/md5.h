@@ -13,52 +13,99 @@
 // limitations under the License.
 
 #pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <string>
 
 namespace paddle {
 namespace lite {
 
-std::string MD5(std::string message) {
-  const uint32_t shiftAmounts[] = {
-      7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
-      5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20,
-      4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
-      6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21};
-  const uint32_t partsOfSines[] = {
-      0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a,
-      0xa8304613, 0xfd469501, 0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be,
-      0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821, 0xf61e2562, 0xc040b340,
-      0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
-      0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8,
-      0x676f02d9, 0x8d2a4c8a, 0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c,
-      0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70, 0x289b7ec6, 0xeaa127fa,
-      0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
-      0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92,
-      0xffeff47d, 0x85845dd1, 0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
-      0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391};
+// The MD5 of a message which is fed in pieces, e.g. while it is written into
+// a file.
+class MD5Hasher {
+ public:
+  MD5Hasher() {
+    state_[0] = 0x67452301;
+    state_[1] = 0xefcdab89;
+    state_[2] = 0x98badcfe;
+    state_[3] = 0x10325476;
+  }
+
+  void Update(const void *data, size_t size) {
+    const uint8_t *src = static_cast<const uint8_t *>(data);
+    size_t used = length_ % 64;
+    length_ += size;
+    if (used > 0) {
+      const size_t n = (std::min)(size, 64 - used);
+      memcpy(buf_ + used, src, n);
+      src += n;
+      size -= n;
+      if (used + n < 64) return;
+      Transform(buf_);
+    }
+    for (; size >= 64; src += 64, size -= 64) {
+      Transform(src);
+    }
+    memcpy(buf_, src, size);
+  }
+
+  // The 16 bytes of the digest, after which the hasher can't be updated.
+  void Final(uint8_t digest[16]) {
+    const uint64_t bits = length_ * 8;
+    const uint8_t padding[64] = {128};
+    Update(padding, 1 + (119 - length_ % 64) % 64);
+    uint8_t tail[8];
+    for (int i = 0; i < 8; ++i) {
+      tail[i] = static_cast<uint8_t>(bits >> (8 * i));
+    }
+    Update(tail, sizeof(tail));
+    memcpy(digest, state_, 16);
+  }
 
-  uint32_t state[4];
-  state[0] = 0x67452301;
-  state[1] = 0xefcdab89;
-  state[2] = 0x98badcfe;
-  state[3] = 0x10325476;
+  // The digest as 32 hex characters.
+  std::string HexFinal() {
+    uint8_t digest[16];
+    Final(digest);
+    std::string res;
+    res.reserve(16 << 1);
+    char hex[3];
+    for (size_t i = 0; i < 16; i++) {
+      snprintf(hex, sizeof(hex), "%02x", digest[i]);
+      res.append(hex);
+    }
+    return res;
+  }
 
-  // Pad with zeros
-  int size = ((((message.length() + 8) / 64) + 1) * 64) - 8;
-  uint8_t *buf = reinterpret_cast<uint8_t *>(calloc(size + 64, 1));
-  memcpy(buf, message.c_str(), message.length());
-  buf[message.length()] = 128;
-  uint32_t bits = 8 * message.length();
-  memcpy(buf + size, &bits, 4);
+ private:
+  // Process a 512-bit(64 bytes) chunk.
+  void Transform(const uint8_t *chunk) {
+    static const uint32_t shiftAmounts[] = {
+        7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+        5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20,
+        4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+        6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21};
+    static const uint32_t partsOfSines[] = {
+        0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a,
+        0xa8304613, 0xfd469501, 0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be,
+        0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821, 0xf61e2562, 0xc040b340,
+        0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+        0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8,
+        0x676f02d9, 0x8d2a4c8a, 0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c,
+        0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70, 0x289b7ec6, 0xeaa127fa,
+        0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+        0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92,
+        0xffeff47d, 0x85845dd1, 0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
+        0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391};
 
-// Process at each 512-bit(64 bytes) chunk
+    uint32_t W[16];
+    memcpy(W, chunk, sizeof(W));
+    uint32_t A = state_[0];
+    uint32_t B = state_[1];
+    uint32_t C = state_[2];
+    uint32_t D = state_[3];
 #define LEFTROTATE(x, c) (((x) << (c)) | ((x) >> (32 - (c))))
-  for (int offset = 0; offset < size; offset += 64) {
-    uint32_t A = state[0];
-    uint32_t B = state[1];
-    uint32_t C = state[2];
-    uint32_t D = state[3];
-    uint32_t *W = reinterpret_cast<uint32_t *>(buf + offset);
     for (uint32_t i = 0; i < 64; i++) {
       uint32_t F, g;
       if (i < 16) {
@@ -80,24 +127,22 @@ std::string MD5(std::string message) {
       B = B + LEFTROTATE((A + F + partsOfSines[i] + W[g]), shiftAmounts[i]);
       A = T;
     }
-    state[0] += A;
-    state[1] += B;
-    state[2] += C;
-    state[3] += D;
-  }
 #undef LEFTROTATE
-  free(buf);
-
-  // Convert digest to string
-  std::string res;
-  res.reserve(16 << 1);
-  const uint8_t *digest = reinterpret_cast<uint8_t *>(state);
-  char hex[3];
-  for (size_t i = 0; i < 16; i++) {
-    snprintf(hex, sizeof(hex), "%02x", digest[i]);
-    res.append(hex);
+    state_[0] += A;
+    state_[1] += B;
+    state_[2] += C;
+    state_[3] += D;
   }
-  return res;
+
+  uint32_t state_[4];
+  uint8_t buf_[64];
+  uint64_t length_{0};
+};
+
+inline std::string MD5(const std::string &message) {
+  MD5Hasher hasher;
+  hasher.Update(message.data(), message.size());
+  return hasher.HexFinal();
 }
 
 }  // namespace lite
@@ -0,0 +1,61 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "lite/utils/trace.h"
+
+namespace paddle {
+namespace lite {
+
+// Run fn(0), ..., fn(num - 1) on `num_threads` threads including the calling
+// one. The tasks are taken one by one, so tasks of uneven costs, such as
+// params of different sizes, are balanced across the threads. It is meant
+// for coarse tasks at load time, which don't share the threads of kernels.
+inline void ParallelFor(int64_t num,
+                        int num_threads,
+                        const std::function<void(int64_t)>& fn) {
+  const int64_t threads = (std::min)(static_cast<int64_t>(num_threads), num);
+  auto task = [&](int64_t i) {
+    TraceScope trace("task", "parallel_task", "idx", i);
+    fn(i);
+  };
+  if (threads <= 1) {
+    for (int64_t i = 0; i < num; ++i) {
+      task(i);
+    }
+    return;
+  }
+  std::atomic<int64_t> next{0};
+  auto worker = [&]() {
+    for (int64_t i = next++; i < num; i = next++) {
+      task(i);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (int64_t i = 1; i < threads; ++i) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto& t : workers) {
+    t.join();
+  }
+}
+
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,206 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/utils/trace.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include "lite/utils/macros.h"
+
+namespace paddle {
+namespace lite {
+
+constexpr size_t TraceEvent::kMaxNameSize;
+constexpr size_t Tracer::kDefaultEventsPerThread;
+
+namespace {
+
+uint32_t ThreadTraceId() {
+  static std::atomic<uint32_t> next_id{0};
+  static LITE_THREAD_LOCAL uint32_t id = next_id++;
+  return id;
+}
+
+void AppendEscaped(const char* str, std::string* out) {
+  for (; *str; ++str) {
+    if (*str == '"' || *str == '\\') {
+      out->push_back('\\');
+    }
+    out->push_back(*str);
+  }
+}
+
+}  // namespace
+
+// Give the buffer of a thread back to the tracer when the thread exits.
+struct ThreadTraceBuffer {
+  ~ThreadTraceBuffer() {
+    if (buffer) Tracer::Global().ReleaseBuffer(buffer);
+  }
+  TraceBuffer* buffer{nullptr};
+};
+
+void TraceBuffer::Reset(size_t capacity) {
+  head_.store(0, std::memory_order_relaxed);
+  events_.assign(capacity, TraceEvent());
+}
+
+void TraceBuffer::Collect(std::vector<TraceEvent>* events) const {
+  const uint64_t head = head_.load(std::memory_order_acquire);
+  const uint64_t size = (std::min)(head, uint64_t(events_.size()));
+  for (uint64_t i = head - size; i < head; ++i) {
+    events->push_back(events_[i % events_.size()]);
+  }
+}
+
+Tracer& Tracer::Global() {
+  // Never destroyed, since the threads may release their buffers after the
+  // static objects are destroyed at exit.
+  static Tracer* x = new Tracer;
+  return *x;
+}
+
+void Tracer::Enable(size_t events_per_thread) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_per_thread_ = (std::max)(events_per_thread, size_t(1));
+  for (auto& buffer : buffers_) {
+    buffer->Reset(events_per_thread_);
+  }
+  start_ns_ = SteadyNowNs();
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& buffer : buffers_) {
+    buffer->Reset(events_per_thread_);
+  }
+}
+
+TraceBuffer* Tracer::ThreadBuffer() {
+  static LITE_THREAD_LOCAL ThreadTraceBuffer thread_buffer;
+  if (!thread_buffer.buffer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!free_buffers_.empty()) {
+      thread_buffer.buffer = free_buffers_.back();
+      free_buffers_.pop_back();
+    } else {
+      buffers_.emplace_back(new TraceBuffer(events_per_thread_));
+      thread_buffer.buffer = buffers_.back().get();
+    }
+  }
+  return thread_buffer.buffer;
+}
+
+void Tracer::ReleaseBuffer(TraceBuffer* buffer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  free_buffers_.push_back(buffer);
+}
+
+void Tracer::AddComplete(const char* category,
+                         const char* name,
+                         uint64_t begin_ns,
+                         uint64_t end_ns,
+                         const char* arg_name,
+                         int64_t arg) {
+  TraceEvent event;
+  event.begin_ns = begin_ns;
+  event.end_ns = end_ns;
+  event.category = category;
+  event.arg_name = arg_name;
+  event.arg = arg;
+  event.tid = ThreadTraceId();
+  event.phase = 'X';
+  std::strncpy(event.name, name, TraceEvent::kMaxNameSize - 1);
+  ThreadBuffer()->Add(event);
+}
+
+void Tracer::AddCounter(const char* category,
+                        const char* name,
+                        const char* arg_name,
+                        int64_t value) {
+  if (!enabled()) return;
+  TraceEvent event;
+  event.begin_ns = SteadyNowNs();
+  event.category = category;
+  event.arg_name = arg_name;
+  event.arg = value;
+  event.tid = ThreadTraceId();
+  event.phase = 'C';
+  std::strncpy(event.name, name, TraceEvent::kMaxNameSize - 1);
+  ThreadBuffer()->Add(event);
+}
+
+std::string Tracer::ToChromeTrace() const {
+  std::vector<TraceEvent> events;
+  uint64_t start_ns = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& buffer : buffers_) {
+      buffer->Collect(&events);
+    }
+    start_ns = start_ns_;
+  }
+  std::sort(events.begin(),
+            events.end(),
+            [](const TraceEvent& a, const TraceEvent& b) {
+              return a.begin_ns < b.begin_ns;
+            });
+  // The timestamps are in us, relative to when the tracer was enabled.
+  std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  char buf[128];
+  for (size_t i = 0; i < events.size(); ++i) {
+    const auto& event = events[i];
+    if (i > 0) json.push_back(',');
+    json += "\n{\"name\":\"";
+    AppendEscaped(event.name, &json);
+    json += "\",\"cat\":\"";
+    AppendEscaped(event.category, &json);
+    snprintf(buf,
+             sizeof(buf),
+             "\",\"ph\":\"%c\",\"pid\":0,\"tid\":%" PRIu32 ",\"ts\":%.3f",
+             event.phase,
+             event.tid,
+             (static_cast<int64_t>(event.begin_ns - start_ns)) / 1e3);
+    json += buf;
+    if (event.phase == 'X') {
+      snprintf(buf,
+               sizeof(buf),
+               ",\"dur\":%.3f",
+               (event.end_ns - event.begin_ns) / 1e3);
+      json += buf;
+    }
+    if (event.arg_name) {
+      json += ",\"args\":{\"";
+      AppendEscaped(event.arg_name, &json);
+      snprintf(buf, sizeof(buf), "\":%" PRId64 "}", event.arg);
+      json += buf;
+    }
+    json.push_back('}');
+  }
+  json += "\n]}\n";
+  return json;
+}
+
+bool Tracer::DumpChromeTrace(const std::string& path) const {
+  const std::string json = ToChromeTrace();
+  FILE* file = fopen(path.c_str(), "wb");
+  if (!file) return false;
+  const bool written = fwrite(json.data(), 1, json.size(), file) == json.size();
+  return fclose(file) == 0 && written;
+}
+
+}  // namespace lite
+}  // namespace paddle
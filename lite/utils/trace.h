@@ -0,0 +1,158 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace lite {
+
+inline uint64_t SteadyNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+struct TraceEvent {
+  static constexpr size_t kMaxNameSize = 32;
+
+  uint64_t begin_ns{0};
+  // The end of a complete event, unused by a counter.
+  uint64_t end_ns{0};
+  // The category and the name of the arg are literals.
+  const char* category{nullptr};
+  const char* arg_name{nullptr};
+  int64_t arg{0};
+  uint32_t tid{0};
+  // 'X' for a complete event, 'C' for a counter.
+  char phase{'X'};
+  char name[kMaxNameSize]{};
+};
+
+// The ring buffer of the events of a thread, which keeps the latest
+// `capacity` events. Only its thread writes it, so adding an event takes no
+// lock.
+class TraceBuffer {
+ public:
+  explicit TraceBuffer(size_t capacity) : events_(capacity) {}
+
+  void Add(const TraceEvent& event) {
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    events_[head % events_.size()] = event;
+    head_.store(head + 1, std::memory_order_release);
+  }
+
+  // Drop the events, and keep `capacity` of them from now on.
+  void Reset(size_t capacity);
+  // Append the events kept in the order they were added.
+  void Collect(std::vector<TraceEvent>* events) const;
+
+ private:
+  std::vector<TraceEvent> events_;
+  std::atomic<uint64_t> head_{0};
+};
+
+/*
+ * Tracer records the begin and the end of the runs, the instructions, the
+ * chunks of the parallel loops and the tasks of ParallelFor, and the sizes of
+ * the workspaces, on every thread, to be dumped as Chrome trace JSON, which
+ * shows the gaps between the instructions and the threads idle inside them in
+ * chrome://tracing or Perfetto.
+ *
+ * Recording costs a relaxed load when the tracer is disabled. Enable, Clear
+ * and the dumps should be called between the runs.
+ */
+class Tracer {
+ public:
+  static constexpr size_t kDefaultEventsPerThread = 1 << 14;
+
+  static Tracer& Global();
+
+  void Enable(size_t events_per_thread = kDefaultEventsPerThread);
+  void Disable() { enabled_.store(false, std::memory_order_relaxed); }
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+  // Drop the events recorded.
+  void Clear();
+
+  void AddComplete(const char* category,
+                   const char* name,
+                   uint64_t begin_ns,
+                   uint64_t end_ns,
+                   const char* arg_name = nullptr,
+                   int64_t arg = 0);
+  void AddCounter(const char* category,
+                  const char* name,
+                  const char* arg_name,
+                  int64_t value);
+
+  std::string ToChromeTrace() const;
+  bool DumpChromeTrace(const std::string& path) const;
+
+ private:
+  Tracer() = default;
+  TraceBuffer* ThreadBuffer();
+  void ReleaseBuffer(TraceBuffer* buffer);
+
+  std::atomic<bool> enabled_{false};
+  uint64_t start_ns_{0};
+  size_t events_per_thread_{kDefaultEventsPerThread};
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<TraceBuffer>> buffers_;
+  // The buffers of the threads exited, whose events are kept until a new
+  // thread takes them, since the threads of ParallelFor don't live long.
+  std::vector<TraceBuffer*> free_buffers_;
+
+  friend struct ThreadTraceBuffer;
+};
+
+// Record a complete event from its construction to its destruction if the
+// tracer is enabled.
+class TraceScope {
+ public:
+  TraceScope(const char* category,
+             const char* name,
+             const char* arg_name = nullptr,
+             int64_t arg = 0) {
+    if (Tracer::Global().enabled()) {
+      category_ = category;
+      name_ = name;
+      arg_name_ = arg_name;
+      arg_ = arg;
+      begin_ns_ = SteadyNowNs();
+    }
+  }
+  ~TraceScope() {
+    if (begin_ns_ > 0) {
+      Tracer::Global().AddComplete(
+          category_, name_, begin_ns_, SteadyNowNs(), arg_name_, arg_);
+    }
+  }
+
+ private:
+  const char* category_{nullptr};
+  const char* name_{nullptr};
+  const char* arg_name_{nullptr};
+  int64_t arg_{0};
+  uint64_t begin_ns_{0};
+};
+
+}  // namespace lite
+}  // namespace paddle
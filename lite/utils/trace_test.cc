@@ -0,0 +1,78 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/utils/trace.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "lite/utils/parallel.h"
+
+namespace paddle {
+namespace lite {
+
+namespace {
+
+size_t Count(const std::string& str, const std::string& pattern) {
+  size_t count = 0;
+  for (size_t pos = str.find(pattern); pos != std::string::npos;
+       pos = str.find(pattern, pos + 1)) {
+    ++count;
+  }
+  return count;
+}
+
+}  // namespace
+
+TEST(Tracer, chrome_trace) {
+  auto& tracer = Tracer::Global();
+  { TraceScope trace("op", "disabled"); }
+  tracer.Enable();
+  {
+    TraceScope trace("run", "run");
+    ParallelFor(8, 4, [](int64_t i) {});
+    tracer.AddCounter("memory", "workspace", "bytes", 1024);
+  }
+  tracer.Disable();
+  { TraceScope trace("op", "disabled"); }
+
+  const std::string json = tracer.ToChromeTrace();
+  EXPECT_EQ(json.find("disabled"), std::string::npos);
+  EXPECT_EQ(Count(json, "\"name\":\"run\""), 1u);
+  EXPECT_EQ(Count(json, "\"name\":\"parallel_task\""), 8u);
+  EXPECT_EQ(Count(json, "\"ph\":\"C\""), 1u);
+  EXPECT_NE(json.find("\"args\":{\"bytes\":1024}"), std::string::npos);
+  EXPECT_EQ(json.front(), '{');
+  EXPECT_EQ(json.substr(json.size() - 3), "]}\n");
+}
+
+TEST(Tracer, ring_buffer) {
+  auto& tracer = Tracer::Global();
+  tracer.Enable(4);
+  for (int i = 0; i < 10; ++i) {
+    TraceScope trace("op", "conv2d", "idx", i);
+  }
+  tracer.Disable();
+  const std::string json = tracer.ToChromeTrace();
+  // Only the latest events are kept.
+  EXPECT_EQ(Count(json, "\"name\":\"conv2d\""), 4u);
+  EXPECT_EQ(json.find("\"idx\":5}"), std::string::npos);
+  EXPECT_NE(json.find("\"idx\":6}"), std::string::npos);
+  EXPECT_NE(json.find("\"idx\":9}"), std::string::npos);
+
+  tracer.Clear();
+  EXPECT_EQ(Count(tracer.ToChromeTrace(), "\"name\""), 0u);
+}
+
+}  // namespace lite
+}  // namespace paddle